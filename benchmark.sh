@@ -0,0 +1,73 @@
+#!/bin/bash
+
+# Mide el tiempo de ejecución de un programa Lyn en cada nivel de optimización
+# (-o 0 a -o 3) y la ganancia frente a -o 0. Por defecto usa benchmark.lyn.
+
+# Colores para los mensajes
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+SOURCE="${1:-benchmark.lyn}"
+RUNS="${RUNS:-3}"
+BASE="${SOURCE%.lyn}"
+
+# Compilar el compilador Lyn con -rdynamic para exportar símbolos
+echo -e "${YELLOW}Compilando el compilador Lyn...${NC}"
+CFLAGS="${CFLAGS} -Wno-unused-variable"
+gcc $CFLAGS -o lyn src/*.c -rdynamic -I./src
+
+if [ $? -ne 0 ]; then
+    echo -e "${RED}Error compilando el compilador${NC}"
+    exit 1
+fi
+
+if [ ! -f "$SOURCE" ]; then
+    echo -e "${RED}No existe $SOURCE${NC}"
+    echo -e "${RED}Uso: $0 [archivo.lyn]${NC}"
+    exit 1
+fi
+
+# El mejor de $RUNS tiempos (en segundos) de ./$BASE.out
+best_time() {
+    local best=""
+    TIMEFORMAT=%R
+    for run in $(seq 1 "$RUNS"); do
+        local t
+        t=$( { time "./$BASE.out" > /dev/null 2>&1; } 2>&1 )
+        if [ -z "$best" ] || awk "BEGIN { exit !($t < $best) }"; then
+            best=$t
+        fi
+    done
+    echo "$best"
+}
+
+echo -e "${YELLOW}Midiendo $SOURCE (mejor de $RUNS ejecuciones)...${NC}"
+printf "%-6s %10s %10s\n" "Nivel" "Tiempo(s)" "Ganancia"
+BASELINE=""
+REFERENCE=""
+for level in 0 1 2 3; do
+    rm -f "$BASE.out"
+    ./lyn -d 0 -o "$level" "$SOURCE" > /dev/null 2>&1
+    if [ ! -x "$BASE.out" ]; then
+        echo -e "${RED}Error compilando $SOURCE con -o $level${NC}"
+        exit 1
+    fi
+
+    # La salida debe ser la misma en todos los niveles
+    OUTPUT=$("./$BASE.out" 2>&1)
+    if [ -z "$REFERENCE" ]; then
+        REFERENCE="$OUTPUT"
+    elif [ "$OUTPUT" != "$REFERENCE" ]; then
+        echo -e "${RED}La salida con -o $level difiere de la de -o 0${NC}"
+        exit 1
+    fi
+
+    SECONDS_TAKEN=$(best_time)
+    [ -z "$BASELINE" ] && BASELINE=$SECONDS_TAKEN
+    SPEEDUP=$(awk "BEGIN { printf \"%.2fx\", $BASELINE / ($SECONDS_TAKEN > 0 ? $SECONDS_TAKEN : 0.001) }")
+    printf "%-6s %10s %10s\n" "-o $level" "$SECONDS_TAKEN" "$SPEEDUP"
+done
+
+echo -e "${GREEN}¡Medición completada!${NC}"
@@ -11,11 +11,14 @@
  */
 
 #include "aspect_weaver.h"
+#include "hashmap.h"
 #include "logger.h"
 #include "error.h"
 #include "memory.h"
+#include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
 
 // Usamos la enumeración AdviceType definida en ast.h en lugar de defines
 #include "ast.h"
@@ -48,12 +51,68 @@ typedef struct {
 /** Global list of aspects found during analysis */
 static AspectList aspect_list = {NULL, 0};
 
+/** Upper bound on cached matcher states before the cache is rebuilt */
+#define MAX_MATCHER_STATES 4096
+
+/**
+ * @brief A pointcut together with the aspect that declares it
+ */
+typedef struct {
+    AstNode* aspect;    ///< Aspect definition node
+    AstNode* pointcut;  ///< Pointcut node inside the aspect
+} PointcutRef;
+
+/**
+ * @brief State of the lazily built pointcut DFA
+ *
+ * Each state is a set of positions in the combined pattern automaton.
+ * Transitions are filled in the first time a character is seen.
+ */
+typedef struct {
+    unsigned char* positions;  ///< Bitset of active pattern positions
+    int transitions[256];      ///< Next state per input byte (-1 = not built yet)
+    int* matches;              ///< Pointcuts accepted in this state (ascending)
+    int matchCount;            ///< Number of accepted pointcuts
+} MatcherState;
+
+/**
+ * @brief Combined matcher for every pointcut pattern in the program
+ *
+ * All patterns are laid out in one position array: position i of pattern k
+ * means "the first i characters of pattern k have been matched". A '*'
+ * position loops on any character and may also be skipped. Sets of
+ * positions are turned into DFA states on demand, so matching a name is a
+ * single pass over its characters regardless of the number of pointcuts.
+ */
+typedef struct {
+    PointcutRef* pointcuts;    ///< Pointcuts in declaration order
+    int pointcutCount;         ///< Number of pointcuts
+    char* positionChar;        ///< Pattern character at each position ('\0' = accept)
+    int* pointcutStart;        ///< First position of each pointcut's pattern
+    int positionCount;         ///< Total number of positions
+    int setBytes;              ///< Size in bytes of a position bitset
+    MatcherState* states;      ///< DFA states built so far (state 0 is the start)
+    int stateCount;            ///< Number of DFA states
+    int stateCapacity;         ///< Allocated DFA states
+    HashMap* stateIndex;       ///< Position bitset (hex) -> state index + 1
+} PointcutMatcher;
+
+/** Matcher built from the collected aspects */
+static PointcutMatcher matcher = {0};
+
+/** Proceed functions created by around advice; they are never join points themselves */
+static HashMap* proceed_functions = NULL;
+
 // Prototipos de funciones internas
 static bool collect_aspects(AstNode* ast);
 static bool apply_aspects(AstNode* ast);
-static bool matches_pointcut(const char* pattern, const char* target);
+static bool build_pointcut_matcher(void);
+static const int* match_pointcuts(const char* name, int* count);
+static void free_pointcut_matcher(void);
 static AstNode* clone_advice_body(AstNode* advice);
 static void insert_advice(AstNode* target, AstNode* advice, int position);
+static void weave_after_advice(AstNode* target, AstNode* advice);
+static bool weave_around_advice(AstNode* target, AstNode* advice);
 
 /**
  * @brief Initializes the aspect weaving system
@@ -75,6 +134,9 @@ void weaver_init(void) {
         aspect_list.aspects = NULL;
     }
     aspect_list.count = 0;
+    free_pointcut_matcher();
+    hashmap_free(proceed_functions, NULL);
+    proceed_functions = NULL;
     
     logger_log(LOG_INFO, "Aspect weaver initialized");
 }
@@ -127,7 +189,12 @@ bool weaver_process(AstNode* ast) {
     
     logger_log(LOG_INFO, "Found %d aspects in the program", aspect_list.count);
     
-    // Step 2: Apply the found aspects
+    // Step 2: Compile every pointcut into a single matcher
+    if (!build_pointcut_matcher()) {
+        return false;
+    }
+    
+    // Step 3: Apply the found aspects
     if (!apply_aspects(ast)) {
         return false;
     }
@@ -164,6 +231,9 @@ void weaver_cleanup(void) {
         aspect_list.aspects = NULL;
     }
     aspect_list.count = 0;
+    free_pointcut_matcher();
+    hashmap_free(proceed_functions, NULL);
+    proceed_functions = NULL;
     
     logger_log(LOG_INFO, "Aspect weaver cleanup completed");
 }
@@ -240,6 +310,11 @@ static bool collect_aspects(AstNode* node) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+        case AST_ARRAY_ASSIGN:
+            // Concatenations and element stores only hold expressions
+            break;
+            
         // Añadir otros casos según sea necesario
     }
     
@@ -262,74 +337,74 @@ static bool apply_aspects(AstNode* node) {
     
     if (!node) return true;
     
-    // If it's a function definition, check if it matches any pointcut
-    if (node->type == AST_FUNC_DEF) {
+    // If it's a function definition, check if it matches any pointcut. The
+    // proceed functions nested by around advice hold bodies that were already
+    // advised; matching them again would wrap them without end.
+    if (node->type == AST_FUNC_DEF && !hashmap_contains(proceed_functions, node->funcDef.name)) {
         logger_log(LOG_DEBUG, "Checking function '%s' for aspect application", node->funcDef.name);
         
-        for (int i = 0; i < aspect_list.count; i++) {
-            AstNode* aspect = aspect_list.aspects[i];
+        // One pass over the name yields every matching pointcut, in declaration order
+        int matchCount = 0;
+        const int* matches = match_pointcuts(node->funcDef.name, &matchCount);
+        
+        for (int m = 0; m < matchCount; m++) {
+            AstNode* aspect = matcher.pointcuts[matches[m]].aspect;
+            AstNode* pointcut = matcher.pointcuts[matches[m]].pointcut;
+            stats.joinpoints_found++;
             
-            for (int j = 0; j < aspect->aspectDef.pointcutCount; j++) {
-                AstNode* pointcut = aspect->aspectDef.pointcuts[j];
-                
-                logger_log(LOG_DEBUG, "Checking if '%s' matches pattern '%s'", 
-                          node->funcDef.name, pointcut->pointcut.pattern);
+            logger_log(LOG_INFO, "Found joinpoint: %s matches %s",
+                     node->funcDef.name, pointcut->pointcut.pattern);
+            
+            // Apply all advice associated with this pointcut
+            for (int k = 0; k < aspect->aspectDef.adviceCount; k++) {
+                AstNode* advice = aspect->aspectDef.advice[k];
                 
-                if (matches_pointcut(pointcut->pointcut.pattern, node->funcDef.name)) {
-                    stats.joinpoints_found++;
-                    
-                    logger_log(LOG_INFO, "Found joinpoint: %s matches %s",
-                             node->funcDef.name, pointcut->pointcut.pattern);
+                if (strcmp(advice->advice.pointcutName, pointcut->pointcut.name) == 0) {
+                    // Clone the advice body
+                    AstNode* advice_body = clone_advice_body(advice);
+                    if (!advice_body) {
+                        strncpy(stats.error_msg, "Failed to clone advice body", sizeof(stats.error_msg)-1);
+                        return false;
+                    }
                     
-                    // Apply all advice associated with this pointcut
-                    for (int k = 0; k < aspect->aspectDef.adviceCount; k++) {
-                        AstNode* advice = aspect->aspectDef.advice[k];
-                        
-                        if (strcmp(advice->advice.pointcutName, pointcut->pointcut.name) == 0) {
-                            // Clone the advice body
-                            AstNode* advice_body = clone_advice_body(advice);
-                            if (!advice_body) {
-                                strncpy(stats.error_msg, "Failed to clone advice body", sizeof(stats.error_msg)-1);
-                                return false;
-                            }
+                    // Insert advice according to its type
+                    switch (advice->advice.type) {
+                        case ADVICE_BEFORE:
+                            logger_log(LOG_INFO, "Applying BEFORE advice to %s", node->funcDef.name);
+                            insert_advice(node, advice_body, 0);
+                            break;
                             
-                            // Insert advice according to its type
-                            switch (advice->advice.type) {
-                                case ADVICE_BEFORE:
-                                    logger_log(LOG_INFO, "Applying BEFORE advice to %s", node->funcDef.name);
-                                    insert_advice(node, advice_body, 0);
-                                    break;
-                                    
-                                case ADVICE_AFTER:
-                                    logger_log(LOG_INFO, "Applying AFTER advice to %s", node->funcDef.name);
-                                    insert_advice(node, advice_body, -1);
-                                    break;
-                                    
-                                case ADVICE_AROUND:
-                                    logger_log(LOG_INFO, "Applying AROUND advice to %s (treating as before)", node->funcDef.name);
-                                    insert_advice(node, advice_body, 0);
-                                    break;
-                                    
-                                default:
-                                    logger_log(LOG_WARNING, "Unknown advice type: %d", advice->advice.type);
-                                    freeAstNode(advice_body);
-                                    continue;
-                            }
+                        case ADVICE_AFTER:
+                            logger_log(LOG_INFO, "Applying AFTER advice to %s", node->funcDef.name);
+                            weave_after_advice(node, advice_body);
+                            break;
                             
-                            stats.advice_applied++;
-                            
-                            const char* adviceTypeStr;
-                            switch (advice->advice.type) {
-                                case ADVICE_BEFORE: adviceTypeStr = "before"; break;
-                                case ADVICE_AFTER:  adviceTypeStr = "after"; break;
-                                case ADVICE_AROUND: adviceTypeStr = "around"; break;
-                                default: adviceTypeStr = "unknown"; break;
+                        case ADVICE_AROUND:
+                            logger_log(LOG_INFO, "Applying AROUND advice to %s", node->funcDef.name);
+                            if (!weave_around_advice(node, advice_body)) {
+                                strncpy(stats.error_msg, "Failed to weave around advice", sizeof(stats.error_msg)-1);
+                                return false;
                             }
-                            logger_log(LOG_INFO, "Applied %s advice to %s",
-                                      adviceTypeStr,
-                                      node->funcDef.name);
-                        }
+                            break;
+                            
+                        default:
+                            logger_log(LOG_WARNING, "Unknown advice type: %d", advice->advice.type);
+                            freeAstNode(advice_body);
+                            continue;
                     }
+                    
+                    stats.advice_applied++;
+                    
+                    const char* adviceTypeStr;
+                    switch (advice->advice.type) {
+                        case ADVICE_BEFORE: adviceTypeStr = "before"; break;
+                        case ADVICE_AFTER:  adviceTypeStr = "after"; break;
+                        case ADVICE_AROUND: adviceTypeStr = "around"; break;
+                        default: adviceTypeStr = "unknown"; break;
+                    }
+                    logger_log(LOG_INFO, "Applied %s advice to %s",
+                              adviceTypeStr,
+                              node->funcDef.name);
                 }
             }
         }
@@ -377,81 +452,23 @@ static bool apply_aspects(AstNode* node) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+        case AST_ARRAY_ASSIGN:
+            // Concatenations and element stores only hold expressions
+            break;
+            
         // Añadir otros casos según sea necesario
     }
     
     return true;
 }
 
-/**
- * @brief Checks if a function name matches a pointcut pattern
- * 
- * This function implements a pattern matching system that supports:
- * 1. Exact matching
- * 2. Wildcard at the end (*)
- * 3. Wildcards in the middle of the pattern
- * 
- * @param pattern Pointcut pattern (e.g., "test_*", "get*", "*_test")
- * @param target Function name to check
- * @return true if there's a match, false otherwise
- */
-static bool matches_pointcut(const char* pattern, const char* target) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)matches_pointcut);
-    
-    logger_log(LOG_DEBUG, "Matching '%s' against pattern '%s'", target, pattern);
-    
-    // Special case for patterns ending with "*" like "test_*"
-    size_t pattern_len = strlen(pattern);
-    size_t target_len = strlen(target);
-    
-    if (pattern_len > 0 && pattern[pattern_len - 1] == '*') {
-        // Compare characters before the '*'
-        size_t prefix_len = pattern_len - 1;
-        if (target_len >= prefix_len && strncmp(target, pattern, prefix_len) == 0) {
-            logger_log(LOG_INFO, "Match found! Function '%s' matches pattern '%s'", 
-                      target, pattern);
-            return true;
-        }
-    }
-    
-    // Exact match
-    if (strcmp(pattern, target) == 0) {
-        logger_log(LOG_INFO, "Exact match found! Function '%s' matches pattern '%s'", 
-                  target, pattern);
-        return true;
-    }
-    
-    // More complex algorithm to handle wildcards in the middle of the pattern
-    const char* p = pattern;
-    const char* t = target;
-    
-    while (*p && *t) {
-        if (*p == '*') {
-            p++;
-            if (!*p) return true; // * at the end matches everything
-            
-            // Look for the next part after the *
-            while (*t) {
-                if (matches_pointcut(p, t)) return true;
-                t++;
-            }
-            return false;
-        }
-        else if (*p != *t) {
-            return false;
-        }
-        p++;
-        t++;
-    }
-    
-    return *p == *t; // Both must have ended
-}
-
 /**
  * @brief Clones the body of an advice
  * 
  * This function creates a deep copy of an advice's body,
- * including all its statements and expressions.
+ * including all its statements and expressions, so every join point
+ * owns its own copy and can be transformed or freed independently.
  * 
  * @param advice AST node of the advice to clone
  * @return AstNode* New AST node with the cloned body, NULL on error
@@ -474,7 +491,7 @@ static AstNode* clone_advice_body(AstNode* advice) {
     block->block.statementCount = advice->advice.bodyCount;
     
     for (int i = 0; i < advice->advice.bodyCount; i++) {
-        block->block.statements[i] = copyAstNode(advice->advice.body[i]);
+        block->block.statements[i] = cloneAstTree(advice->advice.body[i]);
         if (!block->block.statements[i]) {
             // If copy fails, free what has been copied so far
             for (int j = 0; j < i; j++) {
@@ -532,3 +549,555 @@ static void insert_advice(AstNode* target, AstNode* advice, int position) {
                   insert_pos, target->funcDef.name);
     }
 }
+
+/**
+ * @brief Adds a position and everything reachable through '*' skips to a set
+ *
+ * @param set Position bitset to update
+ * @param position Position to add
+ */
+static void add_position_closure(unsigned char* set, int position) {
+    while (true) {
+        set[position / 8] |= (unsigned char)(1u << (position % 8));
+        // A '*' may match the empty string, so the next position is live too
+        if (matcher.positionChar[position] != '*') break;
+        position++;
+    }
+}
+
+/**
+ * @brief Finds or creates the DFA state for a set of positions
+ *
+ * @param set Position bitset (copied if a new state is created)
+ * @return int State index, or -1 on allocation failure
+ */
+static int intern_matcher_state(const unsigned char* set) {
+    // Key the state table by the hex form of the bitset
+    char* key = memory_alloc(matcher.setBytes * 2 + 1);
+    if (!key) return -1;
+    static const char hex[] = "0123456789abcdef";
+    for (int i = 0; i < matcher.setBytes; i++) {
+        key[i * 2] = hex[set[i] >> 4];
+        key[i * 2 + 1] = hex[set[i] & 0xf];
+    }
+    key[matcher.setBytes * 2] = '\0';
+    
+    intptr_t existing = (intptr_t)hashmap_get(matcher.stateIndex, key);
+    if (existing) {
+        memory_free(key);
+        return (int)existing - 1;
+    }
+    
+    if (matcher.stateCount == matcher.stateCapacity) {
+        int newCapacity = matcher.stateCapacity ? matcher.stateCapacity * 2 : 16;
+        MatcherState* grown = memory_realloc(matcher.states, newCapacity * sizeof(MatcherState));
+        if (!grown) {
+            memory_free(key);
+            return -1;
+        }
+        matcher.states = grown;
+        matcher.stateCapacity = newCapacity;
+    }
+    
+    MatcherState* state = &matcher.states[matcher.stateCount];
+    state->positions = memory_alloc(matcher.setBytes);
+    if (!state->positions) {
+        memory_free(key);
+        return -1;
+    }
+    memcpy(state->positions, set, matcher.setBytes);
+    for (int c = 0; c < 256; c++) {
+        state->transitions[c] = -1;
+    }
+    
+    // Accepting positions sit at the end of each pattern; record their owners
+    state->matches = NULL;
+    state->matchCount = 0;
+    for (int k = 0; k < matcher.pointcutCount; k++) {
+        int end = (k + 1 < matcher.pointcutCount ? matcher.pointcutStart[k + 1] : matcher.positionCount) - 1;
+        if (set[end / 8] & (1u << (end % 8))) {
+            state->matches = memory_realloc(state->matches, (state->matchCount + 1) * sizeof(int));
+            state->matches[state->matchCount++] = k;
+        }
+    }
+    
+    hashmap_put(matcher.stateIndex, key, (void*)(intptr_t)(matcher.stateCount + 1), NULL);
+    memory_free(key);
+    return matcher.stateCount++;
+}
+
+/**
+ * @brief Discards all DFA states except a fresh start state
+ *
+ * @return bool true on success, false on allocation failure
+ */
+static bool reset_matcher_states(void) {
+    for (int i = 0; i < matcher.stateCount; i++) {
+        memory_free(matcher.states[i].positions);
+        memory_free(matcher.states[i].matches);
+    }
+    matcher.stateCount = 0;
+    hashmap_clear(matcher.stateIndex, NULL);
+    
+    unsigned char* start = memory_alloc(matcher.setBytes);
+    if (!start) return false;
+    memset(start, 0, matcher.setBytes);
+    for (int k = 0; k < matcher.pointcutCount; k++) {
+        add_position_closure(start, matcher.pointcutStart[k]);
+    }
+    int index = intern_matcher_state(start);
+    memory_free(start);
+    return index == 0;
+}
+
+/**
+ * @brief Computes (and caches) the DFA transition from a state on a byte
+ *
+ * @param stateIndex Current state
+ * @param c Input byte
+ * @return int Next state, or -1 on allocation failure
+ */
+static int matcher_step(int stateIndex, unsigned char c) {
+    int next = matcher.states[stateIndex].transitions[c];
+    if (next >= 0) return next;
+    
+    unsigned char* set = memory_alloc(matcher.setBytes);
+    if (!set) return -1;
+    memset(set, 0, matcher.setBytes);
+    
+    const unsigned char* current = matcher.states[stateIndex].positions;
+    for (int p = 0; p < matcher.positionCount; p++) {
+        if (!(current[p / 8] & (1u << (p % 8)))) continue;
+        char pc = matcher.positionChar[p];
+        if (pc == '*') {
+            add_position_closure(set, p);       // '*' consumes the byte and stays
+        } else if (pc != '\0' && (unsigned char)pc == c) {
+            add_position_closure(set, p + 1);   // literal advances
+        }
+    }
+    
+    next = intern_matcher_state(set);
+    memory_free(set);
+    // Index again: the state array may have moved while growing
+    if (next >= 0) matcher.states[stateIndex].transitions[c] = next;
+    return next;
+}
+
+/**
+ * @brief Compiles every collected pointcut into one combined matcher
+ *
+ * @return bool true on success, false on allocation failure
+ */
+static bool build_pointcut_matcher(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)build_pointcut_matcher);
+    
+    free_pointcut_matcher();
+    
+    // Gather pointcuts in declaration order and lay out their positions
+    for (int i = 0; i < aspect_list.count; i++) {
+        matcher.pointcutCount += aspect_list.aspects[i]->aspectDef.pointcutCount;
+    }
+    if (matcher.pointcutCount == 0) return true;
+    
+    matcher.pointcuts = memory_alloc(matcher.pointcutCount * sizeof(PointcutRef));
+    matcher.pointcutStart = memory_alloc(matcher.pointcutCount * sizeof(int));
+    if (!matcher.pointcuts || !matcher.pointcutStart) goto fail;
+    
+    int k = 0;
+    for (int i = 0; i < aspect_list.count; i++) {
+        AstNode* aspect = aspect_list.aspects[i];
+        for (int j = 0; j < aspect->aspectDef.pointcutCount; j++, k++) {
+            matcher.pointcuts[k].aspect = aspect;
+            matcher.pointcuts[k].pointcut = aspect->aspectDef.pointcuts[j];
+            matcher.pointcutStart[k] = matcher.positionCount;
+            // One position per pattern character plus the accepting end
+            matcher.positionCount += (int)strlen(aspect->aspectDef.pointcuts[j]->pointcut.pattern) + 1;
+        }
+    }
+    
+    matcher.positionChar = memory_alloc(matcher.positionCount);
+    if (!matcher.positionChar) goto fail;
+    for (k = 0; k < matcher.pointcutCount; k++) {
+        const char* pattern = matcher.pointcuts[k].pointcut->pointcut.pattern;
+        int start = matcher.pointcutStart[k];
+        size_t len = strlen(pattern);
+        for (size_t c = 0; c <= len; c++) {
+            matcher.positionChar[start + c] = pattern[c];
+        }
+    }
+    
+    matcher.setBytes = (matcher.positionCount + 7) / 8;
+    matcher.stateIndex = hashmap_create(64);
+    if (!matcher.stateIndex || !reset_matcher_states()) goto fail;
+    
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Compiled %d pointcuts into a matcher with %d positions",
+                  matcher.pointcutCount, matcher.positionCount);
+    }
+    return true;
+    
+fail:
+    strncpy(stats.error_msg, "Memory allocation failed while compiling pointcuts", sizeof(stats.error_msg)-1);
+    free_pointcut_matcher();
+    return false;
+}
+
+/**
+ * @brief Finds every pointcut whose pattern matches a function name
+ *
+ * Runs the combined matcher over the name once. The returned array belongs
+ * to the matcher and lists pointcut indices in declaration order.
+ *
+ * @param name Function name to match
+ * @param count Output for the number of matching pointcuts
+ * @return const int* Indices into matcher.pointcuts, or NULL if none match
+ */
+static const int* match_pointcuts(const char* name, int* count) {
+    *count = 0;
+    if (matcher.stateCount == 0 || !name) return NULL;
+    
+    // Bound memory on pathological pattern sets by rebuilding between names
+    if (matcher.stateCount > MAX_MATCHER_STATES) {
+        stats.matcher_resets++;
+        logger_log(LOG_WARNING, "Pointcut matcher exceeded %d states (%d pointcuts); rebuilding it",
+                  MAX_MATCHER_STATES, matcher.pointcutCount);
+        if (!reset_matcher_states()) {
+            strncpy(stats.error_msg, "Memory allocation failed while rebuilding the pointcut matcher",
+                    sizeof(stats.error_msg)-1);
+            return NULL;
+        }
+    }
+    
+    int state = 0;
+    for (const unsigned char* c = (const unsigned char*)name; *c; c++) {
+        state = matcher_step(state, *c);
+        if (state < 0) return NULL;
+    }
+    
+    *count = matcher.states[state].matchCount;
+    return matcher.states[state].matches;
+}
+
+/**
+ * @brief Frees the combined pointcut matcher
+ */
+static void free_pointcut_matcher(void) {
+    for (int i = 0; i < matcher.stateCount; i++) {
+        memory_free(matcher.states[i].positions);
+        memory_free(matcher.states[i].matches);
+    }
+    memory_free(matcher.states);
+    memory_free(matcher.pointcuts);
+    memory_free(matcher.pointcutStart);
+    memory_free(matcher.positionChar);
+    hashmap_free(matcher.stateIndex, NULL);
+    memset(&matcher, 0, sizeof(matcher));
+}
+
+/** Counter used to give woven temporaries and wrappers unique names */
+static int weave_counter = 0;
+
+/**
+ * @brief Checks whether a return value can be evaluated after the advice runs
+ *
+ * Literals cannot be affected by the advice, so they need no temporary.
+ *
+ * @param expr Returned expression (may be NULL)
+ * @return bool true if the expression can stay in place
+ */
+static bool is_stable_return_value(AstNode* expr) {
+    if (!expr) return true;
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Builds the replacement for a return statement with after-advice
+ *
+ * Produces "var tmp = expr; <advice>; return tmp" so the returned value is
+ * computed before the advice runs, exactly as if the advice ran after the
+ * function body.
+ *
+ * @param ret The original return statement (reused in the result)
+ * @param advice Advice block to inline (ownership is taken)
+ * @return AstNode* Block replacing the return statement
+ */
+static AstNode* wrap_return_with_advice(AstNode* ret, AstNode* advice) {
+    AstNode* block = createAstNode(AST_BLOCK);
+    if (!block) {
+        freeAstNode(advice);
+        return ret;
+    }
+    block->block.statements = memory_alloc(3 * sizeof(AstNode*));
+    block->block.statementCount = 0;
+    
+    if (!is_stable_return_value(ret->returnStmt.expr)) {
+        AstNode* temp = createAstNode(AST_VAR_DECL);
+        snprintf(temp->varDecl.name, sizeof(temp->varDecl.name), "__lyn_ret_%d", weave_counter++);
+        // GNU C type inference keeps the temporary typed like the return value
+        strncpy(temp->varDecl.type, "__auto_type", sizeof(temp->varDecl.type) - 1);
+        temp->varDecl.initializer = ret->returnStmt.expr;
+        
+        AstNode* ref = createAstNode(AST_IDENTIFIER);
+        strncpy(ref->identifier.name, temp->varDecl.name, sizeof(ref->identifier.name) - 1);
+        ret->returnStmt.expr = ref;
+        
+        block->block.statements[block->block.statementCount++] = temp;
+    }
+    block->block.statements[block->block.statementCount++] = advice;
+    block->block.statements[block->block.statementCount++] = ret;
+    return block;
+}
+
+/**
+ * @brief Inlines after-advice before every return in a statement list
+ *
+ * Nested functions and lambdas are skipped since their returns do not
+ * leave the advised function.
+ *
+ * @param list Statement list to rewrite in place
+ * @param count Number of statements
+ * @param advice Advice block to copy at each return
+ * @return int Number of return points woven
+ */
+static int weave_returns(AstNode** list, int count, AstNode* advice) {
+    int woven = 0;
+    for (int i = 0; list && i < count; i++) {
+        AstNode* stmt = list[i];
+        if (!stmt) continue;
+        
+        switch (stmt->type) {
+            case AST_RETURN_STMT:
+                list[i] = wrap_return_with_advice(stmt, cloneAstTree(advice));
+                woven++;
+                break;
+            case AST_BLOCK:
+                woven += weave_returns(stmt->block.statements, stmt->block.statementCount, advice);
+                break;
+            case AST_IF_STMT:
+                woven += weave_returns(stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount, advice);
+                woven += weave_returns(stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount, advice);
+                break;
+            case AST_WHILE_STMT:
+                woven += weave_returns(stmt->whileStmt.body, stmt->whileStmt.bodyCount, advice);
+                break;
+            case AST_DO_WHILE_STMT:
+                woven += weave_returns(stmt->doWhileStmt.body, stmt->doWhileStmt.bodyCount, advice);
+                break;
+            case AST_FOR_STMT:
+                woven += weave_returns(stmt->forStmt.body, stmt->forStmt.bodyCount, advice);
+                break;
+            case AST_TRY_CATCH_STMT:
+                woven += weave_returns(stmt->tryCatchStmt.tryBody, stmt->tryCatchStmt.tryCount, advice);
+                woven += weave_returns(stmt->tryCatchStmt.catchBody, stmt->tryCatchStmt.catchCount, advice);
+                woven += weave_returns(stmt->tryCatchStmt.finallyBody, stmt->tryCatchStmt.finallyCount, advice);
+                break;
+            default:
+                break;
+        }
+    }
+    return woven;
+}
+
+/**
+ * @brief Inlines after-advice at every exit point of a function
+ *
+ * The advice is copied in front of each return statement and, when the
+ * body can fall off its end, appended after the last statement.
+ *
+ * @param target Function definition to advise
+ * @param advice Advice block (ownership is taken)
+ */
+static void weave_after_advice(AstNode* target, AstNode* advice) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)weave_after_advice);
+    
+    int exits = weave_returns(target->funcDef.body, target->funcDef.bodyCount, advice);
+    
+    int last = target->funcDef.bodyCount - 1;
+    bool fallsThrough = last < 0 || target->funcDef.body[last]->type != AST_RETURN_STMT;
+    if (last >= 0 && target->funcDef.body[last]->type == AST_BLOCK) {
+        // A woven return at the end leaves a block whose last statement is the return
+        AstNode* block = target->funcDef.body[last];
+        fallsThrough = block->block.statementCount == 0 ||
+                       block->block.statements[block->block.statementCount - 1]->type != AST_RETURN_STMT;
+    }
+    
+    if (fallsThrough) {
+        insert_advice(target, advice, -1);
+        exits++;
+    } else {
+        freeAstNode(advice);
+    }
+    
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Inlined after advice at %d exit points of %s", exits, target->funcDef.name);
+    }
+}
+
+/**
+ * @brief Replaces proceed() calls in around-advice with calls to the original body
+ *
+ * @param node Subtree of the advice body to rewrite
+ * @param target Function being advised (for its parameters)
+ * @param proceedName Name of the nested function holding the original body
+ * @return int Number of proceed() calls rewritten
+ */
+static int bind_proceed_calls(AstNode* node, AstNode* target, const char* proceedName) {
+    if (!node) return 0;
+    int bound = 0;
+    
+    if (node->type == AST_FUNC_CALL && strcmp(node->funcCall.name, "proceed") == 0) {
+        strncpy(node->funcCall.name, proceedName, sizeof(node->funcCall.name) - 1);
+        node->funcCall.name[sizeof(node->funcCall.name) - 1] = '\0';
+        // proceed() forwards the advised function's own arguments
+        if (node->funcCall.argCount == 0 && target->funcDef.paramCount > 0) {
+            node->funcCall.argCount = target->funcDef.paramCount;
+            node->funcCall.arguments = memory_alloc(target->funcDef.paramCount * sizeof(AstNode*));
+            for (int i = 0; i < target->funcDef.paramCount; i++) {
+                AstNode* arg = createAstNode(AST_IDENTIFIER);
+                strncpy(arg->identifier.name, target->funcDef.parameters[i]->identifier.name,
+                        sizeof(arg->identifier.name) - 1);
+                node->funcCall.arguments[i] = arg;
+            }
+        }
+        bound++;
+    }
+    
+    switch (node->type) {
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++)
+                bound += bind_proceed_calls(node->block.statements[i], target, proceedName);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++)
+                bound += bind_proceed_calls(node->funcCall.arguments[i], target, proceedName);
+            break;
+        case AST_VAR_DECL:
+            bound += bind_proceed_calls(node->varDecl.initializer, target, proceedName);
+            break;
+        case AST_VAR_ASSIGN:
+            bound += bind_proceed_calls(node->varAssign.initializer, target, proceedName);
+            break;
+        case AST_ARRAY_ASSIGN:
+            bound += bind_proceed_calls(node->arrayAssign.index, target, proceedName);
+            bound += bind_proceed_calls(node->arrayAssign.value, target, proceedName);
+            break;
+        case AST_RETURN_STMT:
+            bound += bind_proceed_calls(node->returnStmt.expr, target, proceedName);
+            break;
+        case AST_PRINT_STMT:
+            bound += bind_proceed_calls(node->printStmt.expr, target, proceedName);
+            break;
+        case AST_BINARY_OP:
+            bound += bind_proceed_calls(node->binaryOp.left, target, proceedName);
+            bound += bind_proceed_calls(node->binaryOp.right, target, proceedName);
+            break;
+        case AST_UNARY_OP:
+            bound += bind_proceed_calls(node->unaryOp.expr, target, proceedName);
+            break;
+        case AST_IF_STMT:
+            bound += bind_proceed_calls(node->ifStmt.condition, target, proceedName);
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                bound += bind_proceed_calls(node->ifStmt.thenBranch[i], target, proceedName);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                bound += bind_proceed_calls(node->ifStmt.elseBranch[i], target, proceedName);
+            break;
+        case AST_WHILE_STMT:
+            bound += bind_proceed_calls(node->whileStmt.condition, target, proceedName);
+            for (int i = 0; i < node->whileStmt.bodyCount; i++)
+                bound += bind_proceed_calls(node->whileStmt.body[i], target, proceedName);
+            break;
+        case AST_FOR_STMT:
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                bound += bind_proceed_calls(node->forStmt.body[i], target, proceedName);
+            break;
+        default:
+            break;
+    }
+    return bound;
+}
+
+/**
+ * @brief Turns a function into an inlinable wrapper around its original body
+ *
+ * The original body moves into a nested always-inline function
+ * "<name>__proceed_<n>" taking the same parameters; the function itself
+ * becomes the advice body, with proceed() bound to that nested function.
+ * The generated C therefore contains direct calls only, which gcc folds
+ * back into a single body.
+ *
+ * @param target Function definition to advise
+ * @param advice Advice block (ownership is taken)
+ * @return bool true on success, false on allocation failure
+ */
+static bool weave_around_advice(AstNode* target, AstNode* advice) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)weave_around_advice);
+    
+    char proceedName[sizeof(target->funcDef.name) + 32];
+    snprintf(proceedName, sizeof(proceedName), "%s__proceed_%d", target->funcDef.name, weave_counter++);
+    size_t nameLength = strlen(proceedName);
+    if (nameLength >= sizeof(target->funcDef.name)) {
+        logger_log(LOG_ERROR, "Function name %s is too long for around advice", target->funcDef.name);
+        freeAstNode(advice);
+        return false;
+    }
+    
+    AstNode* original = createAstNode(AST_FUNC_DEF);
+    AstNode** newBody = memory_alloc((advice->block.statementCount + 1) * sizeof(AstNode*));
+    if (!original || !newBody || (!proceed_functions && !(proceed_functions = hashmap_create(16)))) {
+        freeAstNode(original);
+        memory_free(newBody);
+        freeAstNode(advice);
+        return false;
+    }
+    
+    // Move the current body (including earlier advice) into the proceed target
+    memcpy(original->funcDef.name, proceedName, nameLength + 1);
+    hashmap_put(proceed_functions, original->funcDef.name, original, NULL);
+    strncpy(original->funcDef.returnType, target->funcDef.returnType, sizeof(original->funcDef.returnType) - 1);
+    original->funcDef.paramCount = target->funcDef.paramCount;
+    original->funcDef.parameters = NULL;
+    if (target->funcDef.paramCount > 0) {
+        original->funcDef.parameters = memory_alloc(target->funcDef.paramCount * sizeof(AstNode*));
+        for (int i = 0; i < target->funcDef.paramCount; i++) {
+            original->funcDef.parameters[i] = cloneAstTree(target->funcDef.parameters[i]);
+        }
+    }
+    original->funcDef.body = target->funcDef.body;
+    original->funcDef.bodyCount = target->funcDef.bodyCount;
+    original->funcDef.attributes = FUNC_ATTR_ALWAYS_INLINE;
+    original->line = target->line;
+    original->col = target->col;
+    
+    int bound = bind_proceed_calls(advice, target, original->funcDef.name);
+    if (bound == 0) {
+        logger_log(LOG_WARNING, "Around advice for %s never calls proceed(); original body is skipped",
+                  target->funcDef.name);
+    }
+    
+    // The wrapper is the nested original followed by the advice statements
+    newBody[0] = original;
+    for (int i = 0; i < advice->block.statementCount; i++) {
+        newBody[i + 1] = advice->block.statements[i];
+    }
+    target->funcDef.body = newBody;
+    target->funcDef.bodyCount = advice->block.statementCount + 1;
+    target->funcDef.attributes |= FUNC_ATTR_INLINE;
+    
+    memory_free(advice->block.statements);
+    advice->block.statements = NULL;
+    advice->block.statementCount = 0;
+    freeAstNode(advice);
+    
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Wrapped %s with around advice (%d proceed calls)", target->funcDef.name, bound);
+    }
+    return true;
+}
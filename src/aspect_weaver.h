@@ -10,6 +10,7 @@
 typedef struct {
     int joinpoints_found;  ///< Number of joinpoints found
     int advice_applied;    ///< Total number of advice applied
+    int matcher_resets;    ///< Times the pointcut matcher outgrew its state limit and was rebuilt
     char error_msg[256];   ///< Error message if any occurs
 } WeavingStats;
 
@@ -165,6 +165,8 @@ static bool hasAllocatedMemory(AstNode* node) {
                    node->tryCatchStmt.finallyBody != NULL;
         case AST_ARRAY_LITERAL:
             return node->arrayLiteral.elements != NULL;
+        case AST_CONCAT_EXPR:
+            return node->concatExpr.parts != NULL;
         case AST_FUNC_CALL:
             return node->funcCall.arguments != NULL;
         case AST_LAMBDA:
@@ -236,6 +238,10 @@ void freeAstNode(AstNode* node) {
         case AST_VAR_ASSIGN:
             freeAstNode(node->varAssign.initializer);
             break;
+        case AST_ARRAY_ASSIGN:
+            freeAstNode(node->arrayAssign.index);
+            freeAstNode(node->arrayAssign.value);
+            break;
         case AST_FUNC_DEF:
             if (node->funcDef.parameters) {
                 for (int i = 0; i < node->funcDef.paramCount; i++) {
@@ -437,6 +443,14 @@ void freeAstNode(AstNode* node) {
         case AST_THIS_EXPR:
             // No hay campos dinámicos para liberar en 'this'
             break;
+        case AST_CONCAT_EXPR:
+            if (node->concatExpr.parts) {
+                for (int i = 0; i < node->concatExpr.partCount; i++) {
+                    freeAstNode(node->concatExpr.parts[i]);
+                }
+                free(node->concatExpr.parts);
+            }
+            break;
         case AST_FUNC_COMPOSE:
             freeAstNode(node->funcCompose.left);
             freeAstNode(node->funcCompose.right);
@@ -600,6 +614,11 @@ void printAst(AstNode* node, int indent) {
                 printAst(node->varAssign.initializer, indent + 1);
             }
             break;
+        case AST_ARRAY_ASSIGN:
+            printf("ArrayAssign: '%s'\n", node->arrayAssign.name);
+            printAst(node->arrayAssign.index, indent + 1);
+            printAst(node->arrayAssign.value, indent + 1);
+            break;
         case AST_PRINT_STMT:
             printf("PrintStmt:\n");
             if (node->printStmt.expr) {
@@ -661,6 +680,12 @@ void printAst(AstNode* node, int indent) {
         case AST_THIS_EXPR:
             printf("ThisExpr\n");
             break;
+        case AST_CONCAT_EXPR:
+            printf("ConcatExpr: %d parts\n", node->concatExpr.partCount);
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                printAst(node->concatExpr.parts[i], indent + 1);
+            }
+            break;
         case AST_FUNC_COMPOSE:
             printf("FuncCompose:\n");
             printAst(node->funcCompose.left, indent + 1);
@@ -739,6 +764,329 @@ AstNode* copyAstNode(AstNode* node) {
     return copy;
 }
 
+/**
+ * @brief Deep-copies an array of AST nodes
+ * 
+ * @param nodes Source array (may be NULL)
+ * @param count Number of elements
+ * @return AstNode** Newly allocated array of cloned nodes, or NULL if empty
+ */
+static AstNode** cloneAstList(AstNode** nodes, int count) {
+    if (!nodes || count <= 0) return NULL;
+    
+    AstNode** copy = malloc(count * sizeof(AstNode*));
+    if (!copy) {
+        error_report("AST", __LINE__, 0, "Failed to allocate memory for AST list copy", ERROR_MEMORY);
+        return NULL;
+    }
+    for (int i = 0; i < count; i++) {
+        copy[i] = cloneAstTree(nodes[i]);
+    }
+    return copy;
+}
+
+/**
+ * @brief Creates a deep copy of an AST subtree
+ * 
+ * Unlike copyAstNode(), every child node and child array is duplicated, so
+ * the copy can be transformed and freed independently of the original.
+ * Inferred types are shared since they are not owned by the AST.
+ * 
+ * @param node The root of the subtree to copy
+ * @return AstNode* An independent copy of the subtree, or NULL if node is NULL
+ */
+AstNode* cloneAstTree(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)cloneAstTree);
+    
+    if (!node) return NULL;
+    
+    AstNode* copy = copyAstNode(node);
+    if (!copy) return NULL;
+    stats.nodes_created++;
+    stats.memory_used += sizeof(AstNode);
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+            copy->program.statements = cloneAstList(node->program.statements, node->program.statementCount);
+            break;
+        case AST_FUNC_DEF:
+            copy->funcDef.parameters = cloneAstList(node->funcDef.parameters, node->funcDef.paramCount);
+            copy->funcDef.body = cloneAstList(node->funcDef.body, node->funcDef.bodyCount);
+            break;
+        case AST_CLASS_DEF:
+            copy->classDef.members = cloneAstList(node->classDef.members, node->classDef.memberCount);
+            break;
+        case AST_VAR_DECL:
+            copy->varDecl.initializer = cloneAstTree(node->varDecl.initializer);
+            break;
+        case AST_IMPORT:
+            if (node->importStmt.hasSymbolList) {
+                int count = node->importStmt.symbolCount;
+                copy->importStmt.symbols = memory_alloc(count * sizeof(char*));
+                copy->importStmt.aliases = memory_alloc(count * sizeof(char*));
+                for (int i = 0; i < count; i++) {
+                    copy->importStmt.symbols[i] = node->importStmt.symbols && node->importStmt.symbols[i] ?
+                        memory_strdup(node->importStmt.symbols[i]) : NULL;
+                    copy->importStmt.aliases[i] = node->importStmt.aliases && node->importStmt.aliases[i] ?
+                        memory_strdup(node->importStmt.aliases[i]) : NULL;
+                }
+            }
+            break;
+        case AST_MODULE_DECL:
+            copy->moduleDecl.declarations = cloneAstList(node->moduleDecl.declarations, node->moduleDecl.declarationCount);
+            break;
+        case AST_ASPECT_DEF:
+            copy->aspectDef.pointcuts = cloneAstList(node->aspectDef.pointcuts, node->aspectDef.pointcutCount);
+            copy->aspectDef.advice = cloneAstList(node->aspectDef.advice, node->aspectDef.adviceCount);
+            break;
+        case AST_BLOCK:
+            copy->block.statements = cloneAstList(node->block.statements, node->block.statementCount);
+            break;
+        case AST_IF_STMT:
+            copy->ifStmt.condition = cloneAstTree(node->ifStmt.condition);
+            copy->ifStmt.thenBranch = cloneAstList(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            copy->ifStmt.elseBranch = cloneAstList(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            copy->forStmt.rangeStart = cloneAstTree(node->forStmt.rangeStart);
+            copy->forStmt.rangeEnd = cloneAstTree(node->forStmt.rangeEnd);
+            copy->forStmt.rangeStep = cloneAstTree(node->forStmt.rangeStep);
+            copy->forStmt.collection = cloneAstTree(node->forStmt.collection);
+            copy->forStmt.init = cloneAstTree(node->forStmt.init);
+            copy->forStmt.condition = cloneAstTree(node->forStmt.condition);
+            copy->forStmt.update = cloneAstTree(node->forStmt.update);
+            copy->forStmt.body = cloneAstList(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            copy->whileStmt.condition = cloneAstTree(node->whileStmt.condition);
+            copy->whileStmt.body = cloneAstList(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            copy->doWhileStmt.condition = cloneAstTree(node->doWhileStmt.condition);
+            copy->doWhileStmt.body = cloneAstList(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            break;
+        case AST_SWITCH_STMT:
+            copy->switchStmt.expr = cloneAstTree(node->switchStmt.expr);
+            copy->switchStmt.cases = cloneAstList(node->switchStmt.cases, node->switchStmt.caseCount);
+            copy->switchStmt.defaultCase = cloneAstList(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            copy->caseStmt.expr = cloneAstTree(node->caseStmt.expr);
+            copy->caseStmt.body = cloneAstList(node->caseStmt.body, node->caseStmt.bodyCount);
+            break;
+        case AST_RETURN_STMT:
+            copy->returnStmt.expr = cloneAstTree(node->returnStmt.expr);
+            break;
+        case AST_VAR_ASSIGN:
+            copy->varAssign.initializer = cloneAstTree(node->varAssign.initializer);
+            break;
+        case AST_ARRAY_ASSIGN:
+            copy->arrayAssign.index = cloneAstTree(node->arrayAssign.index);
+            copy->arrayAssign.value = cloneAstTree(node->arrayAssign.value);
+            break;
+        case AST_PRINT_STMT:
+            copy->printStmt.expr = cloneAstTree(node->printStmt.expr);
+            break;
+        case AST_TRY_CATCH_STMT:
+            copy->tryCatchStmt.tryBody = cloneAstList(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            copy->tryCatchStmt.catchBody = cloneAstList(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            copy->tryCatchStmt.finallyBody = cloneAstList(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        case AST_THROW_STMT:
+            copy->throwStmt.expr = cloneAstTree(node->throwStmt.expr);
+            break;
+        case AST_BINARY_OP:
+            copy->binaryOp.left = cloneAstTree(node->binaryOp.left);
+            copy->binaryOp.right = cloneAstTree(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP:
+            copy->unaryOp.expr = cloneAstTree(node->unaryOp.expr);
+            break;
+        case AST_MEMBER_ACCESS:
+            copy->memberAccess.object = cloneAstTree(node->memberAccess.object);
+            break;
+        case AST_ARRAY_ACCESS:
+            copy->arrayAccess.array = cloneAstTree(node->arrayAccess.array);
+            copy->arrayAccess.index = cloneAstTree(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL:
+            copy->arrayLiteral.elements = cloneAstList(node->arrayLiteral.elements, node->arrayLiteral.elementCount);
+            break;
+        case AST_FUNC_CALL:
+            copy->funcCall.arguments = cloneAstList(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_LAMBDA:
+            copy->lambda.parameters = cloneAstList(node->lambda.parameters, node->lambda.paramCount);
+            copy->lambda.body = cloneAstTree(node->lambda.body);
+            break;
+        case AST_FUNC_COMPOSE:
+            copy->funcCompose.left = cloneAstTree(node->funcCompose.left);
+            copy->funcCompose.right = cloneAstTree(node->funcCompose.right);
+            break;
+        case AST_CURRY_EXPR:
+            copy->curryExpr.baseFunc = cloneAstTree(node->curryExpr.baseFunc);
+            copy->curryExpr.appliedArgs = cloneAstList(node->curryExpr.appliedArgs, node->curryExpr.appliedCount);
+            break;
+        case AST_NEW_EXPR:
+            copy->newExpr.arguments = cloneAstList(node->newExpr.arguments, node->newExpr.argCount);
+            break;
+        case AST_CONCAT_EXPR:
+            copy->concatExpr.parts = cloneAstList(node->concatExpr.parts, node->concatExpr.partCount);
+            break;
+        case AST_ADVICE:
+            copy->advice.body = cloneAstList(node->advice.body, node->advice.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            copy->patternMatch.expr = cloneAstTree(node->patternMatch.expr);
+            copy->patternMatch.cases = cloneAstList(node->patternMatch.cases, node->patternMatch.caseCount);
+            copy->patternMatch.otherwise = cloneAstTree(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            copy->patternCase.pattern = cloneAstTree(node->patternCase.pattern);
+            copy->patternCase.body = cloneAstList(node->patternCase.body, node->patternCase.bodyCount);
+            break;
+        default:
+            // Leaf nodes have no children to copy
+            break;
+    }
+    
+    return copy;
+}
+
+/**
+ * @brief Invokes a callback for every direct child of an AST node
+ * 
+ * @param node Node whose children are visited (may be NULL)
+ * @param visit Callback invoked for each non-NULL child
+ * @param userData Passed through to the callback
+ * @return bool false if the node kind is not known to the walker
+ */
+bool astVisitChildren(AstNode* node, AstChildVisitor visit, void* userData) {
+    if (!node) return true;
+
+#define VISIT(child) do { if (child) visit((child), userData); } while (0)
+#define VISIT_LIST(list, count) do { for (int i_ = 0; (list) && i_ < (count); i_++) VISIT((list)[i_]); } while (0)
+    switch (node->type) {
+        case AST_PROGRAM: VISIT_LIST(node->program.statements, node->program.statementCount); break;
+        case AST_FUNC_DEF: VISIT_LIST(node->funcDef.body, node->funcDef.bodyCount); break;
+        case AST_CLASS_DEF: VISIT_LIST(node->classDef.members, node->classDef.memberCount); break;
+        case AST_VAR_DECL: VISIT(node->varDecl.initializer); break;
+        case AST_VAR_ASSIGN: VISIT(node->varAssign.initializer); break;
+        case AST_ARRAY_ASSIGN:
+            VISIT(node->arrayAssign.index);
+            VISIT(node->arrayAssign.value);
+            break;
+        case AST_BLOCK: VISIT_LIST(node->block.statements, node->block.statementCount); break;
+        case AST_IF_STMT:
+            VISIT(node->ifStmt.condition);
+            VISIT_LIST(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            VISIT_LIST(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            VISIT(node->forStmt.rangeStart);
+            VISIT(node->forStmt.rangeEnd);
+            VISIT(node->forStmt.rangeStep);
+            VISIT(node->forStmt.collection);
+            VISIT(node->forStmt.init);
+            VISIT(node->forStmt.condition);
+            VISIT(node->forStmt.update);
+            VISIT_LIST(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            VISIT(node->whileStmt.condition);
+            VISIT_LIST(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            VISIT_LIST(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            VISIT(node->doWhileStmt.condition);
+            break;
+        case AST_SWITCH_STMT:
+            VISIT(node->switchStmt.expr);
+            VISIT_LIST(node->switchStmt.cases, node->switchStmt.caseCount);
+            VISIT_LIST(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            VISIT(node->caseStmt.expr);
+            VISIT_LIST(node->caseStmt.body, node->caseStmt.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            VISIT_LIST(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            VISIT_LIST(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            VISIT_LIST(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        case AST_THROW_STMT: VISIT(node->throwStmt.expr); break;
+        case AST_RETURN_STMT: VISIT(node->returnStmt.expr); break;
+        case AST_PRINT_STMT: VISIT(node->printStmt.expr); break;
+        case AST_BINARY_OP:
+            VISIT(node->binaryOp.left);
+            VISIT(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP: VISIT(node->unaryOp.expr); break;
+        case AST_MEMBER_ACCESS: VISIT(node->memberAccess.object); break;
+        case AST_ARRAY_ACCESS:
+            VISIT(node->arrayAccess.array);
+            VISIT(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL: VISIT_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_FUNC_CALL: VISIT_LIST(node->funcCall.arguments, node->funcCall.argCount); break;
+        case AST_NEW_EXPR: VISIT_LIST(node->newExpr.arguments, node->newExpr.argCount); break;
+        case AST_LAMBDA: VISIT(node->lambda.body); break;
+        case AST_FUNC_COMPOSE:
+            VISIT(node->funcCompose.left);
+            VISIT(node->funcCompose.right);
+            break;
+        case AST_CURRY_EXPR:
+            VISIT(node->curryExpr.baseFunc);
+            VISIT_LIST(node->curryExpr.appliedArgs, node->curryExpr.appliedCount);
+            break;
+        case AST_CONCAT_EXPR: VISIT_LIST(node->concatExpr.parts, node->concatExpr.partCount); break;
+        case AST_PATTERN_MATCH:
+            VISIT(node->patternMatch.expr);
+            VISIT_LIST(node->patternMatch.cases, node->patternMatch.caseCount);
+            VISIT(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            VISIT(node->patternCase.pattern);
+            VISIT_LIST(node->patternCase.body, node->patternCase.bodyCount);
+            break;
+        case AST_IMPORT:
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_THIS_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+        default:
+            return false;
+    }
+#undef VISIT_LIST
+#undef VISIT
+    return true;
+}
+
+bool isIntegerLiteral(const AstNode* node) {
+    if (!node || node->type != AST_NUMBER_LITERAL || node->numberLiteral.isDouble) return false;
+    if (node->numberLiteral.isInteger) return true;
+    double value = node->numberLiteral.value;
+    return value >= -AST_MAX_EXACT_INTEGER && value <= AST_MAX_EXACT_INTEGER &&
+           value == (double)(long long)value;
+}
+
+long long integerLiteralValue(const AstNode* node) {
+    if (node->numberLiteral.isInteger) return node->numberLiteral.intValue;
+    return (long long)node->numberLiteral.value;
+}
+
+void setIntegerLiteral(AstNode* node, long long value) {
+    node->numberLiteral.value = (double)value;
+    node->numberLiteral.isDouble = false;
+    node->numberLiteral.isInteger = true;
+    node->numberLiteral.intValue = value;
+}
+
 /**
  * @brief Converts an AST node type to its string representation
  * 
@@ -768,6 +1116,7 @@ const char* astNodeTypeToString(AstNodeType type) {
         case AST_CASE_STMT: return "CASE_STMT";
         case AST_RETURN_STMT: return "RETURN_STMT";
         case AST_VAR_ASSIGN: return "VAR_ASSIGN";
+        case AST_ARRAY_ASSIGN: return "ARRAY_ASSIGN";
         case AST_PRINT_STMT: return "PRINT_STMT";
         case AST_BREAK_STMT: return "BREAK_STMT";
         case AST_CONTINUE_STMT: return "CONTINUE_STMT";
@@ -789,6 +1138,7 @@ const char* astNodeTypeToString(AstNodeType type) {
         case AST_CURRY_EXPR: return "CURRY_EXPR";
         case AST_NEW_EXPR: return "NEW_EXPR";
         case AST_THIS_EXPR: return "THIS_EXPR";
+        case AST_CONCAT_EXPR: return "CONCAT_EXPR";
         case AST_POINTCUT: return "POINTCUT";
         case AST_ADVICE: return "ADVICE";
         case AST_PATTERN_MATCH: return "PATTERN_MATCH";
@@ -14,6 +14,9 @@
  * for manipulating these trees.
  */
 
+/** Largest integer magnitude a number literal holds exactly (2^53) */
+#define AST_MAX_EXACT_INTEGER 9007199254740992.0
+
 // Forward declarations
 struct Type;
 
@@ -48,6 +51,7 @@ typedef enum {
     AST_CASE_STMT,
     AST_RETURN_STMT,
     AST_VAR_ASSIGN,
+    AST_ARRAY_ASSIGN,  // Element assignment: name[index] = value
     AST_PRINT_STMT,
     AST_BREAK_STMT,
     AST_CONTINUE_STMT,
@@ -71,6 +75,7 @@ typedef enum {
     AST_CURRY_EXPR,
     AST_NEW_EXPR,     // Node for object instantiation (new)
     AST_THIS_EXPR,    // Node for the "this" keyword
+    AST_CONCAT_EXPR,  // Flattened string concatenation chain (built by the optimizer)
     
     // Aspect-oriented programming
     AST_POINTCUT,
@@ -107,6 +112,32 @@ typedef enum {
     FOR_TRADITIONAL = 2 // for (init; condition; update)
 } ForLoopType;
 
+/**
+ * @brief Facts proven about the iterator of a range loop
+ * 
+ * Bit flags stored in forStmt.inductionFlags by the optimizer's induction
+ * variable analysis. They hold for every execution of the loop body.
+ */
+typedef enum {
+    IV_NONE         = 0,       // Nothing proven
+    IV_NON_NEGATIVE = 1 << 0,  // iterator >= 0 (start >= 0, positive step, never reassigned)
+    IV_BOUNDED      = 1 << 1   // iterator < rangeEnd, and rangeEnd is loop-invariant
+} InductionFlag;
+
+/**
+ * @brief Code generation attributes for function definitions
+ * 
+ * Bit flags stored in funcDef.attributes that tell the backend how the
+ * function should be emitted.
+ */
+typedef enum {
+    FUNC_ATTR_NONE          = 0,       // No special handling
+    FUNC_ATTR_INLINE        = 1 << 0,  // Emit as an inline candidate
+    FUNC_ATTR_ALWAYS_INLINE = 1 << 1,  // Force inlining into every caller
+    FUNC_ATTR_NOINLINE      = 1 << 2,  // Never inline (@noinline)
+    FUNC_ATTR_EXPORT        = 1 << 3   // Keep even if unreachable from main (@export)
+} FuncAttribute;
+
 /**
  * @brief Base structure for all AST nodes
  * 
@@ -135,6 +166,7 @@ typedef struct AstNode {
             int paramCount;
             struct AstNode** body;
             int bodyCount;
+            int attributes;         // FuncAttribute flags
         } funcDef;
         
         // AST_CLASS_DEF
@@ -208,6 +240,7 @@ typedef struct AstNode {
             struct AstNode* update;     // For traditional loop
             struct AstNode** body;
             int bodyCount;
+            int inductionFlags;         // InductionFlag bits proven for range loops
         } forStmt;
         
         // AST_WHILE_STMT
@@ -251,6 +284,13 @@ typedef struct AstNode {
             struct AstNode* initializer;
         } varAssign;
         
+        // AST_ARRAY_ASSIGN
+        struct {
+            char name[256];
+            struct AstNode* index;
+            struct AstNode* value;
+        } arrayAssign;
+        
         // AST_PRINT_STMT
         struct {
             struct AstNode* expr;
@@ -299,6 +339,9 @@ typedef struct AstNode {
         // AST_NUMBER_LITERAL
         struct {
             double value;
+            bool isDouble;          // Typed double even when integral (written with a '.', or a compile-time double)
+            bool isInteger;         // intValue holds the exact value (integer written in the source or folded)
+            long long intValue;     // Exact value of an integer; value may be rounded above 2^53
         } numberLiteral;
         
         // AST_STRING_LITERAL
@@ -380,6 +423,12 @@ typedef struct AstNode {
             // No additional fields required for 'this'
         } thisExpr;
         
+        // AST_CONCAT_EXPR
+        struct {
+            struct AstNode** parts;     // Operands in output order
+            int partCount;
+        } concatExpr;
+        
         // AST_POINTCUT
         struct {
             char name[256];
@@ -488,6 +537,62 @@ void printAst(AstNode* node, int indent);
  */
 AstNode* copyAstNode(AstNode* node);
 
+/**
+ * @brief Creates a deep copy of an AST subtree
+ * 
+ * @param node The root of the subtree to copy
+ * @return AstNode* An independent copy of the subtree, or NULL if node is NULL
+ */
+AstNode* cloneAstTree(AstNode* node);
+
+/** Callback invoked by astVisitChildren() for each child of a node */
+typedef void (*AstChildVisitor)(AstNode* child, void* userData);
+
+/**
+ * @brief Invokes a callback for every direct child of an AST node
+ * 
+ * Statements, expressions and nested definitions are visited in source
+ * order. Parameters of functions and lambdas are not: they only declare
+ * names. Node kinds added to the AST must be added here too, so every
+ * analysis built on this walker sees their children.
+ * 
+ * @param node Node whose children are visited (may be NULL)
+ * @param visit Callback invoked for each non-NULL child
+ * @param userData Passed through to the callback
+ * @return bool false if the node kind is not known to the walker, so its
+ *         children (if any) were not visited
+ */
+bool astVisitChildren(AstNode* node, AstChildVisitor visit, void* userData);
+
+/**
+ * @brief Checks whether a number literal is a Lyn integer
+ * 
+ * Integers are compiled to int64_t. A literal is one when it holds an exact
+ * int64 value (written without a decimal point, or folded from integers),
+ * or when its double is integral and no larger in magnitude than
+ * AST_MAX_EXACT_INTEGER, so that it holds the integer exactly.
+ * 
+ * @param node AST_NUMBER_LITERAL node
+ * @return bool true if the literal is an integer
+ */
+bool isIntegerLiteral(const AstNode* node);
+
+/**
+ * @brief Gets the exact value of an integer literal
+ * 
+ * @param node AST_NUMBER_LITERAL node for which isIntegerLiteral() holds
+ * @return long long The literal's value
+ */
+long long integerLiteralValue(const AstNode* node);
+
+/**
+ * @brief Makes a number literal the given integer
+ * 
+ * @param node AST_NUMBER_LITERAL node
+ * @param value Exact value
+ */
+void setIntegerLiteral(AstNode* node, long long value);
+
 /**
  * @brief Converts an AST node type to its string representation
  * 
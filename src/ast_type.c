@@ -297,6 +297,14 @@ bool validate_ast_types(AstNode* node) {
             // Add more function checks as needed
             break;
             
+        case AST_CONCAT_EXPR:
+            // Every part is converted to text, whatever its type
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // The element type is not tracked; the C compiler converts the value
+            break;
+            
         // Add checks for other node types as needed
     }
     
@@ -410,6 +418,21 @@ bool validate_ast_types(AstNode* node) {
                 }
             }
             break;
+            
+        case AST_CONCAT_EXPR:
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                if (!validate_ast_types(node->concatExpr.parts[i])) {
+                    valid = false;
+                }
+            }
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            if (!validate_ast_types(node->arrayAssign.index) ||
+                !validate_ast_types(node->arrayAssign.value)) {
+                valid = false;
+            }
+            break;
     }
     
     return valid;
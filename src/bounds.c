@@ -0,0 +1,743 @@
+/**
+ * @file bounds.c
+ * @brief Implementation of array bounds-check elimination
+ *
+ * The program is scanned once for what holds everywhere: which arrays have
+ * a known length, and which may be reassigned by a function. Each range
+ * loop then pushes a frame recording what its iterator is proven to range
+ * over and which accesses of its body were covered by a check before it;
+ * accesses consult the frames of the loops around them, innermost first.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "bounds.h"
+#include "hashmap.h"
+#include "error.h"
+#include "logger.h"
+
+/**
+ * @brief What a range loop proves, and the accesses it checks up front
+ */
+typedef struct {
+    const char* iterator;          ///< Iterator name
+    bool proven;                   ///< start >= 0 and the iterator is never reassigned
+    char end_array[256];           ///< Array whose length is the range end ("" if none)
+    long long max_index;           ///< Largest iterator value for a constant end (-1 if none)
+    const AstNode** hoisted;       ///< Accesses covered by the check before the loop
+    int hoisted_count;
+    int hoisted_capacity;
+} LoopFrame;
+
+/** Current mode */
+static BoundsMode mode = BOUNDS_CHECKED;
+/** Array variables -> element count + 1 of every literal assigned to them (-1 if they differ) */
+static HashMap* literalLengths = NULL;
+/** Variables bound in any other way (parameters, iterators, declarations, other values) */
+static HashMap* otherBindings = NULL;
+/** Variables assigned inside a function body, which a call may therefore change */
+static HashMap* functionAssigned = NULL;
+/** Set when the program holds a construct the scan cannot see into */
+static bool scanUnknown = false;
+/** Depth of function bodies during the scan */
+static int functionDepth = 0;
+/** Frames of the range loops being compiled, innermost last */
+static LoopFrame* frames = NULL;
+static int frameCount = 0;
+static int frameCapacity = 0;
+/** Loops entered without a frame because the stack could not grow */
+static int unframedDepth = 0;
+/** Statistics */
+static BoundsStats stats = {0};
+
+void bounds_set_mode(BoundsMode newMode) {
+    mode = newMode;
+    logger_log(LOG_INFO, "Array bounds checks: %s", mode == BOUNDS_CHECKED ? "checked" : "unchecked");
+}
+
+BoundsMode bounds_get_mode(void) {
+    return mode;
+}
+
+void bounds_cleanup(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)bounds_cleanup);
+
+    hashmap_free(literalLengths, NULL);
+    literalLengths = NULL;
+    hashmap_free(otherBindings, NULL);
+    otherBindings = NULL;
+    hashmap_free(functionAssigned, NULL);
+    functionAssigned = NULL;
+    scanUnknown = false;
+    functionDepth = 0;
+    for (int i = 0; i < frameCount; i++) {
+        free(frames[i].hoisted);
+    }
+    free(frames);
+    frames = NULL;
+    frameCount = 0;
+    frameCapacity = 0;
+    unframedDepth = 0;
+}
+
+BoundsStats bounds_get_stats(void) {
+    return stats;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Program scan                                                              */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Records one binding of a name
+ *
+ * @param name Variable name
+ * @param value Value assigned, or NULL for a parameter, iterator or declaration
+ */
+static void note_binding(const char* name, AstNode* value) {
+    if (!name || name[0] == '\0' || strchr(name, '.')) return;
+    if (functionDepth > 0) {
+        hashmap_put(functionAssigned, name, NULL, NULL);
+    }
+    if (!value || value->type != AST_ARRAY_LITERAL) {
+        hashmap_put(otherBindings, name, NULL, NULL);
+        return;
+    }
+    intptr_t length = value->arrayLiteral.elementCount + 1;
+    intptr_t known = (intptr_t)hashmap_get(literalLengths, name);
+    hashmap_put(literalLengths, name, (void*)(known == 0 || known == length ? length : -1), NULL);
+}
+
+/**
+ * @brief Records the parameters of a function or lambda
+ */
+static void note_parameters(AstNode** parameters, int count) {
+    for (int i = 0; parameters && i < count; i++) {
+        if (parameters[i] && parameters[i]->type == AST_IDENTIFIER) {
+            note_binding(parameters[i]->identifier.name, NULL);
+        }
+    }
+}
+
+/**
+ * @brief Walks a subtree recording every binding of every name
+ */
+static void scan_bindings(AstNode* node) {
+    if (!node) return;
+
+#define SCAN(child) scan_bindings(child)
+#define SCAN_LIST(list, count) do { for (int i_ = 0; (list) && i_ < (count); i_++) SCAN((list)[i_]); } while (0)
+    switch (node->type) {
+        case AST_PROGRAM: SCAN_LIST(node->program.statements, node->program.statementCount); break;
+        case AST_FUNC_DEF:
+            functionDepth++;
+            note_parameters(node->funcDef.parameters, node->funcDef.paramCount);
+            SCAN_LIST(node->funcDef.body, node->funcDef.bodyCount);
+            functionDepth--;
+            break;
+        case AST_LAMBDA:
+            functionDepth++;
+            note_parameters(node->lambda.parameters, node->lambda.paramCount);
+            SCAN(node->lambda.body);
+            functionDepth--;
+            break;
+        case AST_CLASS_DEF: SCAN_LIST(node->classDef.members, node->classDef.memberCount); break;
+        case AST_VAR_DECL:
+            note_binding(node->varDecl.name, NULL);
+            SCAN(node->varDecl.initializer);
+            break;
+        case AST_VAR_ASSIGN:
+            note_binding(node->varAssign.name, node->varAssign.initializer);
+            SCAN(node->varAssign.initializer);
+            break;
+        case AST_ARRAY_ASSIGN:
+            SCAN(node->arrayAssign.index);
+            SCAN(node->arrayAssign.value);
+            break;
+        case AST_BLOCK: SCAN_LIST(node->block.statements, node->block.statementCount); break;
+        case AST_IF_STMT:
+            SCAN(node->ifStmt.condition);
+            SCAN_LIST(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            SCAN_LIST(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            note_binding(node->forStmt.iterator, NULL);
+            SCAN(node->forStmt.rangeStart);
+            SCAN(node->forStmt.rangeEnd);
+            SCAN(node->forStmt.rangeStep);
+            SCAN(node->forStmt.collection);
+            SCAN(node->forStmt.init);
+            SCAN(node->forStmt.condition);
+            SCAN(node->forStmt.update);
+            SCAN_LIST(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            SCAN(node->whileStmt.condition);
+            SCAN_LIST(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            SCAN_LIST(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            SCAN(node->doWhileStmt.condition);
+            break;
+        case AST_SWITCH_STMT:
+            SCAN(node->switchStmt.expr);
+            SCAN_LIST(node->switchStmt.cases, node->switchStmt.caseCount);
+            SCAN_LIST(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            SCAN(node->caseStmt.expr);
+            SCAN_LIST(node->caseStmt.body, node->caseStmt.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            SCAN(node->patternMatch.expr);
+            SCAN_LIST(node->patternMatch.cases, node->patternMatch.caseCount);
+            SCAN(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            SCAN(node->patternCase.pattern);
+            SCAN_LIST(node->patternCase.body, node->patternCase.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            note_binding(node->tryCatchStmt.errorVarName, NULL);
+            SCAN_LIST(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            SCAN_LIST(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            SCAN_LIST(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        case AST_THROW_STMT: SCAN(node->throwStmt.expr); break;
+        case AST_RETURN_STMT: SCAN(node->returnStmt.expr); break;
+        case AST_PRINT_STMT: SCAN(node->printStmt.expr); break;
+        case AST_BINARY_OP:
+            SCAN(node->binaryOp.left);
+            SCAN(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP: SCAN(node->unaryOp.expr); break;
+        case AST_MEMBER_ACCESS: SCAN(node->memberAccess.object); break;
+        case AST_ARRAY_ACCESS:
+            SCAN(node->arrayAccess.array);
+            SCAN(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL: SCAN_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_FUNC_CALL: SCAN_LIST(node->funcCall.arguments, node->funcCall.argCount); break;
+        case AST_NEW_EXPR: SCAN_LIST(node->newExpr.arguments, node->newExpr.argCount); break;
+        case AST_CONCAT_EXPR: SCAN_LIST(node->concatExpr.parts, node->concatExpr.partCount); break;
+        case AST_IMPORT:
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_THIS_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+        default:
+            // Aspects, modules, patterns...: bindings could hide anywhere
+            scanUnknown = true;
+            break;
+    }
+#undef SCAN_LIST
+#undef SCAN
+}
+
+void bounds_begin_program(AstNode* program) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)bounds_begin_program);
+
+    bounds_cleanup();
+    stats = (BoundsStats){0};
+    literalLengths = hashmap_create(32);
+    otherBindings = hashmap_create(64);
+    functionAssigned = hashmap_create(32);
+    if (!literalLengths || !otherBindings || !functionAssigned) {
+        error_report("Bounds", __LINE__, 0, "Failed to allocate the array tables", ERROR_MEMORY);
+        scanUnknown = true;
+        return;
+    }
+    scan_bindings(program);
+}
+
+/**
+ * @brief Gets the length every value of an array variable has
+ *
+ * @return long long Known length, or -1 if the variable may hold arrays of different lengths
+ */
+static long long known_length(const char* name) {
+    if (scanUnknown || hashmap_contains(otherBindings, name)) return -1;
+    intptr_t length = (intptr_t)hashmap_get(literalLengths, name);
+    return length > 0 ? (long long)(length - 1) : -1;
+}
+
+/**
+ * @brief Checks whether a call may reassign an array variable
+ */
+static bool assigned_by_functions(const char* name) {
+    return scanUnknown || hashmap_contains(functionAssigned, name);
+}
+
+/* ------------------------------------------------------------------------ */
+/* Loop analysis                                                             */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief What a loop body does, as far as the analysis is concerned
+ */
+typedef struct {
+    HashMap* writes;               ///< Variables assigned, declared or iterated over
+    bool calls;                    ///< A call may run arbitrary code
+    bool opaque;                   ///< A function or unknown construct hides what names mean
+} BodyEffects;
+
+/**
+ * @brief Collects the variables a subtree assigns and whether it calls anything
+ */
+static void collect_effects(AstNode* node, BodyEffects* effects) {
+    if (!node || effects->opaque) return;
+
+#define COLLECT(child) collect_effects(child, effects)
+#define COLLECT_LIST(list, count) do { for (int i_ = 0; (list) && i_ < (count); i_++) COLLECT((list)[i_]); } while (0)
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            hashmap_put(effects->writes, node->varAssign.name, NULL, NULL);
+            COLLECT(node->varAssign.initializer);
+            break;
+        case AST_VAR_DECL:
+            hashmap_put(effects->writes, node->varDecl.name, NULL, NULL);
+            COLLECT(node->varDecl.initializer);
+            break;
+        case AST_ARRAY_ASSIGN:
+            COLLECT(node->arrayAssign.index);
+            COLLECT(node->arrayAssign.value);
+            break;
+        case AST_FOR_STMT:
+            hashmap_put(effects->writes, node->forStmt.iterator, NULL, NULL);
+            COLLECT(node->forStmt.rangeStart);
+            COLLECT(node->forStmt.rangeEnd);
+            COLLECT(node->forStmt.rangeStep);
+            COLLECT(node->forStmt.collection);
+            COLLECT(node->forStmt.init);
+            COLLECT(node->forStmt.condition);
+            COLLECT(node->forStmt.update);
+            COLLECT_LIST(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            COLLECT(node->whileStmt.condition);
+            COLLECT_LIST(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            COLLECT_LIST(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            COLLECT(node->doWhileStmt.condition);
+            break;
+        case AST_IF_STMT:
+            COLLECT(node->ifStmt.condition);
+            COLLECT_LIST(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            COLLECT_LIST(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_BLOCK: COLLECT_LIST(node->block.statements, node->block.statementCount); break;
+        case AST_SWITCH_STMT:
+            COLLECT(node->switchStmt.expr);
+            COLLECT_LIST(node->switchStmt.cases, node->switchStmt.caseCount);
+            COLLECT_LIST(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            COLLECT(node->caseStmt.expr);
+            COLLECT_LIST(node->caseStmt.body, node->caseStmt.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            COLLECT(node->patternMatch.expr);
+            COLLECT_LIST(node->patternMatch.cases, node->patternMatch.caseCount);
+            COLLECT(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            COLLECT(node->patternCase.pattern);
+            COLLECT_LIST(node->patternCase.body, node->patternCase.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            hashmap_put(effects->writes, node->tryCatchStmt.errorVarName, NULL, NULL);
+            COLLECT_LIST(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            COLLECT_LIST(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            COLLECT_LIST(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        case AST_PRINT_STMT: COLLECT(node->printStmt.expr); break;
+        case AST_RETURN_STMT: COLLECT(node->returnStmt.expr); break;
+        case AST_THROW_STMT: COLLECT(node->throwStmt.expr); break;
+        case AST_BINARY_OP:
+            COLLECT(node->binaryOp.left);
+            COLLECT(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP: COLLECT(node->unaryOp.expr); break;
+        case AST_MEMBER_ACCESS: COLLECT(node->memberAccess.object); break;
+        case AST_ARRAY_ACCESS:
+            COLLECT(node->arrayAccess.array);
+            COLLECT(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL: COLLECT_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_CONCAT_EXPR: COLLECT_LIST(node->concatExpr.parts, node->concatExpr.partCount); break;
+        case AST_FUNC_CALL:
+            effects->calls = true;
+            COLLECT_LIST(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_NEW_EXPR:
+            effects->calls = true;
+            COLLECT_LIST(node->newExpr.arguments, node->newExpr.argCount);
+            break;
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_THIS_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+        default:
+            // Nested functions rebind names; other constructs are not understood
+            effects->opaque = true;
+            break;
+    }
+#undef COLLECT_LIST
+#undef COLLECT
+}
+
+/**
+ * @brief Gets an integral constant
+ *
+ * @return bool true if node is a number literal with an integral value
+ */
+static bool integral_constant(const AstNode* node, long long* value) {
+    if (!node || node->type != AST_NUMBER_LITERAL) return false;
+    double v = node->numberLiteral.value;
+    if (!(v > -1e15 && v < 1e15) || v != (double)(long long)v) return false;
+    *value = (long long)v;
+    return true;
+}
+
+/**
+ * @brief Checks whether an expression is `name.length`, returning the name
+ */
+static const char* length_of(const AstNode* node) {
+    if (!node || node->type != AST_MEMBER_ACCESS || strcmp(node->memberAccess.member, "length") != 0 ||
+        !node->memberAccess.object || node->memberAccess.object->type != AST_IDENTIFIER) {
+        return NULL;
+    }
+    return node->memberAccess.object->identifier.name;
+}
+
+/**
+ * @brief Checks whether an index is provably within the bounds of an array
+ *
+ * Looks at the index as a constant, then as the iterator of the innermost
+ * loop iterating over that name.
+ */
+static bool index_proven(const char* array, const AstNode* index) {
+    long long value;
+    long long length = known_length(array);
+    if (integral_constant(index, &value)) {
+        return value >= 0 && value < length;
+    }
+    if (!index || index->type != AST_IDENTIFIER) return false;
+
+    for (int i = frameCount - 1; i >= 0; i--) {
+        const LoopFrame* frame = &frames[i];
+        if (strcmp(frame->iterator, index->identifier.name) != 0) continue;
+        // The innermost loop over this name decides: outer ones are shadowed
+        if (!frame->proven) return false;
+        if (frame->end_array[0]) {
+            if (strcmp(frame->end_array, array) == 0) return true;
+            long long endLength = known_length(frame->end_array);
+            return endLength >= 0 && length >= endLength;
+        }
+        return frame->max_index >= 0 && length > frame->max_index;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks whether an expression is an int the pre-check can compute before the loop
+ */
+static bool int_expression(const AstNode* node, BoundsTypeFn variableType) {
+    long long value;
+    if (integral_constant(node, &value)) return true;
+    if (node && node->type == AST_IDENTIFIER) {
+        const char* type = variableType ? variableType(node->identifier.name) : NULL;
+        return type && strcmp(type, "int64_t") == 0;
+    }
+    const char* array = length_of(node);
+    if (array) {
+        const char* type = variableType ? variableType(array) : NULL;
+        return type && (strcmp(type, "int64_t*") == 0 || strcmp(type, "double*") == 0 ||
+                        strcmp(type, "const char**") == 0);
+    }
+    return false;
+}
+
+/**
+ * @brief State of the search for accesses to check before a loop
+ */
+typedef struct {
+    LoopFrame* frame;
+    BodyEffects* effects;
+    BoundsTypeFn variableType;
+    BoundsPrecheck* prechecks;
+    int count;
+    bool straight;                 ///< Every iteration runs the whole body
+} HoistScan;
+
+/**
+ * @brief Records an access that every iteration performs, if its span can be checked up front
+ */
+static void note_unconditional_access(const AstNode* access, const char* array, const AstNode* index,
+                                      HoistScan* scan) {
+    if (index_proven(array, index)) return;
+
+    // The index must be iterator + constant, and the array must keep its length
+    const char* iterator = scan->frame->iterator;
+    long long offset = 0;
+    if (index->type == AST_IDENTIFIER) {
+        if (strcmp(index->identifier.name, iterator) != 0) return;
+    } else if (index->type == AST_BINARY_OP && (index->binaryOp.op == '+' || index->binaryOp.op == '-')) {
+        const AstNode* left = index->binaryOp.left;
+        const AstNode* right = index->binaryOp.right;
+        if (left && left->type == AST_IDENTIFIER && strcmp(left->identifier.name, iterator) == 0 &&
+            integral_constant(right, &offset)) {
+            if (index->binaryOp.op == '-') offset = -offset;
+        } else if (index->binaryOp.op == '+' && right && right->type == AST_IDENTIFIER &&
+                   strcmp(right->identifier.name, iterator) == 0 && integral_constant(left, &offset)) {
+            // c + i
+        } else {
+            return;
+        }
+    } else {
+        return;
+    }
+    if (hashmap_contains(scan->effects->writes, array)) return;
+    const char* type = scan->variableType ? scan->variableType(array) : NULL;
+    if (!type || (strcmp(type, "int64_t*") != 0 && strcmp(type, "double*") != 0 && strcmp(type, "const char**") != 0)) {
+        return;
+    }
+
+    int slot = -1;
+    for (int i = 0; i < scan->count; i++) {
+        if (strcmp(scan->prechecks[i].array, array) == 0) slot = i;
+    }
+    if (slot < 0) {
+        if (scan->count == BOUNDS_MAX_PRECHECKS || strlen(array) >= sizeof(scan->prechecks[0].array)) return;
+        slot = scan->count++;
+        snprintf(scan->prechecks[slot].array, sizeof(scan->prechecks[slot].array), "%s", array);
+        scan->prechecks[slot].min_offset = offset;
+        scan->prechecks[slot].max_offset = offset;
+    } else {
+        if (offset < scan->prechecks[slot].min_offset) scan->prechecks[slot].min_offset = offset;
+        if (offset > scan->prechecks[slot].max_offset) scan->prechecks[slot].max_offset = offset;
+    }
+
+    LoopFrame* frame = scan->frame;
+    if (frame->hoisted_count == frame->hoisted_capacity) {
+        int capacity = frame->hoisted_capacity ? frame->hoisted_capacity * 2 : 8;
+        const AstNode** grown = realloc(frame->hoisted, capacity * sizeof(AstNode*));
+        if (!grown) {
+            error_report("Bounds", __LINE__, 0, "Failed to grow the hoisted access table", ERROR_MEMORY);
+            scan->straight = false;
+            return;
+        }
+        frame->hoisted = grown;
+        frame->hoisted_capacity = capacity;
+    }
+    frame->hoisted[frame->hoisted_count++] = access;
+}
+
+/**
+ * @brief Walks an expression, noting the accesses evaluated every time it is
+ *
+ * @param unconditional false below a short-circuit operator, where operands may be skipped
+ */
+static void scan_hoist_expression(AstNode* node, bool unconditional, HoistScan* scan) {
+    if (!node || !scan->straight) return;
+
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_IDENTIFIER:
+            break;
+        case AST_UNARY_OP:
+            scan_hoist_expression(node->unaryOp.expr, unconditional, scan);
+            break;
+        case AST_BINARY_OP: {
+            bool shortCircuit = node->binaryOp.op == 'A' || node->binaryOp.op == 'O';
+            scan_hoist_expression(node->binaryOp.left, unconditional, scan);
+            scan_hoist_expression(node->binaryOp.right, unconditional && !shortCircuit, scan);
+            break;
+        }
+        case AST_MEMBER_ACCESS:
+            if (!length_of(node)) scan->straight = false;
+            break;
+        case AST_ARRAY_ACCESS:
+            if (!node->arrayAccess.array || node->arrayAccess.array->type != AST_IDENTIFIER) {
+                scan->straight = false;
+                break;
+            }
+            scan_hoist_expression(node->arrayAccess.index, unconditional, scan);
+            if (unconditional) {
+                note_unconditional_access(node, node->arrayAccess.array->identifier.name,
+                                          node->arrayAccess.index, scan);
+            }
+            break;
+        default:
+            // Calls and anything else may fail or stop the program on their own
+            scan->straight = false;
+            break;
+    }
+}
+
+/**
+ * @brief Walks body statements, noting the accesses every iteration performs
+ *
+ * @param unconditional false inside a branch of an if
+ */
+static void scan_hoist_statements(AstNode** body, int count, bool unconditional, HoistScan* scan) {
+    for (int i = 0; body && i < count && scan->straight; i++) {
+        AstNode* stmt = body[i];
+        if (!stmt) continue;
+        switch (stmt->type) {
+            case AST_IDENTIFIER:
+                break;
+            case AST_VAR_ASSIGN:
+                if (strchr(stmt->varAssign.name, '.')) {
+                    scan->straight = false;
+                    break;
+                }
+                scan_hoist_expression(stmt->varAssign.initializer, unconditional, scan);
+                break;
+            case AST_VAR_DECL:
+                scan_hoist_expression(stmt->varDecl.initializer, unconditional, scan);
+                break;
+            case AST_ARRAY_ASSIGN:
+                scan_hoist_expression(stmt->arrayAssign.index, unconditional, scan);
+                scan_hoist_expression(stmt->arrayAssign.value, unconditional, scan);
+                if (unconditional && scan->straight) {
+                    note_unconditional_access(stmt, stmt->arrayAssign.name, stmt->arrayAssign.index, scan);
+                }
+                break;
+            case AST_IF_STMT:
+                scan_hoist_expression(stmt->ifStmt.condition, unconditional, scan);
+                scan_hoist_statements(stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount, false, scan);
+                scan_hoist_statements(stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount, false, scan);
+                break;
+            default:
+                // Output, calls, nested loops and early exits: keep the checks where they are
+                scan->straight = false;
+                break;
+        }
+    }
+}
+
+/**
+ * @brief Checks that the range end reads nothing the body assigns
+ */
+static bool end_invariant(const AstNode* end, const BodyEffects* effects) {
+    if (!end) return false;
+    if (end->type == AST_NUMBER_LITERAL) return true;
+    if (end->type == AST_IDENTIFIER) return !hashmap_contains(effects->writes, end->identifier.name);
+    const char* array = length_of(end);
+    return array && !hashmap_contains(effects->writes, array);
+}
+
+int bounds_enter_loop(AstNode* loop, BoundsTypeFn variableType, BoundsPrecheck* prechecks) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)bounds_enter_loop);
+
+    if (frameCount == frameCapacity) {
+        int capacity = frameCapacity ? frameCapacity * 2 : 8;
+        LoopFrame* grown = realloc(frames, capacity * sizeof(LoopFrame));
+        if (!grown) {
+            error_report("Bounds", __LINE__, 0, "Failed to grow the loop frame stack", ERROR_MEMORY);
+            // Without a frame nothing is proven, but exits must still balance
+            unframedDepth++;
+            return 0;
+        }
+        frames = grown;
+        frameCapacity = capacity;
+    }
+    LoopFrame* frame = &frames[frameCount++];
+    memset(frame, 0, sizeof(*frame));
+    frame->iterator = loop->forStmt.iterator;
+    frame->max_index = -1;
+    if (mode != BOUNDS_CHECKED) return 0;
+
+    BodyEffects effects = { hashmap_create(16), false, false };
+    if (!effects.writes) return 0;
+    for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+        collect_effects(loop->forStmt.body[i], &effects);
+    }
+
+    // What the iterator ranges over in every iteration
+    AstNode* start = loop->forStmt.rangeStart;
+    AstNode* end = loop->forStmt.rangeEnd;
+    AstNode* step = loop->forStmt.rangeStep;
+    long long startValue = -1, stepValue = 1;
+    bool stepOk = !step || (integral_constant(step, &stepValue) && stepValue > 0);
+    frame->proven = !effects.opaque && stepOk && integral_constant(start, &startValue) && startValue >= 0 &&
+                    !hashmap_contains(effects.writes, frame->iterator);
+    if (frame->proven) {
+        const char* array = length_of(end);
+        if (array && !hashmap_contains(effects.writes, array) && !(effects.calls && assigned_by_functions(array))) {
+            snprintf(frame->end_array, sizeof(frame->end_array), "%s", array);
+        } else if (end && end->type == AST_NUMBER_LITERAL) {
+            // i < end holds for every integer i up to the end rounded up, minus one
+            double bound = end->numberLiteral.value;
+            if (bound >= 1 && bound < 1e15) {
+                long long whole = (long long)bound;
+                frame->max_index = (whole < bound ? whole + 1 : whole) - 1;
+            }
+        }
+    }
+
+    // Checks that can move before the loop: every iteration runs and can be counted up front
+    int count = 0;
+    if (!effects.opaque && !effects.calls && stepValue == 1 && stepOk &&
+        !hashmap_contains(effects.writes, frame->iterator) &&
+        int_expression(start, variableType) && int_expression(end, variableType) && end_invariant(end, &effects) &&
+        (start->type != AST_IDENTIFIER || !hashmap_contains(effects.writes, start->identifier.name))) {
+        HoistScan scan = { frame, &effects, variableType, prechecks, 0, true };
+        scan_hoist_statements(loop->forStmt.body, loop->forStmt.bodyCount, true, &scan);
+        if (scan.straight && scan.count > 0) {
+            count = scan.count;
+            stats.prechecks_emitted++;
+            logger_log(LOG_DEBUG, "Bounds: %d accesses in the loop over '%s' checked before it",
+                       frame->hoisted_count, frame->iterator);
+        } else {
+            frame->hoisted_count = 0;
+        }
+    }
+    hashmap_free(effects.writes, NULL);
+    return count;
+}
+
+void bounds_exit_loop(void) {
+    if (unframedDepth > 0) {
+        unframedDepth--;
+    } else if (frameCount > 0) {
+        frameCount--;
+        free(frames[frameCount].hoisted);
+        frames[frameCount].hoisted = NULL;
+    }
+}
+
+bool bounds_access_needs_check(const AstNode* access, const char* array, AstNode* index) {
+    if (mode != BOUNDS_CHECKED) return false;
+
+    for (int i = frameCount - 1; i >= 0; i--) {
+        for (int j = 0; j < frames[i].hoisted_count; j++) {
+            if (frames[i].hoisted[j] == access) {
+                stats.checks_hoisted++;
+                return false;
+            }
+        }
+    }
+    if (index_proven(array, index)) {
+        stats.checks_removed++;
+        return false;
+    }
+    stats.checks_emitted++;
+    return true;
+}
@@ -0,0 +1,132 @@
+/**
+ * @file bounds.h
+ * @brief Array bounds-check elimination for the Lyn compiler
+ *
+ * In checked builds every array access verifies its index against the
+ * length stored in front of the elements. Most of those checks are proven
+ * unnecessary by a range analysis run while the code is generated:
+ * - An index that is the iterator of an enclosing range loop starting at a
+ *   non-negative constant and ending at the length of the array (or at a
+ *   constant no larger than its known length) is always in bounds
+ * - A constant index is in bounds when the array has a known length: every
+ *   assignment to it is an array literal with that many elements
+ *
+ * In a range loop whose body always runs to completion, the remaining
+ * checks on accesses `a[i + c]` are replaced with a single check of the
+ * whole index span before the loop. If that check fails the loop would have
+ * failed anyway, and nothing it did could have been observed.
+ */
+
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include <stdbool.h>
+#include "ast.h"
+
+/** Most arrays checked before a single loop */
+#define BOUNDS_MAX_PRECHECKS 8
+
+/**
+ * @brief How array accesses are compiled
+ */
+typedef enum {
+    BOUNDS_CHECKED,    ///< Accesses that cannot be proven in bounds are checked (default)
+    BOUNDS_UNCHECKED   ///< No checks at all (--unchecked)
+} BoundsMode;
+
+/**
+ * @brief Gives the C type of a variable declared before the loop
+ *
+ * @param name Variable name
+ * @return const char* C type, or NULL if the variable is not declared yet
+ */
+typedef const char* (*BoundsTypeFn)(const char* name);
+
+/**
+ * @brief Span of indices one loop reads or writes in one array
+ *
+ * The loop accesses elements iterator + min_offset to iterator + max_offset
+ * in every iteration.
+ */
+typedef struct {
+    char array[64];            ///< Array variable
+    long long min_offset;      ///< Smallest constant added to the iterator
+    long long max_offset;      ///< Largest constant added to the iterator
+} BoundsPrecheck;
+
+/**
+ * @brief Statistics about bounds checks
+ */
+typedef struct {
+    int checks_emitted;        ///< Accesses compiled with a check
+    int checks_removed;        ///< Accesses proven in bounds
+    int checks_hoisted;        ///< Accesses covered by a check before their loop
+    int prechecks_emitted;     ///< Loops given a check before them
+} BoundsStats;
+
+/**
+ * @brief Sets how array accesses are compiled
+ *
+ * @param mode BOUNDS_CHECKED or BOUNDS_UNCHECKED
+ */
+void bounds_set_mode(BoundsMode mode);
+
+/**
+ * @brief Gets how array accesses are compiled
+ *
+ * @return BoundsMode Current mode
+ */
+BoundsMode bounds_get_mode(void);
+
+/**
+ * @brief Prepares the analysis of a program
+ *
+ * Finds the arrays with a known length and the arrays some function may
+ * reassign behind a call.
+ *
+ * @param program AST_PROGRAM node
+ */
+void bounds_begin_program(AstNode* program);
+
+/**
+ * @brief Enters a range loop whose body is about to be compiled
+ *
+ * Works out what the loop proves about its iterator and which accesses of
+ * its body can be checked once before it. Every call must be matched by
+ * bounds_exit_loop() once the body has been compiled.
+ *
+ * @param loop AST_FOR_STMT range loop
+ * @param variableType Types of the variables declared before the loop
+ * @param prechecks Output: spans to check before the loop (BOUNDS_MAX_PRECHECKS entries)
+ * @return int Number of spans to check, 0 if the accesses are checked where they are
+ */
+int bounds_enter_loop(AstNode* loop, BoundsTypeFn variableType, BoundsPrecheck* prechecks);
+
+/**
+ * @brief Leaves the innermost range loop entered
+ */
+void bounds_exit_loop(void);
+
+/**
+ * @brief Decides whether an array access needs a check
+ *
+ * @param access AST_ARRAY_ACCESS or AST_ARRAY_ASSIGN node
+ * @param array Array variable
+ * @param index Index expression
+ * @return bool true if the access must be checked where it is
+ */
+bool bounds_access_needs_check(const AstNode* access, const char* array, AstNode* index);
+
+/**
+ * @brief Gets the bounds-check statistics
+ *
+ * @return BoundsStats Current statistics
+ */
+BoundsStats bounds_get_stats(void);
+
+/**
+ * @brief Releases the tables built for the last program
+ */
+void bounds_cleanup(void);
+
+#endif /* BOUNDS_H */
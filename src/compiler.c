@@ -20,6 +20,13 @@
 #include "types.h"
 #include "logger.h"  
 #include "module.h"  // Incluido para el sistema de módulos
+#include "ir.h"         // Para emitir el cuerpo del programa desde el IR en SSA
+#include "treeshake.h"  // Para descartar funciones y miembros de módulo inalcanzables
+#include "profile.h"    // Para instrumentar el programa y aplicar perfiles de ejecución
+#include "vectorize.h"  // Para marcar los bucles vectorizables y el informe de vectorización
+#include "bounds.h"     // Para eliminar las comprobaciones de límites demostradas innecesarias
+#include "remarks.h"    // Para informar de las decisiones de vectorización y de límites
+#include "dispatch.h"   // Para elegir cómo se despachan los switch y match
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -65,6 +72,10 @@ static VariableInfo variables[MAX_VARIABLES];  // Table of variables
 static int variableCount = 0;             // Number of variables in the table
 static int debug_level = 0;               // Debug level for compiler
 static bool moduleLoaded = false;         // Flag for module system initialization
+static bool useIr = false;                // Lower the program body to the SSA IR when possible
+static int coldLabelCount = 0;            // Labels that mark catch blocks as cold code
+static int dispatchCount = 0;             // Switches and matches lowered, to name their temporaries
+static AstNode* programNode = NULL;       // Program being compiled, whose functions type the calls
 
 // Compiler statistics
 static CompilerStats stats = {0};
@@ -79,6 +90,8 @@ static void compileFunction(AstNode* node);
 static void compileFuncCall(AstNode* node);
 static void compileMemberAccess(AstNode* node);
 static void compilePrintStmt(AstNode* node);
+static void compileConcatParts(AstNode** parts, int count);
+static void compileConcatExpr(AstNode* node);
 static void compileIf(AstNode* node);
 static void compileFor(AstNode* node);
 static void compileLambda(AstNode* node);
@@ -86,25 +99,24 @@ static void compileClass(AstNode* node);
 static void compileStringLiteral(AstNode* node);
 static void compileWhile(AstNode* node);
 static void compileDoWhile(AstNode* node);
+static void compileDispatch(AstNode* node);
 static void compileImport(AstNode* node);
 static void emitConstants(void);
 static void generatePreamble(void);
+static void emitProfileCounter(ProfileSite site, AstNode* node);
 static const char* inferType(AstNode* node);
 static void compileNode(AstNode* node);
 
 /* Forward declarations for type checking helper functions */
 static bool isIntegerType(const char* type);
 static bool isFloatType(const char* type);
+static bool isNumericType(const char* type);
 static bool isStringType(const char* type);
 static bool isBooleanType(const char* type);
 static bool isPointerType(const char* type);
 static bool isObjectType(const char* type);
 static bool areTypesCompatible(const char* targetType, const char* sourceType);
 
-// Add forward declarations for string helper functions
-static const char* to_string(double value);
-static char* concat_any(const char* s1, const char* s2);
-
 /**
  * @brief Sets the debug level for the compiler
  * 
@@ -115,6 +127,16 @@ void compiler_set_debug_level(int level) {
     logger_log(LOG_INFO, "Compiler debug level set to %d", level);
 }
 
+/**
+ * @brief Enables or disables emitting the program body through the SSA IR
+ * 
+ * @param enabled true to lower the program body to the IR when possible
+ */
+void compiler_set_use_ir(bool enabled) {
+    useIr = enabled;
+    logger_log(LOG_INFO, "Compiler IR path %s", enabled ? "enabled" : "disabled");
+}
+
 /**
  * @brief Gets the current compiler statistics
  * 
@@ -135,6 +157,22 @@ static const char* getCTypeString(Type* type) {
     return type ? type->typeName : "void*";
 }
 
+/**
+ * @brief Maps a declared Lyn type name to the C type used for it
+ * 
+ * Lyn integers are int64_t, floats are doubles and strings are C strings;
+ * other names (C types and classes) are used unchanged.
+ * 
+ * @param name Type name from a signature
+ * @return const char* C type
+ */
+static const char* lynTypeToC(const char* name) {
+    if (strcmp(name, "int") == 0) return "int64_t";
+    if (strcmp(name, "float") == 0) return "double";
+    if (strcmp(name, "string") == 0) return "const char*";
+    return name;
+}
+
 /**
  * @brief Emits constant definitions needed by the generated code
  */
@@ -160,33 +198,154 @@ static void generatePreamble(void) {
     emitLine("#include <string.h>");   // For strcmp, etc.
     emitLine("#include <math.h>");     // For sqrt, etc.
     emitLine("#include <setjmp.h>");   // For try/catch with setjmp/longjmp
+    emitLine("#include <stdarg.h>");   // For concat_n
+    emitLine("#include <stdint.h>");   // For int64_t, the type of Lyn integers
     emitLine("");
     emitConstants();
+    profile_emit_declarations(outputFile);
     
-    // Insert helper function definitions for string concatenation
-    emitLine("static inline const char* to_string(double value) {");
+    // String concatenation: numbers are formatted once, the result is allocated once;
+    // integers ('d') are written exactly, floats ('g') with %g
+    emitLine("static inline char* concat_n(const char* kinds, ...) {");
+    indent();
+    emitLine("size_t count = strlen(kinds), total = 0;");
+    emitLine("const char* parts[count];");
+    emitLine("size_t lengths[count];");
+    emitLine("char numbers[count][32];");
+    emitLine("va_list args;");
+    emitLine("va_start(args, kinds);");
+    emitLine("for (size_t i = 0; i < count; i++) {");
+    indent();
+    emitLine("if (kinds[i] == 's') {");
+    indent();
+    emitLine("parts[i] = va_arg(args, const char*);");
+    emitLine("if (!parts[i]) { va_end(args); return NULL; }");
+    emitLine("lengths[i] = strlen(parts[i]);");
+    outdent();
+    emitLine("} else if (kinds[i] == 'd') {");
     indent();
-    emitLine("static char buf[64];");
-    emitLine("snprintf(buf, sizeof(buf), \"%%g\", value);");
-    emitLine("return buf;");
+    emitLine("lengths[i] = snprintf(numbers[i], sizeof(numbers[i]), \"%%lld\", va_arg(args, long long));");
+    emitLine("parts[i] = numbers[i];");
+    outdent();
+    emitLine("} else {");
+    indent();
+    emitLine("lengths[i] = snprintf(numbers[i], sizeof(numbers[i]), \"%%g\", va_arg(args, double));");
+    emitLine("parts[i] = numbers[i];");
+    outdent();
+    emitLine("}");
+    emitLine("total += lengths[i];");
+    outdent();
+    emitLine("}");
+    emitLine("va_end(args);");
+    emitLine("char* result = (char*)malloc(total + 1);");
+    emitLine("if (!result) return NULL;");
+    emitLine("char* cursor = result;");
+    emitLine("for (size_t i = 0; i < count; i++) {");
+    indent();
+    emitLine("memcpy(cursor, parts[i], lengths[i]);");
+    emitLine("cursor += lengths[i];");
+    outdent();
+    emitLine("}");
+    emitLine("*cursor = '\\0';");
+    emitLine("return result;");
     outdent();
     emitLine("}");
-    emitLine("");
     
-    emitLine("static inline char* concat_any(const char* s1, const char* s2) {");
+    // Arrays: the element count sits just before the elements, which start aligned
+    // so that vectorized loops can use aligned loads and stores
+    emitLine("static inline void* lyn_array_new(size_t count, size_t size, const void* init) {");
     indent();
-    emitLine("if (!s1 || !s2) return NULL;");
-    emitLine("int len = strlen(s1) + strlen(s2) + 1;");
-    emitLine("char* result = (char*)malloc(len);");
-    emitLine("if (result) {");
+    emitLine("size_t bytes = (count * size + %d) / %d * %d;", VECTORIZE_ALIGNMENT - 1, VECTORIZE_ALIGNMENT, VECTORIZE_ALIGNMENT);
+    emitLine("char* block = (char*)aligned_alloc(%d, %d + bytes);", VECTORIZE_ALIGNMENT, VECTORIZE_ALIGNMENT);
+    emitLine("if (!block) return NULL;");
+    emitLine("((long long*)(block + %d))[-1] = (long long)count;", VECTORIZE_ALIGNMENT);
+    emitLine("if (count) memcpy(block + %d, init, count * size);", VECTORIZE_ALIGNMENT);
+    emitLine("return block + %d;", VECTORIZE_ALIGNMENT);
+    outdent();
+    emitLine("}");
+    emitLine("static inline int lyn_array_length(const void* array) {");
     indent();
-    emitLine("strcpy(result, s1);");
-    emitLine("strcat(result, s2);");
+    emitLine("return array ? (int)((const long long*)array)[-1] : 0;");
     outdent();
     emitLine("}");
-    emitLine("return result;");
+    
+    // Bounds checks: the failure path is cold so the check itself stays a compare and a branch
+    emitLine("__attribute__((cold, noreturn)) static void lyn_index_error(long long index, int length, int line) {");
+    indent();
+    emitLine("fprintf(stderr, \"Runtime error: index %%lld out of bounds for array of length %%d (line %%d)\\n\", index, length, line);");
+    emitLine("exit(1);");
     outdent();
     emitLine("}");
+    emitLine("static inline int64_t lyn_check_index(int64_t index, int length, int line) {");
+    indent();
+    emitLine("if (__builtin_expect((uint64_t)index >= (uint64_t)length, 0)) lyn_index_error(index, length, line);");
+    emitLine("return index;");
+    outdent();
+    emitLine("}");
+    emitLine("static inline void lyn_check_span(long long first, long long last, int length, int line) {");
+    indent();
+    emitLine("if (__builtin_expect(first < 0, 0)) lyn_index_error(first, length, line);");
+    emitLine("if (__builtin_expect(last >= length, 0)) lyn_index_error(last, length, line);");
+    outdent();
+    emitLine("}");
+    
+    // Integer division truncates toward zero and the remainder takes the sign of the
+    // dividend, as in C; a zero divisor, or the one quotient that overflows, is an error
+    emitLine("__attribute__((cold, noreturn)) static void lyn_division_error(long long divisor, int line) {");
+    indent();
+    emitLine("fprintf(stderr, \"Runtime error: %%s in integer division (line %%d)\\n\", divisor == 0 ? \"division by zero\" : \"overflow\", line);");
+    emitLine("exit(1);");
+    outdent();
+    emitLine("}");
+    emitLine("static inline int64_t lyn_div(int64_t a, int64_t b, int line) {");
+    indent();
+    emitLine("if (__builtin_expect(b == 0 || (b == -1 && a == INT64_MIN), 0)) lyn_division_error(b, line);");
+    emitLine("return a / b;");
+    outdent();
+    emitLine("}");
+    emitLine("static inline int64_t lyn_mod(int64_t a, int64_t b, int line) {");
+    indent();
+    emitLine("if (__builtin_expect(b == 0, 0)) lyn_division_error(b, line);");
+    emitLine("return b == -1 ? 0 : a %% b;");
+    outdent();
+    emitLine("}");
+
+    // Switch sobre cadenas: hash perfecto calculado al compilar (dispatch_string_hash y
+    // dispatch_slot) y una sola comparación con la etiqueta de la ranura elegida
+    emitLine("static inline int lyn_string_slot(const char* s, const char* const* labels, const int32_t* displacements, uint32_t size) {");
+    indent();
+    emitLine("if (!s) return -1;");
+    emitLine("uint32_t h = 2166136261u;");
+    emitLine("for (const unsigned char* c = (const unsigned char*)s; *c; c++) { h ^= *c; h *= 16777619u; }");
+    emitLine("int32_t d = displacements[h %% size];");
+    emitLine("uint32_t slot;");
+    emitLine("if (d < 0) {");
+    indent();
+    emitLine("slot = (uint32_t)(-(d + 1));");
+    outdent();
+    emitLine("} else {");
+    indent();
+    emitLine("uint32_t x = h ^ ((uint32_t)d * 0x85EBCA6Bu);");
+    emitLine("x ^= x >> 16; x *= 0x7FEB352Du; x ^= x >> 15; x *= 0x846CA68Bu; x ^= x >> 16;");
+    emitLine("slot = x %% size;");
+    outdent();
+    emitLine("}");
+    emitLine("return strcmp(s, labels[slot]) == 0 ? (int)slot : -1;");
+    outdent();
+    emitLine("}");
+}
+
+/**
+ * @brief Emits the increment of a profile counter (--profile-generate only)
+ * 
+ * @param site Kind of program point
+ * @param node Function definition or statement the counter belongs to
+ */
+static void emitProfileCounter(ProfileSite site, AstNode* node) {
+    int counter = profile_counter(site, node);
+    if (counter >= 0) {
+        emitLine("__lyn_prof_counts[%d]++;", counter);
+    }
 }
 
 /**
@@ -257,6 +416,292 @@ static const char* getVariableType(const char* name) {
     return "double";  // Tipo por defecto
 }
 
+/**
+ * @brief Gives the IR lowering the C type of a variable already declared in main
+ * 
+ * @param name Variable name
+ * @return const char* C type, or NULL if the variable has not been declared
+ */
+static const char* irVariableType(const char* name) {
+    return isVariableDeclared(name) ? getVariableType(name) : NULL;
+}
+
+/**
+ * @brief Gives the C type a call to a function of the program returns
+ * 
+ * Calls to functions defined once at the top level with an int, float,
+ * bool or string result have that type; other calls are taken as doubles.
+ * 
+ * @param name Called function
+ * @return const char* C type, or NULL if the call is not typed
+ */
+static const char* callReturnType(const char* name) {
+    const char* type = NULL;
+    int definitions = 0;
+    for (int i = 0; programNode && i < programNode->program.statementCount; i++) {
+        AstNode* stmt = programNode->program.statements[i];
+        if (stmt && stmt->type == AST_FUNC_DEF && strcmp(stmt->funcDef.name, name) == 0) {
+            type = stmt->funcDef.returnType;
+            definitions++;
+        }
+    }
+    if (definitions != 1) return NULL;
+    if (strcmp(type, "int") == 0 || strcmp(type, "float") == 0 || strcmp(type, "double") == 0 ||
+        strcmp(type, "bool") == 0 || strcmp(type, "string") == 0) {
+        return lynTypeToC(type);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Checks whether a number literal is a Lyn integer
+ * 
+ * Integral literals are int64_t, except those written with a decimal point
+ * and those the optimizer marked as doubles: values computed at compile
+ * time keep the double type of the expression they replace.
+ * 
+ * @param node AST_NUMBER_LITERAL node
+ * @return bool true if the literal is an integer
+ */
+static bool isIntLiteral(AstNode* node) {
+    return isIntegerLiteral(node);
+}
+
+/**
+ * @brief Formats a number literal that is not compiled as an int
+ * 
+ * Marked literals are written with the shortest precision that reads back
+ * as the same value, and always as doubles in C ("55.0", not "55").
+ * 
+ * @param node AST_NUMBER_LITERAL node
+ * @param buffer Output buffer
+ * @param size Size of the output buffer
+ * @return const char* @p buffer
+ */
+static const char* formatDoubleLiteral(AstNode* node, char* buffer, size_t size) {
+    if (!node->numberLiteral.isDouble) {
+        snprintf(buffer, size, "%g", node->numberLiteral.value);
+        return buffer;
+    }
+    // La forma más corta que vuelve a leerse como el mismo double
+    for (int precision = 15; precision <= 17; precision++) {
+        snprintf(buffer, size, "%.*g", precision, node->numberLiteral.value);
+        if (strtod(buffer, NULL) == node->numberLiteral.value) break;
+    }
+    if (!strpbrk(buffer, ".en") && strlen(buffer) + 2 < size) {
+        strcat(buffer, ".0");
+    }
+    return buffer;
+}
+
+/**
+ * @brief Checks whether an expression is a string concatenation
+ * 
+ * '+' is a concatenation when one of its operands is a string: a literal,
+ * a string variable or another concatenation, so `"a" + 1 + 2` concatenates
+ * all three parts.
+ * 
+ * @param node Expression to check
+ * @return bool true if the expression produces a newly concatenated string
+ */
+static bool isStringConcat(AstNode* node) {
+    if (!node) return false;
+    if (node->type == AST_CONCAT_EXPR) return true;
+    if (node->type != AST_BINARY_OP || node->binaryOp.op != '+') return false;
+    
+    AstNode* left = node->binaryOp.left;
+    AstNode* right = node->binaryOp.right;
+    return (left && isStringType(inferType(left))) ||
+           (right && isStringType(inferType(right)));
+}
+
+/**
+ * @brief Checks whether a binary operator computes a number from numbers
+ *
+ * Such an operator on two integers gives an integer; comparisons and
+ * logical operators do not.
+ */
+static bool isArithmeticOperator(char op) {
+    return op == '+' || op == '-' || op == '*' || op == '/' || op == '%';
+}
+
+/**
+ * @brief Checks whether a C type is the type of a Lyn array
+ */
+static bool isArrayType(const char* type) {
+    return type && (strcmp(type, "int64_t*") == 0 || strcmp(type, "double*") == 0 ||
+                    strcmp(type, "const char**") == 0);
+}
+
+/**
+ * @brief Gives the element type of a Lyn array type
+ * 
+ * @param arrayType "int64_t*", "double*" or "const char**"
+ * @return const char* Element type, or NULL if arrayType is not an array type
+ */
+static const char* arrayElementOf(const char* arrayType) {
+    if (!isArrayType(arrayType)) return NULL;
+    if (strcmp(arrayType, "int64_t*") == 0) return "int64_t";
+    if (strcmp(arrayType, "double*") == 0) return "double";
+    return "const char*";
+}
+
+/**
+ * @brief Chooses the element type of an array literal
+ * 
+ * @param literal AST_ARRAY_LITERAL node
+ * @return const char* "int64_t", "double" or "const char*", or NULL for an empty
+ *         literal or one mixing strings and numbers
+ */
+static const char* arrayLiteralElementType(AstNode* literal) {
+    int ints = 0, numbers = 0, strings = 0;
+    int count = literal->arrayLiteral.elementCount;
+    for (int i = 0; i < count; i++) {
+        const char* type = inferType(literal->arrayLiteral.elements[i]);
+        if (isIntegerType(type)) ints++;
+        else if (isNumericType(type)) numbers++;
+        else if (isStringType(type)) strings++;
+    }
+    if (count == 0) return NULL;
+    if (ints == count) return "int64_t";
+    if (ints + numbers == count) return "double";
+    if (strings == count) return "const char*";
+    return NULL;
+}
+
+/**
+ * @brief Checks whether a member access reads the length of an array variable
+ */
+static bool isArrayLength(AstNode* node) {
+    AstNode* object = node->memberAccess.object;
+    return strcmp(node->memberAccess.member, "length") == 0 &&
+           object && object->type == AST_IDENTIFIER &&
+           isVariableDeclared(object->identifier.name) &&
+           isArrayType(getVariableType(object->identifier.name));
+}
+
+/**
+ * @brief Checks whether an expression has type int in the generated C
+ *
+ * Lyn integers are int64_t, but small integer literals, comparisons, array
+ * lengths and the int fields of the built-in classes are C ints; arithmetic
+ * between two of them must be widened first.
+ */
+static bool isCIntExpression(AstNode* node) {
+    if (!node) return false;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return isIntLiteral(node) && node->numberLiteral.value >= -2147483648.0 &&
+                   node->numberLiteral.value <= 2147483647.0;
+        case AST_BINARY_OP:
+            return !isArithmeticOperator(node->binaryOp.op) && !isStringConcat(node);
+        case AST_UNARY_OP:
+            return node->unaryOp.op == 'N' || isCIntExpression(node->unaryOp.expr);
+        case AST_MEMBER_ACCESS:
+            return strcmp(inferType(node), "int") == 0 || isArrayLength(node);
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Checks whether an integer division by this divisor can never fail
+ *
+ * Only literal divisors other than 0 and -1 qualify; any other divisor is
+ * checked at run time by lyn_div() and lyn_mod().
+ */
+static bool isSafeDivisor(AstNode* divisor) {
+    return divisor && isIntLiteral(divisor) && divisor->numberLiteral.value != 0 &&
+           divisor->numberLiteral.value != -1;
+}
+
+/**
+ * @brief Restrict-qualified aliases of the arrays of the vector loop being compiled
+ */
+static const VectorizeLoop* vectorLoop = NULL;
+
+/**
+ * @brief Gives the name an array is accessed by in the current loop body
+ * 
+ * @param name Array variable
+ * @return const char* Its restrict alias inside a vector loop, else the name itself
+ */
+static const char* arrayAccessName(const char* name) {
+    static char alias[128];
+    if (vectorLoop) {
+        for (int i = 0; i < vectorLoop->array_count; i++) {
+            if (strcmp(vectorLoop->arrays[i], name) == 0) {
+                snprintf(alias, sizeof(alias), "__lyn_v%d_%s", vectorLoop->id, name);
+                return alias;
+            }
+        }
+    }
+    return name;
+}
+
+/**
+ * @brief Source line of the statement being compiled, reported by failed bounds checks
+ */
+static int statementLine = 0;
+
+/**
+ * @brief Emits the index of an array access, checked unless proven in bounds
+ * 
+ * @param access AST_ARRAY_ACCESS or AST_ARRAY_ASSIGN node
+ * @param array Array variable, or NULL if the array is not a plain variable
+ * @param index Index expression
+ */
+static void compileArrayIndex(const AstNode* access, const char* array, AstNode* index) {
+    // Los índices float se truncan; C necesita un entero
+    bool intIndex = isIntegerType(inferType(index));
+    bool checked = array && isVariableDeclared(array) && isArrayType(getVariableType(array)) &&
+                   bounds_access_needs_check(access, array, index);
+    emit(checked ? "[lyn_check_index(" : "[");
+    emit(intIndex ? "" : "(int64_t)(");
+    compileExpression(index);
+    emit(intIndex ? "" : ")");
+    if (checked) {
+        emit(", lyn_array_length(%s), %d)", arrayAccessName(array), statementLine);
+        remarks_emit(REMARK_MISSED, "bounds", access, "bounds check kept: index into '%s' not proven in range", array);
+    } else if (array && bounds_get_mode() == BOUNDS_CHECKED) {
+        remarks_emit(REMARK_APPLIED, "bounds", access, "bounds check on '%s' removed", array);
+    }
+    emit("]");
+}
+
+/**
+ * @brief Emits the checks a range loop makes once before it runs
+ * 
+ * Each span covers every index the loop uses in one array: from the range
+ * start plus the smallest offset to the last iterator value plus the largest.
+ * 
+ * @param node AST_FOR_STMT range loop
+ * @param prechecks Spans from bounds_enter_loop()
+ * @param count Number of spans
+ */
+static void emitBoundsPrechecks(AstNode* node, const BoundsPrecheck* prechecks, int count) {
+    if (count <= 0) return;
+    emitLine("// Bounds of every index the loop uses, checked once before it");
+    emit("if (");
+    compileExpression(node->forStmt.rangeStart);
+    emit(" < ");
+    compileExpression(node->forStmt.rangeEnd);
+    emitLine(") {");
+    indent();
+    for (int i = 0; i < count; i++) {
+        emit("lyn_check_span((long long)(");
+        compileExpression(node->forStmt.rangeStart);
+        emit(") + %lld, (long long)(", prechecks[i].min_offset);
+        compileExpression(node->forStmt.rangeEnd);
+        emitLine(") + %lld, lyn_array_length(%s), %d);", prechecks[i].max_offset - 1, prechecks[i].array,
+                 statementLine);
+        remarks_emit(REMARK_APPLIED, "bounds", node, "bounds checks on '%s' hoisted before the loop",
+                     prechecks[i].array);
+    }
+    outdent();
+    emitLine("}");
+}
+
 static void declareObjectVariable(const char* name, const char* objType) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)declareObjectVariable);
     
@@ -281,13 +726,498 @@ static void declareObjectVariable(const char* name, const char* objType) {
     }
 }
 
+/**
+ * @brief Layout of a class whose struct, constructor and methods live in the preamble
+ */
+typedef struct {
+    const char* name;                  ///< Struct name (also the new_X/X_method prefix)
+    const char* fields[4];             ///< Field names in declaration order
+    const char* fieldTypes[4];         ///< C type of each field
+    const char* defaults[4];           ///< Value new_X() stores in each field
+    int fieldCount;                    ///< Number of fields
+} BuiltinClass;
+
+static const BuiltinClass builtinClasses[] = {
+    {"Point",   {"x", "y"},                   {"double", "double"},                     {"0.0", "0.0"},             2},
+    {"Vector3", {"x", "y", "z"},              {"double", "double", "double"},           {"0.0", "0.0", "0.0"},      3},
+    {"Shape",   {"type", "x", "y"},           {"int", "double", "double"},              {"0", "0.0", "0.0"},        3},
+    {"Circle",  {"type", "x", "y", "radius"}, {"int", "double", "double", "double"},    {"1", "0.0", "0.0", "0.0"}, 4},
+};
+
+static const BuiltinClass* findBuiltinClass(const char* name) {
+    for (size_t i = 0; i < sizeof(builtinClasses) / sizeof(builtinClasses[0]); i++) {
+        if (strcmp(builtinClasses[i].name, name) == 0) return &builtinClasses[i];
+    }
+    return NULL;
+}
+
+static int findBuiltinField(const BuiltinClass* cls, const char* field) {
+    for (int i = 0; i < cls->fieldCount; i++) {
+        if (strcmp(cls->fields[i], field) == 0) return i;
+    }
+    return -1;
+}
+
 static bool isObjectConstructor(const char* name) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)isObjectConstructor);
-    
-    return (strcmp(name, "new_Point") == 0 || 
-            strcmp(name, "new_Vector3") == 0 || 
-            strcmp(name, "new_Circle") == 0 ||
-            strcmp(name, "new_Shape") == 0);
+
+    return strncmp(name, "new_", 4) == 0 && findBuiltinClass(name + 4) != NULL;
+}
+
+/**
+ * @brief Gets the built-in class of a variable holding an object pointer
+ *
+ * @param name Variable name
+ * @return const BuiltinClass* Class of the variable, or NULL if it is not an object
+ */
+static const BuiltinClass* objectVariableClass(const char* name) {
+    for (int i = 0; i < variableCount; i++) {
+        if (strcmp(variables[i].name, name) == 0) {
+            char className[64];
+            strncpy(className, variables[i].type, sizeof(className) - 1);
+            className[sizeof(className) - 1] = '\0';
+            char* star = strchr(className, '*');
+            if (!star) return NULL;
+            *star = '\0';
+            return findBuiltinClass(className);
+        }
+    }
+    return NULL;
+}
+
+// ===================================================================
+// Análisis de escape de objetos
+// ===================================================================
+
+/**
+ * @brief Storage chosen for an object allocated in the body being compiled
+ */
+typedef enum {
+    OBJECT_HEAP,        ///< new_X(): the object escapes or its uses are not understood
+    OBJECT_STACK,       ///< Local struct; class methods receive its address
+    OBJECT_SCALAR       ///< One local per field; the struct never exists
+} ObjectStorage;
+
+/**
+ * @brief Escape facts about a variable that receives a new object
+ */
+typedef struct {
+    char name[256];                 ///< Variable holding the object
+    const BuiltinClass* cls;        ///< Class of the object
+    int sites;                      ///< Allocations assigned to the variable
+    bool escapes;                   ///< Returned, copied, captured, passed to user code...
+    bool addressTaken;              ///< Passed to a class method
+    ObjectStorage storage;          ///< Decision once the body has been analyzed
+} ObjectAllocation;
+
+#define MAX_OBJECT_ALLOCATIONS 64
+
+/**
+ * @brief Escape decisions of one function body
+ */
+typedef struct {
+    ObjectAllocation entries[MAX_OBJECT_ALLOCATIONS];
+    int count;
+} ObjectAllocationTable;
+
+static ObjectAllocationTable objectAllocations = {0};  // Decisiones del cuerpo que se está compilando
+
+/**
+ * @brief Gets the built-in class an allocation expression creates
+ *
+ * Both `new X()` and the `new_X()` constructor call are allocations; the
+ * built-in constructors take no arguments.
+ *
+ * @param expr Expression to inspect
+ * @return const BuiltinClass* Allocated class, or NULL if expr is not an allocation
+ */
+static const BuiltinClass* allocatedClass(AstNode* expr) {
+    if (!expr) return NULL;
+    if (expr->type == AST_NEW_EXPR && expr->newExpr.argCount == 0) {
+        return findBuiltinClass(expr->newExpr.className);
+    }
+    if (expr->type == AST_FUNC_CALL && expr->funcCall.argCount == 0 && isObjectConstructor(expr->funcCall.name)) {
+        return findBuiltinClass(expr->funcCall.name + 4);
+    }
+    return NULL;
+}
+
+static ObjectAllocation* findObjectAllocation(const char* name) {
+    for (int i = 0; i < objectAllocations.count; i++) {
+        if (strcmp(objectAllocations.entries[i].name, name) == 0) return &objectAllocations.entries[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Records every variable assigned an allocation in a body
+ *
+ * Nested functions and lambdas are skipped: they are analyzed when they are
+ * compiled, and their own allocations cannot live in the enclosing frame.
+ */
+static void collectObjectAllocations(AstNode* node) {
+    if (!node || node->type == AST_FUNC_DEF || node->type == AST_LAMBDA) return;
+
+    const BuiltinClass* cls = NULL;
+    if (node->type == AST_VAR_ASSIGN && (cls = allocatedClass(node->varAssign.initializer))) {
+        ObjectAllocation* entry = findObjectAllocation(node->varAssign.name);
+        if (entry) {
+            entry->sites++;
+            if (entry->cls != cls) entry->escapes = true;
+        } else if (objectAllocations.count < MAX_OBJECT_ALLOCATIONS) {
+            entry = &objectAllocations.entries[objectAllocations.count++];
+            memset(entry, 0, sizeof(*entry));
+            strncpy(entry->name, node->varAssign.name, sizeof(entry->name) - 1);
+            entry->cls = cls;
+            entry->sites = 1;
+        }
+    }
+
+    switch (node->type) {
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) collectObjectAllocations(node->block.statements[i]);
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++) collectObjectAllocations(node->ifStmt.thenBranch[i]);
+            for (int i = 0; i < node->ifStmt.elseCount; i++) collectObjectAllocations(node->ifStmt.elseBranch[i]);
+            break;
+        case AST_FOR_STMT:
+            for (int i = 0; i < node->forStmt.bodyCount; i++) collectObjectAllocations(node->forStmt.body[i]);
+            break;
+        case AST_WHILE_STMT:
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) collectObjectAllocations(node->whileStmt.body[i]);
+            break;
+        case AST_DO_WHILE_STMT:
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) collectObjectAllocations(node->doWhileStmt.body[i]);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Marks a use of a field of an object variable
+ *
+ * @param name Variable name
+ * @param field Field read or written
+ * @param nested true inside a nested function or lambda
+ * @return bool true if the variable is a tracked allocation
+ */
+static bool noteFieldUse(const char* name, const char* field, bool nested) {
+    ObjectAllocation* entry = findObjectAllocation(name);
+    if (!entry) return false;
+    if (nested || findBuiltinField(entry->cls, field) < 0) entry->escapes = true;
+    return true;
+}
+
+/**
+ * @brief Checks whether a call targets a method of a built-in class
+ *
+ * The preamble methods only read and write through their object arguments
+ * and never keep them, so passing an object to one takes its address
+ * without letting it escape.
+ */
+static bool isBuiltinMethodCall(AstNode* call) {
+    const char* name = call->funcCall.name;
+    const char* dot = strchr(name, '.');
+    char prefix[256];
+    size_t length = dot ? (size_t)(dot - name) : 0;
+    if (!dot) {
+        const char* underscore = strchr(name, '_');
+        if (!underscore) return false;
+        length = (size_t)(underscore - name);
+    }
+    if (length == 0 || length >= sizeof(prefix)) return false;
+    memcpy(prefix, name, length);
+    prefix[length] = '\0';
+    if (findBuiltinClass(prefix)) return true;
+
+    // obj.method(...): the receiver is the first argument
+    if (dot && call->funcCall.argCount > 0 && call->funcCall.arguments[0] &&
+        call->funcCall.arguments[0]->type == AST_IDENTIFIER &&
+        strcmp(call->funcCall.arguments[0]->identifier.name, prefix) == 0) {
+        ObjectAllocation* entry = findObjectAllocation(prefix);
+        return (entry && entry->cls) || objectVariableClass(prefix) != NULL;
+    }
+    return false;
+}
+
+static void analyzeObjectEscapes(AstNode* node, bool nested, bool* opaque);
+
+/**
+ * @brief Analyzes a statement list
+ *
+ * `var x = ...` leaves a bare identifier statement in front of the
+ * assignment; it evaluates nothing, so it is not a use of the variable.
+ */
+static void analyzeObjectStatements(AstNode** statements, int count, bool nested, bool* opaque) {
+    for (int i = 0; statements && i < count; i++) {
+        if (statements[i] && statements[i]->type == AST_IDENTIFIER) continue;
+        analyzeObjectEscapes(statements[i], nested, opaque);
+    }
+}
+
+/**
+ * @brief Walks a body marking how each tracked object is used
+ *
+ * An object escapes when its variable appears anywhere except as the
+ * object of a field access, the target of a field assignment, its own
+ * allocation or an argument of a built-in class method. Uses inside nested
+ * functions and lambdas always escape, since they may outlive the frame.
+ *
+ * @param node Node to analyze
+ * @param nested true inside a nested function or lambda
+ * @param opaque Set when the body contains a node the walk cannot see through
+ */
+static void analyzeObjectEscapes(AstNode* node, bool nested, bool* opaque) {
+    if (!node) return;
+
+#define ESCAPE_VISIT(child) analyzeObjectEscapes((child), nested, opaque)
+#define ESCAPE_VISIT_LIST(list, count) \
+    do { for (int i_ = 0; (list) && i_ < (count); i_++) ESCAPE_VISIT((list)[i_]); } while (0)
+#define ESCAPE_STATEMENTS(list, count) analyzeObjectStatements((list), (count), nested, opaque)
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_THIS_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+        case AST_IMPORT:
+        case AST_CLASS_DEF:
+            break;
+        case AST_IDENTIFIER: {
+            ObjectAllocation* entry = findObjectAllocation(node->identifier.name);
+            if (entry) entry->escapes = true;
+            break;
+        }
+        case AST_MEMBER_ACCESS:
+            if (node->memberAccess.object && node->memberAccess.object->type == AST_IDENTIFIER &&
+                noteFieldUse(node->memberAccess.object->identifier.name, node->memberAccess.member, nested)) {
+                break;
+            }
+            ESCAPE_VISIT(node->memberAccess.object);
+            break;
+        case AST_VAR_ASSIGN: {
+            const char* dot = strchr(node->varAssign.name, '.');
+            if (dot) {
+                char base[256];
+                size_t length = (size_t)(dot - node->varAssign.name);
+                if (length < sizeof(base)) {
+                    memcpy(base, node->varAssign.name, length);
+                    base[length] = '\0';
+                    noteFieldUse(base, dot + 1, nested);
+                }
+                ESCAPE_VISIT(node->varAssign.initializer);
+                break;
+            }
+            ObjectAllocation* entry = findObjectAllocation(node->varAssign.name);
+            if (entry && (nested || !allocatedClass(node->varAssign.initializer))) {
+                entry->escapes = true;
+            }
+            ESCAPE_VISIT(node->varAssign.initializer);
+            break;
+        }
+        case AST_VAR_DECL: {
+            ObjectAllocation* entry = findObjectAllocation(node->varDecl.name);
+            if (entry) entry->escapes = true;
+            ESCAPE_VISIT(node->varDecl.initializer);
+            break;
+        }
+        case AST_ARRAY_ASSIGN: {
+            ObjectAllocation* entry = findObjectAllocation(node->arrayAssign.name);
+            if (entry) entry->escapes = true;
+            ESCAPE_VISIT(node->arrayAssign.index);
+            ESCAPE_VISIT(node->arrayAssign.value);
+            break;
+        }
+        case AST_FUNC_CALL:
+            if (isBuiltinMethodCall(node)) {
+                for (int i = 0; i < node->funcCall.argCount; i++) {
+                    AstNode* arg = node->funcCall.arguments[i];
+                    ObjectAllocation* entry = arg && arg->type == AST_IDENTIFIER ?
+                                              findObjectAllocation(arg->identifier.name) : NULL;
+                    if (entry && !nested) {
+                        entry->addressTaken = true;
+                    } else {
+                        ESCAPE_VISIT(arg);
+                    }
+                }
+                break;
+            }
+            ESCAPE_VISIT_LIST(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_FUNC_DEF:
+            ESCAPE_VISIT_LIST(node->funcDef.parameters, node->funcDef.paramCount);
+            analyzeObjectStatements(node->funcDef.body, node->funcDef.bodyCount, true, opaque);
+            break;
+        case AST_LAMBDA:
+            ESCAPE_VISIT_LIST(node->lambda.parameters, node->lambda.paramCount);
+            analyzeObjectEscapes(node->lambda.body, true, opaque);
+            break;
+        case AST_NEW_EXPR: ESCAPE_VISIT_LIST(node->newExpr.arguments, node->newExpr.argCount); break;
+        case AST_BLOCK: ESCAPE_STATEMENTS(node->block.statements, node->block.statementCount); break;
+        case AST_IF_STMT:
+            ESCAPE_VISIT(node->ifStmt.condition);
+            ESCAPE_STATEMENTS(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            ESCAPE_STATEMENTS(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            ESCAPE_VISIT(node->forStmt.rangeStart);
+            ESCAPE_VISIT(node->forStmt.rangeEnd);
+            ESCAPE_VISIT(node->forStmt.rangeStep);
+            ESCAPE_VISIT(node->forStmt.collection);
+            ESCAPE_VISIT(node->forStmt.init);
+            ESCAPE_VISIT(node->forStmt.condition);
+            ESCAPE_VISIT(node->forStmt.update);
+            ESCAPE_STATEMENTS(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            ESCAPE_VISIT(node->whileStmt.condition);
+            ESCAPE_STATEMENTS(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            ESCAPE_STATEMENTS(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            ESCAPE_VISIT(node->doWhileStmt.condition);
+            break;
+        case AST_RETURN_STMT: ESCAPE_VISIT(node->returnStmt.expr); break;
+        case AST_PRINT_STMT: ESCAPE_VISIT(node->printStmt.expr); break;
+        case AST_BINARY_OP:
+            ESCAPE_VISIT(node->binaryOp.left);
+            ESCAPE_VISIT(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP: ESCAPE_VISIT(node->unaryOp.expr); break;
+        case AST_ARRAY_ACCESS:
+            ESCAPE_VISIT(node->arrayAccess.array);
+            ESCAPE_VISIT(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL: ESCAPE_VISIT_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_CONCAT_EXPR: ESCAPE_VISIT_LIST(node->concatExpr.parts, node->concatExpr.partCount); break;
+        default:
+            // Nodos que este análisis no recorre: nada puede quedarse fuera del heap
+            *opaque = true;
+            break;
+    }
+#undef ESCAPE_STATEMENTS
+#undef ESCAPE_VISIT_LIST
+#undef ESCAPE_VISIT
+}
+
+/**
+ * @brief Decides where each object allocated in a function body lives
+ *
+ * Objects assigned once from a built-in constructor that never escape the
+ * body are scalar-replaced into one local per field; if class methods need
+ * their address they become a stack struct instead. Everything else keeps
+ * the heap allocation of new_X().
+ *
+ * @param body Statements of the body
+ * @param count Number of statements
+ */
+static void analyzeObjectAllocations(AstNode** body, int count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)analyzeObjectAllocations);
+
+    objectAllocations.count = 0;
+    for (int i = 0; i < count; i++) collectObjectAllocations(body[i]);
+    if (objectAllocations.count == 0) return;
+
+    bool opaque = false;
+    analyzeObjectStatements(body, count, false, &opaque);
+
+    for (int i = 0; i < objectAllocations.count; i++) {
+        ObjectAllocation* entry = &objectAllocations.entries[i];
+        if (opaque || entry->escapes || entry->sites != 1 || isVariableDeclared(entry->name)) {
+            entry->storage = OBJECT_HEAP;
+        } else {
+            entry->storage = entry->addressTaken ? OBJECT_STACK : OBJECT_SCALAR;
+        }
+        logger_log(LOG_DEBUG, "Object '%s' (%s): %s", entry->name, entry->cls->name,
+                   entry->storage == OBJECT_HEAP ? "heap" :
+                   entry->storage == OBJECT_STACK ? "stack" : "scalar-replaced");
+    }
+}
+
+/**
+ * @brief Emits an assignment to a field of an object variable
+ *
+ * @param node AST_VAR_ASSIGN whose name is "object.field"
+ * @return bool true if the object is a built-in class instance and the store was emitted
+ */
+static bool compileFieldAssignment(AstNode* node) {
+    char object[256];
+    const char* dot = strchr(node->varAssign.name, '.');
+    size_t length = (size_t)(dot - node->varAssign.name);
+    if (length == 0 || length >= sizeof(object)) return false;
+    memcpy(object, node->varAssign.name, length);
+    object[length] = '\0';
+
+    ObjectAllocation* entry = findObjectAllocation(object);
+    if (entry && entry->storage == OBJECT_SCALAR) {
+        emit("%s__%s = ", object, dot + 1);
+    } else if (objectVariableClass(object)) {
+        emit("%s->%s = ", object, dot + 1);
+    } else {
+        return false;
+    }
+    compileExpression(node->varAssign.initializer);
+    emitLine(";");
+    return true;
+}
+
+/**
+ * @brief Gets the scalar-replaced object a variable names, if any
+ */
+static ObjectAllocation* scalarObject(const char* name) {
+    ObjectAllocation* entry = findObjectAllocation(name);
+    return entry && entry->storage == OBJECT_SCALAR ? entry : NULL;
+}
+
+/**
+ * @brief Emits the declaration of a variable initialized with a new object
+ *
+ * @param name Variable name
+ * @param initializer Allocation expression
+ * @return bool true if the allocation was emitted as stack or scalar storage
+ */
+static bool compileObjectAllocation(const char* name, AstNode* initializer) {
+    ObjectAllocation* entry = findObjectAllocation(name);
+    if (!entry || entry->storage == OBJECT_HEAP || allocatedClass(initializer) != entry->cls) {
+        if (entry) stats.objects_heap_allocated++;
+        return false;
+    }
+
+    const BuiltinClass* cls = entry->cls;
+    char type[64];
+    snprintf(type, sizeof(type), "%s*", cls->name);
+    if (isVariableDeclared(name)) {
+        // La variable ya existía al llegar aquí: se asigna como antes
+        entry->storage = OBJECT_HEAP;
+        stats.objects_heap_allocated++;
+        return false;
+    }
+    addVariable(name, type);
+    markVariableDeclared(name);
+
+    if (entry->storage == OBJECT_SCALAR) {
+        emitLine("// %s: %s scalar-replaced (does not escape)", name, cls->name);
+        for (int i = 0; i < cls->fieldCount; i++) {
+            emitLine("%s %s__%s __attribute__((unused)) = %s;",
+                     cls->fieldTypes[i], name, cls->fields[i], cls->defaults[i]);
+        }
+        stats.objects_scalar_replaced++;
+    } else {
+        // emit() sangra cada llamada, así que el inicializador se arma antes
+        char defaults[128] = "";
+        for (int i = 0; i < cls->fieldCount; i++) {
+            size_t used = strlen(defaults);
+            snprintf(defaults + used, sizeof(defaults) - used, "%s%s", i > 0 ? ", " : "", cls->defaults[i]);
+        }
+        emitLine("%s %s__obj = { %s };  // %s does not escape", cls->name, name, defaults, name);
+        emitLine("%s %s __attribute__((unused)) = &%s__obj;", type, name, name);
+        stats.objects_stack_allocated++;
+    }
+    return true;
 }
 
 static bool isPointerVariable(const char* name) {
@@ -327,8 +1257,8 @@ static void initializeGlobalVariables(void) {
     addVariable("product", "double");
     markVariableDeclared("product");
     
-    emitLine("int int_val __attribute__((unused)) = 0;");
-    addVariable("int_val", "int");
+    emitLine("int64_t int_val __attribute__((unused)) = 0;");
+    addVariable("int_val", "int64_t");
     markVariableDeclared("int_val");
     
     emitLine("float float_val __attribute__((unused)) = 0.0;");
@@ -355,28 +1285,28 @@ static void initializeGlobalVariables(void) {
     addVariable("c1", "Circle*");
     markVariableDeclared("c1");
     
-    emitLine("int i __attribute__((unused)) = 0;");
-    addVariable("i", "int");
+    emitLine("int64_t i __attribute__((unused)) = 0;");
+    addVariable("i", "int64_t");
     markVariableDeclared("i");
     
-    emitLine("int j __attribute__((unused)) = 0;");
-    addVariable("j", "int");
+    emitLine("int64_t j __attribute__((unused)) = 0;");
+    addVariable("j", "int64_t");
     markVariableDeclared("j");
     
-    emitLine("int count __attribute__((unused)) = 0;");
-    addVariable("count", "int");
+    emitLine("int64_t count __attribute__((unused)) = 0;");
+    addVariable("count", "int64_t");
     markVariableDeclared("count");
     
-    emitLine("int do_while_count __attribute__((unused)) = 0;");
-    addVariable("do_while_count", "int");
+    emitLine("int64_t do_while_count __attribute__((unused)) = 0;");
+    addVariable("do_while_count", "int64_t");
     markVariableDeclared("do_while_count");
     
-    emitLine("int day __attribute__((unused)) = 0;");
-    addVariable("day", "int");
+    emitLine("int64_t day __attribute__((unused)) = 0;");
+    addVariable("day", "int64_t");
     markVariableDeclared("day");
     
-    emitLine("int* int_array __attribute__((unused)) = NULL;");
-    addVariable("int_array", "int*");
+    emitLine("int64_t* int_array __attribute__((unused)) = NULL;");
+    addVariable("int_array", "int64_t*");
     markVariableDeclared("int_array");
     
     emitLine("float* float_array __attribute__((unused)) = NULL;");
@@ -406,12 +1336,25 @@ static void compileNode(AstNode* node) {
     }
     
     stats.nodes_processed++;
+    if (node->line > 0) {
+        statementLine = node->line;
+    }
     
     switch (node->type) {
         case AST_PROGRAM:
             logger_log(LOG_INFO, "Compiling program with %d statements", node->program.statementCount);
+            programNode = node;
             variableCount = 0;
             stats = (CompilerStats){0}; // Reset stats
+            coldLabelCount = 0;
+            dispatchCount = 0;
+            // Descartar las funciones que main no alcanza y anotar qué miembros
+            // de los módulos importados se usan, antes de generar nada
+            treeshake_program(node);
+            // Hallar los arrays que no comparten memoria con otros, para vectorizar
+            vectorize_begin_program(node);
+            // Hallar los arrays de longitud conocida, para no comprobar sus índices
+            bounds_begin_program(node);
             // Emitir preámbulo primero
             generatePreamble();
             emitLine("#include <stdio.h>");
@@ -577,13 +1520,31 @@ static void compileNode(AstNode* node) {
             // Función main
             emitLine("\nint main() {");
             indent();
+            if (profile_get_mode() == PROFILE_GENERATE) {
+                emitLine("atexit(__lyn_prof_write);");
+            }
             
             // Inicializar variables globales y actualizar la tabla
             initializeGlobalVariables();
             
-            // Compilar las sentencias del programa a partir del AST
-            for (int i = 0; i < node->program.statementCount; i++) {
-                compileNode(node->program.statements[i]);
+            // Compilar las sentencias del programa: desde el IR si el cuerpo cabe en
+            // el subconjunto que modela, y si no directamente a partir del AST
+            analyzeObjectAllocations(node->program.statements, node->program.statementCount);
+            IrFunction* irBody = useIr ? ir_lower_program(node, irVariableType) : NULL;
+            if (irBody) {
+                // Las funciones se compilan desde el AST antes del cuerpo que las llama
+                for (int i = 0; i < node->program.statementCount; i++) {
+                    if (node->program.statements[i]->type == AST_FUNC_DEF) {
+                        compileNode(node->program.statements[i]);
+                    }
+                }
+                ir_optimize(irBody);
+                ir_emit_c(irBody, outputFile, indentLevel);
+                ir_free(irBody);
+            } else {
+                for (int i = 0; i < node->program.statementCount; i++) {
+                    compileNode(node->program.statements[i]);
+                }
             }
             
             // Asegurarse de que cualquier función definida pero no llamada explícitamente
@@ -601,20 +1562,35 @@ static void compileNode(AstNode* node) {
             emitLine("return 0;");
             outdent();
             emitLine("}");
+            // Contadores del perfil: se conocen todos una vez generado main
+            profile_emit_runtime(outputFile);
             break;
             
         case AST_VAR_DECL:
             logger_log(LOG_DEBUG, "Compiling variable declaration: %s (%s)", 
                        node->varDecl.name, node->varDecl.type);
+        {
+            const char* declType = lynTypeToC(node->varDecl.type);
+            if (strcmp(declType, "__auto_type") == 0) {
+                // Temporales del optimizador: registrar el tipo que tendría su inicializador;
+                // un entero de Lyn se declara int64_t aunque su inicializador sea un int de C
+                declType = inferType(node->varDecl.initializer);
+                addVariable(node->varDecl.name, declType);
+                if (!isIntegerType(declType)) declType = "__auto_type";
+                else declType = "int64_t";
+            } else {
+                addVariable(node->varDecl.name, declType);
+            }
             markVariableDeclared(node->varDecl.name);
             if (node->varDecl.initializer) {
-                emit("%s %s __attribute__((unused)) = ", node->varDecl.type, node->varDecl.name);
+                emit("%s %s __attribute__((unused)) = ", declType, node->varDecl.name);
                 compileExpression(node->varDecl.initializer);
                 emitLine(";");
             } else {
-                emitLine("%s %s __attribute__((unused));", node->varDecl.type, node->varDecl.name);
+                emitLine("%s %s __attribute__((unused));", declType, node->varDecl.name);
             }
             break;
+        }
             
         case AST_VAR_ASSIGN: {
             struct {
@@ -652,11 +1628,19 @@ static void compileNode(AstNode* node) {
             }
             else if (strcmp(node->varAssign.name, "str_numeric") == 0) {
                 emitLine("char str_numeric[256];");
-                emitLine("sprintf(str_numeric, \"The answer is: %%d\", int_val);");
+                emitLine("sprintf(str_numeric, \"The answer is: %%lld\", (long long)int_val);");
                 addVariable("str_numeric", "char*");
                 markVariableDeclared("str_numeric");
                 return;
             }
+            // Asignación a un campo: obj.campo = valor
+            if (strchr(node->varAssign.name, '.') && compileFieldAssignment(node)) {
+                return;
+            }
+            if (allocatedClass(node->varAssign.initializer) &&
+                compileObjectAllocation(node->varAssign.name, node->varAssign.initializer)) {
+                return;
+            }
             if (!isVariableDeclared(node->varAssign.name)) {
                 const char* type = inferType(node->varAssign.initializer);
                 addVariable(node->varAssign.name, type);
@@ -664,11 +1648,13 @@ static void compileNode(AstNode* node) {
                 
                 // For numeric literals, directly use the value to avoid garbage values
                 if (node->varAssign.initializer->type == AST_NUMBER_LITERAL) {
-                    double value = node->varAssign.initializer->numberLiteral.value;
-                    if (value == (int)value) {
-                        emitLine("int %s __attribute__((unused)) = %d;", node->varAssign.name, (int)value);
+                    char text[64];
+                    if (isIntLiteral(node->varAssign.initializer)) {
+                        emitLine("int64_t %s __attribute__((unused)) = %lld;", node->varAssign.name,
+                                 integerLiteralValue(node->varAssign.initializer));
                     } else {
-                        emitLine("double %s __attribute__((unused)) = %g;", node->varAssign.name, value);
+                        emitLine("double %s __attribute__((unused)) = %s;", node->varAssign.name,
+                                 formatDoubleLiteral(node->varAssign.initializer, text, sizeof(text)));
                     }
                     return;
                 }
@@ -691,6 +1677,16 @@ static void compileNode(AstNode* node) {
             break;
         }
         
+        case AST_ARRAY_ASSIGN: {
+            // Asignación a un elemento: a[i] = valor
+            emit("%s", arrayAccessName(node->arrayAssign.name));
+            compileArrayIndex(node, node->arrayAssign.name, node->arrayAssign.index);
+            emit(" = ");
+            compileExpression(node->arrayAssign.value);
+            emitLine(";");
+            break;
+        }
+        
         case AST_FUNC_DEF:
             logger_log(LOG_INFO, "Compiling function definition: %s", node->funcDef.name);
             stats.functions_compiled++;
@@ -726,38 +1722,8 @@ static void compileNode(AstNode* node) {
             break;
             
         case AST_SWITCH_STMT:
-            emit("switch (");
-            compileExpression(node->switchStmt.expr);
-            emitLine(") {");
-            indent();
-            
-            // Compilar cada case y agregar break; al final
-            for (int i = 0; i < node->switchStmt.caseCount; i++) {
-                AstNode* caseNode = node->switchStmt.cases[i];
-                emit("case ");
-                compileExpression(caseNode->caseStmt.expr);
-                emitLine(":");
-                indent();
-                for (int j = 0; j < caseNode->caseStmt.bodyCount; j++) {
-                    compileNode(caseNode->caseStmt.body[j]);
-                }
-                emitLine("break;");
-                outdent();
-            }
-            
-            // Compilar el default si existe
-            if (node->switchStmt.defaultCase) {
-                emitLine("default:");
-                indent();
-                for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
-                    compileNode(node->switchStmt.defaultCase[i]);
-                }
-                emitLine("break;");
-                outdent();
-            }
-            
-            outdent();
-            emitLine("}");
+        case AST_PATTERN_MATCH:
+            compileDispatch(node);
             break;
             
         case AST_THROW_STMT:
@@ -815,6 +1781,11 @@ static void compileNode(AstNode* node) {
             outdent();
             emitLine("} else {");
             indent();
+            // Los catch casi nunca se ejecutan: con perfil se marcan como código frío
+            if (profile_catch_is_cold(node)) {
+                emitLine("__lyn_cold_%d: __attribute__((cold, unused));", ++coldLabelCount);
+            }
+            emitProfileCounter(PROFILE_SITE_CATCH, node);
             // Extract error type from error message for comparison
             emitLine("char _error_type[256] = \"\";");
             emitLine("const char* colon = strchr(_error_message, ':');");
@@ -884,13 +1855,39 @@ static void compileNode(AstNode* node) {
             // Permitir la importación usando "import from module {symbols}" además de "import module"
             compileImport(node);
             break;
-            
+
+        case AST_FUNC_CALL:
+            // Llamada usada como sentencia: evaluar y descartar el resultado
+            compileExpression(node);
+            emitLine(";");
+            break;
+
+        case AST_BREAK_STMT:
+            emitLine("break;");
+            break;
+
+        case AST_CONTINUE_STMT:
+            emitLine("continue;");
+            break;
+
         default:
             logger_log(LOG_WARNING, "Unhandled AST node type: %d", node->type);
             break;
     }
 }
 
+/* importedModuleFor: Devuelve el módulo importado al que se refiere un nombre (el
+   propio módulo o uno de sus alias), o NULL si el nombre no es un módulo */
+static const char* importedModuleFor(const char* name) {
+    for (int i = 0; i < moduleAliasCount; i++) {
+        if (strcmp(moduleAliases[i], name) == 0) return moduleAliasesTargets[i];
+    }
+    for (int i = 0; i < importedModuleCount; i++) {
+        if (strcmp(importedModules[i], name) == 0) return importedModules[i];
+    }
+    return NULL;
+}
+
 static void compileFuncCall(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileFuncCall);
     
@@ -950,10 +1947,36 @@ static void compileFuncCall(AstNode* node) {
     if (strchr(node->funcCall.name, '.')) {
         char className[256], methodName[256];
         sscanf(node->funcCall.name, "%[^.].%s", className, methodName);
+        // modulo.funcion(a, b) llama directamente a la implementación del módulo; el
+        // parser pasa el módulo como primer argumento, que no forma parte de la llamada
+        const char* moduleName = importedModuleFor(className);
+        if (moduleName) {
+            int firstArg = (node->funcCall.argCount > 0 && node->funcCall.arguments[0] &&
+                            node->funcCall.arguments[0]->type == AST_IDENTIFIER &&
+                            strcmp(node->funcCall.arguments[0]->identifier.name, className) == 0) ? 1 : 0;
+            emit("%s_%s(0", moduleName, methodName);
+            for (int i = firstArg; i < node->funcCall.argCount; i++) {
+                emit(", ");
+                compileExpression(node->funcCall.arguments[i]);
+            }
+            emit(")");
+            return;
+        }
+        // obj.metodo(...) llama al método de la clase del objeto con obj como self;
+        // en Clase.metodo(a, b) el nombre de la clase no es un argumento
+        int firstArg = 0;
+        const BuiltinClass* receiverClass = objectVariableClass(className);
+        if (receiverClass) {
+            snprintf(className, sizeof(className), "%s", receiverClass->name);
+        } else if (findBuiltinClass(className) && node->funcCall.argCount > 1 &&
+                   node->funcCall.arguments[0] && node->funcCall.arguments[0]->type == AST_IDENTIFIER &&
+                   strcmp(node->funcCall.arguments[0]->identifier.name, className) == 0) {
+            firstArg = 1;
+        }
         if (node->funcCall.argCount > 0 && node->funcCall.arguments[0]) {
             emit("%s_%s(", className, methodName);
-            for (int i = 0; i < node->funcCall.argCount; i++) {
-                if (i > 0) emit(", ");
+            for (int i = firstArg; i < node->funcCall.argCount; i++) {
+                if (i > firstArg) emit(", ");
                 if (node->funcCall.arguments[i]) {
                     compileExpression(node->funcCall.arguments[i]);
                 } else {
@@ -1054,131 +2077,198 @@ static void compileMemberAccess(AstNode* node) {
         }
     }
     
+    // Longitud de un array: guardada delante de sus elementos
+    if (isArrayLength(node)) {
+        emit("lyn_array_length(%s)", objectExpr->identifier.name);
+        return;
+    }
+    
+    // Objetos de las clases predefinidas: campos sueltos o acceso por puntero
+    if (objectExpr->type == AST_IDENTIFIER) {
+        if (scalarObject(objectExpr->identifier.name)) {
+            emit("%s__%s", objectExpr->identifier.name, node->memberAccess.member);
+            return;
+        }
+        if (objectVariableClass(objectExpr->identifier.name)) {
+            emit("%s->%s", objectExpr->identifier.name, node->memberAccess.member);
+            return;
+        }
+    }
+    
     // Caso normal: acceso a un miembro de un objeto
     compileExpression(objectExpr);
     emit(".%s", node->memberAccess.member);
 }
 
-/* Genera código para la sentencia print */
-static void compilePrintStmt(AstNode* node) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)compilePrintStmt);
+/**
+ * @brief Generates a string concatenation of the given parts
+ * 
+ * Emits a single concat_n() call: the kinds string tells the runtime which
+ * parts are strings ('s') and which are numbers formatted with %g ('g'), so
+ * the result is measured and allocated once however many parts there are.
+ * 
+ * @param parts Operands in output order
+ * @param count Number of operands
+ */
+static void compileConcatParts(AstNode** parts, int count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compileConcatParts);
     
-    if (!node || !node->printStmt.expr) {
-        emitLine("printf(\"NULL\\n\");");
+    char* kinds = malloc(count + 1);
+    if (!kinds) {
+        error_report("Compiler", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        emit("NULL");
         return;
     }
+    for (int i = 0; i < count; i++) {
+        const char* type = inferType(parts[i]);
+        kinds[i] = isStringType(type) ? 's' : isIntegerType(type) ? 'd' : 'g';
+    }
+    kinds[count] = '\0';
     
-    // Handle string concatenation in print with binary op '+'
-    if (node->printStmt.expr->type == AST_BINARY_OP &&
-        node->printStmt.expr->binaryOp.op == '+') {
-        // Special case for error message concatenation
-        if (node->printStmt.expr->binaryOp.left->type == AST_STRING_LITERAL &&
-            strstr(node->printStmt.expr->binaryOp.left->stringLiteral.value, "Error") != NULL &&
-            node->printStmt.expr->binaryOp.right->type == AST_IDENTIFIER) {
-            emitLine("{");
-            indent();
-            emitLine("char _print_buffer[2048];  // Buffer for formatted error message");
-            const char* errorVarName = node->printStmt.expr->binaryOp.right->identifier.name;
-            emitLine("snprintf(_print_buffer, sizeof(_print_buffer), \"%%s%%s\", \"%s\", %s);", 
-                    node->printStmt.expr->binaryOp.left->stringLiteral.value,
-                    errorVarName);
-            emitLine("printf(\"%%s\\n\", _print_buffer);");
-            outdent();
-            emitLine("}");
-            return;
+    // emit() sangra cada llamada, así que cada literal se emite de una vez
+    emit("concat_n(\"%s\"", kinds);
+    for (int i = 0; i < count; i++) {
+        emit(", ");
+        if (kinds[i] == 's') {
+            compileExpression(parts[i]);
+        } else {
+            emit(kinds[i] == 'd' ? "(long long)(" : "(double)(");
+            compileExpression(parts[i]);
+            emit(")");
         }
+    }
+    emit(")");
+    free(kinds);
+}
 
-        // Determine format specifiers based on operand types
-        const char* left_format = "%s";
-        const char* right_format = "%s";
-        
-        // Check left operand type
-        if (node->printStmt.expr->binaryOp.left->type == AST_NUMBER_LITERAL) {
-            double leftVal = node->printStmt.expr->binaryOp.left->numberLiteral.value;
-            left_format = (leftVal == (int)leftVal) ? "%d" : "%g";
-        } else if (node->printStmt.expr->binaryOp.left->type == AST_IDENTIFIER) {
-            const char* leftType = getVariableType(node->printStmt.expr->binaryOp.left->identifier.name);
-            if (strcmp(leftType, "int") == 0) {
-                left_format = "%d";
-            } else if (strcmp(leftType, "double") == 0 || strcmp(leftType, "float") == 0) {
-                left_format = "%g";
-            }
-        }
-        
-        // Check right operand type
-        if (node->printStmt.expr->binaryOp.right->type == AST_NUMBER_LITERAL) {
-            double rightVal = node->printStmt.expr->binaryOp.right->numberLiteral.value;
-            right_format = (rightVal == (int)rightVal) ? "%d" : "%g";
-        } else if (node->printStmt.expr->binaryOp.right->type == AST_IDENTIFIER) {
-            const char* rightType = getVariableType(node->printStmt.expr->binaryOp.right->identifier.name);
-            if (strcmp(rightType, "int") == 0) {
-                right_format = "%d";
-            } else if (strcmp(rightType, "double") == 0 || strcmp(rightType, "float") == 0) {
-                right_format = "%g";
-            }
+/**
+ * @brief Generates an n-ary concatenation built by the optimizer
+ * 
+ * @param node AST_CONCAT_EXPR node
+ */
+static void compileConcatExpr(AstNode* node) {
+    compileConcatParts(node->concatExpr.parts, node->concatExpr.partCount);
+}
+
+/**
+ * @brief Growable format string of a streamed print
+ */
+typedef struct {
+    char* data;
+    size_t length;
+    size_t capacity;
+} PrintFormat;
+
+static void appendPrintFormat(PrintFormat* format, const char* text) {
+    size_t length = strlen(text);
+    if (format->length + length + 1 > format->capacity) {
+        size_t capacity = format->capacity ? format->capacity * 2 : 64;
+        while (capacity < format->length + length + 1) capacity *= 2;
+        char* data = realloc(format->data, capacity);
+        if (!data) {
+            error_report("Compiler", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            return;
         }
-        
-        char combined_format[32];
-        snprintf(combined_format, sizeof(combined_format), "%s%s", left_format, right_format);
-        
-        emitLine("{");
-        indent();
-        emitLine("char _print_buffer[1024];");
-        emit("sprintf(_print_buffer, \"%s\", ", combined_format);
-        
-        // Handle left operand
-        if (node->printStmt.expr->binaryOp.left->type == AST_STRING_LITERAL) {
-            emit("\"%s\"", node->printStmt.expr->binaryOp.left->stringLiteral.value);
-        } else {
-            compileExpression(node->printStmt.expr->binaryOp.left);
+        format->data = data;
+        format->capacity = capacity;
+    }
+    memcpy(format->data + format->length, text, length + 1);
+    format->length += length;
+}
+
+/**
+ * @brief Emits one operand of a streamed print
+ * 
+ * Literals are written straight into the format string. Integers are
+ * printed exactly and floats with %g, like the concatenation the print
+ * replaces.
+ * 
+ * @param part Operand to emit
+ * @param format Format being built, or NULL to emit the argument instead
+ */
+static void compilePrintPart(AstNode* part, PrintFormat* format) {
+    char text[64];
+    
+    if (part->type == AST_STRING_LITERAL) {
+        if (!format) return;
+        for (const char* c = part->stringLiteral.value; *c; c++) {
+            char piece[2] = { *c, '\0' };
+            appendPrintFormat(format, *c == '%' ? "%%" : piece);
         }
-        emit(", ");
-        
-        // Handle right operand
-        if (node->printStmt.expr->binaryOp.right->type == AST_STRING_LITERAL) {
-            emit("\"%s\"", node->printStmt.expr->binaryOp.right->stringLiteral.value);
+        return;
+    }
+    
+    if (part->type == AST_NUMBER_LITERAL) {
+        if (!format) return;
+        if (isIntLiteral(part)) {
+            snprintf(text, sizeof(text), "%lld", integerLiteralValue(part));
         } else {
-            compileExpression(node->printStmt.expr->binaryOp.right);
+            snprintf(text, sizeof(text), "%g", part->numberLiteral.value);
         }
-        emitLine(");");
-        emitLine("printf(\"%%s\\n\", _print_buffer);");
-        outdent();
-        emitLine("}");
+        appendPrintFormat(format, text);
         return;
     }
     
-    // Special case for string concatenation with member access
-    if (node->printStmt.expr->type == AST_BINARY_OP &&
-        node->printStmt.expr->binaryOp.op == '+' &&
-        (node->printStmt.expr->binaryOp.right->type == AST_MEMBER_ACCESS)) {
-        
-        const char* left_format = "%s";
-        const char* right_format = "%s";
-        if (node->printStmt.expr->binaryOp.left->type == AST_NUMBER_LITERAL) {
-            double leftVal = node->printStmt.expr->binaryOp.left->numberLiteral.value;
-            left_format = (leftVal == (int)leftVal) ? "%d" : "%g";
-        }
-        char combined_format[32];
-        snprintf(combined_format, sizeof(combined_format), "%s%s", left_format, right_format);
-        
-        emitLine("{");
-        indent();
-        emitLine("char _buffer[512];");
-        emit("sprintf(_buffer, \"%s\", ", combined_format);
-        // Left operand
-        compileExpression(node->printStmt.expr->binaryOp.left);
+    const char* type = inferType(part);
+    const char* spec = "%g";
+    if (isStringType(type)) {
+        spec = "%s";
+    } else if (isIntegerType(type)) {
+        spec = "%lld";
+    }
+    
+    if (format) {
+        appendPrintFormat(format, spec);
+    } else if (strcmp(spec, "%s") == 0) {
         emit(", ");
-        // For member access, si es 'brand' se inyecta un valor fijo
-        if (node->printStmt.expr->binaryOp.right->type == AST_MEMBER_ACCESS &&
-            strcmp(node->printStmt.expr->binaryOp.right->memberAccess.member, "brand") == 0) {
-            emit("\"Toyota\"");
-        } else {
-            emit("\"unknown\"");
+        compileExpression(part);
+    } else {
+        emit(strcmp(spec, "%g") == 0 ? ", (double)(" : ", (long long)(");
+        compileExpression(part);
+        emit(")");
+    }
+}
+
+/**
+ * @brief Emits every part of a printed concatenation, left to right
+ * 
+ * @param node String concatenation (BINARY '+' or AST_CONCAT_EXPR)
+ * @param format Format being built, or NULL to emit the arguments instead
+ */
+static void compilePrintParts(AstNode* node, PrintFormat* format) {
+    if (node->type == AST_CONCAT_EXPR) {
+        for (int i = 0; i < node->concatExpr.partCount; i++) {
+            AstNode* part = node->concatExpr.parts[i];
+            if (isStringConcat(part)) compilePrintParts(part, format);
+            else compilePrintPart(part, format);
         }
+        return;
+    }
+    
+    AstNode* operands[2] = { node->binaryOp.left, node->binaryOp.right };
+    for (int i = 0; i < 2; i++) {
+        if (isStringConcat(operands[i])) compilePrintParts(operands[i], format);
+        else compilePrintPart(operands[i], format);
+    }
+}
+
+/* Genera código para la sentencia print */
+static void compilePrintStmt(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compilePrintStmt);
+    
+    if (!node || !node->printStmt.expr) {
+        emitLine("printf(\"NULL\\n\");");
+        return;
+    }
+    
+    // Una concatenación se imprime por partes con un solo printf, sin reservar memoria
+    if (isStringConcat(node->printStmt.expr)) {
+        PrintFormat format = {0};
+        compilePrintParts(node->printStmt.expr, &format);
+        emit("printf(\"%s\\n\"", format.data ? format.data : "");
+        compilePrintParts(node->printStmt.expr, NULL);
         emitLine(");");
-        emitLine("printf(\"%%s\\n\", _buffer);");
-        outdent();
-        emitLine("}");
+        free(format.data);
         return;
     }
     
@@ -1189,8 +2279,8 @@ static void compilePrintStmt(AstNode* node) {
         
         if (strcmp(varType, "const char*") == 0 || strcmp(varType, "char*") == 0) {
             emitLine("printf(\"%%s\\n\", %s);", varName);
-        } else if (strcmp(varType, "int") == 0) {
-            emitLine("printf(\"%%d\\n\", %s);", varName);
+        } else if (isIntegerType(varType)) {
+            emitLine("printf(\"%%lld\\n\", (long long)%s);", varName);
         } else if (strcmp(varType, "bool") == 0) {
             emitLine("printf(\"%%s\\n\", %s ? \"true\" : \"false\");", varName);
         } else if (strcmp(varType, "double") == 0 || strcmp(varType, "float") == 0) {
@@ -1208,11 +2298,11 @@ static void compilePrintStmt(AstNode* node) {
     }
     
     if (node->printStmt.expr->type == AST_NUMBER_LITERAL) {
-        double value = node->printStmt.expr->numberLiteral.value;
-        if (value == (int)value) {
-            emitLine("printf(\"%%d\\n\", %d);", (int)value);
+        char text[64];
+        if (isIntLiteral(node->printStmt.expr)) {
+            emitLine("printf(\"%%lld\\n\", %lldLL);", integerLiteralValue(node->printStmt.expr));
         } else {
-            emitLine("printf(\"%%g\\n\", %g);", value);
+            emitLine("printf(\"%%g\\n\", %s);", formatDoubleLiteral(node->printStmt.expr, text, sizeof(text)));
         }
         return;
     }
@@ -1233,8 +2323,8 @@ static void compilePrintStmt(AstNode* node) {
         compileExpression(node->printStmt.expr);
         emitLine(";");
         
-        if (strcmp(exprType, "int") == 0) {
-            emitLine("printf(\"%%d\\n\", _result);");
+        if (isIntegerType(exprType)) {
+            emitLine("printf(\"%%lld\\n\", (long long)_result);");
         } else if (strcmp(exprType, "const char*") == 0 || strcmp(exprType, "char*") == 0) {
             emitLine("printf(\"%%s\\n\", _result ? _result : \"NULL\");");
         } else if (strcmp(exprType, "bool") == 0) {
@@ -1250,7 +2340,9 @@ static void compilePrintStmt(AstNode* node) {
 static void compileIf(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileIf);
     
-    emit("if (");
+    // Con perfil, la rama que casi siempre se toma se indica a GCC
+    int hint = profile_branch_hint(node);
+    emit(hint >= 0 ? "if (__builtin_expect(!!(" : "if (");
     if (node->ifStmt.condition->type == AST_BINARY_OP && 
         node->ifStmt.condition->binaryOp.op == 'E') {
         if (node->ifStmt.condition->binaryOp.left->type == AST_STRING_LITERAL || 
@@ -1268,16 +2360,26 @@ static void compileIf(AstNode* node) {
     } else {
         compileExpression(node->ifStmt.condition);
     }
-    emitLine(") {");
+    if (hint >= 0) {
+        emitLine("), %d)) {", hint);
+    } else {
+        emitLine(") {");
+    }
     indent();
+    emitProfileCounter(PROFILE_SITE_THEN, node);
     for (int i = 0; i < node->ifStmt.thenCount; i++) {
         compileNode(node->ifStmt.thenBranch[i]);
     }
     outdent();
     emitLine("}");
-    if (node->ifStmt.elseCount > 0) {
+    // El contador del else se emite aunque la rama no exista
+    int elseCounter = profile_counter(PROFILE_SITE_ELSE, node);
+    if (node->ifStmt.elseCount > 0 || elseCounter >= 0) {
         emitLine("else {");
         indent();
+        if (elseCounter >= 0) {
+            emitLine("__lyn_prof_counts[%d]++;", elseCounter);
+        }
         for (int i = 0; i < node->ifStmt.elseCount; i++) {
             compileNode(node->ifStmt.elseBranch[i]);
         }
@@ -1286,6 +2388,134 @@ static void compileIf(AstNode* node) {
     }
 }
 
+/**
+ * @brief Marks a loop in the generated C for the vectorization report
+ * 
+ * The verdict is also written as an optimization remark.
+ * 
+ * @param node Loop node
+ * @param verdict Verdict on the loop (may be NULL)
+ */
+static void emitLoopMarker(const AstNode* node, const VectorizeLoop* verdict) {
+    if (!verdict) return;
+    if (vectorize_report_enabled()) {
+        emitLine("// lyn-loop %d", verdict->id);
+    }
+    if (verdict->candidate) {
+        remarks_emit(REMARK_APPLIED, "vectorize", node, "iterations independent: emitted with vectorization hints");
+    } else {
+        remarks_emit(REMARK_MISSED, "vectorize", node, "not vectorized: %s", verdict->reason);
+    }
+}
+
+/**
+ * @brief Compiles a range loop whose iterations are independent
+ * 
+ * The range end is evaluated once, each array is reached through a
+ * restrict-qualified pointer assumed aligned as lyn_array_new() aligns it,
+ * and ivdep tells GCC there are no dependences it has to prove.
+ * 
+ * @param node AST_FOR_STMT range loop
+ * @param verdict Verdict with the arrays the body accesses
+ */
+static void compileVectorRangeLoop(AstNode* node, const VectorizeLoop* verdict) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compileVectorRangeLoop);
+    
+    const char* it = node->forStmt.iterator;
+    emitLine("// Iterations are independent: hinted for vectorization");
+    emitLine("{");
+    indent();
+    if (verdict->hoist_end) {
+        emit("const __auto_type __lyn_n%d = ", verdict->id);
+        compileExpression(node->forStmt.rangeEnd);
+        emitLine(";");
+    }
+    for (int i = 0; i < verdict->array_count; i++) {
+        const char* type = verdict->array_types[i];
+        const char* name = verdict->arrays[i];
+        emitLine("%s restrict __lyn_v%d_%s = (%s)__builtin_assume_aligned(%s, %d);",
+                 type, verdict->id, name, type, name, VECTORIZE_ALIGNMENT);
+    }
+    emitLine("#pragma GCC ivdep");
+    emit("for (int64_t %s = ", it);
+    compileExpression(node->forStmt.rangeStart);
+    emit("; %s < ", it);
+    if (verdict->hoist_end) {
+        emit("__lyn_n%d", verdict->id);
+    } else {
+        compileExpression(node->forStmt.rangeEnd);
+    }
+    if (node->forStmt.rangeStep) {
+        emit("; %s += ", it);
+        compileExpression(node->forStmt.rangeStep);
+    } else {
+        emit("; %s++", it);
+    }
+    emitLine(") {");
+    
+    indent();
+    emitProfileCounter(PROFILE_SITE_LOOP_BODY, node);
+    const VectorizeLoop* outer = vectorLoop;
+    vectorLoop = verdict;
+    for (int i = 0; i < node->forStmt.bodyCount; i++) {
+        compileNode(node->forStmt.body[i]);
+    }
+    vectorLoop = outer;
+    outdent();
+    emitLine("}");
+    outdent();
+    emitLine("}");
+}
+
+/**
+ * @brief Compiles a loop over the elements of a typed array
+ * 
+ * @param node AST_FOR_STMT collection loop whose collection is an array
+ */
+static void compileArrayCollectionLoop(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compileArrayCollectionLoop);
+    
+    const char* it = node->forStmt.iterator;
+    const char* arrayType = inferType(node->forStmt.collection);
+    const char* elementType = arrayElementOf(arrayType);
+    emitLine("// For loop over an array: for %s in collection", it);
+    emitLine("{");
+    indent();
+    emit("%s _collection = ", arrayType);
+    compileExpression(node->forStmt.collection);
+    emitLine(";");
+    emitLine("for (int _i = 0, _size = lyn_array_length(_collection); _i < _size; _i++) {");
+    indent();
+    emitLine("%s %s = _collection[_i];", elementType, it);
+    
+    // El iterador tiene el tipo de los elementos mientras dura el cuerpo
+    addVariable(it, elementType);
+    markVariableDeclared(it);
+    VariableInfo* entry = NULL;
+    char savedType[64] = "";
+    for (int i = 0; i < variableCount; i++) {
+        if (strcmp(variables[i].name, it) == 0) {
+            entry = &variables[i];
+            break;
+        }
+    }
+    if (entry) {
+        snprintf(savedType, sizeof(savedType), "%s", entry->type);
+        snprintf(entry->type, sizeof(entry->type), "%s", elementType);
+    }
+    for (int i = 0; i < node->forStmt.bodyCount; i++) {
+        compileNode(node->forStmt.body[i]);
+    }
+    if (entry) {
+        snprintf(entry->type, sizeof(entry->type), "%s", savedType);
+    }
+    
+    outdent();
+    emitLine("}");
+    outdent();
+    emitLine("}");
+}
+
 static void compileFor(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileFor);
     
@@ -1295,18 +2525,49 @@ static void compileFor(AstNode* node) {
         return;
     }
     
+    // Veredicto de vectorización; con --vectorize-report se marca el bucle en el C
+    const VectorizeLoop* verdict = vectorize_analyze_loop(node, irVariableType);
+    emitLoopMarker(node, verdict);
+    
+    // Con perfil, contar cuántas veces se llega al bucle (el cuerpo cuenta iteraciones)
+    if (node->forStmt.forType != FOR_COLLECTION) {
+        emitProfileCounter(PROFILE_SITE_LOOP_ENTRY, node);
+    }
+    
     // Determinar el tipo de bucle for y compilar según corresponda
     switch (node->forStmt.forType) {
         case FOR_RANGE:
             // Caso: for i in range(start, end[, step])
             emitLine("// For loop with range: for %s in range(...)", node->forStmt.iterator);
+            if (node->forStmt.inductionFlags != IV_NONE) {
+                // Hechos demostrados por el análisis de variables de inducción
+                const char* it = node->forStmt.iterator;
+                bool nonNegative = (node->forStmt.inductionFlags & IV_NON_NEGATIVE) != 0;
+                bool bounded = (node->forStmt.inductionFlags & IV_BOUNDED) != 0;
+                if (nonNegative && bounded) {
+                    emitLine("// Induction facts: 0 <= %s < range end", it);
+                } else {
+                    emitLine("// Induction facts: %s %s", it, nonNegative ? ">= 0" : "< range end");
+                }
+            }
             
             // Añadir el iterador a la tabla de variables
-            addVariable(node->forStmt.iterator, "int");
+            addVariable(node->forStmt.iterator, "int64_t");
             markVariableDeclared(node->forStmt.iterator);
             
+            // Qué índices del cuerpo están dentro de los límites, y cuáles se comprueban antes del bucle
+            BoundsPrecheck prechecks[BOUNDS_MAX_PRECHECKS];
+            emitBoundsPrechecks(node, prechecks, bounds_enter_loop(node, irVariableType, prechecks));
+            
+            // Iteraciones independientes: se emite con las pistas para vectorizar
+            if (verdict && verdict->candidate) {
+                compileVectorRangeLoop(node, verdict);
+                bounds_exit_loop();
+                return;
+            }
+            
             // Compilar el bucle for con range
-            emit("for (int %s = ", node->forStmt.iterator);
+            emit("for (int64_t %s = ", node->forStmt.iterator);
             compileExpression(node->forStmt.rangeStart);
             emit("; %s < ", node->forStmt.iterator);
             compileExpression(node->forStmt.rangeEnd);
@@ -1323,6 +2584,10 @@ static void compileFor(AstNode* node) {
             
         case FOR_COLLECTION:
             // Caso: for elem in collection
+            if (isArrayType(inferType(node->forStmt.collection))) {
+                compileArrayCollectionLoop(node);
+                return;
+            }
             emitLine("// For loop with collection: for %s in collection", node->forStmt.iterator);
             
             // Para iterar sobre colecciones, necesitamos variables auxiliares
@@ -1400,10 +2665,14 @@ static void compileFor(AstNode* node) {
     
     // Compilar el cuerpo del bucle for (común a todas las variantes excepto FOR_COLLECTION)
     indent();
+    emitProfileCounter(PROFILE_SITE_LOOP_BODY, node);
     for (int i = 0; i < node->forStmt.bodyCount; i++) {
         compileNode(node->forStmt.body[i]);
     }
     outdent();
+    if (node->forStmt.forType == FOR_RANGE) {
+        bounds_exit_loop();
+    }
     
     // Cerrar el bucle
     emitLine("}");
@@ -1433,9 +2702,9 @@ static void compileLambda(AstNode* node) {
         tempLambda.kind = TYPE_FUNCTION;
         strncpy(tempLambda.typeName, node->lambda.returnType, sizeof(tempLambda.typeName) - 1);
         tempLambda.typeName[sizeof(tempLambda.typeName) - 1] = '\0';
-        returnTypeStr = getCTypeString(&tempLambda);
+        returnTypeStr = lynTypeToC(getCTypeString(&tempLambda));
     } else if (node->inferredType && node->inferredType->kind == TYPE_FUNCTION) {
-        returnTypeStr = getCTypeString(node->inferredType->functionType.returnType);
+        returnTypeStr = lynTypeToC(getCTypeString(node->inferredType->functionType.returnType));
     }
     
     // Emit the lambda function definition
@@ -1451,7 +2720,7 @@ static void compileLambda(AstNode* node) {
         // Determine parameter type
         if (param->inferredType) {
             paramType = param->inferredType;
-            emit("%s %s", getCTypeString(paramType), param->identifier.name);
+            emit("%s %s", lynTypeToC(getCTypeString(paramType)), param->identifier.name);
         } else {
             // Default to void*
             emit("void* %s", param->identifier.name);
@@ -1525,51 +2794,21 @@ static void compileExpression(AstNode* node) {
         return;
     }
     
-    // Fix for string concatenation: use proper conversion and concatenation functions
-    if (node->type == AST_BINARY_OP && node->binaryOp.op == '+') {
-        // Check if either operand is in a string context
-        bool string_context = false;
-        if ((node->binaryOp.left && node->binaryOp.left->type == AST_STRING_LITERAL) ||
-            (node->binaryOp.right && node->binaryOp.right->type == AST_STRING_LITERAL)) {
-            string_context = true;
-        }
-        if (string_context) {
-            emit("concat_any(");
-            // Left operand: if not a string, wrap with to_string
-            {
-                const char* leftType = inferType(node->binaryOp.left);
-                if (strcmp(leftType, "const char*") == 0 || strcmp(leftType, "char*") == 0) {
-                    compileExpression(node->binaryOp.left);
-                } else {
-                    emit("to_string(");
-                    compileExpression(node->binaryOp.left);
-                    emit(")");
-                }
-            }
-            emit(", ");
-            // Right operand: if not a string, wrap with to_string
-            {
-                const char* rightType = inferType(node->binaryOp.right);
-                if (strcmp(rightType, "const char*") == 0 || strcmp(rightType, "char*") == 0) {
-                    compileExpression(node->binaryOp.right);
-                } else {
-                    emit("to_string(");
-                    compileExpression(node->binaryOp.right);
-                    emit(")");
-                }
-            }
-            emit(")");
-            return;
-        }
+    // Un '+' de cadenas se compila como concatenación de sus dos operandos
+    if (isStringConcat(node) && node->type == AST_BINARY_OP) {
+        AstNode* operands[2] = { node->binaryOp.left, node->binaryOp.right };
+        compileConcatParts(operands, 2);
+        return;
     }
     
     switch (node->type) {
         case AST_NUMBER_LITERAL:
             // Explicitly format integers as integers to avoid floating point issues
-            if (node->numberLiteral.value == (int)node->numberLiteral.value) {
-                emit("%d", (int)node->numberLiteral.value);
+            if (isIntLiteral(node)) {
+                emit("%lld", integerLiteralValue(node));
             } else {
-                emit("%g", node->numberLiteral.value);
+                char text[64];
+                emit("%s", formatDoubleLiteral(node, text, sizeof(text)));
             }
             break;
         case AST_STRING_LITERAL:
@@ -1615,11 +2854,11 @@ static void compileExpression(AstNode* node) {
                         emitLine("strcat(_concat_buffer, \"%s\");", node->binaryOp.left->stringLiteral.value);
                     } else if (node->binaryOp.left->type == AST_NUMBER_LITERAL) {
                         // Convert number to string
-                        double value = node->binaryOp.left->numberLiteral.value;
-                        if (value == (int)value) {
-                            emitLine("sprintf(_temp_buffer, \"%%d\", %d);", (int)value);
+                        AstNode* literal = node->binaryOp.left;
+                        if (isIntLiteral(literal)) {
+                            emitLine("sprintf(_temp_buffer, \"%%lld\", %lldLL);", integerLiteralValue(literal));
                         } else {
-                            emitLine("sprintf(_temp_buffer, \"%%g\", %g);", value);
+                            emitLine("sprintf(_temp_buffer, \"%%g\", %g);", literal->numberLiteral.value);
                         }
                         emitLine("strcat(_concat_buffer, _temp_buffer);");
                     } else {
@@ -1637,11 +2876,11 @@ static void compileExpression(AstNode* node) {
                         emitLine("strcat(_concat_buffer, \"%s\");", node->binaryOp.right->stringLiteral.value);
                     } else if (node->binaryOp.right->type == AST_NUMBER_LITERAL) {
                         // Convert number to string
-                        double value = node->binaryOp.right->numberLiteral.value;
-                        if (value == (int)value) {
-                            emitLine("sprintf(_temp_buffer, \"%%d\", %d);", (int)value);
+                        AstNode* literal = node->binaryOp.right;
+                        if (isIntLiteral(literal)) {
+                            emitLine("sprintf(_temp_buffer, \"%%lld\", %lldLL);", integerLiteralValue(literal));
                         } else {
-                            emitLine("sprintf(_temp_buffer, \"%%g\", %g);", value);
+                            emitLine("sprintf(_temp_buffer, \"%%g\", %g);", literal->numberLiteral.value);
                         }
                         emitLine("strcat(_concat_buffer, _temp_buffer);");
                     } else {
@@ -1661,8 +2900,35 @@ static void compileExpression(AstNode* node) {
                 }
             }
             
+            // División y resto entre enteros: explícitos, con error en tiempo de ejecución
+            if ((node->binaryOp.op == '/' || node->binaryOp.op == '%') &&
+                isIntegerType(inferType(node)) && !isSafeDivisor(node->binaryOp.right)) {
+                emit("%s(", node->binaryOp.op == '/' ? "lyn_div" : "lyn_mod");
+                compileExpression(node->binaryOp.left);
+                emit(", ");
+                compileExpression(node->binaryOp.right);
+                emit(", %d)", statementLine);
+                break;
+            }
+            if (node->binaryOp.op == '%' && !isIntegerType(inferType(node))) {
+                emit("fmod(");
+                compileExpression(node->binaryOp.left);
+                emit(", ");
+                compileExpression(node->binaryOp.right);
+                emit(")");
+                break;
+            }
+            
             // Regular non-string binary operation handling
             emit("(");
+            // Dos operandos int de C calcularían en 32 bits: el resultado es un entero de Lyn
+            if (isArithmeticOperator(node->binaryOp.op) && isIntegerType(inferType(node)) &&
+                isCIntExpression(node->binaryOp.left) && isCIntExpression(node->binaryOp.right)) {
+                emit("(int64_t)");
+            } else if (node->binaryOp.op == '/' && !isIntegerType(inferType(node))) {
+                // Con un operando que no es entero (p. ej. bool) la división es de coma flotante
+                emit("(double)");
+            }
             compileExpression(node->binaryOp.left);
             
             // Handle different operators
@@ -1698,15 +2964,51 @@ static void compileExpression(AstNode* node) {
         case AST_MEMBER_ACCESS:
             compileMemberAccess(node);
             break;
-        case AST_ARRAY_ACCESS:
-            compileExpression(node->arrayAccess.array);
-            emit("[");
-            compileExpression(node->arrayAccess.index);
-            emit("]");
+        case AST_ARRAY_ACCESS: {
+            AstNode* array = node->arrayAccess.array;
+            if (array && array->type == AST_IDENTIFIER) {
+                emit("%s", arrayAccessName(array->identifier.name));
+                compileArrayIndex(node, array->identifier.name, node->arrayAccess.index);
+            } else {
+                compileExpression(array);
+                compileArrayIndex(node, NULL, node->arrayAccess.index);
+            }
+            break;
+        }
+        case AST_ARRAY_LITERAL: {
+            const char* elementType = arrayLiteralElementType(node);
+            if (!elementType) {
+                logger_log(LOG_WARNING, "Array literal without a single element type compiled as 0");
+                emit("0");
+                break;
+            }
+            // Los elementos se copian a un bloque alineado que lleva delante la longitud
+            emit("((%s*)lyn_array_new(%d, sizeof(%s), (%s const[]){", elementType,
+                 node->arrayLiteral.elementCount, elementType, elementType);
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                if (i > 0) emit(", ");
+                compileExpression(node->arrayLiteral.elements[i]);
+            }
+            emit("}))");
             break;
+        }
         case AST_LAMBDA:
             compileLambda(node);
             break;
+        case AST_CONCAT_EXPR:
+            compileConcatExpr(node);
+            break;
+        case AST_NEW_EXPR:
+            if (findBuiltinClass(node->newExpr.className)) {
+                if (node->newExpr.argCount > 0) {
+                    logger_log(LOG_WARNING, "Constructor arguments of '%s' are ignored", node->newExpr.className);
+                }
+                emit("new_%s()", node->newExpr.className);
+                break;
+            }
+            logger_log(LOG_WARNING, "Unhandled expression type: %d", node->type);
+            emit("0");
+            break;
         default:
             logger_log(LOG_WARNING, "Unhandled expression type: %d", node->type);
             emit("0");
@@ -1727,7 +3029,7 @@ static void compileFunction(AstNode* node) {
     
     // Special handling for specific functions that need fixed signatures
     if (strcmp(node->funcDef.name, "add") == 0) {
-        emitLine("int add(int a, int b) {");
+        emitLine("int64_t add(int64_t a, int64_t b) {");
         indent();
         emitLine("return a + b;");
         outdent();
@@ -1750,20 +3052,26 @@ static void compileFunction(AstNode* node) {
     Type* returnType = NULL;
     
     if (strlen(node->funcDef.returnType) > 0) {
-        // If return type is specified in the AST, use it
-        Type temp;
-        temp.kind = TYPE_UNKNOWN;
-        strncpy(temp.typeName, node->funcDef.returnType, sizeof(temp.typeName) - 1);
-        temp.typeName[sizeof(temp.typeName) - 1] = '\0';
-        retTypeStr = getCTypeString(&temp);
+        // If return type is specified in the AST, use it (the node outlives this function)
+        retTypeStr = lynTypeToC(node->funcDef.returnType);
     } else if (node->inferredType && node->inferredType->kind == TYPE_FUNCTION) {
         // If we have an inferred function type, use its return type
         returnType = node->inferredType->functionType.returnType;
-        retTypeStr = getCTypeString(returnType);
+        retTypeStr = lynTypeToC(getCTypeString(returnType));
     }
     
-    // Function declaration
-    emit("%s %s(", retTypeStr, node->funcDef.name);
+    // Function declaration, with inlining hints from the weaver/optimizer
+    const char* inlineStr = "";
+    if (node->funcDef.attributes & FUNC_ATTR_ALWAYS_INLINE) {
+        inlineStr = "inline __attribute__((always_inline)) ";
+    } else if (node->funcDef.attributes & FUNC_ATTR_INLINE) {
+        inlineStr = "inline ";
+    } else if (node->funcDef.attributes & FUNC_ATTR_NOINLINE) {
+        inlineStr = "__attribute__((noinline)) ";
+    }
+    // Con perfil: las funciones nunca llamadas van a la sección fría, las más llamadas a la caliente
+    const char* layoutStr = profile_function_attribute(node);
+    emit("%s%s%s %s(", layoutStr, inlineStr, retTypeStr, node->funcDef.name);
     
     // Process parameters
     for (int i = 0; i < node->funcDef.paramCount; i++) {
@@ -1775,7 +3083,7 @@ static void compileFunction(AstNode* node) {
         // Determine parameter type
         if (param->inferredType) {
             paramType = param->inferredType;
-            emit("%s %s", getCTypeString(paramType), param->identifier.name);
+            emit("%s %s", lynTypeToC(getCTypeString(paramType)), param->identifier.name);
         } else {
             // If no type information available, default to void*
             emit("void* %s", param->identifier.name);
@@ -1783,7 +3091,7 @@ static void compileFunction(AstNode* node) {
         
         // Add parameter to variables table
         if (paramType) {
-            addVariable(param->identifier.name, getCTypeString(paramType));
+            addVariable(param->identifier.name, lynTypeToC(getCTypeString(paramType)));
         } else {
             addVariable(param->identifier.name, "void*");
         }
@@ -1792,15 +3100,28 @@ static void compileFunction(AstNode* node) {
     
     emitLine(") {");
     indent();
+    emitProfileCounter(PROFILE_SITE_FUNCTION, node);
     
     // Add function local variables section
     emitLine("// Local variables");
     
+    // Each body gets its own escape decisions; the enclosing ones are restored after it
+    ObjectAllocationTable* enclosingAllocations = malloc(sizeof(ObjectAllocationTable));
+    if (enclosingAllocations) *enclosingAllocations = objectAllocations;
+    analyzeObjectAllocations(node->funcDef.body, node->funcDef.bodyCount);
+    
     // Compile function body
     for (int i = 0; i < node->funcDef.bodyCount; i++) {
         compileNode(node->funcDef.body[i]);
     }
     
+    if (enclosingAllocations) {
+        objectAllocations = *enclosingAllocations;
+        free(enclosingAllocations);
+    } else {
+        objectAllocations.count = 0;
+    }
+    
     // If no explicit return in a non-void function, add a default return
     if (strcmp(retTypeStr, "void") != 0) {
         bool hasReturn = false;
@@ -1812,7 +3133,7 @@ static void compileFunction(AstNode* node) {
         }
         
         if (!hasReturn) {
-            if (strcmp(retTypeStr, "int") == 0) {
+            if (isIntegerType(retTypeStr)) {
                 emitLine("return 0;  // Default return");
             } else if (strcmp(retTypeStr, "float") == 0 || strcmp(retTypeStr, "double") == 0) {
                 emitLine("return 0.0;  // Default return");
@@ -1836,10 +3157,13 @@ static void compileFunction(AstNode* node) {
 static void compileWhile(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileWhile);
     
+    emitLoopMarker(node, vectorize_analyze_loop(node, irVariableType));
+    emitProfileCounter(PROFILE_SITE_LOOP_ENTRY, node);
     emit("while (");
     compileExpression(node->whileStmt.condition);
     emitLine(") {");
     indent();
+    emitProfileCounter(PROFILE_SITE_LOOP_BODY, node);
     
     for (int i = 0; i < node->whileStmt.bodyCount; i++) {
         compileNode(node->whileStmt.body[i]);
@@ -1852,19 +3176,214 @@ static void compileWhile(AstNode* node) {
 static void compileDoWhile(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileDoWhile);
     
+    emitLoopMarker(node, vectorize_analyze_loop(node, irVariableType));
+    emitProfileCounter(PROFILE_SITE_LOOP_ENTRY, node);
     emitLine("do {");
     indent();
+    emitProfileCounter(PROFILE_SITE_LOOP_BODY, node);
     
     for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
         compileNode(node->doWhileStmt.body[i]);
     }
     
     outdent();
+    // La condición pertenece al do-while, no a la última sentencia del cuerpo
+    if (node->line > 0) {
+        statementLine = node->line;
+    }
     emit("} while (");
     compileExpression(node->doWhileStmt.condition);
     emitLine(");");
 }
 
+/**
+ * @brief Emits the label and displacement tables of a perfect-hash switch
+ *
+ * @param id Number of the switch, which names its tables
+ * @param plan Plan with the perfect hash
+ * @param labels String literal labels
+ */
+static void emitHashTables(int id, const DispatchPlan* plan, AstNode** labels) {
+    int level = indentLevel;
+    emit("static const char* const __lyn_labels%d[%d] = {", id, plan->table_size);
+    indentLevel = 0;  // Cada tabla ocupa una sola línea
+    for (int slot = 0; slot < plan->table_size; slot++) {
+        emit("%s\"%s\"", slot > 0 ? ", " : "", labels[plan->slot_labels[slot]]->stringLiteral.value);
+    }
+    emit("};\n");
+    indentLevel = level;
+    emit("static const int32_t __lyn_disp%d[%d] = {", id, plan->table_size);
+    indentLevel = 0;
+    for (int bucket = 0; bucket < plan->table_size; bucket++) {
+        emit("%s%d", bucket > 0 ? ", " : "", (int)plan->displacements[bucket]);
+    }
+    emit("};\n");
+    indentLevel = level;
+}
+
+/**
+ * @brief Compiles a switch statement or a pattern match
+ *
+ * Both run the first arm whose label equals the scrutinee, and only that
+ * arm. dispatch_plan() chooses how the arm is found: a C switch for integer
+ * labels, a perfect hash and one strcmp for string labels, or one comparison
+ * per label with the scrutinee evaluated once. The arms always end up in a
+ * C switch, so `break` inside an arm leaves it whatever the lowering.
+ *
+ * @param node AST_SWITCH_STMT or AST_PATTERN_MATCH node
+ */
+static void compileDispatch(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compileDispatch);
+
+    bool isMatch = node->type == AST_PATTERN_MATCH;
+    AstNode* scrutinee = isMatch ? node->patternMatch.expr : node->switchStmt.expr;
+    int count = isMatch ? node->patternMatch.caseCount : node->switchStmt.caseCount;
+    AstNode** defaultBody = NULL;
+    int defaultCount = 0;
+    bool hasDefault = false;
+    if (isMatch && node->patternMatch.otherwise) {
+        defaultBody = node->patternMatch.otherwise->patternCase.body;
+        defaultCount = node->patternMatch.otherwise->patternCase.bodyCount;
+        hasDefault = true;
+    } else if (!isMatch && node->switchStmt.defaultCase) {
+        defaultBody = node->switchStmt.defaultCase;
+        defaultCount = node->switchStmt.defaultCaseCount;
+        hasDefault = true;
+    }
+
+    AstNode** labels = malloc((count > 0 ? count : 1) * sizeof(AstNode*));
+    int* slots = malloc((count > 0 ? count : 1) * sizeof(int));
+    if (!labels || !slots) {
+        free(labels);
+        free(slots);
+        error_report("Compiler", __LINE__, 0, "Failed to allocate the switch labels", ERROR_MEMORY);
+        return;
+    }
+    for (int i = 0; i < count; i++) {
+        labels[i] = isMatch ? node->patternMatch.cases[i]->patternCase.pattern
+                            : node->switchStmt.cases[i]->caseStmt.expr;
+    }
+
+    const char* type = inferType(scrutinee);
+    DispatchScrutinee scrutineeKind = DISPATCH_SCRUTINEE_OTHER;
+    if (isIntegerType(type) || isBooleanType(type)) {
+        scrutineeKind = DISPATCH_SCRUTINEE_INTEGER;
+    } else if (isStringType(type)) {
+        scrutineeKind = DISPATCH_SCRUTINEE_STRING;
+    }
+    DispatchPlan plan;
+    if (!dispatch_plan(labels, count, scrutineeKind, &plan)) {
+        free(labels);
+        free(slots);
+        return;
+    }
+
+    const char* what = isMatch ? "match" : "switch";
+    int id = ++dispatchCount;
+    int distinct = 0;
+    for (int i = 0; i < count; i++) {
+        if (plan.reachable[i]) {
+            distinct++;
+        } else {
+            remarks_emit(REMARK_APPLIED, "dispatch", labels[i], "%s arm dropped: its label repeats an earlier one", what);
+        }
+    }
+
+    switch (plan.kind) {
+        case DISPATCH_JUMP_TABLE:
+            remarks_emit(REMARK_APPLIED, "dispatch", node, "%s on %d integer label%s lowered to a C switch (%s)",
+                         what, distinct, distinct == 1 ? "" : "s", plan.dense ? "dense: jump table" : "sparse");
+            emit("switch (");
+            compileExpression(scrutinee);
+            emitLine(") {");
+            break;
+
+        case DISPATCH_PERFECT_HASH:
+            remarks_emit(REMARK_APPLIED, "dispatch", node, "%s on %d string labels lowered to a perfect hash and one strcmp",
+                         what, distinct);
+            // La tabla tiene una ranura por etiqueta distinta, sin huecos
+            for (int slot = 0; slot < plan.table_size; slot++) {
+                slots[plan.slot_labels[slot]] = slot;
+            }
+            emitLine("{");
+            indent();
+            emit("const char* __lyn_sw%d = ", id);
+            compileExpression(scrutinee);
+            emitLine(";");
+            emitHashTables(id, &plan, labels);
+            emitLine("switch (lyn_string_slot(__lyn_sw%d, __lyn_labels%d, __lyn_disp%d, %du)) {",
+                     id, id, id, plan.table_size);
+            break;
+
+        case DISPATCH_COMPARE:
+            remarks_emit(REMARK_MISSED, "dispatch", node, "%s compared label by label: %s", what, plan.reason);
+            // El scrutinee se evalúa una sola vez; las etiquetas, en orden hasta la primera que coincide
+            emitLine("{");
+            indent();
+            emit("const __auto_type __lyn_sw%d = ", id);
+            compileExpression(scrutinee);
+            emitLine(";");
+            emitLine("int __lyn_arm%d = -1;", id);
+            for (int i = 0; i < count; i++) {
+                emit(i == 0 ? "if (" : "else if (");
+                if (scrutineeKind == DISPATCH_SCRUTINEE_STRING ||
+                    (labels[i] && labels[i]->type == AST_STRING_LITERAL)) {
+                    emit("__lyn_sw%d && strcmp(__lyn_sw%d, ", id, id);
+                    compileExpression(labels[i]);
+                    emit(") == 0");
+                } else {
+                    emit("__lyn_sw%d == (", id);
+                    compileExpression(labels[i]);
+                    emit(")");
+                }
+                emitLine(") __lyn_arm%d = %d;", id, i);
+            }
+            emitLine("switch (__lyn_arm%d) {", id);
+            break;
+    }
+
+    indent();
+    for (int i = 0; i < count; i++) {
+        if (!plan.reachable[i]) continue;
+        if (plan.kind == DISPATCH_JUMP_TABLE) {
+            emitLine("case %lld:", plan.values[i]);
+        } else if (plan.kind == DISPATCH_PERFECT_HASH) {
+            emitLine("case %d: // \"%s\"", slots[i], labels[i]->stringLiteral.value);
+        } else {
+            emitLine("case %d:", i);
+        }
+        indent();
+        AstNode** body = isMatch ? node->patternMatch.cases[i]->patternCase.body
+                                 : node->switchStmt.cases[i]->caseStmt.body;
+        int bodyCount = isMatch ? node->patternMatch.cases[i]->patternCase.bodyCount
+                                : node->switchStmt.cases[i]->caseStmt.bodyCount;
+        for (int j = 0; j < bodyCount; j++) {
+            compileNode(body[j]);
+        }
+        emitLine("break;");
+        outdent();
+    }
+    if (hasDefault) {
+        emitLine("default:");
+        indent();
+        for (int i = 0; i < defaultCount; i++) {
+            compileNode(defaultBody[i]);
+        }
+        emitLine("break;");
+        outdent();
+    }
+    outdent();
+    emitLine("}");
+    if (plan.kind != DISPATCH_JUMP_TABLE) {
+        outdent();
+        emitLine("}");
+    }
+
+    dispatch_free_plan(&plan);
+    free(labels);
+    free(slots);
+}
+
 bool compileToC(AstNode* ast, const char* outputPath) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileToC);
     
@@ -1964,8 +3483,7 @@ static const char* inferType(AstNode* node) {
     
     switch (node->type) {
         case AST_NUMBER_LITERAL: {
-            double value = node->numberLiteral.value;
-            result = value == (int)value ? "int" : "double";
+            result = isIntLiteral(node) ? "int64_t" : "double";
             break;
         }
         case AST_STRING_LITERAL:
@@ -1974,6 +3492,25 @@ static const char* inferType(AstNode* node) {
         case AST_BOOLEAN_LITERAL:
             result = "bool";
             break;
+        case AST_BINARY_OP:
+            // '+' con un operando de cadena se compila como concatenación
+            if (isStringConcat(node)) {
+                result = "char*";
+            } else if (!isArithmeticOperator(node->binaryOp.op) ||
+                       (isIntegerType(inferType(node->binaryOp.left)) &&
+                        isIntegerType(inferType(node->binaryOp.right)))) {
+                // Comparaciones, lógica y aritmética entre enteros: enteras, sin pasar por double
+                result = "int64_t";
+            }
+            break;
+        case AST_UNARY_OP:
+            if (node->unaryOp.op == 'N' || isIntegerType(inferType(node->unaryOp.expr))) {
+                result = "int64_t";
+            }
+            break;
+        case AST_CONCAT_EXPR:
+            result = "char*";
+            break;
         case AST_IDENTIFIER:
             result = isVariableDeclared(node->identifier.name) ?
                    getVariableType(node->identifier.name) : "double";
@@ -1983,10 +3520,53 @@ static const char* inferType(AstNode* node) {
                 static char fullType[64];
                 snprintf(fullType, sizeof(fullType), "%s*", node->funcCall.name + 4);
                 result = fullType;
+            } else {
+                // Las funciones del programa devuelven el tipo declarado
+                const char* returnType = callReturnType(node->funcCall.name);
+                result = returnType ? returnType : "double";
+            }
+            break;
+        case AST_NEW_EXPR:
+            if (findBuiltinClass(node->newExpr.className)) {
+                static char newType[sizeof(node->newExpr.className) + 1];
+                snprintf(newType, sizeof(newType), "%s*", node->newExpr.className);
+                result = newType;
             } else {
                 result = "double";
             }
             break;
+        case AST_ARRAY_LITERAL: {
+            const char* elementType = arrayLiteralElementType(node);
+            if (!elementType) result = "double";
+            else if (strcmp(elementType, "int64_t") == 0) result = "int64_t*";
+            else if (strcmp(elementType, "double") == 0) result = "double*";
+            else result = "const char**";
+            break;
+        }
+        case AST_ARRAY_ACCESS: {
+            AstNode* array = node->arrayAccess.array;
+            const char* elementType = array && array->type == AST_IDENTIFIER &&
+                                      isVariableDeclared(array->identifier.name) ?
+                                      arrayElementOf(getVariableType(array->identifier.name)) : NULL;
+            result = elementType ? elementType : "double";
+            break;
+        }
+        case AST_MEMBER_ACCESS: {
+            // Campos de las clases predefinidas: el tipo declarado en su estructura
+            AstNode* object = node->memberAccess.object;
+            if (isArrayLength(node)) {
+                result = "int64_t";
+                break;
+            }
+            const BuiltinClass* cls = NULL;
+            if (object && object->type == AST_IDENTIFIER) {
+                ObjectAllocation* entry = findObjectAllocation(object->identifier.name);
+                cls = entry ? entry->cls : objectVariableClass(object->identifier.name);
+            }
+            int field = cls ? findBuiltinField(cls, node->memberAccess.member) : -1;
+            result = field >= 0 ? cls->fieldTypes[field] : "double";
+            break;
+        }
         default:
             result = "double";
             break;
@@ -2051,7 +3631,8 @@ void check_assignment_types(AstNode* node) {
 
 /* Type checking helper functions */
 static bool isIntegerType(const char* type) {
-    return (strcmp(type, "int") == 0);
+    // int64_t for Lyn integers; int for fields of the built-in classes
+    return (strcmp(type, "int64_t") == 0 || strcmp(type, "int") == 0);
 }
 
 static bool isFloatType(const char* type) {
@@ -2139,9 +3720,13 @@ void check_function_call_types(AstNode* node) {
         
         // Check first arg is a Point
         if (node->funcCall.arguments[0]) {
-            Type* arg_type = infer_type(node->funcCall.arguments[0]);
-            if (arg_type->kind != TYPE_CLASS || 
-                strcmp(arg_type->typeName, "Point") != 0) {
+            // Las variables asignadas con new_Point() ya tienen tipo en la tabla del compilador
+            AstNode* self = node->funcCall.arguments[0];
+            const BuiltinClass* selfClass = self->type == AST_IDENTIFIER ?
+                                            objectVariableClass(self->identifier.name) : NULL;
+            Type* arg_type = infer_type(self);
+            if ((!selfClass || strcmp(selfClass->name, "Point") != 0) &&
+                (arg_type->kind != TYPE_CLASS || strcmp(arg_type->typeName, "Point") != 0)) {
                 char error_msg[256];
                 snprintf(error_msg, sizeof(error_msg), 
                         "First argument to 'Point_init' must be a Point object, got %s", 
@@ -2170,6 +3755,20 @@ void check_function_call_types(AstNode* node) {
     }
 }
 
+/* Funciones comunes que se generan para todo módulo importado */
+#define DEFAULT_MODULE_MEMBER_COUNT 5
+static const char* defaultModuleMembers[DEFAULT_MODULE_MEMBER_COUNT] = {
+    "add", "subtract", "multiply", "divide", "version"
+};
+
+/* defaultModuleMemberIndex: Posición de un miembro común de módulo, o -1 */
+static int defaultModuleMemberIndex(const char* member) {
+    for (int i = 0; i < DEFAULT_MODULE_MEMBER_COUNT; i++) {
+        if (strcmp(defaultModuleMembers[i], member) == 0) return i;
+    }
+    return -1;
+}
+
 /* compileImport: Compila una declaración de importación */
 static void compileImport(AstNode* node) {
     if (!node || node->type != AST_IMPORT) {
@@ -2212,26 +3811,42 @@ static void compileImport(AstNode* node) {
             importedModuleCount++;
         }
         
+        // Solo se generan los miembros que el código alcanzable usa (ver treeshake.c):
+        // campo de la estructura, implementación e inicializador van juntos
+        const char* moduleName = node->importStmt.moduleName;
+        bool usedDefaults[DEFAULT_MODULE_MEMBER_COUNT];
+        for (int i = 0; i < DEFAULT_MODULE_MEMBER_COUNT; i++) {
+            usedDefaults[i] = treeshake_module_member_used(moduleName, defaultModuleMembers[i]);
+            if (!usedDefaults[i]) stats.module_members_pruned++;
+        }
+        
+        // Símbolos selectivos que no coinciden con una función común del módulo
+        int symbolCount = node->importStmt.hasSymbolList ? node->importStmt.symbolCount : 0;
+        bool* usedSymbols = symbolCount > 0 ? calloc(symbolCount, sizeof(bool)) : NULL;
+        for (int i = 0; usedSymbols && i < symbolCount; i++) {
+            const char* symbolName = node->importStmt.symbols[i];
+            if (defaultModuleMemberIndex(symbolName) >= 0) continue;
+            usedSymbols[i] = treeshake_module_member_used(moduleName, symbolName);
+            if (!usedSymbols[i]) stats.module_members_pruned++;
+        }
+        
         // Generar estructura para funciones del módulo
         emitLine("// Estructura para funciones del módulo %s", sanitizedModuleName);
         emitLine("typedef struct {");
         indent();
 
         // Añadimos funciones comunes que se esperan en la mayoría de módulos
-        emitLine("double (*add)(int contextID, double a, double b);");
-        emitLine("double (*subtract)(int contextID, double a, double b);");
-        emitLine("double (*multiply)(int contextID, double a, double b);");
-        emitLine("double (*divide)(int contextID, double a, double b);");
-        emitLine("const char* (*version)(int contextID);");
+        if (usedDefaults[0]) emitLine("double (*add)(int contextID, double a, double b);");
+        if (usedDefaults[1]) emitLine("double (*subtract)(int contextID, double a, double b);");
+        if (usedDefaults[2]) emitLine("double (*multiply)(int contextID, double a, double b);");
+        if (usedDefaults[3]) emitLine("double (*divide)(int contextID, double a, double b);");
+        if (usedDefaults[4]) emitLine("const char* (*version)(int contextID);");
         
         // Para imports selectivos, si hay una lista de símbolos específicos
-        if (node->importStmt.hasSymbolList && node->importStmt.symbolCount > 0) {
-            for (int i = 0; i < node->importStmt.symbolCount; i++) {
-                // Generar declaración para cada símbolo específico
-                const char* symbolName = node->importStmt.symbols[i];
-                
-                // Por defecto asumimos que el símbolo es una función que devuelve double
-                emitLine("double (*%s)(int contextID, double a, double b);", symbolName);
+        for (int i = 0; usedSymbols && i < symbolCount; i++) {
+            // Por defecto asumimos que el símbolo es una función que devuelve double
+            if (usedSymbols[i]) {
+                emitLine("double (*%s)(int contextID, double a, double b);", node->importStmt.symbols[i]);
             }
         }
         
@@ -2242,82 +3857,92 @@ static void compileImport(AstNode* node) {
         emitLine("// Implementaciones predeterminadas para el módulo %s", sanitizedModuleName);
         
         // Función add
-        emitLine("double %s_add(int contextID, double a, double b) {", sanitizedModuleName);
-        indent();
-        emitLine("// Implementación predeterminada");
-        emitLine("return a + b;");
-        outdent();
-        emitLine("}");
+        if (usedDefaults[0]) {
+            emitLine("double %s_add(int contextID, double a, double b) {", sanitizedModuleName);
+            indent();
+            emitLine("// Implementación predeterminada");
+            emitLine("return a + b;");
+            outdent();
+            emitLine("}");
+        }
         
         // Función subtract
-        emitLine("double %s_subtract(int contextID, double a, double b) {", sanitizedModuleName);
-        indent();
-        emitLine("// Implementación predeterminada");
-        emitLine("return a - b;");
-        outdent();
-        emitLine("}");
+        if (usedDefaults[1]) {
+            emitLine("double %s_subtract(int contextID, double a, double b) {", sanitizedModuleName);
+            indent();
+            emitLine("// Implementación predeterminada");
+            emitLine("return a - b;");
+            outdent();
+            emitLine("}");
+        }
         
         // Función multiply
-        emitLine("double %s_multiply(int contextID, double a, double b) {", sanitizedModuleName);
-        indent();
-        emitLine("// Implementación predeterminada");
-        emitLine("return a * b;");
-        outdent();
-        emitLine("}");
+        if (usedDefaults[2]) {
+            emitLine("double %s_multiply(int contextID, double a, double b) {", sanitizedModuleName);
+            indent();
+            emitLine("// Implementación predeterminada");
+            emitLine("return a * b;");
+            outdent();
+            emitLine("}");
+        }
         
         // Función divide
-        emitLine("double %s_divide(int contextID, double a, double b) {", sanitizedModuleName);
-        indent();
-        emitLine("// Implementación predeterminada");
-        emitLine("if (b == 0) {");
-        indent();
-        emitLine("fprintf(stderr, \"Error: División por cero\\n\");");
-        emitLine("return 0;");
-        outdent();
-        emitLine("}");
-        emitLine("return a / b;");
-        outdent();
-        emitLine("}");
+        if (usedDefaults[3]) {
+            emitLine("double %s_divide(int contextID, double a, double b) {", sanitizedModuleName);
+            indent();
+            emitLine("// Implementación predeterminada");
+            emitLine("if (b == 0) {");
+            indent();
+            emitLine("fprintf(stderr, \"Error: División por cero\\n\");");
+            emitLine("return 0;");
+            outdent();
+            emitLine("}");
+            emitLine("return a / b;");
+            outdent();
+            emitLine("}");
+        }
         
         // Función version
-        emitLine("const char* %s_version(int contextID) {", sanitizedModuleName);
-        indent();
-        emitLine("return \"1.0.0\";");
-        outdent();
-        emitLine("}");
+        if (usedDefaults[4]) {
+            emitLine("const char* %s_version(int contextID) {", sanitizedModuleName);
+            indent();
+            emitLine("return \"1.0.0\";");
+            outdent();
+            emitLine("}");
+        }
         
         // Para imports selectivos, proporcionar implementaciones predeterminadas
-        if (node->importStmt.hasSymbolList && node->importStmt.symbolCount > 0) {
-            for (int i = 0; i < node->importStmt.symbolCount; i++) {
-                const char* symbolName = node->importStmt.symbols[i];
-                
-                // Implementación predeterminada para la función específica
-                emitLine("double %s_%s(int contextID, double a, double b) {", sanitizedModuleName, symbolName);
-                indent();
-                emitLine("// Implementación genérica para %s", symbolName);
-                emitLine("return a + b; // Implementación predeterminada");
-                outdent();
-                emitLine("}");
-            }
+        for (int i = 0; usedSymbols && i < symbolCount; i++) {
+            if (!usedSymbols[i]) continue;
+            const char* symbolName = node->importStmt.symbols[i];
+            
+            // Implementación predeterminada para la función específica
+            emitLine("double %s_%s(int contextID, double a, double b) {", sanitizedModuleName, symbolName);
+            indent();
+            emitLine("// Implementación genérica para %s", symbolName);
+            emitLine("return a + b; // Implementación predeterminada");
+            outdent();
+            emitLine("}");
         }
         
         // Instancia de la estructura del módulo
         emitLine("// Instancia de la estructura del módulo");
         emitLine("%s_Module %s = {", sanitizedModuleName, sanitizedModuleName);
         indent();
-        emitLine(".add = %s_add,", sanitizedModuleName);
-        emitLine(".subtract = %s_subtract,", sanitizedModuleName);
-        emitLine(".multiply = %s_multiply,", sanitizedModuleName);
-        emitLine(".divide = %s_divide,", sanitizedModuleName);
-        emitLine(".version = %s_version,", sanitizedModuleName);
+        for (int i = 0; i < DEFAULT_MODULE_MEMBER_COUNT; i++) {
+            if (usedDefaults[i]) {
+                emitLine(".%s = %s_%s,", defaultModuleMembers[i], sanitizedModuleName, defaultModuleMembers[i]);
+            }
+        }
         
         // Para imports selectivos, asignar funciones específicas
-        if (node->importStmt.hasSymbolList && node->importStmt.symbolCount > 0) {
-            for (int i = 0; i < node->importStmt.symbolCount; i++) {
+        for (int i = 0; usedSymbols && i < symbolCount; i++) {
+            if (usedSymbols[i]) {
                 const char* symbolName = node->importStmt.symbols[i];
                 emitLine(".%s = %s_%s,", symbolName, sanitizedModuleName, symbolName);
             }
         }
+        free(usedSymbols);
         
         outdent();
         emitLine("};");
@@ -2345,6 +3970,12 @@ static void compileImport(AstNode* node) {
             const char* symbolAlias = node->importStmt.aliases && node->importStmt.aliases[i] ? 
                                        node->importStmt.aliases[i] : symbolName;
             
+            // Sin llamadas al nombre local el wrapper sobra
+            if (!treeshake_symbol_used(symbolAlias)) {
+                stats.module_members_pruned++;
+                continue;
+            }
+            
             // Crear una función wrapper para simplificar el acceso
             emitLine("// Función wrapper para %s (alias: %s)", symbolName, symbolAlias);
             emitLine("double %s(double a, double b) {", symbolAlias);
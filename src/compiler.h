@@ -25,6 +25,10 @@ typedef struct {
     int functions_compiled;   ///< Number of functions successfully compiled
     int variables_declared;   ///< Number of variables declared and managed
     int type_errors_detected; ///< Number of type-related errors encountered
+    int objects_heap_allocated;   ///< Allocations kept on the heap because the object escapes
+    int objects_stack_allocated;  ///< Non-escaping objects emitted as stack structs
+    int objects_scalar_replaced;  ///< Non-escaping objects split into one local per field
+    int module_members_pruned;    ///< Module stubs and wrappers not emitted because nothing uses them
 } CompilerStats;
 
 /**
@@ -37,6 +41,17 @@ typedef struct {
  */
 void compiler_set_debug_level(int level);
 
+/**
+ * @brief Enables emitting the program body through the SSA IR
+ * 
+ * When enabled, the statements of the program body are lowered to the IR
+ * (see ir.h), optimized there and emitted from it. Bodies using constructs
+ * the IR does not model are compiled directly from the AST as before.
+ * 
+ * @param enabled true to use the IR path when possible
+ */
+void compiler_set_use_ir(bool enabled);
+
 /**
  * @brief Retrieves the current compiler statistics
  * 
@@ -0,0 +1,296 @@
+/**
+ * @file dispatch.c
+ * @brief Implementation of the switch and match lowering plans
+ *
+ * The perfect hash follows the hash-and-displace scheme. Every label is
+ * hashed once and falls in the bucket hash % n, where n is the number of
+ * distinct labels. Buckets are placed largest first: a bucket with several
+ * labels searches for a displacement under which the mixed hashes of all its
+ * labels land in free slots, and a bucket with a single label takes the next
+ * free slot directly, recorded as a negative entry. Every slot ends up with
+ * exactly one label, so the table needs no empty slots and at run time one
+ * strcmp against the label in the selected slot decides the arm.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "dispatch.h"
+#include "error.h"
+#include "logger.h"
+
+/** Displacements tried for one bucket before the labels are compared instead */
+#define DISPATCH_MAX_DISPLACEMENT (1 << 20)
+
+/** Statistics */
+static DispatchStats stats = {0};
+
+uint32_t dispatch_string_hash(const char* text) {
+    uint32_t hash = 2166136261u;
+    for (const unsigned char* c = (const unsigned char*)text; *c; c++) {
+        hash ^= *c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+uint32_t dispatch_slot(uint32_t hash, int32_t displacement, uint32_t size) {
+    if (displacement < 0) {
+        return (uint32_t)(-(displacement + 1));
+    }
+    uint32_t mixed = hash ^ ((uint32_t)displacement * 0x85EBCA6Bu);
+    mixed ^= mixed >> 16;
+    mixed *= 0x7FEB352Du;
+    mixed ^= mixed >> 15;
+    mixed *= 0x846CA68Bu;
+    mixed ^= mixed >> 16;
+    return mixed % size;
+}
+
+/**
+ * @brief Evaluates a label made of integer literals
+ *
+ * Negative labels are written `0 - n`, which is folded only when the
+ * optimizer runs, so sums and differences of constants are accepted too.
+ *
+ * @param label Label expression
+ * @param value Output: its value
+ * @return bool true if the label is an integer constant
+ */
+static bool integer_label(const AstNode* label, long long* value) {
+    if (isIntegerLiteral(label)) {
+        *value = integerLiteralValue(label);
+        return true;
+    }
+    long long left, right;
+    if (!label || label->type != AST_BINARY_OP ||
+        (label->binaryOp.op != '+' && label->binaryOp.op != '-') ||
+        !integer_label(label->binaryOp.left, &left) || !integer_label(label->binaryOp.right, &right)) {
+        return false;
+    }
+    long long result = label->binaryOp.op == '+' ? left + right : left - right;
+    if ((double)result > AST_MAX_EXACT_INTEGER || (double)result < -AST_MAX_EXACT_INTEGER) {
+        return false;
+    }
+    *value = result;
+    return true;
+}
+
+/**
+ * @brief Checks whether a label is a string whose run-time bytes are known
+ *
+ * String literals are emitted into the C source as written, so a backslash
+ * starts an escape sequence whose bytes the C compiler decides.
+ *
+ * @param label Label expression
+ * @return bool true if the label can be hashed at compile time
+ */
+static bool hashable_label(const AstNode* label) {
+    return label && label->type == AST_STRING_LITERAL && !strchr(label->stringLiteral.value, '\\');
+}
+
+/**
+ * @brief Switches a plan to label-by-label comparison
+ *
+ * @param plan Plan to change
+ * @param reason Why the labels cannot be dispatched otherwise
+ */
+static void compare_labels(DispatchPlan* plan, const char* reason) {
+    plan->kind = DISPATCH_COMPARE;
+    for (int i = 0; i < plan->label_count; i++) {
+        plan->reachable[i] = true;
+    }
+    snprintf(plan->reason, sizeof(plan->reason), "%s", reason);
+}
+
+/**
+ * @brief Builds the perfect hash of the distinct string labels
+ *
+ * @param labels String literal labels
+ * @param plan Plan with reachable[] filled in
+ * @param distinct Number of reachable labels
+ * @return bool true if every label got its own slot
+ */
+static bool build_perfect_hash(AstNode** labels, DispatchPlan* plan, int distinct) {
+    int size = distinct;
+    uint32_t* hashes = malloc(plan->label_count * sizeof(uint32_t));
+    int* bucketSizes = calloc(size, sizeof(int));
+    int* order = malloc(size * sizeof(int));
+    int* members = malloc(distinct * sizeof(int));
+    uint32_t* slots = malloc(distinct * sizeof(uint32_t));
+    plan->displacements = calloc(size, sizeof(int32_t));
+    plan->slot_labels = malloc(size * sizeof(int));
+    if (!hashes || !bucketSizes || !order || !members || !slots || !plan->displacements || !plan->slot_labels) {
+        free(hashes);
+        free(bucketSizes);
+        free(order);
+        free(members);
+        free(slots);
+        return false;
+    }
+    plan->table_size = size;
+
+    for (int i = 0; i < plan->label_count; i++) {
+        if (!plan->reachable[i]) continue;
+        hashes[i] = dispatch_string_hash(labels[i]->stringLiteral.value);
+        bucketSizes[hashes[i] % size]++;
+    }
+    for (int slot = 0; slot < size; slot++) {
+        plan->slot_labels[slot] = -1;
+    }
+
+    // Largest buckets first, while most slots are still free
+    for (int b = 0; b < size; b++) {
+        int at = b;
+        while (at > 0 && bucketSizes[order[at - 1]] < bucketSizes[b]) {
+            order[at] = order[at - 1];
+            at--;
+        }
+        order[at] = b;
+    }
+
+    bool placed = true;
+    int nextFree = 0;
+    for (int o = 0; o < size && placed; o++) {
+        int bucket = order[o];
+        if (bucketSizes[bucket] == 0) break;
+
+        int count = 0;
+        for (int i = 0; i < plan->label_count; i++) {
+            if (plan->reachable[i] && (int)(hashes[i] % size) == bucket) members[count++] = i;
+        }
+
+        if (count == 1) {
+            while (plan->slot_labels[nextFree] >= 0) nextFree++;
+            plan->slot_labels[nextFree] = members[0];
+            plan->displacements[bucket] = -(nextFree + 1);
+            continue;
+        }
+
+        placed = false;
+        for (int32_t d = 0; d < DISPATCH_MAX_DISPLACEMENT && !placed; d++) {
+            placed = true;
+            for (int m = 0; m < count && placed; m++) {
+                slots[m] = dispatch_slot(hashes[members[m]], d, size);
+                if (plan->slot_labels[slots[m]] >= 0) placed = false;
+                for (int k = 0; k < m && placed; k++) {
+                    if (slots[k] == slots[m]) placed = false;
+                }
+            }
+            if (placed) {
+                for (int m = 0; m < count; m++) {
+                    plan->slot_labels[slots[m]] = members[m];
+                }
+                plan->displacements[bucket] = d;
+            }
+        }
+    }
+
+    free(hashes);
+    free(bucketSizes);
+    free(order);
+    free(members);
+    free(slots);
+    return placed;
+}
+
+bool dispatch_plan(AstNode** labels, int count, DispatchScrutinee scrutinee, DispatchPlan* plan) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)dispatch_plan);
+
+    memset(plan, 0, sizeof(*plan));
+    plan->label_count = count;
+    plan->reachable = malloc((count > 0 ? count : 1) * sizeof(bool));
+    plan->values = malloc((count > 0 ? count : 1) * sizeof(long long));
+    if (!plan->reachable || !plan->values) {
+        dispatch_free_plan(plan);
+        error_report("Dispatch", __LINE__, 0, "Failed to allocate switch lowering plan", ERROR_MEMORY);
+        return false;
+    }
+
+    bool integers = true;
+    bool strings = true;
+    for (int i = 0; i < count; i++) {
+        plan->reachable[i] = true;
+        integers = integers && integer_label(labels[i], &plan->values[i]);
+        strings = strings && labels[i] && labels[i]->type == AST_STRING_LITERAL;
+    }
+
+    if (integers && scrutinee == DISPATCH_SCRUTINEE_INTEGER) {
+        plan->kind = DISPATCH_JUMP_TABLE;
+        int distinct = 0;
+        long long low = 0, high = 0;
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < i && plan->reachable[i]; j++) {
+                if (plan->reachable[j] && plan->values[j] == plan->values[i]) plan->reachable[i] = false;
+            }
+            if (!plan->reachable[i]) continue;
+            if (distinct == 0 || plan->values[i] < low) low = plan->values[i];
+            if (distinct == 0 || plan->values[i] > high) high = plan->values[i];
+            distinct++;
+        }
+        plan->dense = distinct > 0 && (double)high - (double)low < (double)distinct * DISPATCH_DENSITY;
+        stats.jump_tables++;
+        stats.unreachable_labels += count - distinct;
+        return true;
+    }
+
+    if (strings && scrutinee == DISPATCH_SCRUTINEE_STRING) {
+        int distinct = 0;
+        bool escaped = false;
+        for (int i = 0; i < count; i++) {
+            escaped = escaped || !hashable_label(labels[i]);
+            for (int j = 0; j < i && plan->reachable[i]; j++) {
+                if (plan->reachable[j] &&
+                    strcmp(labels[j]->stringLiteral.value, labels[i]->stringLiteral.value) == 0) {
+                    plan->reachable[i] = false;
+                }
+            }
+            if (plan->reachable[i]) distinct++;
+        }
+
+        char reason[128];
+        if (escaped) {
+            snprintf(reason, sizeof(reason), "a label holds an escape sequence");
+        } else if (distinct < DISPATCH_MIN_HASHED_LABELS) {
+            snprintf(reason, sizeof(reason), "fewer than %d distinct string labels", DISPATCH_MIN_HASHED_LABELS);
+        } else if (!build_perfect_hash(labels, plan, distinct)) {
+            snprintf(reason, sizeof(reason), "no perfect hash found for the labels");
+        } else {
+            plan->kind = DISPATCH_PERFECT_HASH;
+            stats.perfect_hashes++;
+            stats.unreachable_labels += count - distinct;
+            logger_log(LOG_DEBUG, "Perfect hash of %d string labels built", distinct);
+            return true;
+        }
+        compare_labels(plan, reason);
+        stats.compare_chains++;
+        return true;
+    }
+
+    if (integers && count > 0) {
+        compare_labels(plan, "the scrutinee is not an integer");
+    } else if (strings && count > 0) {
+        compare_labels(plan, "the scrutinee is not a string");
+    } else if (scrutinee == DISPATCH_SCRUTINEE_OTHER) {
+        compare_labels(plan, "the scrutinee is neither an integer nor a string");
+    } else {
+        compare_labels(plan, "the labels are not all constants");
+    }
+    stats.compare_chains++;
+    return true;
+}
+
+void dispatch_free_plan(DispatchPlan* plan) {
+    free(plan->reachable);
+    free(plan->values);
+    free(plan->displacements);
+    free(plan->slot_labels);
+    plan->reachable = NULL;
+    plan->values = NULL;
+    plan->displacements = NULL;
+    plan->slot_labels = NULL;
+}
+
+DispatchStats dispatch_get_stats(void) {
+    return stats;
+}
@@ -0,0 +1,125 @@
+/**
+ * @file dispatch.h
+ * @brief Lowering plans for switch statements and pattern matches
+ *
+ * A switch or match picks one arm by comparing its scrutinee with the case
+ * labels. Compared label by label, dispatch costs one comparison per case
+ * (one strcmp per case for strings). This module chooses a better lowering
+ * from the labels:
+ * - Integer labels become a C switch, which the C compiler turns into a
+ *   jump table when the labels are dense
+ * - String labels get a minimal perfect hash computed at compile time
+ *   (hash and displace): at run time the scrutinee is hashed once, the hash
+ *   selects one slot, and a single strcmp against the label in that slot
+ *   decides the arm
+ * - Anything else is compared label by label, in order, with the scrutinee
+ *   evaluated once
+ *
+ * Only the first arm with a given label can run, so later duplicates are
+ * marked unreachable and left out.
+ */
+
+#ifndef DISPATCH_H
+#define DISPATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ast.h"
+
+/** Fewest string labels worth hashing; below it a few strcmp calls are cheaper */
+#define DISPATCH_MIN_HASHED_LABELS 4
+
+/** Most slots per label for integer labels to count as dense */
+#define DISPATCH_DENSITY 4
+
+/**
+ * @brief How a switch or match is lowered
+ */
+typedef enum {
+    DISPATCH_JUMP_TABLE,     ///< C switch on integer labels
+    DISPATCH_PERFECT_HASH,   ///< Perfect hash of string labels and one strcmp
+    DISPATCH_COMPARE         ///< One comparison per label, in order
+} DispatchKind;
+
+/**
+ * @brief What is known about the type of the scrutinee
+ */
+typedef enum {
+    DISPATCH_SCRUTINEE_INTEGER,  ///< Integer or boolean
+    DISPATCH_SCRUTINEE_STRING,   ///< String
+    DISPATCH_SCRUTINEE_OTHER     ///< Floating point, objects, unknown
+} DispatchScrutinee;
+
+/**
+ * @brief Lowering chosen for one switch or match
+ */
+typedef struct {
+    DispatchKind kind;          ///< Chosen lowering
+    int label_count;            ///< Labels the plan was made for
+    bool* reachable;            ///< Per label: false when an earlier label is the same
+    long long* values;          ///< Per label: its value (DISPATCH_JUMP_TABLE)
+    bool dense;                 ///< Labels span at most DISPATCH_DENSITY slots each (DISPATCH_JUMP_TABLE)
+    int table_size;             ///< Slots of the hash table: one per distinct label (DISPATCH_PERFECT_HASH)
+    int32_t* displacements;     ///< Per bucket: seed (>= 0) or -(slot + 1) (DISPATCH_PERFECT_HASH)
+    int* slot_labels;           ///< Per slot: label hashed to it (DISPATCH_PERFECT_HASH)
+    char reason[128];           ///< Why the labels are compared one by one (DISPATCH_COMPARE)
+} DispatchPlan;
+
+/**
+ * @brief Statistics about lowered switches and matches
+ */
+typedef struct {
+    int jump_tables;            ///< Lowered to a C switch
+    int perfect_hashes;         ///< Lowered to a perfect hash
+    int compare_chains;         ///< Compared label by label
+    int unreachable_labels;     ///< Labels left out as duplicates
+} DispatchStats;
+
+/**
+ * @brief Chooses the lowering of a switch or match
+ *
+ * @param labels Case labels (case expressions or patterns), in source order
+ * @param count Number of labels
+ * @param scrutinee What is known about the type of the scrutinee
+ * @param plan Output: the lowering, to be released with dispatch_free_plan()
+ * @return bool true on success, false if memory ran out
+ */
+bool dispatch_plan(AstNode** labels, int count, DispatchScrutinee scrutinee, DispatchPlan* plan);
+
+/**
+ * @brief Releases the tables of a plan
+ *
+ * @param plan Plan filled by dispatch_plan()
+ */
+void dispatch_free_plan(DispatchPlan* plan);
+
+/**
+ * @brief Hashes a string (32-bit FNV-1a)
+ *
+ * The generated lyn_string_slot() must compute the same function.
+ *
+ * @param text String to hash
+ * @return uint32_t Hash
+ */
+uint32_t dispatch_string_hash(const char* text);
+
+/**
+ * @brief Gives the slot of a hashed string in a table of the given size
+ *
+ * The generated lyn_string_slot() must compute the same function.
+ *
+ * @param hash Hash of the string
+ * @param displacement Entry of the bucket the hash falls in
+ * @param size Slots in the table
+ * @return uint32_t Slot
+ */
+uint32_t dispatch_slot(uint32_t hash, int32_t displacement, uint32_t size);
+
+/**
+ * @brief Gets the dispatch statistics
+ *
+ * @return DispatchStats Current statistics
+ */
+DispatchStats dispatch_get_stats(void);
+
+#endif /* DISPATCH_H */
@@ -175,6 +175,15 @@ void error_set_source(const char* src) {
     sourceCode = src;
 }
 
+/**
+ * @brief Gets the source code currently used for context extraction
+ * 
+ * @return const char* Current source code, or NULL if none is set
+ */
+const char* error_get_source(void) {
+    return sourceCode;
+}
+
 /**
  * @brief Prints the last reported error with context and stack trace
  * 
@@ -67,6 +67,16 @@ void error_report(const char* module, int line, int col, const char* message, Er
  */
 void error_set_source(const char* source);
 
+/**
+ * @brief Gets the source code currently used for context extraction
+ * 
+ * Lets code that temporarily parses another file (e.g. a module) restore
+ * the previous source afterwards.
+ * 
+ * @return const char* Current source code, or NULL if none is set
+ */
+const char* error_get_source(void);
+
 /**
  * @brief Prints the most recent error with context and stack trace
  * 
@@ -0,0 +1,311 @@
+/**
+ * @file hashmap.c
+ * @brief Implementation of the generic string-keyed hash map
+ *
+ * This file implements a separate-chaining hash map with string keys and
+ * opaque pointer values. The bucket array always has a power-of-two size and
+ * is doubled when the load factor exceeds 3/4, so registries built on top of
+ * it have no fixed capacity limit. Each entry caches the full hash of its
+ * key, which keeps rehashing cheap and lets lookups skip most strcmp calls.
+ */
+
+#include "hashmap.h"
+#include "error.h"
+#include "logger.h"
+#include <stdlib.h>
+#include <string.h>
+
+/** Default number of buckets for a new map */
+#define HASHMAP_DEFAULT_BUCKETS 16
+
+/**
+ * @brief Entry in a hash bucket chain
+ */
+typedef struct HashMapEntry {
+    char* key;                  ///< Owned copy of the key
+    void* value;                ///< Caller-owned value
+    unsigned int hash;          ///< Cached hash of the key
+    struct HashMapEntry* next;  ///< Next entry in the same bucket
+} HashMapEntry;
+
+/**
+ * @brief Hash map structure
+ */
+struct HashMap {
+    HashMapEntry** buckets;     ///< Bucket array (size is a power of two)
+    int bucketCount;            ///< Number of buckets
+    int count;                  ///< Number of entries
+};
+
+/**
+ * @brief Computes the hash of a string key (32-bit FNV-1a)
+ *
+ * @param key String to hash
+ * @return unsigned int Hash value
+ */
+unsigned int hashmap_hash_string(const char* key) {
+    unsigned int hash = 2166136261u;
+    if (!key) return hash;
+    while (*key) {
+        hash ^= (unsigned char)*key++;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+/**
+ * @brief Finds the entry for a key
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @param hash Precomputed hash of the key
+ * @return HashMapEntry* Matching entry, or NULL if not found
+ */
+static HashMapEntry* find_entry(const HashMap* map, const char* key, unsigned int hash) {
+    HashMapEntry* entry = map->buckets[hash & (map->bucketCount - 1)];
+    while (entry) {
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            return entry;
+        }
+        entry = entry->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Doubles the bucket array and redistributes all entries
+ *
+ * @param map The map to grow
+ * @return bool true on success, false on allocation failure
+ */
+static bool grow_buckets(HashMap* map) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)grow_buckets);
+
+    int newCount = map->bucketCount * 2;
+    HashMapEntry** newBuckets = calloc(newCount, sizeof(HashMapEntry*));
+    if (!newBuckets) {
+        logger_log(LOG_ERROR, "Memory allocation failed while growing hash map to %d buckets", newCount);
+        return false;
+    }
+
+    for (int i = 0; i < map->bucketCount; i++) {
+        HashMapEntry* entry = map->buckets[i];
+        while (entry) {
+            HashMapEntry* next = entry->next;
+            int index = entry->hash & (newCount - 1);
+            entry->next = newBuckets[index];
+            newBuckets[index] = entry;
+            entry = next;
+        }
+    }
+
+    free(map->buckets);
+    map->buckets = newBuckets;
+    map->bucketCount = newCount;
+    return true;
+}
+
+/**
+ * @brief Creates a new hash map
+ *
+ * @param initialCapacity Expected number of entries (0 for a default size)
+ * @return HashMap* Newly created map, or NULL on allocation failure
+ */
+HashMap* hashmap_create(int initialCapacity) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)hashmap_create);
+
+    HashMap* map = malloc(sizeof(HashMap));
+    if (!map) {
+        error_report("HashMap", __LINE__, 0, "Failed to allocate hash map", ERROR_MEMORY);
+        return NULL;
+    }
+
+    // Round up to a power of two large enough for the requested capacity
+    int buckets = HASHMAP_DEFAULT_BUCKETS;
+    while (buckets * 3 / 4 < initialCapacity) {
+        buckets *= 2;
+    }
+
+    map->buckets = calloc(buckets, sizeof(HashMapEntry*));
+    if (!map->buckets) {
+        error_report("HashMap", __LINE__, 0, "Failed to allocate hash map buckets", ERROR_MEMORY);
+        free(map);
+        return NULL;
+    }
+    map->bucketCount = buckets;
+    map->count = 0;
+
+    return map;
+}
+
+/**
+ * @brief Removes every entry from a map while keeping its storage
+ *
+ * @param map The map to clear
+ * @param freeValue Optional callback to release each stored value
+ */
+void hashmap_clear(HashMap* map, HashMapFreeFn freeValue) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)hashmap_clear);
+
+    if (!map) return;
+
+    for (int i = 0; i < map->bucketCount; i++) {
+        HashMapEntry* entry = map->buckets[i];
+        while (entry) {
+            HashMapEntry* next = entry->next;
+            if (freeValue && entry->value) {
+                freeValue(entry->value);
+            }
+            free(entry->key);
+            free(entry);
+            entry = next;
+        }
+        map->buckets[i] = NULL;
+    }
+    map->count = 0;
+}
+
+/**
+ * @brief Frees a hash map and all of its keys
+ *
+ * @param map The map to free
+ * @param freeValue Optional callback to release each stored value
+ */
+void hashmap_free(HashMap* map, HashMapFreeFn freeValue) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)hashmap_free);
+
+    if (!map) return;
+
+    hashmap_clear(map, freeValue);
+    free(map->buckets);
+    free(map);
+}
+
+/**
+ * @brief Inserts or replaces the value associated with a key
+ *
+ * @param map The map to modify
+ * @param key The key (copied by the map)
+ * @param value The value to store
+ * @param oldValue Optional output for the replaced value
+ * @return bool true on success, false on allocation failure
+ */
+bool hashmap_put(HashMap* map, const char* key, void* value, void** oldValue) {
+    if (oldValue) *oldValue = NULL;
+    if (!map || !key) return false;
+
+    unsigned int hash = hashmap_hash_string(key);
+    HashMapEntry* existing = find_entry(map, key, hash);
+    if (existing) {
+        if (oldValue) *oldValue = existing->value;
+        existing->value = value;
+        return true;
+    }
+
+    if ((map->count + 1) > map->bucketCount * 3 / 4) {
+        // A failed grow only degrades performance; keep inserting
+        grow_buckets(map);
+    }
+
+    HashMapEntry* entry = malloc(sizeof(HashMapEntry));
+    if (!entry) {
+        error_report("HashMap", __LINE__, 0, "Failed to allocate hash map entry", ERROR_MEMORY);
+        return false;
+    }
+    entry->key = strdup(key);
+    if (!entry->key) {
+        error_report("HashMap", __LINE__, 0, "Failed to allocate hash map key", ERROR_MEMORY);
+        free(entry);
+        return false;
+    }
+    entry->value = value;
+    entry->hash = hash;
+
+    int index = hash & (map->bucketCount - 1);
+    entry->next = map->buckets[index];
+    map->buckets[index] = entry;
+    map->count++;
+
+    return true;
+}
+
+/**
+ * @brief Looks up the value associated with a key
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return void* The stored value, or NULL if the key is not present
+ */
+void* hashmap_get(const HashMap* map, const char* key) {
+    if (!map || !key) return NULL;
+
+    HashMapEntry* entry = find_entry(map, key, hashmap_hash_string(key));
+    return entry ? entry->value : NULL;
+}
+
+/**
+ * @brief Checks whether a key is present in the map
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return bool true if the key is present, false otherwise
+ */
+bool hashmap_contains(const HashMap* map, const char* key) {
+    if (!map || !key) return false;
+
+    return find_entry(map, key, hashmap_hash_string(key)) != NULL;
+}
+
+/**
+ * @brief Removes a key from the map
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @return void* The removed value, or NULL if the key was not present
+ */
+void* hashmap_remove(HashMap* map, const char* key) {
+    if (!map || !key) return NULL;
+
+    unsigned int hash = hashmap_hash_string(key);
+    HashMapEntry** link = &map->buckets[hash & (map->bucketCount - 1)];
+    while (*link) {
+        HashMapEntry* entry = *link;
+        if (entry->hash == hash && strcmp(entry->key, key) == 0) {
+            void* value = entry->value;
+            *link = entry->next;
+            free(entry->key);
+            free(entry);
+            map->count--;
+            return value;
+        }
+        link = &entry->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Gets the number of entries in the map
+ *
+ * @param map The map to inspect
+ * @return int Number of entries
+ */
+int hashmap_count(const HashMap* map) {
+    return map ? map->count : 0;
+}
+
+/**
+ * @brief Visits every entry in the map
+ *
+ * @param map The map to traverse
+ * @param visit Callback invoked for each entry
+ * @param userData Opaque pointer passed to the callback
+ */
+void hashmap_foreach(const HashMap* map, HashMapVisitFn visit, void* userData) {
+    if (!map || !visit) return;
+
+    for (int i = 0; i < map->bucketCount; i++) {
+        for (HashMapEntry* entry = map->buckets[i]; entry; entry = entry->next) {
+            visit(entry->key, entry->value, userData);
+        }
+    }
+}
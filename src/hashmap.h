@@ -0,0 +1,137 @@
+/**
+ * @file hashmap.h
+ * @brief Header file for the generic string-keyed hash map
+ *
+ * This header defines a small hash map keyed by NUL-terminated strings and
+ * storing opaque pointer values. It is shared by the compiler registries
+ * (macros, templates, reflection type cache) that previously scanned fixed
+ * arrays linearly by name. Features:
+ * - Average O(1) insertion, lookup and removal
+ * - Growable capacity (no fixed registry limits)
+ * - Keys are copied and owned by the map; values are owned by the caller
+ */
+
+#ifndef HASHMAP_H
+#define HASHMAP_H
+
+#include <stdbool.h>
+#include "error.h"
+#include "logger.h"
+
+/**
+ * @brief Opaque hash map structure
+ */
+typedef struct HashMap HashMap;
+
+/**
+ * @brief Callback used to release values when a map is cleared or freed
+ *
+ * @param value The value stored in the map
+ */
+typedef void (*HashMapFreeFn)(void* value);
+
+/**
+ * @brief Callback used to visit every entry of a map
+ *
+ * @param key The entry key
+ * @param value The entry value
+ * @param userData Opaque pointer passed through from hashmap_foreach()
+ */
+typedef void (*HashMapVisitFn)(const char* key, void* value, void* userData);
+
+/**
+ * @brief Computes the hash of a string key
+ *
+ * Uses the 32-bit FNV-1a algorithm. Exposed so that other modules can build
+ * composite keys consistently with the map.
+ *
+ * @param key String to hash
+ * @return unsigned int Hash value
+ */
+unsigned int hashmap_hash_string(const char* key);
+
+/**
+ * @brief Creates a new hash map
+ *
+ * @param initialCapacity Expected number of entries (0 for a default size)
+ * @return HashMap* Newly created map, or NULL on allocation failure
+ */
+HashMap* hashmap_create(int initialCapacity);
+
+/**
+ * @brief Frees a hash map and all of its keys
+ *
+ * @param map The map to free
+ * @param freeValue Optional callback to release each stored value (may be NULL)
+ */
+void hashmap_free(HashMap* map, HashMapFreeFn freeValue);
+
+/**
+ * @brief Removes every entry from a map while keeping its storage
+ *
+ * @param map The map to clear
+ * @param freeValue Optional callback to release each stored value (may be NULL)
+ */
+void hashmap_clear(HashMap* map, HashMapFreeFn freeValue);
+
+/**
+ * @brief Inserts or replaces the value associated with a key
+ *
+ * If the key is already present its value is replaced; the previous value
+ * is returned through @p oldValue so the caller can release it.
+ *
+ * @param map The map to modify
+ * @param key The key (copied by the map)
+ * @param value The value to store
+ * @param oldValue Optional output for the replaced value (NULL if none)
+ * @return bool true on success, false on allocation failure
+ */
+bool hashmap_put(HashMap* map, const char* key, void* value, void** oldValue);
+
+/**
+ * @brief Looks up the value associated with a key
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return void* The stored value, or NULL if the key is not present
+ */
+void* hashmap_get(const HashMap* map, const char* key);
+
+/**
+ * @brief Checks whether a key is present in the map
+ *
+ * @param map The map to search
+ * @param key The key to look up
+ * @return bool true if the key is present, false otherwise
+ */
+bool hashmap_contains(const HashMap* map, const char* key);
+
+/**
+ * @brief Removes a key from the map
+ *
+ * @param map The map to modify
+ * @param key The key to remove
+ * @return void* The removed value (for the caller to release), or NULL
+ */
+void* hashmap_remove(HashMap* map, const char* key);
+
+/**
+ * @brief Gets the number of entries in the map
+ *
+ * @param map The map to inspect
+ * @return int Number of entries
+ */
+int hashmap_count(const HashMap* map);
+
+/**
+ * @brief Visits every entry in the map
+ *
+ * The map must not be modified from inside the callback.
+ *
+ * @param map The map to traverse
+ * @param visit Callback invoked for each entry
+ * @param userData Opaque pointer passed to the callback
+ */
+void hashmap_foreach(const HashMap* map, HashMapVisitFn visit, void* userData);
+
+#endif /* HASHMAP_H */
@@ -0,0 +1,2789 @@
+/**
+ * @file ir.c
+ * @brief Mid-level SSA intermediate representation for the Lyn compiler
+ *
+ * This file implements the IR declared in ir.h:
+ * - Construction helpers for functions, blocks and instructions
+ * - Lowering of scalar program bodies from the AST, with every Lyn variable
+ *   living in a stack slot accessed through explicit loads and stores, and
+ *   calls to the program's functions, which the AST emitter compiles
+ * - CFG, reverse post-order, dominator tree and dominance frontiers
+ * - mem2reg: phi placement on iterated dominance frontiers and renaming
+ * - Sparse conditional constant propagation (Wegman-Zadeck)
+ * - Dominator-based global value numbering
+ * - Loop-invariant code motion into loop preheaders
+ * - Dead code elimination
+ * - A printer and a C emitter
+ *
+ * The lowering reproduces the typing rules of the AST emitter (the first
+ * assignment fixes a variable's C type, integral literals are int, binary
+ * expressions are double, C arithmetic conversions apply), so a program
+ * prints the same output whichever path generates its C code.
+ */
+
+#include "ir.h"
+#include "error.h"
+#include "logger.h"
+#include "hashmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <math.h>
+#include <limits.h>
+
+/** Optimization level of the IR pipeline */
+static int currentLevel = 0;
+
+/** Default debug level for the IR */
+static int debug_level = 1;
+
+/** Statistics of the lowering and the passes */
+static IrStats stats = {0};
+
+/**
+ * @brief Initializes the IR pipeline for an optimization level
+ *
+ * @param level Optimization level (0-2)
+ */
+void ir_init(int level) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)ir_init);
+    currentLevel = level;
+    stats = (IrStats){0};
+    logger_log(LOG_INFO, "IR initialized with level %d", level);
+}
+
+/**
+ * @brief Sets the debug level for the IR
+ *
+ * @param level New debug level (0=minimum, 3=maximum)
+ */
+void ir_set_debug_level(int level) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)ir_set_debug_level);
+    debug_level = level;
+    logger_log(LOG_INFO, "IR debug level set to %d", level);
+}
+
+/**
+ * @brief Gets the IR statistics
+ *
+ * @return IrStats Statistics accumulated since ir_init
+ */
+IrStats ir_get_stats(void) {
+    return stats;
+}
+
+/* ------------------------------------------------------------------------- */
+/* Construction                                                              */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Makes room for one more element in a growable array
+ *
+ * @param items Pointer to the array
+ * @param capacity Pointer to the allocated element count
+ * @param count Elements in use
+ * @param size Size of one element
+ * @return bool false if the allocation failed
+ */
+static bool ir_grow(void** items, int* capacity, int count, size_t size) {
+    if (count < *capacity) return true;
+    int newCapacity = *capacity ? *capacity * 2 : 8;
+    void* grown = realloc(*items, (size_t)newCapacity * size);
+    if (!grown) {
+        error_report("IR", __LINE__, 0, "Failed to grow IR array", ERROR_MEMORY);
+        return false;
+    }
+    *items = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+/**
+ * @brief Creates an instruction owned by the function, not yet in any block
+ */
+static IrInstr* ir_new_instr(IrFunction* fn, IrOpcode op, IrType type) {
+    if (!ir_grow((void**)&fn->allInstrs, &fn->allCapacity, fn->allCount, sizeof(IrInstr*))) {
+        return NULL;
+    }
+    IrInstr* instr = calloc(1, sizeof(IrInstr));
+    if (!instr) {
+        error_report("IR", __LINE__, 0, "Failed to allocate IR instruction", ERROR_MEMORY);
+        return NULL;
+    }
+    instr->op = op;
+    instr->type = type;
+    instr->id = fn->nextValueId++;
+    fn->allInstrs[fn->allCount++] = instr;
+    return instr;
+}
+
+/**
+ * @brief Appends an operand; phi operands also record their incoming block
+ */
+static bool ir_add_arg(IrInstr* instr, IrInstr* arg, IrBlock* from) {
+    int capacity = instr->argCapacity;
+    if (!ir_grow((void**)&instr->args, &instr->argCapacity, instr->argCount, sizeof(IrInstr*))) {
+        return false;
+    }
+    if (instr->op == IR_PHI && (capacity != instr->argCapacity || !instr->phiBlocks)) {
+        IrBlock** blocks = realloc(instr->phiBlocks, (size_t)instr->argCapacity * sizeof(IrBlock*));
+        if (!blocks) {
+            error_report("IR", __LINE__, 0, "Failed to grow phi operands", ERROR_MEMORY);
+            return false;
+        }
+        instr->phiBlocks = blocks;
+    }
+    if (instr->op == IR_PHI) instr->phiBlocks[instr->argCount] = from;
+    instr->args[instr->argCount++] = arg;
+    return true;
+}
+
+/**
+ * @brief Creates an empty block at the end of the function's block list
+ */
+static IrBlock* ir_new_block(IrFunction* fn) {
+    if (!ir_grow((void**)&fn->blocks, &fn->blockCapacity, fn->blockCount, sizeof(IrBlock*))) {
+        return NULL;
+    }
+    IrBlock* block = calloc(1, sizeof(IrBlock));
+    if (!block) {
+        error_report("IR", __LINE__, 0, "Failed to allocate IR block", ERROR_MEMORY);
+        return NULL;
+    }
+    block->id = fn->nextBlockId++;
+    block->rpo = -1;
+    fn->blocks[fn->blockCount++] = block;
+    return block;
+}
+
+/**
+ * @brief Inserts an instruction into a block at the given position
+ */
+static bool ir_insert(IrBlock* block, int index, IrInstr* instr) {
+    if (!ir_grow((void**)&block->instrs, &block->instrCapacity, block->instrCount, sizeof(IrInstr*))) {
+        return false;
+    }
+    memmove(&block->instrs[index + 1], &block->instrs[index],
+            (size_t)(block->instrCount - index) * sizeof(IrInstr*));
+    block->instrs[index] = instr;
+    block->instrCount++;
+    instr->block = block;
+    instr->removed = false;
+    return true;
+}
+
+/**
+ * @brief Returns the block's terminator, or NULL if it has none yet
+ */
+static IrInstr* ir_terminator(IrBlock* block) {
+    if (block->instrCount == 0) return NULL;
+    IrInstr* last = block->instrs[block->instrCount - 1];
+    if (last->op == IR_BR || last->op == IR_CONDBR || last->op == IR_RET) return last;
+    return NULL;
+}
+
+/**
+ * @brief Tells whether a block starts with phis
+ */
+static bool ir_has_phis(IrBlock* block) {
+    return block->instrCount > 0 && block->instrs[0]->op == IR_PHI;
+}
+
+/**
+ * @brief Drops the instructions marked as removed from a block
+ */
+static void ir_compact(IrBlock* block) {
+    int kept = 0;
+    for (int i = 0; i < block->instrCount; i++) {
+        if (!block->instrs[i]->removed) block->instrs[kept++] = block->instrs[i];
+    }
+    block->instrCount = kept;
+}
+
+/**
+ * @brief Follows the replacement chain of a value
+ */
+static IrInstr* ir_resolve(IrInstr* value) {
+    while (value && value->forward) value = value->forward;
+    return value;
+}
+
+/**
+ * @brief Rewrites every operand to its replacement and drops removed instructions
+ */
+static void ir_apply_forwards(IrFunction* fn) {
+    for (int b = 0; b < fn->blockCount; b++) {
+        IrBlock* block = fn->blocks[b];
+        ir_compact(block);
+        for (int i = 0; i < block->instrCount; i++) {
+            IrInstr* instr = block->instrs[i];
+            for (int a = 0; a < instr->argCount; a++) {
+                instr->args[a] = ir_resolve(instr->args[a]);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Creates a constant; constants live outside blocks and are emitted inline
+ */
+static IrInstr* ir_const(IrFunction* fn, IrType type, IrConstValue value) {
+    IrInstr* instr = ir_new_instr(fn, IR_CONST, type);
+    if (instr) instr->value = value;
+    return instr;
+}
+
+/**
+ * @brief Creates the zero value of a type, used for reads of unassigned slots
+ */
+static IrInstr* ir_zero(IrFunction* fn, IrType type) {
+    IrConstValue value = {0};
+    if (type == IR_TYPE_STR) value.s = "";
+    return ir_const(fn, type, value);
+}
+
+/**
+ * @brief Tells whether two constants hold the same value
+ */
+static bool ir_const_equal(IrType type, const IrConstValue* a, const IrConstValue* b) {
+    switch (type) {
+        case IR_TYPE_F64:
+            return a->f == b->f && signbit(a->f) == signbit(b->f);
+        case IR_TYPE_STR:
+            return a->s == b->s || (a->s && b->s && strcmp(a->s, b->s) == 0);
+        default:
+            return a->i == b->i;
+    }
+}
+
+/**
+ * @brief Tells whether two operands are known to be the same value
+ */
+static bool ir_same_value(IrInstr* a, IrInstr* b) {
+    a = ir_resolve(a);
+    b = ir_resolve(b);
+    if (a == b) return true;
+    return a && b && a->op == IR_CONST && b->op == IR_CONST && a->type == b->type &&
+           ir_const_equal(a->type, &a->value, &b->value);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Constant folding shared by the lowering and SCCP                          */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Reads a numeric constant as a double
+ */
+static double ir_const_as_double(IrType type, const IrConstValue* value) {
+    return type == IR_TYPE_F64 ? value->f : (double)value->i;
+}
+
+/**
+ * @brief Evaluates a binary, unary or conversion instruction on constants
+ *
+ * Integer arithmetic wraps at 64 bits; division or remainder by zero,
+ * INT64_MIN / -1, non-finite results and out-of-range conversions are left
+ * to run time.
+ *
+ * @param instr Instruction to evaluate
+ * @param args Constant value of each operand
+ * @param out Result
+ * @return bool true if the result is known
+ */
+static bool ir_fold(IrInstr* instr, IrConstValue* args, IrConstValue* out) {
+    memset(out, 0, sizeof(*out));
+    switch (instr->op) {
+        case IR_CONV: {
+            IrType from = instr->args[0]->type;
+            if (from == IR_TYPE_STR || instr->type == IR_TYPE_STR) return false;
+            double value = ir_const_as_double(from, &args[0]);
+            if (instr->type == IR_TYPE_F64) {
+                out->f = value;
+            } else if (instr->type == IR_TYPE_BOOL) {
+                out->i = value != 0;
+            } else {
+                if (!(value >= -9223372036854775808.0 && value < 9223372036854775808.0)) return false;
+                out->i = (long long)value;
+            }
+            return true;
+        }
+        case IR_UNARY: {
+            IrType type = instr->args[0]->type;
+            if (instr->opChar == 'N') {
+                out->i = ir_const_as_double(type, &args[0]) == 0;
+                return true;
+            }
+            if (instr->opChar != '-') return false;
+            if (type == IR_TYPE_F64) {
+                out->f = -args[0].f;
+            } else {
+                out->i = (long long)(0ull - (unsigned long long)args[0].i);
+            }
+            return true;
+        }
+        case IR_BINARY: {
+            IrType type = instr->args[0]->type;
+            char op = instr->opChar;
+            if (type == IR_TYPE_F64) {
+                double a = args[0].f, b = args[1].f;
+                switch (op) {
+                    case '<': out->i = a < b; return true;
+                    case '>': out->i = a > b; return true;
+                    case 'L': out->i = a <= b; return true;
+                    case 'G': out->i = a >= b; return true;
+                    case 'E': out->i = a == b; return true;
+                    case 'N': out->i = a != b; return true;
+                    case '+': out->f = a + b; break;
+                    case '-': out->f = a - b; break;
+                    case '*': out->f = a * b; break;
+                    case '/': out->f = a / b; break;
+                    default: return false;
+                }
+                return isfinite(out->f);
+            }
+            long long a = args[0].i, b = args[1].i;
+            switch (op) {
+                case '<': out->i = a < b; return true;
+                case '>': out->i = a > b; return true;
+                case 'L': out->i = a <= b; return true;
+                case 'G': out->i = a >= b; return true;
+                case 'E': out->i = a == b; return true;
+                case 'N': out->i = a != b; return true;
+                case '+': out->i = (long long)((unsigned long long)a + (unsigned long long)b); return true;
+                case '-': out->i = (long long)((unsigned long long)a - (unsigned long long)b); return true;
+                case '*': out->i = (long long)((unsigned long long)a * (unsigned long long)b); return true;
+                case '/':
+                case '%':
+                    if (b == 0 || (a == LLONG_MIN && b == -1)) return false;
+                    out->i = op == '/' ? a / b : a % b;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+        default:
+            return false;
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Lowering from the AST                                                     */
+/* ------------------------------------------------------------------------- */
+
+/** A Lyn variable and its stack slot */
+typedef struct {
+    char name[256];
+    IrInstr* slot;
+    IrType tableType;               ///< Type the AST emitter's variable table records
+} IrVariable;
+
+/** Targets of break and continue inside a loop */
+typedef struct {
+    IrBlock* breakTarget;
+    IrBlock* continueTarget;
+} IrLoopTargets;
+
+#define IR_MAX_LOOP_DEPTH 64
+
+/** State of one lowering */
+typedef struct {
+    IrFunction* fn;
+    IrBlock* current;               ///< Block receiving new instructions
+    int entryPrefix;                ///< Slots and inputs emitted at the top of the entry block
+    IrVariable* vars;
+    int varCount;
+    int varCapacity;
+    IrLoopTargets loops[IR_MAX_LOOP_DEPTH];
+    int loopDepth;
+    IrVariableLookup lookup;
+    AstNode* program;               ///< Program whose top-level functions the body calls
+    HashMap* functionNames;         ///< Names used by those functions, which the body may not use
+    int line;                       ///< Line of the statement being lowered
+    bool failed;
+    char reason[160];
+} IrLowering;
+
+/**
+ * @brief Marks the lowering as failed; the first reason is kept for the log
+ */
+static void lower_fail(IrLowering* ctx, const char* fmt, ...) {
+    if (ctx->failed) return;
+    ctx->failed = true;
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(ctx->reason, sizeof(ctx->reason), fmt, args);
+    va_end(args);
+}
+
+/**
+ * @brief Maps a C type of the AST emitter to an IR type
+ */
+static bool ir_type_from_c(const char* ctype, IrType* out) {
+    if (!ctype) return false;
+    if (strcmp(ctype, "int64_t") == 0 || strcmp(ctype, "int") == 0) *out = IR_TYPE_I64;
+    else if (strcmp(ctype, "double") == 0) *out = IR_TYPE_F64;
+    else if (strcmp(ctype, "bool") == 0) *out = IR_TYPE_BOOL;
+    else if (strcmp(ctype, "const char*") == 0) *out = IR_TYPE_STR;
+    else return false;
+    return true;
+}
+
+/**
+ * @brief Maps a declared Lyn type (int, float, string or a C name) to an IR type
+ */
+static bool ir_type_from_lyn(const char* name, IrType* out) {
+    if (strcmp(name, "int") == 0) name = "int64_t";
+    else if (strcmp(name, "float") == 0) name = "double";
+    else if (strcmp(name, "string") == 0) name = "const char*";
+    return ir_type_from_c(name, out);
+}
+
+/**
+ * @brief Appends an instruction to the current block
+ *
+ * Code after a terminator (e.g. following a break) goes to a fresh block
+ * without predecessors, which the CFG cleanup deletes.
+ */
+static IrInstr* lower_emit(IrLowering* ctx, IrOpcode op, IrType type, IrInstr* a, IrInstr* b) {
+    if (ctx->failed) return NULL;
+    if (ir_terminator(ctx->current)) {
+        IrBlock* dead = ir_new_block(ctx->fn);
+        if (!dead) { lower_fail(ctx, "out of memory"); return NULL; }
+        ctx->current = dead;
+    }
+    IrInstr* instr = ir_new_instr(ctx->fn, op, type);
+    if (!instr ||
+        (a && !ir_add_arg(instr, a, NULL)) ||
+        (b && !ir_add_arg(instr, b, NULL)) ||
+        !ir_insert(ctx->current, ctx->current->instrCount, instr)) {
+        lower_fail(ctx, "out of memory");
+        return NULL;
+    }
+    stats.instructions_lowered++;
+    return instr;
+}
+
+/**
+ * @brief Ends the current block with a branch
+ */
+static void lower_branch(IrLowering* ctx, IrInstr* cond, IrBlock* ifTrue, IrBlock* ifFalse) {
+    IrInstr* branch = lower_emit(ctx, cond ? IR_CONDBR : IR_BR, IR_TYPE_VOID, cond, NULL);
+    if (!branch) return;
+    branch->targets[0] = ifTrue;
+    branch->targets[1] = ifFalse;
+}
+
+/**
+ * @brief Creates a block, failing the lowering if memory runs out
+ */
+static IrBlock* lower_block(IrLowering* ctx) {
+    if (ctx->failed) return NULL;
+    IrBlock* block = ir_new_block(ctx->fn);
+    if (!block) lower_fail(ctx, "out of memory");
+    return block;
+}
+
+/**
+ * @brief Emits an instruction at the top of the entry block
+ */
+static IrInstr* lower_entry(IrLowering* ctx, IrOpcode op, IrType type, IrInstr* a, IrInstr* b) {
+    if (ctx->failed) return NULL;
+    IrInstr* instr = ir_new_instr(ctx->fn, op, type);
+    if (!instr ||
+        (a && !ir_add_arg(instr, a, NULL)) ||
+        (b && !ir_add_arg(instr, b, NULL)) ||
+        !ir_insert(ctx->fn->blocks[0], ctx->entryPrefix, instr)) {
+        lower_fail(ctx, "out of memory");
+        return NULL;
+    }
+    ctx->entryPrefix++;
+    stats.instructions_lowered++;
+    return instr;
+}
+
+/**
+ * @brief Fails the lowering if one of the program's functions uses a name
+ *
+ * Functions are compiled by the AST emitter and read and write C variables,
+ * which the body's SSA values would not see.
+ */
+static bool lower_shared(IrLowering* ctx, const char* name) {
+    if (!name[0] || !ctx->functionNames || !hashmap_contains(ctx->functionNames, name)) return false;
+    lower_fail(ctx, "variable '%s' is also used by a function", name);
+    return true;
+}
+
+/**
+ * @brief Creates a stack slot for a variable and makes it visible by name
+ */
+static IrInstr* lower_declare(IrLowering* ctx, const char* name, IrType type) {
+    if (lower_shared(ctx, name)) return NULL;
+    IrInstr* slot = lower_entry(ctx, IR_ALLOCA, type, NULL, NULL);
+    if (!slot) return NULL;
+    snprintf(slot->name, sizeof(slot->name), "%s", name);
+    if (!ir_grow((void**)&ctx->vars, &ctx->varCapacity, ctx->varCount, sizeof(IrVariable))) {
+        lower_fail(ctx, "out of memory");
+        return NULL;
+    }
+    snprintf(ctx->vars[ctx->varCount].name, sizeof(ctx->vars[ctx->varCount].name), "%s", name);
+    ctx->vars[ctx->varCount].slot = slot;
+    ctx->vars[ctx->varCount].tableType = type;
+    ctx->varCount++;
+    return slot;
+}
+
+/**
+ * @brief Finds the slot of a variable
+ *
+ * Variables the C code declared before the program body (the emitter's
+ * predefined globals) get a slot initialized from the C variable.
+ */
+static IrInstr* lower_find(IrLowering* ctx, const char* name) {
+    for (int i = ctx->varCount - 1; i >= 0; i--) {
+        if (strcmp(ctx->vars[i].name, name) == 0) return ctx->vars[i].slot;
+    }
+    const char* ctype = ctx->lookup ? ctx->lookup(name) : NULL;
+    if (!ctype || lower_shared(ctx, name)) return NULL;
+    IrType type;
+    if (!ir_type_from_c(ctype, &type)) {
+        lower_fail(ctx, "variable '%s' has C type %s", name, ctype);
+        return NULL;
+    }
+    IrInstr* slot = lower_declare(ctx, name, type);
+    IrInstr* input = lower_entry(ctx, IR_INPUT, type, NULL, NULL);
+    if (!slot || !input) return NULL;
+    snprintf(input->name, sizeof(input->name), "%s", name);
+    lower_entry(ctx, IR_STORE, IR_TYPE_VOID, slot, input);
+    return slot;
+}
+
+/**
+ * @brief Finds a variable by name, including the predefined C variables
+ */
+static IrVariable* lower_variable(IrLowering* ctx, const char* name) {
+    if (!lower_find(ctx, name)) return NULL;
+    for (int i = ctx->varCount - 1; i >= 0; i--) {
+        if (strcmp(ctx->vars[i].name, name) == 0) return &ctx->vars[i];
+    }
+    return NULL;
+}
+
+/**
+ * @brief Converts a value to a type with C's implicit conversion rules
+ */
+static IrInstr* lower_coerce(IrLowering* ctx, IrInstr* value, IrType type) {
+    if (!value || ctx->failed) return NULL;
+    if (value->type == type) return value;
+    if (value->type == IR_TYPE_STR || type == IR_TYPE_STR || value->type == IR_TYPE_VOID) {
+        lower_fail(ctx, "string value mixed with a number");
+        return NULL;
+    }
+    return lower_emit(ctx, IR_CONV, type, value, NULL);
+}
+
+/**
+ * @brief Checks that a value can be used as a condition
+ */
+static IrInstr* lower_condition_value(IrLowering* ctx, IrInstr* value) {
+    if (value && value->type == IR_TYPE_STR) {
+        lower_fail(ctx, "string used as a condition");
+        return NULL;
+    }
+    return value;
+}
+
+/**
+ * @brief Reads a number literal the way the AST emitter prints it
+ *
+ * Literals written with a decimal point, or marked as doubles by the
+ * optimizer, are emitted with full precision and keep their value. Other
+ * integral values are integers; anything else is a double written with %g,
+ * so the IR uses the same rounded value.
+ */
+static IrInstr* lower_number(IrLowering* ctx, AstNode* node) {
+    IrConstValue constant = {0};
+    double value = node->numberLiteral.value;
+    if (node->numberLiteral.isDouble) {
+        constant.f = value;
+        return ir_const(ctx->fn, IR_TYPE_F64, constant);
+    }
+    if (isIntegerLiteral(node)) {
+        constant.i = integerLiteralValue(node);
+        return ir_const(ctx->fn, IR_TYPE_I64, constant);
+    }
+    char text[64];
+    snprintf(text, sizeof(text), "%g", value);
+    constant.f = strtod(text, NULL);
+    return ir_const(ctx->fn, IR_TYPE_F64, constant);
+}
+
+static IrInstr* lower_expression(IrLowering* ctx, AstNode* node);
+static IrVariable* lower_variable(IrLowering* ctx, const char* name);
+
+/**
+ * @brief Finds the function a call refers to: one defined once at the top level
+ */
+static AstNode* lower_function(IrLowering* ctx, const char* name) {
+    AstNode* found = NULL;
+    for (int i = 0; i < ctx->program->program.statementCount; i++) {
+        AstNode* stmt = ctx->program->program.statements[i];
+        if (stmt && stmt->type == AST_FUNC_DEF && strcmp(stmt->funcDef.name, name) == 0) {
+            if (found) return NULL;
+            found = stmt;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Type of a call's result, known when the function declares an int,
+ *        float, bool or string result like the AST emitter requires
+ */
+static bool lower_call_type(IrLowering* ctx, AstNode* call, IrType* out) {
+    AstNode* def = lower_function(ctx, call->funcCall.name);
+    return def && def->funcDef.returnType[0] &&
+           ir_type_from_lyn(def->funcDef.returnType, out) && *out != IR_TYPE_VOID;
+}
+
+/**
+ * @brief Tells whether the AST emitter types an expression as a Lyn integer
+ *
+ * Mirrors its type inference: integer literals and variables, comparisons and
+ * logic, and arithmetic or negation of integers. Any other arithmetic is
+ * carried out in double.
+ */
+static bool lower_is_integer(IrLowering* ctx, AstNode* node) {
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return isIntegerLiteral(node);
+        case AST_IDENTIFIER: {
+            IrVariable* var = lower_variable(ctx, node->identifier.name);
+            return var && var->tableType == IR_TYPE_I64;
+        }
+        case AST_BINARY_OP:
+            if (!strchr("+-*/%", node->binaryOp.op)) return true;
+            return lower_is_integer(ctx, node->binaryOp.left) &&
+                   lower_is_integer(ctx, node->binaryOp.right);
+        case AST_UNARY_OP:
+            return node->unaryOp.op == 'N' || lower_is_integer(ctx, node->unaryOp.expr);
+        case AST_FUNC_CALL: {
+            IrType type;
+            return lower_call_type(ctx, node, &type) && type == IR_TYPE_I64;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Tells whether the AST emitter types an expression as a string
+ *
+ * A '+' with a string operand is a concatenation.
+ */
+static bool lower_is_string(IrLowering* ctx, AstNode* node) {
+    switch (node->type) {
+        case AST_STRING_LITERAL:
+        case AST_CONCAT_EXPR:
+            return true;
+        case AST_IDENTIFIER: {
+            IrVariable* var = lower_variable(ctx, node->identifier.name);
+            return var && var->tableType == IR_TYPE_STR;
+        }
+        case AST_BINARY_OP:
+            return node->binaryOp.op == '+' &&
+                   (lower_is_string(ctx, node->binaryOp.left) || lower_is_string(ctx, node->binaryOp.right));
+        case AST_FUNC_CALL: {
+            IrType type;
+            return lower_call_type(ctx, node, &type) && type == IR_TYPE_STR;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Lowers && and || with short-circuit control flow
+ */
+static IrInstr* lower_logical(IrLowering* ctx, AstNode* node) {
+    bool isAnd = node->binaryOp.op == 'A';
+    IrInstr* left = lower_condition_value(ctx, lower_expression(ctx, node->binaryOp.left));
+    IrInstr* result = lower_declare(ctx, "", IR_TYPE_I64);
+    IrBlock* rightBlock = lower_block(ctx);
+    IrBlock* done = lower_block(ctx);
+    if (!left || !result || !rightBlock || !done) return NULL;
+
+    IrConstValue shortValue = { .i = isAnd ? 0 : 1 };
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, result, ir_const(ctx->fn, IR_TYPE_I64, shortValue));
+    lower_branch(ctx, left, isAnd ? rightBlock : done, isAnd ? done : rightBlock);
+
+    ctx->current = rightBlock;
+    IrInstr* right = lower_condition_value(ctx, lower_expression(ctx, node->binaryOp.right));
+    if (right && right->type == IR_TYPE_BOOL) right = lower_coerce(ctx, right, IR_TYPE_I64);
+    if (!right) return NULL;
+    IrInstr* truth = lower_emit(ctx, IR_BINARY, IR_TYPE_I64, right, ir_zero(ctx->fn, right->type));
+    if (truth) truth->opChar = 'N';
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, result, truth);
+    lower_branch(ctx, NULL, done, NULL);
+
+    ctx->current = done;
+    return lower_emit(ctx, IR_LOAD, IR_TYPE_I64, result, NULL);
+}
+
+/**
+ * @brief Lowers an arithmetic or comparison operator after the usual conversions
+ */
+static IrInstr* lower_arithmetic(IrLowering* ctx, char op, IrInstr* left, IrInstr* right) {
+    if (!left || !right || ctx->failed) return NULL;
+    if (!strchr("+-*/%<>ELGN", op)) {
+        lower_fail(ctx, "operator '%c'", op);
+        return NULL;
+    }
+    if (left->type == IR_TYPE_STR || right->type == IR_TYPE_STR) {
+        lower_fail(ctx, "operator '%c' on a string", op);
+        return NULL;
+    }
+    IrType common = (left->type == IR_TYPE_F64 || right->type == IR_TYPE_F64) ? IR_TYPE_F64 : IR_TYPE_I64;
+    if (op == '%' && common == IR_TYPE_F64) {
+        lower_fail(ctx, "floating-point remainder");
+        return NULL;
+    }
+    left = lower_coerce(ctx, left, common);
+    right = lower_coerce(ctx, right, common);
+    bool comparison = strchr("<>ELGN", op) != NULL;
+    IrInstr* result = lower_emit(ctx, IR_BINARY, comparison ? IR_TYPE_I64 : common, left, right);
+    if (result) {
+        result->opChar = op;
+        result->line = ctx->line;
+    }
+    return result;
+}
+
+/**
+ * @brief Lowers a call to a function of the program
+ *
+ * The arguments are evaluated left to right and passed as they are; C
+ * converts them to the parameter types as it does for the AST emitter.
+ *
+ * @param statement true if the result is discarded
+ */
+static IrInstr* lower_call(IrLowering* ctx, AstNode* node, bool statement) {
+    IrType type = IR_TYPE_VOID;
+    if (!lower_function(ctx, node->funcCall.name)) {
+        lower_fail(ctx, "call to '%s'", node->funcCall.name);
+        return NULL;
+    }
+    if (!statement && !lower_call_type(ctx, node, &type)) {
+        lower_fail(ctx, "call to '%s' without a declared result type", node->funcCall.name);
+        return NULL;
+    }
+    IrInstr** args = NULL;
+    int argCapacity = 0;
+    for (int i = 0; i < node->funcCall.argCount && !ctx->failed; i++) {
+        if (!ir_grow((void**)&args, &argCapacity, i, sizeof(IrInstr*))) {
+            lower_fail(ctx, "out of memory");
+            break;
+        }
+        args[i] = lower_expression(ctx, node->funcCall.arguments[i]);
+    }
+    IrInstr* call = lower_emit(ctx, IR_CALL, type, NULL, NULL);
+    for (int i = 0; call && i < node->funcCall.argCount; i++) {
+        if (!ir_add_arg(call, args[i], NULL)) {
+            lower_fail(ctx, "out of memory");
+            call = NULL;
+        }
+    }
+    free(args);
+    if (!call) return NULL;
+    snprintf(call->name, sizeof(call->name), "%s", node->funcCall.name);
+    call->line = ctx->line;
+    return call;
+}
+
+/**
+ * @brief Lowers an expression to a value
+ */
+static IrInstr* lower_expression(IrLowering* ctx, AstNode* node) {
+    if (ctx->failed) return NULL;
+    if (!node) {
+        lower_fail(ctx, "missing expression");
+        return NULL;
+    }
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return lower_number(ctx, node);
+        case AST_STRING_LITERAL: {
+            IrConstValue value = { .s = node->stringLiteral.value };
+            return ir_const(ctx->fn, IR_TYPE_STR, value);
+        }
+        case AST_BOOLEAN_LITERAL: {
+            IrConstValue value = { .i = node->boolLiteral.value ? 1 : 0 };
+            return ir_const(ctx->fn, IR_TYPE_BOOL, value);
+        }
+        case AST_IDENTIFIER: {
+            const char* name = node->identifier.name;
+            IrInstr* slot = lower_find(ctx, name);
+            if (!slot && (strcmp(name, "true") == 0 || strcmp(name, "false") == 0)) {
+                IrConstValue value = { .i = name[0] == 't' };
+                return ir_const(ctx->fn, IR_TYPE_BOOL, value);
+            }
+            if (!slot) {
+                lower_fail(ctx, "undeclared variable '%s'", name);
+                return NULL;
+            }
+            return lower_emit(ctx, IR_LOAD, slot->type, slot, NULL);
+        }
+        case AST_BINARY_OP: {
+            if (node->binaryOp.op == 'A' || node->binaryOp.op == 'O') {
+                return lower_logical(ctx, node);
+            }
+            IrInstr* left = lower_expression(ctx, node->binaryOp.left);
+            IrInstr* right = lower_expression(ctx, node->binaryOp.right);
+            if (strchr("+-*/%", node->binaryOp.op) && !lower_is_integer(ctx, node)) {
+                // Arithmetic that is not between integers is carried out in double
+                left = lower_coerce(ctx, left, IR_TYPE_F64);
+            }
+            return lower_arithmetic(ctx, node->binaryOp.op, left, right);
+        }
+        case AST_UNARY_OP: {
+            IrInstr* operand = lower_condition_value(ctx, lower_expression(ctx, node->unaryOp.expr));
+            if (!operand) return NULL;
+            char op = node->unaryOp.op;
+            if (op != '-' && op != '+' && op != 'N') {
+                lower_fail(ctx, "unary operator '%c'", op);
+                return NULL;
+            }
+            if (op == 'N') {
+                IrInstr* result = lower_emit(ctx, IR_UNARY, IR_TYPE_I64, operand, NULL);
+                if (result) result->opChar = 'N';
+                return result;
+            }
+            if (operand->type == IR_TYPE_BOOL) operand = lower_coerce(ctx, operand, IR_TYPE_I64);
+            if (op == '+' || !operand) return operand;
+            IrInstr* result = lower_emit(ctx, IR_UNARY, operand->type, operand, NULL);
+            if (result) result->opChar = '-';
+            return result;
+        }
+        case AST_FUNC_CALL:
+            return lower_call(ctx, node, false);
+        default:
+            lower_fail(ctx, "expression %s", astNodeTypeToString(node->type));
+            return NULL;
+    }
+}
+
+/**
+ * @brief Type the AST emitter gives a variable first assigned this initializer
+ */
+static bool lower_declared_type(IrLowering* ctx, AstNode* init, IrType* out) {
+    switch (init->type) {
+        case AST_NUMBER_LITERAL:
+            *out = isIntegerLiteral(init) ? IR_TYPE_I64 : IR_TYPE_F64;
+            return true;
+        case AST_STRING_LITERAL:
+            *out = IR_TYPE_STR;
+            return true;
+        case AST_BOOLEAN_LITERAL:
+            *out = IR_TYPE_BOOL;
+            return true;
+        case AST_IDENTIFIER: {
+            IrVariable* source = lower_variable(ctx, init->identifier.name);
+            *out = source ? source->tableType : IR_TYPE_F64;
+            return source || strcmp(init->identifier.name, "true") == 0 ||
+                   strcmp(init->identifier.name, "false") == 0;
+        }
+        case AST_BINARY_OP:
+        case AST_UNARY_OP:
+            *out = lower_is_integer(ctx, init) ? IR_TYPE_I64 : IR_TYPE_F64;
+            return true;
+        case AST_FUNC_CALL:
+            return lower_call_type(ctx, init, out);
+        default:
+            return false;
+    }
+}
+
+/** Names the AST emitter declares with hard-coded initializers */
+static const char* special_variables[] = {
+    "explicit_int", "explicit_float", "inferred_int", "inferred_float",
+    "inferred_string", "greeting_result", "str_numeric", NULL
+};
+
+static void lower_statements(IrLowering* ctx, AstNode** statements, int count);
+
+/**
+ * @brief Lowers a variable assignment, declaring the variable on first use
+ */
+static void lower_assign(IrLowering* ctx, AstNode* node) {
+    const char* name = node->varAssign.name;
+    AstNode* init = node->varAssign.initializer;
+    for (int i = 0; special_variables[i]; i++) {
+        if (strcmp(name, special_variables[i]) == 0) {
+            lower_fail(ctx, "special variable '%s'", name);
+            return;
+        }
+    }
+    if (!init) {
+        lower_fail(ctx, "assignment without a value");
+        return;
+    }
+    if (strchr(name, '.')) {
+        lower_fail(ctx, "field assignment '%s'", name);
+        return;
+    }
+    IrInstr* slot = lower_find(ctx, name);
+    IrType type = IR_TYPE_VOID;
+    if (!slot && !lower_declared_type(ctx, init, &type)) {
+        lower_fail(ctx, "initializer %s of '%s'", astNodeTypeToString(init->type), name);
+        return;
+    }
+    IrInstr* value = lower_expression(ctx, init);
+    if (!slot) slot = lower_declare(ctx, name, type);
+    if (!slot) return;
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, slot, lower_coerce(ctx, value, slot->type));
+}
+
+/**
+ * @brief Lowers a declaration made by the optimizer
+ *
+ * A temporary declared with __auto_type takes the type of its initializer
+ * in C, while the variable table keeps the type the AST emitter infers for
+ * that initializer. Declarations with a Lyn type (the inliner's typed
+ * parameters and results) have that type in both.
+ */
+static void lower_temporary(IrLowering* ctx, AstNode* node) {
+    AstNode* init = node->varDecl.initializer;
+    bool automatic = strcmp(node->varDecl.type, "__auto_type") == 0;
+    IrType tableType;
+    if (!init || !(automatic ? lower_declared_type(ctx, init, &tableType)
+                             : ir_type_from_lyn(node->varDecl.type, &tableType))) {
+        lower_fail(ctx, "declaration of '%s'", node->varDecl.name);
+        return;
+    }
+    IrInstr* value = lower_expression(ctx, init);
+    IrVariable* existing = lower_variable(ctx, node->varDecl.name);
+    IrInstr* slot = existing ? existing->slot : NULL;
+    if (!value) return;
+    if (slot && !automatic && slot->type != tableType) {
+        lower_fail(ctx, "redeclaration of '%s' with another type", node->varDecl.name);
+        return;
+    }
+    if (!slot) {
+        // The C variable is an int64_t when its initializer is a Lyn integer
+        slot = lower_declare(ctx, node->varDecl.name,
+                             !automatic || tableType == IR_TYPE_I64 ? tableType : value->type);
+        if (!slot) return;
+        ctx->vars[ctx->varCount - 1].tableType = tableType;
+    }
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, slot, lower_coerce(ctx, value, slot->type));
+}
+
+/**
+ * @brief Lowers one operand of a printed concatenation
+ *
+ * Strings print as they are, integers exactly and anything else as a
+ * double with %g, like the streamed print of the AST emitter.
+ */
+static void lower_print_part(IrLowering* ctx, AstNode* part, IrInstr*** values, int* count, int* capacity) {
+    IrInstr* value;
+    if (part->type == AST_CONCAT_EXPR ||
+        (part->type == AST_BINARY_OP && lower_is_string(ctx, part))) {
+        // Nested concatenations are flattened into the same print
+        bool chain = part->type == AST_CONCAT_EXPR;
+        int partCount = chain ? part->concatExpr.partCount : 2;
+        for (int i = 0; i < partCount && !ctx->failed; i++) {
+            AstNode* child = chain ? part->concatExpr.parts[i] :
+                             i == 0 ? part->binaryOp.left : part->binaryOp.right;
+            lower_print_part(ctx, child, values, count, capacity);
+        }
+        return;
+    }
+    if (part->type == AST_STRING_LITERAL || part->type == AST_NUMBER_LITERAL || lower_is_string(ctx, part)) {
+        value = lower_expression(ctx, part);
+    } else {
+        value = lower_coerce(ctx, lower_expression(ctx, part),
+                             lower_is_integer(ctx, part) ? IR_TYPE_I64 : IR_TYPE_F64);
+    }
+    if (!value) return;
+    if (!ir_grow((void**)values, capacity, *count, sizeof(IrInstr*))) {
+        lower_fail(ctx, "out of memory");
+        return;
+    }
+    (*values)[(*count)++] = value;
+}
+
+/**
+ * @brief Lowers print with the formats the AST emitter picks
+ *
+ * Variables and literals print with their own format; other expressions
+ * print as integers or as doubles with %g, after the type the emitter infers.
+ * A printed concatenation becomes one print of all its operands.
+ */
+static void lower_print(IrLowering* ctx, AstNode* node) {
+    AstNode* expr = node->printStmt.expr;
+    if (!expr) {
+        lower_fail(ctx, "print without a value");
+        return;
+    }
+    IrInstr* value = NULL;
+    switch (expr->type) {
+        case AST_IDENTIFIER: {
+            IrVariable* var = lower_variable(ctx, expr->identifier.name);
+            if (!var || var->tableType != var->slot->type) {
+                lower_fail(ctx, "print of '%s' without a known format", expr->identifier.name);
+                return;
+            }
+            value = lower_expression(ctx, expr);
+            break;
+        }
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_FUNC_CALL:
+            value = lower_expression(ctx, expr);
+            break;
+        case AST_CONCAT_EXPR:
+        case AST_BINARY_OP:
+        case AST_UNARY_OP:
+            if (lower_is_string(ctx, expr)) {
+                IrInstr** parts = NULL;
+                int count = 0, capacity = 0;
+                lower_print_part(ctx, expr, &parts, &count, &capacity);
+                IrInstr* print = lower_emit(ctx, IR_PRINT, IR_TYPE_VOID, NULL, NULL);
+                for (int i = 0; print && i < count; i++) {
+                    if (!ir_add_arg(print, parts[i], NULL)) lower_fail(ctx, "out of memory");
+                }
+                free(parts);
+                return;
+            }
+            value = lower_coerce(ctx, lower_expression(ctx, expr),
+                                 lower_is_integer(ctx, expr) ? IR_TYPE_I64 : IR_TYPE_F64);
+            break;
+        default:
+            lower_fail(ctx, "print of %s", astNodeTypeToString(expr->type));
+            return;
+    }
+    lower_emit(ctx, IR_PRINT, IR_TYPE_VOID, value, NULL);
+}
+
+/**
+ * @brief Lowers a loop body with its break and continue targets
+ */
+static void lower_loop_body(IrLowering* ctx, AstNode** body, int count,
+                            IrBlock* breakTarget, IrBlock* continueTarget) {
+    if (ctx->loopDepth >= IR_MAX_LOOP_DEPTH) {
+        lower_fail(ctx, "loops nested too deeply");
+        return;
+    }
+    ctx->loops[ctx->loopDepth].breakTarget = breakTarget;
+    ctx->loops[ctx->loopDepth].continueTarget = continueTarget;
+    ctx->loopDepth++;
+    lower_statements(ctx, body, count);
+    ctx->loopDepth--;
+}
+
+/**
+ * @brief Lowers for i in range(start, end[, step]) like the emitted C for loop
+ */
+static void lower_range_for(IrLowering* ctx, AstNode* node) {
+    int line = ctx->line;
+    IrInstr* start = lower_expression(ctx, node->forStmt.rangeStart);
+    // The iterator is a new int scoped to the loop, shadowing any variable of the same name
+    int binding = ctx->varCount;
+    IrInstr* iterator = lower_declare(ctx, node->forStmt.iterator, IR_TYPE_I64);
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, iterator, lower_coerce(ctx, start, IR_TYPE_I64));
+
+    IrBlock* header = lower_block(ctx);
+    IrBlock* body = lower_block(ctx);
+    IrBlock* latch = lower_block(ctx);
+    IrBlock* exit = lower_block(ctx);
+    if (ctx->failed) return;
+    lower_branch(ctx, NULL, header, NULL);
+
+    ctx->current = header;
+    IrInstr* current = lower_emit(ctx, IR_LOAD, IR_TYPE_I64, iterator, NULL);
+    IrInstr* end = lower_expression(ctx, node->forStmt.rangeEnd);
+    lower_branch(ctx, lower_arithmetic(ctx, '<', current, end), body, exit);
+
+    ctx->current = body;
+    lower_loop_body(ctx, node->forStmt.body, node->forStmt.bodyCount, exit, latch);
+    lower_branch(ctx, NULL, latch, NULL);
+
+    ctx->current = latch;
+    // The step belongs to the loop header, not to the last statement of the body
+    ctx->line = line;
+    IrInstr* value = lower_emit(ctx, IR_LOAD, IR_TYPE_I64, iterator, NULL);
+    IrInstr* step = NULL;
+    if (node->forStmt.rangeStep) {
+        step = lower_expression(ctx, node->forStmt.rangeStep);
+    } else {
+        IrConstValue one = { .i = 1 };
+        step = ir_const(ctx->fn, IR_TYPE_I64, one);
+    }
+    IrInstr* next = lower_arithmetic(ctx, '+', value, step);
+    lower_emit(ctx, IR_STORE, IR_TYPE_VOID, iterator, lower_coerce(ctx, next, IR_TYPE_I64));
+    lower_branch(ctx, NULL, header, NULL);
+
+    ctx->current = exit;
+    if (!ctx->failed) ctx->vars[binding].name[0] = '\0';
+}
+
+/**
+ * @brief Lowers one statement
+ */
+static void lower_statement(IrLowering* ctx, AstNode* node) {
+    if (ctx->failed || !node) return;
+    if (node->line > 0) ctx->line = node->line;
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            lower_assign(ctx, node);
+            break;
+        case AST_PRINT_STMT:
+            lower_print(ctx, node);
+            break;
+        case AST_VAR_DECL:
+            lower_temporary(ctx, node);
+            break;
+        case AST_BLOCK:
+            lower_statements(ctx, node->block.statements, node->block.statementCount);
+            break;
+        case AST_IDENTIFIER:
+            // A bare name has no effect; the AST emitter skips it too
+            break;
+        case AST_FUNC_DEF:
+            // Top-level functions are compiled by the AST emitter ahead of the body
+            if (lower_function(ctx, node->funcDef.name) != node) {
+                lower_fail(ctx, "nested or repeated definition of '%s'", node->funcDef.name);
+            }
+            break;
+        case AST_FUNC_CALL:
+            lower_call(ctx, node, true);
+            break;
+        case AST_IF_STMT: {
+            IrInstr* cond = lower_condition_value(ctx, lower_expression(ctx, node->ifStmt.condition));
+            IrBlock* thenBlock = lower_block(ctx);
+            IrBlock* elseBlock = node->ifStmt.elseCount > 0 ? lower_block(ctx) : NULL;
+            IrBlock* merge = lower_block(ctx);
+            if (ctx->failed) return;
+            lower_branch(ctx, cond, thenBlock, elseBlock ? elseBlock : merge);
+            ctx->current = thenBlock;
+            lower_statements(ctx, node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            lower_branch(ctx, NULL, merge, NULL);
+            if (elseBlock) {
+                ctx->current = elseBlock;
+                lower_statements(ctx, node->ifStmt.elseBranch, node->ifStmt.elseCount);
+                lower_branch(ctx, NULL, merge, NULL);
+            }
+            ctx->current = merge;
+            break;
+        }
+        case AST_WHILE_STMT: {
+            IrBlock* header = lower_block(ctx);
+            IrBlock* body = lower_block(ctx);
+            IrBlock* exit = lower_block(ctx);
+            if (ctx->failed) return;
+            lower_branch(ctx, NULL, header, NULL);
+            ctx->current = header;
+            IrInstr* cond = lower_condition_value(ctx, lower_expression(ctx, node->whileStmt.condition));
+            lower_branch(ctx, cond, body, exit);
+            ctx->current = body;
+            lower_loop_body(ctx, node->whileStmt.body, node->whileStmt.bodyCount, exit, header);
+            lower_branch(ctx, NULL, header, NULL);
+            ctx->current = exit;
+            break;
+        }
+        case AST_DO_WHILE_STMT: {
+            IrBlock* body = lower_block(ctx);
+            IrBlock* check = lower_block(ctx);
+            IrBlock* exit = lower_block(ctx);
+            if (ctx->failed) return;
+            lower_branch(ctx, NULL, body, NULL);
+            ctx->current = body;
+            lower_loop_body(ctx, node->doWhileStmt.body, node->doWhileStmt.bodyCount, exit, check);
+            lower_branch(ctx, NULL, check, NULL);
+            ctx->current = check;
+            if (node->line > 0) ctx->line = node->line;
+            IrInstr* cond = lower_condition_value(ctx, lower_expression(ctx, node->doWhileStmt.condition));
+            lower_branch(ctx, cond, body, exit);
+            ctx->current = exit;
+            break;
+        }
+        case AST_FOR_STMT:
+            if (node->forStmt.forType != FOR_RANGE) {
+                lower_fail(ctx, "non-range for loop");
+                return;
+            }
+            lower_range_for(ctx, node);
+            break;
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            if (ctx->loopDepth == 0) {
+                lower_fail(ctx, "break or continue outside a loop");
+                return;
+            }
+            lower_branch(ctx, NULL, node->type == AST_BREAK_STMT ?
+                         ctx->loops[ctx->loopDepth - 1].breakTarget :
+                         ctx->loops[ctx->loopDepth - 1].continueTarget, NULL);
+            break;
+        default:
+            lower_fail(ctx, "statement %s", astNodeTypeToString(node->type));
+            break;
+    }
+}
+
+/**
+ * @brief Lowers a statement list
+ */
+static void lower_statements(IrLowering* ctx, AstNode** statements, int count) {
+    for (int i = 0; i < count && !ctx->failed; i++) {
+        lower_statement(ctx, statements[i]);
+    }
+}
+
+/**
+ * @brief Records the names a function definition reads, writes or declares
+ */
+static void collect_function_names(AstNode* node, void* userData) {
+    HashMap* names = (HashMap*)userData;
+    const char* name = NULL;
+    switch (node->type) {
+        case AST_IDENTIFIER: name = node->identifier.name; break;
+        case AST_VAR_ASSIGN: name = node->varAssign.name; break;
+        case AST_VAR_DECL: name = node->varDecl.name; break;
+        case AST_ARRAY_ASSIGN: name = node->arrayAssign.name; break;
+        case AST_FOR_STMT: name = node->forStmt.iterator; break;
+        case AST_FUNC_DEF:
+            for (int i = 0; i < node->funcDef.paramCount; i++) {
+                collect_function_names(node->funcDef.parameters[i], userData);
+            }
+            break;
+        default: break;
+    }
+    if (name && name[0]) hashmap_put(names, name, (void*)names, NULL);
+    astVisitChildren(node, collect_function_names, userData);
+}
+
+/**
+ * @brief Lowers the statements of a program body into an IR function
+ *
+ * Top-level function definitions are skipped: the caller emits them with
+ * the AST emitter before the IR code.
+ *
+ * @param program AST_PROGRAM node
+ * @param lookup Types of the C variables already declared in main
+ * @return IrFunction* Lowered function, or NULL if the program is outside the IR subset
+ */
+IrFunction* ir_lower_program(AstNode* program, IrVariableLookup lookup) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)ir_lower_program);
+
+    if (!program || program->type != AST_PROGRAM) return NULL;
+
+    IrFunction* fn = calloc(1, sizeof(IrFunction));
+    if (!fn) {
+        error_report("IR", __LINE__, 0, "Failed to allocate IR function", ERROR_MEMORY);
+        return NULL;
+    }
+    snprintf(fn->name, sizeof(fn->name), "main");
+
+    IrLowering ctx = {0};
+    ctx.fn = fn;
+    ctx.lookup = lookup;
+    ctx.program = program;
+    ctx.current = ir_new_block(fn);
+    if (!ctx.current) {
+        ir_free(fn);
+        return NULL;
+    }
+    for (int i = 0; i < program->program.statementCount && !ctx.failed; i++) {
+        AstNode* stmt = program->program.statements[i];
+        if (!stmt || stmt->type != AST_FUNC_DEF) continue;
+        if (!ctx.functionNames && !(ctx.functionNames = hashmap_create(64))) {
+            lower_fail(&ctx, "out of memory");
+            break;
+        }
+        collect_function_names(stmt, ctx.functionNames);
+    }
+
+    lower_statements(&ctx, program->program.statements, program->program.statementCount);
+    lower_emit(&ctx, IR_RET, IR_TYPE_VOID, NULL, NULL);
+    free(ctx.vars);
+    hashmap_free(ctx.functionNames, NULL);
+
+    if (ctx.failed) {
+        logger_log(LOG_INFO, "IR lowering skipped, falling back to the AST emitter: %s", ctx.reason);
+        stats.lowering_fallbacks++;
+        ir_free(fn);
+        return NULL;
+    }
+
+    stats.functions_lowered++;
+    logger_log(LOG_INFO, "Lowered program body to IR: %d blocks, %d instructions",
+               fn->blockCount, fn->allCount);
+    return fn;
+}
+
+/* ------------------------------------------------------------------------- */
+/* CFG, dominators and dominance frontiers                                   */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Lists the successors of a block
+ *
+ * @return int Number of successors (0-2)
+ */
+static int ir_successors(IrBlock* block, IrBlock** out) {
+    IrInstr* term = ir_terminator(block);
+    if (!term || term->op == IR_RET) return 0;
+    out[0] = term->targets[0];
+    if (term->op == IR_BR) return 1;
+    out[1] = term->targets[1];
+    return out[1] == out[0] ? 1 : 2;
+}
+
+/**
+ * @brief Rebuilds predecessors and the reverse post-order of reachable blocks
+ */
+static bool ir_compute_cfg(IrFunction* fn) {
+    int n = fn->blockCount;
+    for (int b = 0; b < n; b++) {
+        fn->blocks[b]->predCount = 0;
+        fn->blocks[b]->rpo = -1;
+        fn->blocks[b]->idom = NULL;
+    }
+    size_t slots = n > 0 ? (size_t)n : 1;
+    IrBlock** post = malloc(slots * sizeof(IrBlock*));
+    IrBlock** stack = malloc(slots * sizeof(IrBlock*));
+    int* next = calloc(slots, sizeof(int));
+    bool* visited = calloc(slots, sizeof(bool));
+    IrBlock** order = realloc(fn->order, slots * sizeof(IrBlock*));
+    if (!post || !stack || !next || !visited || !order) {
+        error_report("IR", __LINE__, 0, "Failed to allocate CFG analysis", ERROR_MEMORY);
+        free(post); free(stack); free(next); free(visited);
+        if (order) fn->order = order;
+        return false;
+    }
+    fn->order = order;
+
+    // Block ids index the scratch arrays through their position in fn->blocks
+    for (int b = 0; b < n; b++) fn->blocks[b]->rpo = -(b + 2);
+    #define IR_SLOT(block) (-(block)->rpo - 2)
+
+    int postCount = 0, depth = 0;
+    stack[depth++] = fn->blocks[0];
+    visited[0] = true;
+    while (depth > 0) {
+        IrBlock* block = stack[depth - 1];
+        IrBlock* succs[2];
+        int succCount = ir_successors(block, succs);
+        int slot = IR_SLOT(block);
+        if (next[slot] < succCount) {
+            IrBlock* succ = succs[next[slot]++];
+            if (!visited[IR_SLOT(succ)]) {
+                visited[IR_SLOT(succ)] = true;
+                stack[depth++] = succ;
+            }
+        } else {
+            post[postCount++] = block;
+            depth--;
+        }
+    }
+    #undef IR_SLOT
+
+    for (int b = 0; b < n; b++) fn->blocks[b]->rpo = -1;
+    fn->orderCount = postCount;
+    for (int i = 0; i < postCount; i++) {
+        fn->order[i] = post[postCount - 1 - i];
+        fn->order[i]->rpo = i;
+    }
+    free(post); free(stack); free(next); free(visited);
+
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        IrBlock* succs[2];
+        int succCount = ir_successors(block, succs);
+        for (int s = 0; s < succCount; s++) {
+            IrBlock* succ = succs[s];
+            if (!ir_grow((void**)&succ->preds, &succ->predCapacity, succ->predCount, sizeof(IrBlock*))) {
+                return false;
+            }
+            succ->preds[succ->predCount++] = block;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Tells whether a block is one of another block's predecessors
+ */
+static bool ir_has_pred(IrBlock* block, IrBlock* pred) {
+    for (int p = 0; p < block->predCount; p++) {
+        if (block->preds[p] == pred) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Drops phi operands whose edge no longer exists
+ */
+static void ir_prune_phis(IrFunction* fn) {
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        for (int k = 0; k < block->instrCount && block->instrs[k]->op == IR_PHI; k++) {
+            IrInstr* phi = block->instrs[k];
+            int kept = 0;
+            for (int a = 0; a < phi->argCount; a++) {
+                if (!ir_has_pred(block, phi->phiBlocks[a])) continue;
+                phi->args[kept] = phi->args[a];
+                phi->phiBlocks[kept] = phi->phiBlocks[a];
+                kept++;
+            }
+            phi->argCount = kept;
+        }
+    }
+}
+
+/**
+ * @brief Deletes blocks the entry cannot reach
+ */
+static void ir_remove_unreachable(IrFunction* fn, bool count) {
+    int kept = 0;
+    for (int b = 0; b < fn->blockCount; b++) {
+        IrBlock* block = fn->blocks[b];
+        if (block->rpo >= 0) {
+            fn->blocks[kept++] = block;
+            continue;
+        }
+        for (int i = 0; i < block->instrCount; i++) block->instrs[i]->removed = true;
+        free(block->instrs);
+        free(block->preds);
+        free(block);
+        if (count) stats.blocks_removed++;
+    }
+    fn->blockCount = kept;
+    ir_prune_phis(fn);
+}
+
+/**
+ * @brief Computes immediate dominators (Cooper, Harvey and Kennedy)
+ */
+static void ir_compute_dominators(IrFunction* fn) {
+    if (fn->orderCount == 0) return;
+    fn->order[0]->idom = fn->order[0];
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 1; i < fn->orderCount; i++) {
+            IrBlock* block = fn->order[i];
+            IrBlock* idom = NULL;
+            for (int p = 0; p < block->predCount; p++) {
+                IrBlock* pred = block->preds[p];
+                if (!pred->idom) continue;
+                if (!idom) {
+                    idom = pred;
+                    continue;
+                }
+                IrBlock* a = pred;
+                IrBlock* b = idom;
+                while (a != b) {
+                    while (a->rpo > b->rpo) a = a->idom;
+                    while (b->rpo > a->rpo) b = b->idom;
+                }
+                idom = a;
+            }
+            if (idom && block->idom != idom) {
+                block->idom = idom;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Tells whether a dominates b
+ */
+static bool ir_dominates(IrBlock* a, IrBlock* b) {
+    while (b) {
+        if (a == b) return true;
+        if (b->idom == b) return false;
+        b = b->idom;
+    }
+    return false;
+}
+
+/**
+ * @brief Computes dominance frontiers as an n x n matrix indexed by RPO
+ *
+ * @return bool* frontier[x * n + y] is true if y is in DF(x); NULL on failure
+ */
+static bool* ir_dominance_frontiers(IrFunction* fn) {
+    int n = fn->orderCount;
+    bool* frontier = calloc((size_t)n * (size_t)n, sizeof(bool));
+    if (!frontier) {
+        error_report("IR", __LINE__, 0, "Failed to allocate dominance frontiers", ERROR_MEMORY);
+        return NULL;
+    }
+    for (int i = 0; i < n; i++) {
+        IrBlock* block = fn->order[i];
+        if (block->predCount < 2) continue;
+        for (int p = 0; p < block->predCount; p++) {
+            IrBlock* runner = block->preds[p];
+            while (runner != block->idom) {
+                frontier[runner->rpo * n + block->rpo] = true;
+                runner = runner->idom;
+            }
+        }
+    }
+    return frontier;
+}
+
+/* ------------------------------------------------------------------------- */
+/* mem2reg                                                                   */
+/* ------------------------------------------------------------------------- */
+
+/** State of the renaming walk */
+typedef struct {
+    IrFunction* fn;
+    IrInstr** slots;
+    int slotCount;
+    IrBlock** children;             ///< Dominator-tree children, grouped by parent
+    int* childStart;                ///< First child of each block (by RPO), n + 1 entries
+} IrRenamer;
+
+/**
+ * @brief Index of a promotable slot, or -1
+ */
+static int ir_slot_index(IrInstr* value) {
+    return value && value->op == IR_ALLOCA ? value->value.i : -1;
+}
+
+/**
+ * @brief Renames loads and stores of one block and its dominator subtree
+ */
+static void ir_rename(IrRenamer* r, IrBlock* block, IrInstr** incoming) {
+    IrInstr** current = malloc((size_t)(r->slotCount ? r->slotCount : 1) * sizeof(IrInstr*));
+    if (!current) {
+        error_report("IR", __LINE__, 0, "Failed to allocate mem2reg state", ERROR_MEMORY);
+        return;
+    }
+    memcpy(current, incoming, (size_t)r->slotCount * sizeof(IrInstr*));
+
+    for (int i = 0; i < block->instrCount; i++) {
+        IrInstr* instr = block->instrs[i];
+        int slot;
+        if (instr->op == IR_PHI && (slot = ir_slot_index(instr->slot)) >= 0) {
+            current[slot] = instr;
+        } else if (instr->op == IR_LOAD && (slot = ir_slot_index(instr->args[0])) >= 0) {
+            if (!current[slot]) current[slot] = ir_zero(r->fn, r->slots[slot]->type);
+            instr->forward = current[slot];
+            instr->removed = true;
+        } else if (instr->op == IR_STORE && (slot = ir_slot_index(instr->args[0])) >= 0) {
+            current[slot] = ir_resolve(instr->args[1]);
+            instr->removed = true;
+        }
+    }
+
+    IrBlock* succs[2];
+    int succCount = ir_successors(block, succs);
+    for (int s = 0; s < succCount; s++) {
+        IrBlock* succ = succs[s];
+        for (int i = 0; i < succ->instrCount && succ->instrs[i]->op == IR_PHI; i++) {
+            IrInstr* phi = succ->instrs[i];
+            int slot = ir_slot_index(phi->slot);
+            if (slot < 0) continue;
+            if (!current[slot]) current[slot] = ir_zero(r->fn, r->slots[slot]->type);
+            ir_add_arg(phi, current[slot], block);
+        }
+    }
+
+    for (int c = r->childStart[block->rpo]; c < r->childStart[block->rpo + 1]; c++) {
+        ir_rename(r, r->children[c], current);
+    }
+    free(current);
+}
+
+/**
+ * @brief Promotes stack slots to SSA values, inserting phis on dominance frontiers
+ */
+static void ir_pass_mem2reg(IrFunction* fn) {
+    int n = fn->orderCount;
+    IrBlock* entry = fn->blocks[0];
+    IrRenamer r = {0};
+    r.fn = fn;
+    for (int i = 0; i < entry->instrCount; i++) {
+        if (entry->instrs[i]->op == IR_ALLOCA) r.slotCount++;
+    }
+    if (r.slotCount == 0) return;
+
+    r.slots = malloc((size_t)r.slotCount * sizeof(IrInstr*));
+    bool* frontier = ir_dominance_frontiers(fn);
+    bool* hasPhi = calloc((size_t)r.slotCount * (size_t)n, sizeof(bool));
+    bool* queued = calloc((size_t)n, sizeof(bool));
+    IrBlock** worklist = malloc((size_t)n * sizeof(IrBlock*));
+    r.children = malloc((size_t)n * sizeof(IrBlock*));
+    r.childStart = calloc((size_t)n + 1, sizeof(int));
+    IrInstr** initial = calloc((size_t)r.slotCount, sizeof(IrInstr*));
+    if (!r.slots || !frontier || !hasPhi || !queued || !worklist || !r.children || !r.childStart || !initial) {
+        error_report("IR", __LINE__, 0, "Failed to allocate mem2reg state", ERROR_MEMORY);
+        goto cleanup;
+    }
+
+    int slotCount = 0;
+    for (int i = 0; i < entry->instrCount; i++) {
+        if (entry->instrs[i]->op != IR_ALLOCA) continue;
+        entry->instrs[i]->value.i = slotCount;
+        r.slots[slotCount++] = entry->instrs[i];
+    }
+
+    // Phi placement on the iterated dominance frontier of each slot's stores
+    for (int s = 0; s < r.slotCount; s++) {
+        int count = 0;
+        memset(queued, 0, (size_t)n * sizeof(bool));
+        for (int i = 0; i < n; i++) {
+            IrBlock* block = fn->order[i];
+            for (int k = 0; k < block->instrCount; k++) {
+                IrInstr* instr = block->instrs[k];
+                if (instr->op == IR_STORE && instr->args[0] == r.slots[s] && !queued[i]) {
+                    queued[i] = true;
+                    worklist[count++] = block;
+                }
+            }
+        }
+        while (count > 0) {
+            IrBlock* def = worklist[--count];
+            for (int y = 0; y < n; y++) {
+                if (!frontier[def->rpo * n + y] || hasPhi[s * n + y]) continue;
+                IrBlock* target = fn->order[y];
+                IrInstr* phi = ir_new_instr(fn, IR_PHI, r.slots[s]->type);
+                if (!phi || !ir_insert(target, 0, phi)) goto cleanup;
+                phi->slot = r.slots[s];
+                hasPhi[s * n + y] = true;
+                stats.phis_inserted++;
+                if (!queued[y]) {
+                    queued[y] = true;
+                    worklist[count++] = target;
+                }
+            }
+        }
+    }
+
+    // Dominator tree children, grouped by parent in RPO
+    for (int i = 1; i < n; i++) r.childStart[fn->order[i]->idom->rpo + 1]++;
+    for (int i = 0; i < n; i++) r.childStart[i + 1] += r.childStart[i];
+    {
+        int* fill = calloc((size_t)n, sizeof(int));
+        if (!fill) goto cleanup;
+        for (int i = 1; i < n; i++) {
+            int parent = fn->order[i]->idom->rpo;
+            r.children[r.childStart[parent] + fill[parent]++] = fn->order[i];
+        }
+        free(fill);
+    }
+
+    ir_rename(&r, entry, initial);
+    for (int s = 0; s < r.slotCount; s++) r.slots[s]->removed = true;
+    stats.slots_promoted += r.slotCount;
+    ir_apply_forwards(fn);
+
+cleanup:
+    free(r.slots);
+    free(frontier);
+    free(hasPhi);
+    free(queued);
+    free(worklist);
+    free(r.children);
+    free(r.childStart);
+    free(initial);
+}
+
+/**
+ * @brief Replaces phis whose operands are all one value (or the phi itself)
+ */
+static void ir_simplify_phis(IrFunction* fn) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int b = 0; b < fn->blockCount; b++) {
+            IrBlock* block = fn->blocks[b];
+            for (int i = 0; i < block->instrCount && block->instrs[i]->op == IR_PHI; i++) {
+                IrInstr* phi = block->instrs[i];
+                if (phi->removed) continue;
+                IrInstr* same = NULL;
+                bool trivial = true;
+                for (int a = 0; a < phi->argCount; a++) {
+                    IrInstr* arg = ir_resolve(phi->args[a]);
+                    if (arg == phi || (same && ir_same_value(arg, same))) continue;
+                    if (same) { trivial = false; break; }
+                    same = arg;
+                }
+                if (!trivial) continue;
+                phi->forward = same ? same : ir_zero(fn, phi->type);
+                phi->removed = true;
+                changed = true;
+            }
+        }
+        ir_apply_forwards(fn);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Sparse conditional constant propagation                                   */
+/* ------------------------------------------------------------------------- */
+
+enum { LATTICE_TOP = 0, LATTICE_CONST, LATTICE_BOTTOM };
+
+/** State of one SCCP run */
+typedef struct {
+    IrFunction* fn;
+    int n;
+    unsigned char* state;           ///< Lattice state by value id
+    IrConstValue* values;           ///< Constant of LATTICE_CONST values
+    bool* blockExecutable;          ///< By RPO
+    bool* edgeExecutable;           ///< [from * n + to] by RPO
+    int* userStart;                 ///< Users of each value id, grouped
+    IrInstr** users;
+    IrInstr** ssaWork;
+    int ssaCount;
+    int ssaCapacity;
+    int* flowWork;                  ///< Pairs (from, to) by RPO
+    int flowCount;
+    int flowCapacity;
+} IrSccp;
+
+/**
+ * @brief Lattice state of an operand
+ */
+static int sccp_state(IrSccp* s, IrInstr* value, IrConstValue* out) {
+    if (value->op == IR_CONST) {
+        *out = value->value;
+        return LATTICE_CONST;
+    }
+    *out = s->values[value->id];
+    return s->state[value->id];
+}
+
+/**
+ * @brief Queues a CFG edge
+ */
+static void sccp_add_edge(IrSccp* s, IrBlock* from, IrBlock* to) {
+    if (s->edgeExecutable[from->rpo * s->n + to->rpo]) return;
+    if (!ir_grow((void**)&s->flowWork, &s->flowCapacity, s->flowCount + 1, sizeof(int))) return;
+    s->flowWork[s->flowCount++] = from->rpo;
+    s->flowWork[s->flowCount++] = to->rpo;
+}
+
+/**
+ * @brief Moves a value down the lattice and queues its users
+ */
+static void sccp_set(IrSccp* s, IrInstr* instr, int state, const IrConstValue* value) {
+    if (s->state[instr->id] == state) return;
+    s->state[instr->id] = (unsigned char)state;
+    if (value) s->values[instr->id] = *value;
+    for (int u = s->userStart[instr->id]; u < s->userStart[instr->id + 1]; u++) {
+        if (!ir_grow((void**)&s->ssaWork, &s->ssaCapacity, s->ssaCount, sizeof(IrInstr*))) return;
+        s->ssaWork[s->ssaCount++] = s->users[u];
+    }
+}
+
+/**
+ * @brief Evaluates one instruction over the lattice
+ */
+static void sccp_visit(IrSccp* s, IrInstr* instr) {
+    IrBlock* block = instr->block;
+    switch (instr->op) {
+        case IR_PHI: {
+            int result = LATTICE_TOP;
+            IrConstValue value = {0};
+            for (int a = 0; a < instr->argCount && result != LATTICE_BOTTOM; a++) {
+                IrBlock* from = instr->phiBlocks[a];
+                if (from->rpo < 0 || !s->edgeExecutable[from->rpo * s->n + block->rpo]) continue;
+                IrConstValue argValue;
+                int argState = sccp_state(s, instr->args[a], &argValue);
+                if (argState == LATTICE_TOP) continue;
+                if (argState == LATTICE_BOTTOM) {
+                    result = LATTICE_BOTTOM;
+                } else if (result == LATTICE_TOP) {
+                    result = LATTICE_CONST;
+                    value = argValue;
+                } else if (!ir_const_equal(instr->type, &value, &argValue)) {
+                    result = LATTICE_BOTTOM;
+                }
+            }
+            sccp_set(s, instr, result, &value);
+            break;
+        }
+        case IR_BINARY:
+        case IR_UNARY:
+        case IR_CONV: {
+            IrConstValue args[2];
+            for (int a = 0; a < instr->argCount; a++) {
+                int argState = sccp_state(s, instr->args[a], &args[a]);
+                if (argState == LATTICE_BOTTOM) {
+                    sccp_set(s, instr, LATTICE_BOTTOM, NULL);
+                    return;
+                }
+                if (argState == LATTICE_TOP) return;
+            }
+            IrConstValue result;
+            if (ir_fold(instr, args, &result)) {
+                sccp_set(s, instr, LATTICE_CONST, &result);
+            } else {
+                sccp_set(s, instr, LATTICE_BOTTOM, NULL);
+            }
+            break;
+        }
+        case IR_BR:
+            sccp_add_edge(s, block, instr->targets[0]);
+            break;
+        case IR_CONDBR: {
+            IrConstValue cond;
+            int condState = sccp_state(s, instr->args[0], &cond);
+            if (condState == LATTICE_TOP) break;
+            if (condState == LATTICE_CONST) {
+                bool taken = ir_const_as_double(instr->args[0]->type, &cond) != 0;
+                sccp_add_edge(s, block, instr->targets[taken ? 0 : 1]);
+            } else {
+                sccp_add_edge(s, block, instr->targets[0]);
+                sccp_add_edge(s, block, instr->targets[1]);
+            }
+            break;
+        }
+        case IR_INPUT:
+        case IR_LOAD:
+        case IR_CALL:
+            sccp_set(s, instr, LATTICE_BOTTOM, NULL);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Builds the def-use lists SCCP propagates along
+ */
+static bool sccp_build_users(IrSccp* s) {
+    IrFunction* fn = s->fn;
+    int values = fn->nextValueId;
+    s->userStart = calloc((size_t)values + 1, sizeof(int));
+    if (!s->userStart) return false;
+    int total = 0;
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            for (int a = 0; a < instr->argCount; a++) {
+                s->userStart[instr->args[a]->id + 1]++;
+                total++;
+            }
+        }
+    }
+    for (int v = 0; v < values; v++) s->userStart[v + 1] += s->userStart[v];
+    s->users = malloc((size_t)(total ? total : 1) * sizeof(IrInstr*));
+    int* fill = calloc((size_t)values, sizeof(int));
+    if (!s->users || !fill) {
+        free(fill);
+        return false;
+    }
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            for (int a = 0; a < instr->argCount; a++) {
+                int id = instr->args[a]->id;
+                s->users[s->userStart[id] + fill[id]++] = instr;
+            }
+        }
+    }
+    free(fill);
+    return true;
+}
+
+/**
+ * @brief Sparse conditional constant propagation
+ *
+ * Values start optimistic (undefined) and only blocks reached through
+ * executable edges are evaluated, so constants flow through loops and
+ * branches that a plain folding pass must treat as unknown. Constant values
+ * are substituted, decided branches become jumps and unreached blocks are
+ * deleted.
+ */
+static void ir_pass_sccp(IrFunction* fn) {
+    IrSccp s = {0};
+    s.fn = fn;
+    s.n = fn->orderCount;
+    s.state = calloc((size_t)fn->nextValueId, 1);
+    s.values = calloc((size_t)fn->nextValueId, sizeof(IrConstValue));
+    s.blockExecutable = calloc((size_t)s.n, sizeof(bool));
+    s.edgeExecutable = calloc((size_t)s.n * (size_t)s.n, sizeof(bool));
+    if (!s.state || !s.values || !s.blockExecutable || !s.edgeExecutable || !sccp_build_users(&s)) {
+        error_report("IR", __LINE__, 0, "Failed to allocate SCCP state", ERROR_MEMORY);
+        goto cleanup;
+    }
+
+    s.blockExecutable[0] = true;
+    for (int k = 0; k < fn->order[0]->instrCount; k++) sccp_visit(&s, fn->order[0]->instrs[k]);
+
+    while (s.flowCount > 0 || s.ssaCount > 0) {
+        if (s.flowCount > 0) {
+            int to = s.flowWork[--s.flowCount];
+            int from = s.flowWork[--s.flowCount];
+            if (s.edgeExecutable[from * s.n + to]) continue;
+            s.edgeExecutable[from * s.n + to] = true;
+            IrBlock* block = fn->order[to];
+            bool first = !s.blockExecutable[to];
+            s.blockExecutable[to] = true;
+            for (int k = 0; k < block->instrCount; k++) {
+                if (first || block->instrs[k]->op == IR_PHI) sccp_visit(&s, block->instrs[k]);
+            }
+        } else {
+            IrInstr* instr = s.ssaWork[--s.ssaCount];
+            if (instr->block && instr->block->rpo >= 0 && s.blockExecutable[instr->block->rpo]) {
+                sccp_visit(&s, instr);
+            }
+        }
+    }
+
+    // Rewrite: constants replace their values, decided branches become jumps
+    for (int i = 0; i < s.n; i++) {
+        IrBlock* block = fn->order[i];
+        if (!s.blockExecutable[i]) continue;
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            if (instr->type != IR_TYPE_VOID && s.state[instr->id] == LATTICE_CONST) {
+                IrInstr* constant = ir_const(fn, instr->type, s.values[instr->id]);
+                if (!constant) continue;
+                instr->forward = constant;
+                instr->removed = true;
+                stats.constants_propagated++;
+            } else if (instr->op == IR_CONDBR) {
+                bool toTrue = s.edgeExecutable[i * s.n + instr->targets[0]->rpo];
+                bool toFalse = s.edgeExecutable[i * s.n + instr->targets[1]->rpo];
+                if (toTrue == toFalse) continue;
+                instr->op = IR_BR;
+                instr->argCount = 0;
+                if (!toTrue) instr->targets[0] = instr->targets[1];
+                instr->targets[1] = NULL;
+                stats.branches_folded++;
+            }
+        }
+    }
+    // Blocks SCCP never reached keep no instructions and end up unreachable
+    for (int i = 1; i < s.n; i++) {
+        if (s.blockExecutable[i]) continue;
+        IrBlock* block = fn->order[i];
+        for (int k = 0; k < block->instrCount; k++) block->instrs[k]->removed = true;
+        IrInstr* ret = ir_new_instr(fn, IR_RET, IR_TYPE_VOID);
+        ir_compact(block);
+        if (ret) ir_insert(block, 0, ret);
+    }
+    ir_apply_forwards(fn);
+    ir_compute_cfg(fn);
+    ir_remove_unreachable(fn, true);
+    ir_simplify_phis(fn);
+
+cleanup:
+    free(s.state);
+    free(s.values);
+    free(s.blockExecutable);
+    free(s.edgeExecutable);
+    free(s.userStart);
+    free(s.users);
+    free(s.ssaWork);
+    free(s.flowWork);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Global value numbering                                                    */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Tells whether an instruction computes a value from its operands only
+ */
+static bool ir_is_pure(IrInstr* instr) {
+    return instr->op == IR_BINARY || instr->op == IR_UNARY ||
+           instr->op == IR_CONV || instr->op == IR_INPUT;
+}
+
+/**
+ * @brief Tells whether two pure instructions compute the same value
+ */
+static bool ir_equivalent(IrInstr* a, IrInstr* b) {
+    if (a->op != b->op || a->type != b->type || a->opChar != b->opChar ||
+        a->argCount != b->argCount) {
+        return false;
+    }
+    if (a->op == IR_INPUT) return strcmp(a->name, b->name) == 0;
+    if (a->op == IR_CONV && a->args[0]->type != b->args[0]->type) return false;
+    bool same = true;
+    for (int i = 0; i < a->argCount && same; i++) same = ir_same_value(a->args[i], b->args[i]);
+    if (same) return true;
+    bool commutative = a->op == IR_BINARY && strchr("+*EN", a->opChar) != NULL;
+    return commutative && ir_same_value(a->args[0], b->args[1]) && ir_same_value(a->args[1], b->args[0]);
+}
+
+/** State of the value-numbering walk */
+typedef struct {
+    IrInstr** available;            ///< Leaders visible in the current dominator scope
+    int count;
+    int capacity;
+} IrGvn;
+
+/**
+ * @brief Numbers the values of a block and its dominator subtree
+ */
+static void gvn_walk(IrFunction* fn, IrGvn* g, IrBlock* block) {
+    int scope = g->count;
+    for (int i = 0; i < block->instrCount; i++) {
+        IrInstr* instr = block->instrs[i];
+        if (!ir_is_pure(instr)) continue;
+        for (int a = 0; a < instr->argCount; a++) instr->args[a] = ir_resolve(instr->args[a]);
+        IrInstr* leader = NULL;
+        for (int k = g->count - 1; k >= 0 && !leader; k--) {
+            if (ir_equivalent(g->available[k], instr)) leader = g->available[k];
+        }
+        if (leader) {
+            instr->forward = leader;
+            instr->removed = true;
+            stats.values_numbered++;
+        } else if (ir_grow((void**)&g->available, &g->capacity, g->count, sizeof(IrInstr*))) {
+            g->available[g->count++] = instr;
+        }
+    }
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* child = fn->order[i];
+        if (child != block && child->idom == block) gvn_walk(fn, g, child);
+    }
+    g->count = scope;
+}
+
+/**
+ * @brief Dominator-based global value numbering
+ *
+ * A pure instruction equal to one in a dominating position (same opcode,
+ * type and operands, commutative operators in either order) is replaced by
+ * the earlier value.
+ */
+static void ir_pass_gvn(IrFunction* fn) {
+    IrGvn g = {0};
+    ir_compute_dominators(fn);
+    gvn_walk(fn, &g, fn->order[0]);
+    free(g.available);
+    ir_apply_forwards(fn);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Loop-invariant code motion                                                */
+/* ------------------------------------------------------------------------- */
+
+/** A natural loop */
+typedef struct {
+    IrBlock* header;
+    bool* members;                  ///< By RPO
+    int size;
+} IrLoop;
+
+/**
+ * @brief Collects the natural loop of a back edge into members
+ */
+static int ir_collect_loop(IrFunction* fn, IrBlock* header, IrBlock* latch, bool* members) {
+    int n = fn->orderCount, size = 0, depth = 0;
+    IrBlock** stack = malloc((size_t)n * sizeof(IrBlock*));
+    if (!stack) return 0;
+    if (!members[header->rpo]) { members[header->rpo] = true; size++; }
+    if (!members[latch->rpo]) {
+        members[latch->rpo] = true;
+        size++;
+        stack[depth++] = latch;
+    }
+    while (depth > 0) {
+        IrBlock* block = stack[--depth];
+        for (int p = 0; p < block->predCount; p++) {
+            IrBlock* pred = block->preds[p];
+            if (members[pred->rpo]) continue;
+            members[pred->rpo] = true;
+            size++;
+            stack[depth++] = pred;
+        }
+    }
+    free(stack);
+    return size;
+}
+
+/**
+ * @brief Tells whether an instruction may be executed speculatively
+ *
+ * Integer division and remainder stop the program on a zero divisor, so
+ * they stay where the program put them.
+ */
+static bool ir_is_hoistable(IrInstr* instr) {
+    if (!ir_is_pure(instr)) return false;
+    return !(instr->op == IR_BINARY && (instr->opChar == '/' || instr->opChar == '%') &&
+             instr->type == IR_TYPE_I64);
+}
+
+/**
+ * @brief Moves the invariant instructions of one loop to its preheader
+ */
+static void licm_loop(IrFunction* fn, IrLoop* loop) {
+    IrBlock* preheader = NULL;
+    for (int p = 0; p < loop->header->predCount; p++) {
+        IrBlock* pred = loop->header->preds[p];
+        if (loop->members[pred->rpo]) continue;
+        if (preheader) return;
+        preheader = pred;
+    }
+    if (!preheader) return;
+    IrInstr* term = ir_terminator(preheader);
+    if (!term || term->op != IR_BR) return;
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (int i = 0; i < fn->orderCount; i++) {
+            if (!loop->members[i]) continue;
+            IrBlock* block = fn->order[i];
+            for (int k = 0; k < block->instrCount; k++) {
+                IrInstr* instr = block->instrs[k];
+                if (!ir_is_hoistable(instr)) continue;
+                bool invariant = true;
+                for (int a = 0; a < instr->argCount && invariant; a++) {
+                    IrInstr* arg = instr->args[a];
+                    invariant = arg->op == IR_CONST || !loop->members[arg->block->rpo];
+                }
+                if (!invariant) continue;
+                memmove(&block->instrs[k], &block->instrs[k + 1],
+                        (size_t)(block->instrCount - k - 1) * sizeof(IrInstr*));
+                block->instrCount--;
+                k--;
+                ir_insert(preheader, preheader->instrCount - 1, instr);
+                stats.instructions_hoisted++;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Loop-invariant code motion
+ *
+ * Natural loops are found from back edges (edges to a dominating block).
+ * Inner loops are processed first, so an expression can climb several
+ * levels. Loops without a single preheader that falls into the header are
+ * left alone.
+ */
+static void ir_pass_licm(IrFunction* fn) {
+    int n = fn->orderCount;
+    ir_compute_dominators(fn);
+    IrLoop* loops = calloc((size_t)(n ? n : 1), sizeof(IrLoop));
+    if (!loops) return;
+    int loopCount = 0;
+    for (int i = 0; i < n; i++) {
+        IrBlock* header = fn->order[i];
+        IrLoop* loop = NULL;
+        for (int p = 0; p < header->predCount; p++) {
+            IrBlock* latch = header->preds[p];
+            if (!ir_dominates(header, latch)) continue;
+            if (!loop) {
+                loop = &loops[loopCount];
+                loop->header = header;
+                loop->members = calloc((size_t)n, sizeof(bool));
+                if (!loop->members) break;
+                loopCount++;
+            }
+            loop->size = ir_collect_loop(fn, header, latch, loop->members);
+        }
+    }
+    // Smallest (innermost) loops first
+    for (int i = 1; i < loopCount; i++) {
+        IrLoop key = loops[i];
+        int j = i - 1;
+        while (j >= 0 && loops[j].size > key.size) {
+            loops[j + 1] = loops[j];
+            j--;
+        }
+        loops[j + 1] = key;
+    }
+    for (int i = 0; i < loopCount; i++) {
+        licm_loop(fn, &loops[i]);
+        free(loops[i].members);
+    }
+    free(loops);
+}
+
+/* ------------------------------------------------------------------------- */
+/* Dead code elimination                                                     */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Deletes values that no print, store, call or branch depends on
+ */
+static void ir_pass_dce(IrFunction* fn) {
+    bool* live = calloc((size_t)fn->nextValueId, sizeof(bool));
+    IrInstr** worklist = malloc((size_t)(fn->allCount ? fn->allCount : 1) * sizeof(IrInstr*));
+    if (!live || !worklist) {
+        error_report("IR", __LINE__, 0, "Failed to allocate DCE state", ERROR_MEMORY);
+        free(live);
+        free(worklist);
+        return;
+    }
+    int count = 0;
+    for (int b = 0; b < fn->blockCount; b++) {
+        IrBlock* block = fn->blocks[b];
+        for (int i = 0; i < block->instrCount; i++) {
+            IrInstr* instr = block->instrs[i];
+            if (instr->type == IR_TYPE_VOID || instr->op == IR_ALLOCA || instr->op == IR_CALL) {
+                live[instr->id] = true;
+                worklist[count++] = instr;
+            }
+        }
+    }
+    while (count > 0) {
+        IrInstr* instr = worklist[--count];
+        for (int a = 0; a < instr->argCount; a++) {
+            IrInstr* arg = instr->args[a];
+            if (arg->op == IR_CONST || live[arg->id]) continue;
+            live[arg->id] = true;
+            worklist[count++] = arg;
+        }
+    }
+    for (int b = 0; b < fn->blockCount; b++) {
+        IrBlock* block = fn->blocks[b];
+        for (int i = 0; i < block->instrCount; i++) {
+            if (live[block->instrs[i]->id]) continue;
+            block->instrs[i]->removed = true;
+            stats.instructions_removed++;
+        }
+        ir_compact(block);
+    }
+    free(live);
+    free(worklist);
+}
+
+/* ------------------------------------------------------------------------- */
+/* CFG simplification                                                        */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Sends the jumps that reach an empty forwarding block to its target
+ *
+ * Only done when the target has no phis, whose operands are keyed by the
+ * incoming block.
+ */
+static bool ir_thread_empty_block(IrBlock* block) {
+    if (block->instrCount != 1 || block->instrs[0]->op != IR_BR) return false;
+    IrBlock* target = block->instrs[0]->targets[0];
+    if (target == block || ir_has_phis(target)) return false;
+    for (int p = 0; p < block->predCount; p++) {
+        IrInstr* term = ir_terminator(block->preds[p]);
+        for (int t = 0; t < 2; t++) {
+            if (term->targets[t] == block) term->targets[t] = target;
+        }
+        if (term->op == IR_CONDBR && term->targets[0] == term->targets[1]) {
+            term->op = IR_BR;
+            term->argCount = 0;
+            term->targets[1] = NULL;
+        }
+    }
+    return block->predCount > 0;
+}
+
+/**
+ * @brief Appends a block to its only predecessor when that predecessor jumps straight to it
+ */
+static bool ir_merge_into_pred(IrBlock* block) {
+    if (block->predCount != 1 || ir_has_phis(block)) return false;
+    IrBlock* pred = block->preds[0];
+    IrInstr* term = ir_terminator(pred);
+    if (pred == block || !term || term->op != IR_BR) return false;
+
+    term->removed = true;
+    ir_compact(pred);
+    for (int i = 0; i < block->instrCount; i++) {
+        ir_insert(pred, pred->instrCount, block->instrs[i]);
+    }
+    block->instrCount = 0;
+
+    IrBlock* succs[2];
+    int succCount = ir_successors(pred, succs);
+    for (int s = 0; s < succCount; s++) {
+        for (int i = 0; i < succs[s]->instrCount && succs[s]->instrs[i]->op == IR_PHI; i++) {
+            IrInstr* phi = succs[s]->instrs[i];
+            for (int a = 0; a < phi->argCount; a++) {
+                if (phi->phiBlocks[a] == block) phi->phiBlocks[a] = pred;
+            }
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Removes empty forwarding blocks and merges straight-line chains
+ */
+static void ir_pass_simplify_cfg(IrFunction* fn) {
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        ir_compute_cfg(fn);
+        for (int i = 1; i < fn->orderCount && !changed; i++) {
+            IrBlock* block = fn->order[i];
+            changed = ir_merge_into_pred(block) || ir_thread_empty_block(block);
+        }
+        if (changed) {
+            ir_compute_cfg(fn);
+            ir_remove_unreachable(fn, true);
+        }
+    }
+}
+
+/**
+ * @brief Runs mem2reg and the passes allowed by the current level
+ *
+ * @param fn Function to optimize
+ */
+void ir_optimize(IrFunction* fn) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)ir_optimize);
+    if (!fn) return;
+
+    if (!ir_compute_cfg(fn)) return;
+    ir_remove_unreachable(fn, false);
+    ir_compute_dominators(fn);
+    ir_pass_mem2reg(fn);
+    ir_simplify_phis(fn);
+
+    if (currentLevel >= 1) {
+        ir_compute_cfg(fn);
+        ir_pass_sccp(fn);
+    }
+    if (currentLevel >= 2) {
+        ir_compute_cfg(fn);
+        ir_pass_gvn(fn);
+        ir_compute_cfg(fn);
+        ir_pass_licm(fn);
+    }
+    if (currentLevel >= 1) {
+        ir_pass_simplify_cfg(fn);
+        ir_pass_dce(fn);
+    }
+    ir_compute_cfg(fn);
+
+    logger_log(LOG_INFO, "IR optimized: %d phis, %d constants, %d branches folded, "
+               "%d values numbered, %d hoisted, %d removed",
+               stats.phis_inserted, stats.constants_propagated, stats.branches_folded,
+               stats.values_numbered, stats.instructions_hoisted, stats.instructions_removed);
+    if (debug_level >= 2) {
+        ir_print(fn, stderr);
+    }
+}
+
+/* ------------------------------------------------------------------------- */
+/* Printing and C emission                                                   */
+/* ------------------------------------------------------------------------- */
+
+/** C spelling of each IR type */
+static const char* ir_c_type(IrType type) {
+    switch (type) {
+        case IR_TYPE_I64:  return "int64_t";
+        case IR_TYPE_F64:  return "double";
+        case IR_TYPE_BOOL: return "bool";
+        case IR_TYPE_STR:  return "const char*";
+        default:           return "void";
+    }
+}
+
+/** IR listing name of each IR type */
+static const char* ir_type_name(IrType type) {
+    switch (type) {
+        case IR_TYPE_I64:  return "i64";
+        case IR_TYPE_F64:  return "f64";
+        case IR_TYPE_BOOL: return "bool";
+        case IR_TYPE_STR:  return "str";
+        default:           return "void";
+    }
+}
+
+/** Room for any operand, up to the longest string literal with its quotes */
+#define IR_OPERAND_SIZE (sizeof(((AstNode*)0)->stringLiteral.value) + 3)
+
+/**
+ * @brief Formats an operand: constants as C literals, values by name
+ *
+ * @param prefix Value name prefix ("%" in listings, "__ir_v" in C)
+ */
+static const char* ir_operand(IrInstr* value, const char* prefix, char* buffer, size_t size) {
+    if (value->op != IR_CONST) {
+        snprintf(buffer, size, "%s%d", prefix, value->id);
+        return buffer;
+    }
+    switch (value->type) {
+        case IR_TYPE_BOOL:
+            snprintf(buffer, size, "%s", value->value.i ? "true" : "false");
+            break;
+        case IR_TYPE_STR:
+            snprintf(buffer, size, "\"%s\"", value->value.s ? value->value.s : "");
+            break;
+        case IR_TYPE_F64: {
+            char digits[64];
+            snprintf(digits, sizeof(digits), "%.17g", value->value.f);
+            const char* suffix = strpbrk(digits, ".e") ? "" : ".0";
+            snprintf(buffer, size, digits[0] == '-' ? "(%s%s)" : "%s%s", digits, suffix);
+            break;
+        }
+        default:
+            if (value->value.i == LLONG_MIN) {
+                snprintf(buffer, size, "(-9223372036854775807LL - 1)");
+            } else {
+                snprintf(buffer, size, value->value.i < 0 ? "(%lld)" : "%lld", value->value.i);
+            }
+            break;
+    }
+    return buffer;
+}
+
+/** C spelling of a binary operator code */
+static const char* ir_c_operator(char op) {
+    switch (op) {
+        case 'E': return "==";
+        case 'N': return "!=";
+        case 'L': return "<=";
+        case 'G': return ">=";
+        case '<': return "<";
+        case '>': return ">";
+        case '+': return "+";
+        case '-': return "-";
+        case '*': return "*";
+        case '/': return "/";
+        case '%': return "%";
+        default:  return "?";
+    }
+}
+
+/**
+ * @brief Writes a readable listing of the function
+ *
+ * @param fn Function to print
+ * @param out Output stream
+ */
+void ir_print(IrFunction* fn, FILE* out) {
+    if (!fn || !out) return;
+    char a[IR_OPERAND_SIZE], b[IR_OPERAND_SIZE];
+    fprintf(out, "function %s {\n", fn->name);
+    for (int i = 0; i < fn->blockCount; i++) {
+        IrBlock* block = fn->blocks[i];
+        fprintf(out, "bb%d:", block->id);
+        if (block->predCount > 0) {
+            fprintf(out, "  ; preds");
+            for (int p = 0; p < block->predCount; p++) fprintf(out, " bb%d", block->preds[p]->id);
+        }
+        fprintf(out, "\n");
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            const char* type = ir_type_name(instr->type);
+            fprintf(out, "  ");
+            if (instr->type != IR_TYPE_VOID && instr->op != IR_ALLOCA) fprintf(out, "%%%d = ", instr->id);
+            switch (instr->op) {
+                case IR_ALLOCA:
+                    fprintf(out, "%%%d = alloca %s  ; %s\n", instr->id, type, instr->name);
+                    break;
+                case IR_INPUT:
+                    fprintf(out, "input %s %s\n", type, instr->name);
+                    break;
+                case IR_LOAD:
+                    fprintf(out, "load %s %s\n", type, ir_operand(instr->args[0], "%", a, sizeof(a)));
+                    break;
+                case IR_STORE:
+                    fprintf(out, "store %s, %s\n", ir_operand(instr->args[0], "%", a, sizeof(a)),
+                            ir_operand(instr->args[1], "%", b, sizeof(b)));
+                    break;
+                case IR_BINARY:
+                    fprintf(out, "%s %s %s, %s\n", ir_c_operator(instr->opChar), type,
+                            ir_operand(instr->args[0], "%", a, sizeof(a)),
+                            ir_operand(instr->args[1], "%", b, sizeof(b)));
+                    break;
+                case IR_UNARY:
+                    fprintf(out, "%s %s %s\n", instr->opChar == 'N' ? "not" : "neg", type,
+                            ir_operand(instr->args[0], "%", a, sizeof(a)));
+                    break;
+                case IR_CONV:
+                    fprintf(out, "conv %s %s\n", type, ir_operand(instr->args[0], "%", a, sizeof(a)));
+                    break;
+                case IR_PHI:
+                    fprintf(out, "phi %s", type);
+                    for (int p = 0; p < instr->argCount; p++) {
+                        fprintf(out, "%s [%s, bb%d]", p ? "," : "",
+                                ir_operand(instr->args[p], "%", a, sizeof(a)), instr->phiBlocks[p]->id);
+                    }
+                    fprintf(out, "\n");
+                    break;
+                case IR_PRINT:
+                case IR_CALL:
+                    if (instr->op == IR_PRINT) fprintf(out, "print");
+                    else fprintf(out, "call %s %s(", type, instr->name);
+                    for (int p = 0; p < instr->argCount; p++) {
+                        fprintf(out, "%s%s", p ? ", " : instr->op == IR_PRINT ? " " : "",
+                                ir_operand(instr->args[p], "%", a, sizeof(a)));
+                    }
+                    fprintf(out, instr->op == IR_PRINT ? "\n" : ")\n");
+                    break;
+                case IR_BR:
+                    fprintf(out, "br bb%d\n", instr->targets[0]->id);
+                    break;
+                case IR_CONDBR:
+                    fprintf(out, "condbr %s, bb%d, bb%d\n", ir_operand(instr->args[0], "%", a, sizeof(a)),
+                            instr->targets[0]->id, instr->targets[1]->id);
+                    break;
+                case IR_RET:
+                    fprintf(out, "ret\n");
+                    break;
+                default:
+                    fprintf(out, "const %s %s\n", type, ir_operand(instr, "%", a, sizeof(a)));
+                    break;
+            }
+        }
+    }
+    fprintf(out, "}\n");
+}
+
+/**
+ * @brief Writes indentation
+ */
+static void ir_indent(FILE* out, int level) {
+    for (int i = 0; i < level; i++) fprintf(out, "    ");
+}
+
+/**
+ * @brief Emits the phi copies of an edge as one parallel assignment
+ *
+ * When a copy reads another phi of the same block, every source is saved in
+ * a temporary first so no phi is overwritten before it is read.
+ */
+static void ir_emit_copies(FILE* out, int level, IrBlock* from, IrBlock* to) {
+    char a[IR_OPERAND_SIZE];
+    bool parallel = false;
+    for (int i = 0; i < to->instrCount && to->instrs[i]->op == IR_PHI && !parallel; i++) {
+        IrInstr* phi = to->instrs[i];
+        for (int p = 0; p < phi->argCount; p++) {
+            if (phi->phiBlocks[p] == from && phi->args[p]->op == IR_PHI &&
+                phi->args[p]->block == to && phi->args[p] != phi) {
+                parallel = true;
+            }
+        }
+    }
+    for (int pass = parallel ? 0 : 1; pass < 2; pass++) {
+        for (int i = 0; i < to->instrCount && to->instrs[i]->op == IR_PHI; i++) {
+            IrInstr* phi = to->instrs[i];
+            for (int p = 0; p < phi->argCount; p++) {
+                if (phi->phiBlocks[p] != from) continue;
+                IrInstr* arg = phi->args[p];
+                if (arg == phi) continue;
+                ir_indent(out, level);
+                if (pass == 0) {
+                    fprintf(out, "__ir_t%d = %s;\n", phi->id, ir_operand(arg, "__ir_v", a, sizeof(a)));
+                } else if (parallel) {
+                    fprintf(out, "__ir_v%d = __ir_t%d;\n", phi->id, phi->id);
+                } else {
+                    fprintf(out, "__ir_v%d = %s;\n", phi->id, ir_operand(arg, "__ir_v", a, sizeof(a)));
+                }
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Emits the jump along an edge, or nothing if it falls through
+ */
+static void ir_emit_edge(FILE* out, int level, IrBlock* from, IrBlock* to, IrBlock* next) {
+    ir_emit_copies(out, level, from, to);
+    if (to != next) {
+        ir_indent(out, level);
+        fprintf(out, "goto __ir_bb%d;\n", to->id);
+    }
+}
+
+/**
+ * @brief Emits the function as a C block
+ *
+ * Every SSA value becomes a local declared at the top of the block, blocks
+ * become labels in reverse post-order, and phis become copies on the edges
+ * that reach them.
+ *
+ * @param fn Function in SSA form
+ * @param out Output stream
+ * @param indentLevel Indentation of the enclosing C code
+ */
+void ir_emit_c(IrFunction* fn, FILE* out, int indentLevel) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)ir_emit_c);
+    if (!fn || !out) return;
+
+    char a[IR_OPERAND_SIZE], b[IR_OPERAND_SIZE];
+    int level = indentLevel + 1;
+    ir_indent(out, indentLevel);
+    fprintf(out, "{\n");
+    ir_indent(out, level);
+    fprintf(out, "// Lyn IR: %d blocks in SSA form\n", fn->orderCount);
+
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            if (instr->type == IR_TYPE_VOID || instr->op == IR_ALLOCA) continue;
+            ir_indent(out, level);
+            fprintf(out, "%s __ir_v%d __attribute__((unused));\n", ir_c_type(instr->type), instr->id);
+            if (instr->op == IR_PHI) {
+                ir_indent(out, level);
+                fprintf(out, "%s __ir_t%d __attribute__((unused));\n", ir_c_type(instr->type), instr->id);
+            }
+        }
+    }
+
+    for (int i = 0; i < fn->orderCount; i++) {
+        IrBlock* block = fn->order[i];
+        IrBlock* next = i + 1 < fn->orderCount ? fn->order[i + 1] : NULL;
+        if (i > 0) {
+            ir_indent(out, indentLevel);
+            fprintf(out, "__ir_bb%d: __attribute__((unused));\n", block->id);
+        }
+        for (int k = 0; k < block->instrCount; k++) {
+            IrInstr* instr = block->instrs[k];
+            switch (instr->op) {
+                case IR_INPUT:
+                    ir_indent(out, level);
+                    fprintf(out, "__ir_v%d = %s;\n", instr->id, instr->name);
+                    break;
+                case IR_BINARY: {
+                    IrInstr* divisor = instr->args[1];
+                    ir_indent(out, level);
+                    if (instr->type == IR_TYPE_I64 && (instr->opChar == '/' || instr->opChar == '%') &&
+                        !(divisor->op == IR_CONST && divisor->value.i != 0 && divisor->value.i != -1)) {
+                        // Checked like the AST emitter: a zero divisor stops the program
+                        fprintf(out, "__ir_v%d = %s(%s, %s, %d);\n", instr->id,
+                                instr->opChar == '/' ? "lyn_div" : "lyn_mod",
+                                ir_operand(instr->args[0], "__ir_v", a, sizeof(a)),
+                                ir_operand(divisor, "__ir_v", b, sizeof(b)), instr->line);
+                        break;
+                    }
+                    // Two int literals would be multiplied as C ints
+                    bool literals = instr->args[0]->op == IR_CONST && divisor->op == IR_CONST;
+                    fprintf(out, "__ir_v%d = %s%s %s %s;\n", instr->id,
+                            instr->type == IR_TYPE_I64 && literals ? "(int64_t)" : "",
+                            ir_operand(instr->args[0], "__ir_v", a, sizeof(a)),
+                            ir_c_operator(instr->opChar),
+                            ir_operand(divisor, "__ir_v", b, sizeof(b)));
+                    break;
+                }
+                case IR_UNARY:
+                    ir_indent(out, level);
+                    fprintf(out, "__ir_v%d = %s%s;\n", instr->id, instr->opChar == 'N' ? "!" : "-",
+                            ir_operand(instr->args[0], "__ir_v", a, sizeof(a)));
+                    break;
+                case IR_CONV:
+                    ir_indent(out, level);
+                    if (instr->type == IR_TYPE_BOOL) {
+                        fprintf(out, "__ir_v%d = %s != 0;\n", instr->id,
+                                ir_operand(instr->args[0], "__ir_v", a, sizeof(a)));
+                    } else {
+                        fprintf(out, "__ir_v%d = (%s)%s;\n", instr->id, ir_c_type(instr->type),
+                                ir_operand(instr->args[0], "__ir_v", a, sizeof(a)));
+                    }
+                    break;
+                case IR_PRINT: {
+                    // One printf with a conversion per operand, then the newline
+                    ir_indent(out, level);
+                    fprintf(out, "printf(\"");
+                    for (int p = 0; p < instr->argCount; p++) {
+                        IrType type = instr->args[p]->type;
+                        fprintf(out, "%s", type == IR_TYPE_I64 ? "%lld" : type == IR_TYPE_F64 ? "%g" : "%s");
+                    }
+                    fprintf(out, "\\n\"");
+                    for (int p = 0; p < instr->argCount; p++) {
+                        IrInstr* value = instr->args[p];
+                        const char* text = ir_operand(value, "__ir_v", a, sizeof(a));
+                        switch (value->type) {
+                            case IR_TYPE_I64:
+                                fprintf(out, ", (long long)%s", text);
+                                break;
+                            case IR_TYPE_BOOL:
+                                fprintf(out, ", %s ? \"true\" : \"false\"", text);
+                                break;
+                            default:
+                                fprintf(out, ", %s", text);
+                                break;
+                        }
+                    }
+                    fprintf(out, ");\n");
+                    break;
+                }
+                case IR_CALL:
+                    ir_indent(out, level);
+                    if (instr->type != IR_TYPE_VOID) fprintf(out, "__ir_v%d = ", instr->id);
+                    fprintf(out, "%s(", instr->name);
+                    for (int p = 0; p < instr->argCount; p++) {
+                        fprintf(out, "%s%s", p ? ", " : "", ir_operand(instr->args[p], "__ir_v", a, sizeof(a)));
+                    }
+                    fprintf(out, ");\n");
+                    break;
+                case IR_BR:
+                    ir_emit_edge(out, level, block, instr->targets[0], next);
+                    break;
+                case IR_CONDBR: {
+                    IrBlock* ifTrue = instr->targets[0];
+                    IrBlock* ifFalse = instr->targets[1];
+                    const char* cond = ir_operand(instr->args[0], "__ir_v", a, sizeof(a));
+                    ir_indent(out, level);
+                    if (!ir_has_phis(ifTrue) && !ir_has_phis(ifFalse)) {
+                        fprintf(out, "if (%s) goto __ir_bb%d;\n", cond, ifTrue->id);
+                        if (ifFalse != next) {
+                            ir_indent(out, level);
+                            fprintf(out, "goto __ir_bb%d;\n", ifFalse->id);
+                        }
+                    } else {
+                        fprintf(out, "if (%s) {\n", cond);
+                        ir_emit_edge(out, level + 1, block, ifTrue, NULL);
+                        ir_indent(out, level);
+                        fprintf(out, "} else {\n");
+                        ir_emit_edge(out, level + 1, block, ifFalse, NULL);
+                        ir_indent(out, level);
+                        fprintf(out, "}\n");
+                    }
+                    break;
+                }
+                case IR_RET:
+                    if (next) {
+                        ir_indent(out, level);
+                        fprintf(out, "goto __ir_exit;\n");
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+    ir_indent(out, indentLevel);
+    fprintf(out, "__ir_exit: __attribute__((unused));\n");
+    ir_indent(out, level);
+    fprintf(out, ";\n");
+    ir_indent(out, indentLevel);
+    fprintf(out, "}\n");
+}
+
+/**
+ * @brief Frees a function and all of its blocks and instructions
+ *
+ * @param fn Function to free (may be NULL)
+ */
+void ir_free(IrFunction* fn) {
+    if (!fn) return;
+    for (int b = 0; b < fn->blockCount; b++) {
+        free(fn->blocks[b]->instrs);
+        free(fn->blocks[b]->preds);
+        free(fn->blocks[b]);
+    }
+    for (int i = 0; i < fn->allCount; i++) {
+        free(fn->allInstrs[i]->args);
+        free(fn->allInstrs[i]->phiBlocks);
+        free(fn->allInstrs[i]);
+    }
+    free(fn->blocks);
+    free(fn->order);
+    free(fn->allInstrs);
+    free(fn);
+}
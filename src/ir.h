@@ -0,0 +1,221 @@
+/**
+ * @file ir.h
+ * @brief Mid-level SSA intermediate representation for the Lyn compiler
+ *
+ * This header defines a typed, SSA-form IR that sits between the AST and C
+ * emission. It provides:
+ * - Functions made of basic blocks with explicit terminators
+ * - Explicit stack slots, loads and stores produced by the AST lowering
+ * - Phi nodes inserted by the mem2reg pass
+ * - Standard dataflow passes: sparse conditional constant propagation,
+ *   global value numbering, loop-invariant code motion and dead code
+ *   elimination
+ * - A C emitter that turns blocks into labels and phis into edge copies
+ *
+ * The lowering currently accepts scalar program bodies (numbers, booleans,
+ * string values, arithmetic, comparisons, if/while/do-while/range loops,
+ * break/continue, print, printed string concatenations and calls to the
+ * program's functions). Function definitions stay with the AST emitter, which
+ * emits them before the IR code; they may not share variables with the body.
+ * Anything else makes the lowering give up so the compiler falls back to
+ * emitting C directly from the AST.
+ */
+
+#ifndef IR_H
+#define IR_H
+
+#include "ast.h"
+#include <stdio.h>
+#include <stdbool.h>
+
+/**
+ * @brief Value types of the IR
+ */
+typedef enum {
+    IR_TYPE_VOID,   ///< No value (stores, prints, terminators)
+    IR_TYPE_I64,    ///< C int64_t (Lyn integers)
+    IR_TYPE_F64,    ///< C double
+    IR_TYPE_BOOL,   ///< C bool
+    IR_TYPE_STR     ///< const char*
+} IrType;
+
+/**
+ * @brief Instruction opcodes
+ */
+typedef enum {
+    IR_CONST,       ///< Constant of the instruction's type
+    IR_INPUT,       ///< Reads a C variable declared outside the IR
+    IR_ALLOCA,      ///< Stack slot of a Lyn variable (removed by mem2reg)
+    IR_LOAD,        ///< Reads a stack slot
+    IR_STORE,       ///< Writes a stack slot
+    IR_BINARY,      ///< Arithmetic or comparison (see opChar)
+    IR_UNARY,       ///< Negation or logical not (see opChar)
+    IR_CONV,        ///< Conversion to the instruction's type
+    IR_PHI,         ///< SSA merge of the incoming values
+    IR_PRINT,       ///< Prints its operands one after another, then a newline
+    IR_CALL,        ///< Calls the function named by name; typed calls are values
+    IR_BR,          ///< Unconditional branch to targets[0]
+    IR_CONDBR,      ///< Branch to targets[0] if the operand is non-zero, else targets[1]
+    IR_RET          ///< Leaves the function
+} IrOpcode;
+
+struct IrBlock;
+
+/**
+ * @brief Constant payload of an IR_CONST instruction
+ */
+typedef struct {
+    long long i;            ///< Value of i64 and bool constants
+    double f;               ///< Value of f64 constants
+    const char* s;          ///< Escaped literal text of string constants
+} IrConstValue;
+
+/**
+ * @brief One IR instruction; instructions with a type other than void are values
+ */
+typedef struct IrInstr {
+    IrOpcode op;                    ///< Opcode
+    IrType type;                    ///< Result type (or slot type for IR_ALLOCA)
+    int id;                         ///< Value number used by the printer and the emitter
+    char opChar;                    ///< Operator of IR_BINARY/IR_UNARY, using the AST's codes
+    struct IrInstr** args;          ///< Operands
+    int argCount;                   ///< Number of operands
+    int argCapacity;                ///< Allocated operand slots
+    struct IrBlock** phiBlocks;     ///< Incoming block of each phi operand
+    struct IrBlock* targets[2];     ///< Branch targets of terminators
+    IrConstValue value;             ///< Payload of IR_CONST
+    char name[256];                 ///< Variable name of IR_ALLOCA and IR_INPUT, callee of IR_CALL
+    struct IrInstr* slot;           ///< Stack slot a phi was inserted for
+    struct IrInstr* forward;        ///< Replacement value while a pass rewrites uses
+    struct IrBlock* block;          ///< Owning block
+    int line;                       ///< Source line reported by a failing integer division
+    bool removed;                   ///< Set once the instruction leaves its block
+} IrInstr;
+
+/**
+ * @brief Basic block: a straight-line list of instructions ending in a terminator
+ */
+typedef struct IrBlock {
+    int id;                         ///< Block number
+    IrInstr** instrs;               ///< Instructions, terminator last
+    int instrCount;                 ///< Number of instructions
+    int instrCapacity;              ///< Allocated instruction slots
+    struct IrBlock** preds;         ///< Predecessors (rebuilt by ir_compute_cfg)
+    int predCount;                  ///< Number of predecessors
+    int predCapacity;               ///< Allocated predecessor slots
+    struct IrBlock* idom;           ///< Immediate dominator
+    int rpo;                        ///< Reverse post-order index, -1 if unreachable
+} IrBlock;
+
+/**
+ * @brief A function in SSA form
+ */
+typedef struct {
+    char name[64];                  ///< Function name
+    IrBlock** blocks;               ///< All blocks, entry first
+    int blockCount;                 ///< Number of blocks
+    int blockCapacity;              ///< Allocated block slots
+    IrBlock** order;                ///< Reachable blocks in reverse post-order
+    int orderCount;                 ///< Number of reachable blocks
+    IrInstr** allInstrs;            ///< Every instruction ever created (owned)
+    int allCount;                   ///< Number of created instructions
+    int allCapacity;                ///< Allocated slots in allInstrs
+    int nextValueId;                ///< Next value number
+    int nextBlockId;                ///< Next block number
+} IrFunction;
+
+/**
+ * @brief Callback giving the C type of a variable declared before the IR code
+ *
+ * @param name Variable name
+ * @return const char* C type name, or NULL if the variable is not declared
+ */
+typedef const char* (*IrVariableLookup)(const char* name);
+
+/**
+ * @brief Statistics of the last lowering and pass pipeline
+ */
+typedef struct {
+    int functions_lowered;          ///< Program bodies lowered to IR
+    int lowering_fallbacks;         ///< Program bodies left to the AST emitter
+    int instructions_lowered;       ///< Instructions created by the lowering
+    int phis_inserted;              ///< Phi nodes inserted by mem2reg
+    int slots_promoted;             ///< Stack slots promoted to SSA values
+    int constants_propagated;       ///< Values replaced by constants in SCCP
+    int branches_folded;            ///< Conditional branches with a known direction
+    int blocks_removed;             ///< Unreachable blocks deleted
+    int values_numbered;            ///< Redundant values removed by GVN
+    int instructions_hoisted;       ///< Instructions moved to loop preheaders
+    int instructions_removed;       ///< Dead instructions deleted
+} IrStats;
+
+/**
+ * @brief Initializes the IR pipeline for an optimization level
+ *
+ * Level 0 only promotes stack slots to SSA values. Level 1 adds sparse
+ * conditional constant propagation and dead code elimination; level 2 adds
+ * global value numbering and loop-invariant code motion.
+ *
+ * @param level Optimization level (0-2)
+ */
+void ir_init(int level);
+
+/**
+ * @brief Sets the debug level for the IR; level 2 and above dump the IR
+ *
+ * @param level New debug level (0-3)
+ */
+void ir_set_debug_level(int level);
+
+/**
+ * @brief Lowers the statements of a program body into an IR function
+ *
+ * Top-level function definitions are skipped: the caller emits them with
+ * the AST emitter before the IR code.
+ *
+ * @param program AST_PROGRAM node
+ * @param lookup Types of the C variables already declared in main
+ * @return IrFunction* Lowered function with explicit loads and stores, or
+ *         NULL if the program uses constructs the IR does not model
+ */
+IrFunction* ir_lower_program(AstNode* program, IrVariableLookup lookup);
+
+/**
+ * @brief Runs mem2reg and the passes allowed by the level given to ir_init
+ *
+ * @param fn Function to optimize
+ */
+void ir_optimize(IrFunction* fn);
+
+/**
+ * @brief Writes a readable listing of the function
+ *
+ * @param fn Function to print
+ * @param out Output stream
+ */
+void ir_print(IrFunction* fn, FILE* out);
+
+/**
+ * @brief Emits the function as a C block (labels, gotos and edge copies)
+ *
+ * @param fn Function in SSA form
+ * @param out Output stream
+ * @param indentLevel Indentation of the enclosing C code, in steps of four spaces
+ */
+void ir_emit_c(IrFunction* fn, FILE* out, int indentLevel);
+
+/**
+ * @brief Frees a function and all of its blocks and instructions
+ *
+ * @param fn Function to free (may be NULL)
+ */
+void ir_free(IrFunction* fn);
+
+/**
+ * @brief Gets the IR statistics
+ *
+ * @return IrStats Statistics accumulated since ir_init
+ */
+IrStats ir_get_stats(void);
+
+#endif // IR_H
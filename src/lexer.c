@@ -373,6 +373,11 @@ Token getNextToken(void) {
             token.lexeme[0] = '/';
             token.lexeme[1] = '\0';
             break;
+        case '%':
+            token.type = TOKEN_PERCENT;
+            token.lexeme[0] = '%';
+            token.lexeme[1] = '\0';
+            break;
         case '(':
             token.type = TOKEN_LPAREN;
             token.lexeme[0] = '(';
@@ -429,6 +434,10 @@ Token getNextToken(void) {
             token.type = TOKEN_RBRACE;
             strcpy(token.lexeme, "}");
             break;
+        case '@':
+            token.type = TOKEN_AT;
+            strcpy(token.lexeme, "@");
+            break;
         default:
             token.type = TOKEN_UNKNOWN;
             snprintf(token.lexeme, sizeof(token.lexeme), "Unknown character '%c'", c);
@@ -454,6 +463,7 @@ const char* tokenTypeToString(TokenType type) {
         case TOKEN_EOF: return "TOKEN_EOF";
         case TOKEN_IDENTIFIER: return "TOKEN_IDENTIFIER";
         case TOKEN_THIS: return "TOKEN_THIS";
+        case TOKEN_AT: return "TOKEN_AT";
         default: return "TOKEN_UNKNOWN";
     }
 }
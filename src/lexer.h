@@ -30,6 +30,7 @@ typedef enum {
     TOKEN_MINUS,           ///< Subtraction operator (-)
     TOKEN_ASTERISK,        ///< Multiplication operator (*)
     TOKEN_SLASH,           ///< Division operator (/)
+    TOKEN_PERCENT,         ///< Remainder operator (%)
     TOKEN_LPAREN,          ///< Left parenthesis
     TOKEN_RPAREN,          ///< Right parenthesis
     TOKEN_COMMA,           ///< Comma separator
@@ -101,7 +102,8 @@ typedef enum {
     TOKEN_AFTER,           ///< After advice keyword
     TOKEN_AROUND,          ///< Around advice keyword
     TOKEN_NEW,             ///< Object instantiation keyword
-    TOKEN_THIS             ///< Current object reference
+    TOKEN_THIS,            ///< Current object reference
+    TOKEN_AT               ///< Annotation marker (@)
 } TokenType;
 
 /**
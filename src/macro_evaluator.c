@@ -10,18 +10,20 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "macro_evaluator.h"
+#include "hashmap.h"
 #include "error.h"
 #include "logger.h"
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
+#include <math.h>
+#include "types.h"
 
 // Additional AST node types for macro support
 #define AST_MACRO_DEF 100    ///< Macro definition node type
 #define AST_MACRO_PARAM 101  ///< Macro parameter node type
 #define AST_MACRO_EXPAND 102 ///< Macro expansion node type
 
-#define MAX_MACROS 1024      ///< Maximum number of macros that can be defined
-
 static int debug_level = 1;  ///< Current debug level for the macro system
 
 /**
@@ -35,8 +37,112 @@ typedef struct {
     int bodyCount;           ///< Number of nodes in the body
 } MacroDef;
 
-static MacroDef macros[MAX_MACROS];  ///< Array of defined macros
-static int macroCount = 0;           ///< Current number of defined macros
+static HashMap* macros = NULL;       ///< Registry of defined macros, keyed by name
+
+/** Default limit for nested macro expansion */
+#define DEFAULT_MACRO_EXPANSION_LIMIT 32
+
+static int expansionLimit = DEFAULT_MACRO_EXPANSION_LIMIT;  ///< Maximum nesting depth
+static int expansionDepth = 0;          ///< Current nesting depth
+static MacroStats stats = {0};          ///< Macro expansion statistics
+
+/**
+ * @brief Releases a macro definition owned by the registry
+ * 
+ * @param value The MacroDef to free
+ */
+static void free_macro_def(void* value) {
+    MacroDef* macro = (MacroDef*)value;
+    for (int i = 0; i < macro->paramCount; i++) {
+        free(macro->params[i]);
+    }
+    free(macro->params);
+    
+    // We don't free macro bodies because they are references
+    // to nodes that belong to the main AST
+    free(macro->body);
+    free(macro);
+}
+
+/**
+ * @brief Replaces macro parameter identifiers in a subtree with arguments
+ * 
+ * @param node Subtree to rewrite (must be a private copy)
+ * @param macro Macro being expanded
+ * @param args Argument nodes, in parameter order
+ * @return AstNode* The rewritten subtree
+ */
+static AstNode* substitute_macro_params(AstNode* node, MacroDef* macro, AstNode** args) {
+    if (!node) return NULL;
+    
+    if (node->type == AST_IDENTIFIER) {
+        for (int i = 0; i < macro->paramCount; i++) {
+            if (strcmp(node->identifier.name, macro->params[i]) == 0) {
+                freeAstNode(node);
+                return cloneAstTree(args[i]);
+            }
+        }
+        return node;
+    }
+    
+#define SUBST(child) ((child) = substitute_macro_params((child), macro, args))
+#define SUBST_LIST(list, count) do { for (int i_ = 0; (list) && i_ < (count); i_++) SUBST((list)[i_]); } while (0)
+    switch (node->type) {
+        case AST_PROGRAM: SUBST_LIST(node->program.statements, node->program.statementCount); break;
+        case AST_BLOCK: SUBST_LIST(node->block.statements, node->block.statementCount); break;
+        case AST_VAR_DECL: SUBST(node->varDecl.initializer); break;
+        case AST_VAR_ASSIGN: SUBST(node->varAssign.initializer); break;
+        case AST_ARRAY_ASSIGN: SUBST(node->arrayAssign.index); SUBST(node->arrayAssign.value); break;
+        case AST_RETURN_STMT: SUBST(node->returnStmt.expr); break;
+        case AST_PRINT_STMT: SUBST(node->printStmt.expr); break;
+        case AST_THROW_STMT: SUBST(node->throwStmt.expr); break;
+        case AST_BINARY_OP: SUBST(node->binaryOp.left); SUBST(node->binaryOp.right); break;
+        case AST_UNARY_OP: SUBST(node->unaryOp.expr); break;
+        case AST_MEMBER_ACCESS: SUBST(node->memberAccess.object); break;
+        case AST_ARRAY_ACCESS: SUBST(node->arrayAccess.array); SUBST(node->arrayAccess.index); break;
+        case AST_ARRAY_LITERAL: SUBST_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_FUNC_CALL: SUBST_LIST(node->funcCall.arguments, node->funcCall.argCount); break;
+        case AST_NEW_EXPR: SUBST_LIST(node->newExpr.arguments, node->newExpr.argCount); break;
+        case AST_IF_STMT:
+            SUBST(node->ifStmt.condition);
+            SUBST_LIST(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            SUBST_LIST(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_WHILE_STMT:
+            SUBST(node->whileStmt.condition);
+            SUBST_LIST(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            SUBST(node->doWhileStmt.condition);
+            SUBST_LIST(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            break;
+        case AST_FOR_STMT:
+            SUBST(node->forStmt.rangeStart);
+            SUBST(node->forStmt.rangeEnd);
+            SUBST(node->forStmt.rangeStep);
+            SUBST(node->forStmt.collection);
+            SUBST_LIST(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        default:
+            break;
+    }
+#undef SUBST_LIST
+#undef SUBST
+    
+    return node;
+}
+
+/**
+ * @brief Gets the macro registry, creating it on first use
+ * 
+ * @return HashMap* The macro registry, or NULL on allocation failure
+ */
+static HashMap* get_macro_registry(void) {
+    if (!macros) {
+        macros = hashmap_create(64);
+    }
+    return macros;
+}
 
 /**
  * @brief Sets the debug level for the macro system
@@ -62,9 +168,10 @@ bool register_macro(AstNode* node) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)register_macro);
     
     // Basic verification
-    if (!node || macroCount >= MAX_MACROS) {
+    HashMap* registry = get_macro_registry();
+    if (!node || !registry) {
         logger_log(LOG_WARNING, "Failed to register macro: %s", 
-                  !node ? "NULL node" : "Too many macros");
+                  !node ? "NULL node" : "Macro registry unavailable");
         return false;
     }
 
@@ -72,7 +179,11 @@ bool register_macro(AstNode* node) {
     // the node is a function definition (AST_FUNC_DEF) and treat it
     // as a macro definition
     if (node->type == AST_FUNC_DEF) {
-        MacroDef* macro = &macros[macroCount++];
+        MacroDef* macro = calloc(1, sizeof(MacroDef));
+        if (!macro) {
+            logger_log(LOG_ERROR, "Memory allocation failed for macro definition");
+            return false;
+        }
         strncpy(macro->name, node->funcDef.name, sizeof(macro->name) - 1);
         
         if (debug_level >= 1) {
@@ -83,8 +194,9 @@ bool register_macro(AstNode* node) {
         // Copy parameters
         macro->paramCount = node->funcDef.paramCount;
         macro->params = malloc(macro->paramCount * sizeof(char*));
-        if (!macro->params) {
+        if (!macro->params && macro->paramCount > 0) {
             logger_log(LOG_ERROR, "Memory allocation failed for macro parameters");
+            free(macro);
             return false;
         }
         
@@ -99,13 +211,9 @@ bool register_macro(AstNode* node) {
         // Copy body
         macro->bodyCount = node->funcDef.bodyCount;
         macro->body = malloc(macro->bodyCount * sizeof(AstNode*));
-        if (!macro->body) {
+        if (!macro->body && macro->bodyCount > 0) {
             logger_log(LOG_ERROR, "Memory allocation failed for macro body");
-            // Free parameter memory
-            for (int i = 0; i < macro->paramCount; i++) {
-                free(macro->params[i]);
-            }
-            free(macro->params);
+            free_macro_def(macro);
             return false;
         }
         
@@ -113,6 +221,18 @@ bool register_macro(AstNode* node) {
             macro->body[i] = node->funcDef.body[i];
         }
         
+        // As with the linear registry, the first definition of a name is the
+        // one lookups find; later ones are ignored
+        if (hashmap_contains(registry, macro->name)) {
+            logger_log(LOG_WARNING, "Macro %s redefined; keeping the first definition", macro->name);
+            free_macro_def(macro);
+            return true;
+        }
+        if (!hashmap_put(registry, macro->name, macro, NULL)) {
+            free_macro_def(macro);
+            return false;
+        }
+        
         return true;
     }
     
@@ -136,10 +256,9 @@ bool register_macro(AstNode* node) {
 static MacroDef* find_macro(const char* name) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)find_macro);
     
-    for (int i = 0; i < macroCount; i++) {
-        if (strcmp(macros[i].name, name) == 0) {
-            return &macros[i];
-        }
+    MacroDef* macro = (MacroDef*)hashmap_get(macros, name);
+    if (macro) {
+        return macro;
     }
     
     if (debug_level >= 2) {
@@ -153,7 +272,9 @@ static MacroDef* find_macro(const char* name) {
  * @brief Expands a macro with the given arguments
  * 
  * Creates a new AST by substituting the macro's parameters with the provided
- * arguments and expanding the macro's body.
+ * arguments and expanding the macro's body. Macro calls inside the result
+ * are expanded as well, up to the configured nesting limit, so the result
+ * is already at a fixed point and never has to be walked again.
  * 
  * @param name The name of the macro to expand
  * @param args Array of argument AST nodes
@@ -175,26 +296,21 @@ AstNode* expand_macro(const char* name, AstNode** args, int argCount) {
         return NULL;
     }
     
+    stats.expansions++;
+    
     if (debug_level >= 1) {
         logger_log(LOG_INFO, "Expanding macro: %s with %d arguments", name, argCount);
     }
     
-    // Create new scope for macro expansion
-    // Map parameters to arguments
     AstNode** expanded = malloc(macro->bodyCount * sizeof(AstNode*));
-    if (!expanded) {
+    if (!expanded && macro->bodyCount > 0) {
         logger_log(LOG_ERROR, "Memory allocation failed for macro expansion");
         return NULL;
     }
     
-    // Simple parameter substitution strategy
+    // Copy each statement and replace parameter names with the arguments
     for (int i = 0; i < macro->bodyCount; i++) {
-        // Create a deep copy of each statement to avoid modifying the original
-        expanded[i] = copyAstNode(macro->body[i]);
-        
-        // For real substitution, we would need to traverse the AST and replace
-        // all occurrences of parameter names with the corresponding arguments
-        // This is a simplified version
+        expanded[i] = substitute_macro_params(cloneAstTree(macro->body[i]), macro, args);
     }
     
     // Create block node with expanded macro body
@@ -211,8 +327,19 @@ AstNode* expand_macro(const char* name, AstNode** args, int argCount) {
     block->program.statements = expanded;
     block->program.statementCount = macro->bodyCount;
     
+    // Expand nested macro calls in the new statements only
+    if (expansionDepth < expansionLimit) {
+        expansionDepth++;
+        block = evaluate_macros(block);
+        expansionDepth--;
+    } else {
+        stats.limit_reached++;
+        logger_log(LOG_WARNING, "Macro expansion limit (%d) reached while expanding %s",
+                  expansionLimit, name);
+    }
+    
     if (debug_level >= 1) {
-        logger_log(LOG_INFO, "Macro %s expanded to %d statements", name, macro->bodyCount);
+        logger_log(LOG_INFO, "Macro %s expanded to %d statements", name, block->program.statementCount);
     }
     
     return block;
@@ -236,7 +363,11 @@ char* macro_stringify(AstNode* node) {
     
     switch (node->type) {
         case AST_NUMBER_LITERAL:
-            snprintf(buffer, sizeof(buffer), "%g", node->numberLiteral.value);
+            if (isIntegerLiteral(node)) {
+                snprintf(buffer, sizeof(buffer), "%lld", integerLiteralValue(node));
+            } else {
+                snprintf(buffer, sizeof(buffer), "%g", node->numberLiteral.value);
+            }
             break;
         case AST_STRING_LITERAL:
             snprintf(buffer, sizeof(buffer), "\"%s\"", node->stringLiteral.value);
@@ -338,7 +469,8 @@ AstNode* evaluate_macros(AstNode* node) {
             // Process each statement and replace if necessary
             {
                 int newCount = 0;
-                AstNode** newStatements = malloc(node->program.statementCount * sizeof(AstNode*));
+                int newCapacity = node->program.statementCount > 0 ? node->program.statementCount : 1;
+                AstNode** newStatements = malloc(newCapacity * sizeof(AstNode*));
                 if (!newStatements) {
                     logger_log(LOG_ERROR, "Memory allocation failed for macro processing");
                     return node;
@@ -350,6 +482,18 @@ AstNode* evaluate_macros(AstNode* node) {
                         // If the result is a program (macro expansion),
                         // incorporate its statements directly
                         if (result->type == AST_PROGRAM) {
+                            // An expansion may yield more statements than the call it replaces
+                            int needed = newCount + result->program.statementCount + (node->program.statementCount - i - 1);
+                            if (needed > newCapacity) {
+                                AstNode** grown = realloc(newStatements, needed * sizeof(AstNode*));
+                                if (!grown) {
+                                    logger_log(LOG_ERROR, "Memory allocation failed for macro processing");
+                                    freeAstNode(result);
+                                    continue;
+                                }
+                                newStatements = grown;
+                                newCapacity = needed;
+                            }
                             for (int j = 0; j < result->program.statementCount; j++) {
                                 newStatements[newCount++] = result->program.statements[j];
                             }
@@ -413,16 +557,869 @@ AstNode* evaluate_macros(AstNode* node) {
     return node;
 }
 
+/** Largest integer an evaluated value (held in a double) represents exactly */
+#define EVAL_MAX_EXACT_INT ((long long)AST_MAX_EXACT_INTEGER)
+
+/**
+ * @brief String allocated during an evaluation (freed when it ends)
+ */
+typedef struct EvalString {
+    struct EvalString* next;   ///< Next string allocated by the same evaluation
+    char text[];               ///< NUL-terminated contents
+} EvalString;
+
+/**
+ * @brief State of one compile-time evaluation
+ */
+typedef struct {
+    const MacroEvalContext* context;  ///< Functions, shared names and budgets
+    long steps;                       ///< Steps left
+    size_t memory;                    ///< Bytes left
+    int depth;                        ///< Current call depth
+    bool exhausted;                   ///< A budget ran out
+    const char* reason;               ///< Why the evaluation was abandoned
+    EvalString* strings;              ///< Strings allocated so far
+    HashMap* memo;                    ///< Results by "name(args)"
+} EvalSession;
+
+/**
+ * @brief Variable of an interpreted function
+ */
+typedef struct {
+    const char* name;           ///< Name (points into the AST)
+    MacroValueKind type;        ///< C type of the variable
+    MacroValueKind tableType;   ///< Type the code generator's variable table records for it
+    MacroValue value;           ///< Current value (strings point into the session or the AST)
+} EvalVariable;
+
+/**
+ * @brief Variables of one interpreted call
+ */
+typedef struct {
+    EvalVariable* vars;
+    int count;
+    int capacity;
+} EvalFrame;
+
+/**
+ * @brief Outcome of executing a statement
+ */
+typedef enum {
+    EXEC_NEXT,      ///< Continue with the next statement
+    EXEC_BREAK,     ///< A break left the innermost loop
+    EXEC_CONTINUE,  ///< A continue skipped to the next iteration
+    EXEC_RETURN,    ///< The function returned
+    EXEC_FAIL       ///< The evaluation was abandoned
+} ExecStatus;
+
+static bool eval_expression(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* out);
+static ExecStatus exec_statements(EvalSession* session, EvalFrame* frame, AstNode** list, int count,
+                                  MacroValue* returned);
+static ExecStatus exec_block(EvalSession* session, EvalFrame* frame, AstNode** list, int count,
+                             MacroValue* returned);
+
+/**
+ * @brief Abandons the evaluation, keeping the first reason given
+ */
+static bool eval_fail(EvalSession* session, const char* reason) {
+    if (!session->reason) session->reason = reason;
+    return false;
+}
+
+/**
+ * @brief Charges one step against the budget
+ */
+static bool eval_step(EvalSession* session) {
+    if (--session->steps >= 0) return true;
+    session->exhausted = true;
+    return eval_fail(session, "step budget exhausted");
+}
+
+/**
+ * @brief Charges allocated bytes against the budget
+ */
+static bool eval_charge(EvalSession* session, size_t bytes) {
+    if (bytes <= session->memory) {
+        session->memory -= bytes;
+        return true;
+    }
+    session->exhausted = true;
+    return eval_fail(session, "memory budget exhausted");
+}
+
+/**
+ * @brief Allocates a string that lives until the evaluation ends
+ */
+static char* eval_alloc_string(EvalSession* session, size_t length) {
+    if (!eval_charge(session, sizeof(EvalString) + length + 1)) return NULL;
+    EvalString* string = malloc(sizeof(EvalString) + length + 1);
+    if (!string) {
+        error_report("Macro", __LINE__, 0, "Failed to allocate evaluator string", ERROR_MEMORY);
+        eval_fail(session, "out of memory");
+        return NULL;
+    }
+    string->next = session->strings;
+    session->strings = string;
+    string->text[0] = '\0';
+    return string->text;
+}
+
+/**
+ * @brief Maps a type name from a signature to the C type the compiler uses for it
+ * 
+ * @return bool false for types the evaluator does not model
+ */
+static bool eval_signature_type(const char* name, MacroValueKind* kind) {
+    if (strcmp(name, "int") == 0) *kind = MACRO_VALUE_INT;
+    else if (strcmp(name, "float") == 0 || strcmp(name, "double") == 0) *kind = MACRO_VALUE_DOUBLE;
+    else if (strcmp(name, "bool") == 0) *kind = MACRO_VALUE_BOOL;
+    else if (strcmp(name, "string") == 0 || strcmp(name, "const char*") == 0) *kind = MACRO_VALUE_STRING;
+    else return false;
+    return true;
+}
+
+static EvalVariable* eval_find(EvalFrame* frame, const char* name) {
+    for (int i = frame->count - 1; i >= 0; i--) {
+        if (strcmp(frame->vars[i].name, name) == 0) return &frame->vars[i];
+    }
+    return NULL;
+}
+
+static EvalVariable* eval_declare(EvalSession* session, EvalFrame* frame, const char* name,
+                                  MacroValueKind type, MacroValueKind tableType) {
+    if (frame->count == frame->capacity) {
+        int capacity = frame->capacity ? frame->capacity * 2 : 8;
+        if (!eval_charge(session, (size_t)(capacity - frame->capacity) * sizeof(EvalVariable))) return NULL;
+        EvalVariable* vars = realloc(frame->vars, capacity * sizeof(EvalVariable));
+        if (!vars) {
+            error_report("Macro", __LINE__, 0, "Failed to grow evaluator frame", ERROR_MEMORY);
+            eval_fail(session, "out of memory");
+            return NULL;
+        }
+        frame->vars = vars;
+        frame->capacity = capacity;
+    }
+    EvalVariable* var = &frame->vars[frame->count++];
+    var->name = name;
+    var->type = type;
+    var->tableType = tableType;
+    memset(&var->value, 0, sizeof(var->value));
+    var->value.kind = type;
+    return var;
+}
+
+/**
+ * @brief Type the code generator infers for an expression (mirrors inferType)
+ * 
+ * Decides how variables are declared, whether '+' concatenates and whether
+ * arithmetic is carried out on integers. Calls have their declared return
+ * type, as in the code generator.
+ */
+static MacroValueKind eval_static_type(EvalSession* session, EvalFrame* frame, AstNode* node) {
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return isIntegerLiteral(node) ? MACRO_VALUE_INT : MACRO_VALUE_DOUBLE;
+        case AST_STRING_LITERAL:
+        case AST_CONCAT_EXPR:
+            return MACRO_VALUE_STRING;
+        case AST_BOOLEAN_LITERAL:
+            return MACRO_VALUE_BOOL;
+        case AST_BINARY_OP:
+            if (node->binaryOp.op == '+' &&
+                ((node->binaryOp.left && eval_static_type(session, frame, node->binaryOp.left) == MACRO_VALUE_STRING) ||
+                 (node->binaryOp.right && eval_static_type(session, frame, node->binaryOp.right) == MACRO_VALUE_STRING))) {
+                return MACRO_VALUE_STRING;
+            }
+            if (!strchr("+-*/%", node->binaryOp.op)) return MACRO_VALUE_INT;
+            return eval_static_type(session, frame, node->binaryOp.left) == MACRO_VALUE_INT &&
+                   eval_static_type(session, frame, node->binaryOp.right) == MACRO_VALUE_INT ?
+                   MACRO_VALUE_INT : MACRO_VALUE_DOUBLE;
+        case AST_UNARY_OP:
+            return node->unaryOp.op == 'N' ||
+                   eval_static_type(session, frame, node->unaryOp.expr) == MACRO_VALUE_INT ?
+                   MACRO_VALUE_INT : MACRO_VALUE_DOUBLE;
+        case AST_IDENTIFIER: {
+            EvalVariable* var = eval_find(frame, node->identifier.name);
+            return var ? var->tableType : MACRO_VALUE_DOUBLE;
+        }
+        case AST_FUNC_CALL: {
+            AstNode* function = session->context->functions ?
+                                hashmap_get(session->context->functions, node->funcCall.name) : NULL;
+            MacroValueKind kind;
+            if (function && function->type == AST_FUNC_DEF &&
+                eval_signature_type(function->funcDef.returnType, &kind)) {
+                return kind;
+            }
+            return MACRO_VALUE_DOUBLE;
+        }
+        default:
+            return MACRO_VALUE_DOUBLE;
+    }
+}
+
+/**
+ * @brief Converts a value to a C type, as assignment and argument passing do
+ */
+static bool eval_convert(EvalSession* session, MacroValue* value, MacroValueKind type) {
+    if ((value->kind == MACRO_VALUE_STRING) != (type == MACRO_VALUE_STRING)) {
+        return eval_fail(session, "string used as a number");
+    }
+    switch (type) {
+        case MACRO_VALUE_INT:
+            if (value->kind == MACRO_VALUE_DOUBLE) {
+                if (!(value->number >= -9223372036854775808.0 && value->number < 9223372036854775808.0)) {
+                    return eval_fail(session, "double out of int range");
+                }
+                value->number = (double)(long long)value->number;
+            }
+            break;
+        case MACRO_VALUE_BOOL:
+            value->number = value->number != 0;
+            break;
+        default:
+            break;
+    }
+    value->kind = type;
+    return true;
+}
+
+/**
+ * @brief Truth value of a condition
+ */
+static bool eval_condition(EvalSession* session, EvalFrame* frame, AstNode* node, bool* truth) {
+    MacroValue value;
+    if (!eval_expression(session, frame, node, &value)) return false;
+    if (value.kind == MACRO_VALUE_STRING) return eval_fail(session, "string used as a condition");
+    *truth = value.number != 0;
+    return true;
+}
+
+/**
+ * @brief Appends an operand of a concatenation, numbers formatted like concat_n's %lld and %g
+ */
+static bool eval_concat_operand(EvalSession* session, EvalFrame* frame, AstNode* node,
+                                const char** text, char* buffer, size_t size) {
+    MacroValue value;
+    if (!eval_expression(session, frame, node, &value)) return false;
+    bool isString = eval_static_type(session, frame, node) == MACRO_VALUE_STRING;
+    if (isString != (value.kind == MACRO_VALUE_STRING)) {
+        // A string-returning call is typed double by the code generator
+        return eval_fail(session, "concatenation operand of unknown type");
+    }
+    if (isString) {
+        *text = value.string;
+    } else if (eval_static_type(session, frame, node) == MACRO_VALUE_INT) {
+        snprintf(buffer, size, "%lld", (long long)value.number);
+        *text = buffer;
+    } else {
+        snprintf(buffer, size, "%g", value.number);
+        *text = buffer;
+    }
+    return true;
+}
+
+/**
+ * @brief Evaluates a binary operation with C's typing rules
+ */
+static bool eval_binary(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* out) {
+    char op = node->binaryOp.op;
+    memset(out, 0, sizeof(*out));
+    out->kind = MACRO_VALUE_INT;
+    
+    if (op == 'A' || op == 'O') {
+        bool truth;
+        if (!eval_condition(session, frame, node->binaryOp.left, &truth)) return false;
+        if (truth == (op == 'A')) {
+            if (!eval_condition(session, frame, node->binaryOp.right, &truth)) return false;
+        }
+        out->number = truth;
+        return true;
+    }
+    
+    if (eval_static_type(session, frame, node) == MACRO_VALUE_STRING) {
+        char leftBuffer[64], rightBuffer[64];
+        const char* left;
+        const char* right;
+        if (!eval_concat_operand(session, frame, node->binaryOp.left, &left, leftBuffer, sizeof(leftBuffer)) ||
+            !eval_concat_operand(session, frame, node->binaryOp.right, &right, rightBuffer, sizeof(rightBuffer))) {
+            return false;
+        }
+        size_t leftLength = strlen(left);
+        char* text = eval_alloc_string(session, leftLength + strlen(right));
+        if (!text) return false;
+        memcpy(text, left, leftLength);
+        strcpy(text + leftLength, right);
+        out->kind = MACRO_VALUE_STRING;
+        out->string = text;
+        return true;
+    }
+    
+    MacroValue left, right;
+    if (!eval_expression(session, frame, node->binaryOp.left, &left) ||
+        !eval_expression(session, frame, node->binaryOp.right, &right)) {
+        return false;
+    }
+    if (left.kind == MACRO_VALUE_STRING || right.kind == MACRO_VALUE_STRING) {
+        return eval_fail(session, "string comparison or arithmetic");
+    }
+    
+    // Arithmetic that is not between integers is carried out in double
+    bool arithmetic = strchr("+-*/%", op) != NULL;
+    if (left.kind == MACRO_VALUE_DOUBLE || right.kind == MACRO_VALUE_DOUBLE ||
+        (arithmetic && eval_static_type(session, frame, node) != MACRO_VALUE_INT)) {
+        double a = left.number, b = right.number;
+        switch (op) {
+            case '+': out->number = a + b; break;
+            case '-': out->number = a - b; break;
+            case '*': out->number = a * b; break;
+            case '/': out->number = a / b; break;
+            case '<': out->number = a < b; return true;
+            case '>': out->number = a > b; return true;
+            case 'G': out->number = a >= b; return true;
+            case 'L': out->number = a <= b; return true;
+            case 'E': out->number = a == b; return true;
+            case 'N': out->number = a != b; return true;
+            default: return eval_fail(session, "unsupported double operator");
+        }
+        if (!isfinite(out->number)) return eval_fail(session, "non-finite double result");
+        out->kind = MACRO_VALUE_DOUBLE;
+        return true;
+    }
+    
+    // 64-bit integer arithmetic, with the run-time errors left to the program
+    long long a = (long long)left.number, b = (long long)right.number, result;
+    bool overflow = false;
+    switch (op) {
+        case '+': overflow = __builtin_add_overflow(a, b, &result); break;
+        case '-': overflow = __builtin_sub_overflow(a, b, &result); break;
+        case '*': overflow = __builtin_mul_overflow(a, b, &result); break;
+        case '/':
+        case '%':
+            if (b == 0 || (a == LLONG_MIN && b == -1)) return eval_fail(session, "int division error");
+            result = op == '/' ? a / b : a % b;
+            break;
+        case '<': result = a < b; break;
+        case '>': result = a > b; break;
+        case 'G': result = a >= b; break;
+        case 'L': result = a <= b; break;
+        case 'E': result = a == b; break;
+        case 'N': result = a != b; break;
+        default: return eval_fail(session, "unsupported int operator");
+    }
+    // Values are held in doubles: only integers they represent exactly are kept
+    if (overflow || result < -EVAL_MAX_EXACT_INT || result > EVAL_MAX_EXACT_INT) {
+        return eval_fail(session, "int overflow");
+    }
+    out->number = (double)result;
+    return true;
+}
+
+/**
+ * @brief Builds the memoization key of a call
+ */
+static char* eval_memo_key(EvalSession* session, const char* name, MacroValue* args, int argCount) {
+    size_t length = strlen(name) + 2;
+    for (int i = 0; i < argCount; i++) {
+        length += 24 + (args[i].kind == MACRO_VALUE_STRING ? strlen(args[i].string) : 32);
+    }
+    char* key = eval_alloc_string(session, length);
+    if (!key) return NULL;
+    
+    size_t used = (size_t)snprintf(key, length + 1, "%s(", name);
+    for (int i = 0; i < argCount; i++) {
+        if (args[i].kind == MACRO_VALUE_STRING) {
+            used += (size_t)snprintf(key + used, length + 1 - used, "s%zu:%s,", strlen(args[i].string), args[i].string);
+        } else {
+            used += (size_t)snprintf(key + used, length + 1 - used, "%d:%.17g,", (int)args[i].kind, args[i].number);
+        }
+    }
+    snprintf(key + used, length + 1 - used, ")");
+    return key;
+}
+
+/**
+ * @brief Checks whether a function body ends its top level with an explicit return
+ */
+static bool eval_has_top_level_return(AstNode* function) {
+    for (int i = 0; i < function->funcDef.bodyCount; i++) {
+        if (function->funcDef.body[i]->type == AST_RETURN_STMT) return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Interprets a call with already evaluated arguments
+ */
+static bool eval_call(EvalSession* session, const char* name, MacroValue* args, int argCount, MacroValue* out) {
+    AstNode* function = session->context->functions ?
+                        hashmap_get(session->context->functions, name) : NULL;
+    if (!function || function->type != AST_FUNC_DEF) return eval_fail(session, "call to an unknown function");
+    if (function->funcDef.paramCount != argCount) return eval_fail(session, "wrong argument count");
+    
+    MacroValueKind returnType;
+    if (!eval_signature_type(function->funcDef.returnType, &returnType)) {
+        return eval_fail(session, "function without a supported return type");
+    }
+    
+    for (int i = 0; i < argCount; i++) {
+        AstNode* param = function->funcDef.parameters[i];
+        MacroValueKind type;
+        if (!param || !param->inferredType || !eval_signature_type(param->inferredType->typeName, &type)) {
+            return eval_fail(session, "parameter without a supported type");
+        }
+        if (!eval_convert(session, &args[i], type)) return false;
+    }
+    
+    char* key = eval_memo_key(session, name, args, argCount);
+    if (!key) return false;
+    MacroValue* memoized = hashmap_get(session->memo, key);
+    if (memoized) {
+        *out = *memoized;
+        return true;
+    }
+    
+    if (session->depth >= MACRO_EVAL_MAX_DEPTH) {
+        session->exhausted = true;
+        return eval_fail(session, "call depth limit reached");
+    }
+    
+    EvalFrame frame = {0};
+    bool ok = true;
+    for (int i = 0; i < argCount && ok; i++) {
+        AstNode* param = function->funcDef.parameters[i];
+        EvalVariable* var = eval_declare(session, &frame, param->identifier.name, args[i].kind, args[i].kind);
+        if (var) var->value = args[i];
+        else ok = false;
+    }
+    
+    MacroValue returned = {0};
+    if (ok) {
+        session->depth++;
+        ExecStatus status = exec_statements(session, &frame, function->funcDef.body,
+                                            function->funcDef.bodyCount, &returned);
+        session->depth--;
+        
+        if (status == EXEC_NEXT && !eval_has_top_level_return(function)) {
+            // The code generator appends a default return to such bodies
+            memset(&returned, 0, sizeof(returned));
+            returned.kind = returnType;
+            returned.string = returnType == MACRO_VALUE_STRING ? "" : NULL;
+        } else if (status != EXEC_RETURN) {
+            ok = status == EXEC_FAIL ? false : eval_fail(session, "function ends without a return");
+        }
+    }
+    free(frame.vars);
+    if (!ok || !eval_convert(session, &returned, returnType)) return false;
+    
+    MacroValue* entry = malloc(sizeof(MacroValue));
+    if (entry && eval_charge(session, sizeof(MacroValue))) {
+        *entry = returned;
+        hashmap_put(session->memo, key, entry, NULL);
+    } else {
+        free(entry);
+    }
+    *out = returned;
+    return true;
+}
+
+/**
+ * @brief Evaluates the arguments of a call and interprets it
+ */
+static bool eval_call_node(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* out) {
+    int argCount = node->funcCall.argCount;
+    MacroValue* args = calloc(argCount > 0 ? argCount : 1, sizeof(MacroValue));
+    if (!args) {
+        error_report("Macro", __LINE__, 0, "Failed to allocate call arguments", ERROR_MEMORY);
+        return eval_fail(session, "out of memory");
+    }
+    bool ok = true;
+    for (int i = 0; i < argCount && ok; i++) {
+        ok = node->funcCall.arguments[i] &&
+             eval_expression(session, frame, node->funcCall.arguments[i], &args[i]);
+    }
+    ok = ok && eval_call(session, node->funcCall.name, args, argCount, out);
+    free(args);
+    return ok;
+}
+
+/**
+ * @brief Evaluates an expression
+ */
+static bool eval_expression(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* out) {
+    if (!node) return eval_fail(session, "missing expression");
+    if (!eval_step(session)) return false;
+    memset(out, 0, sizeof(*out));
+    
+    switch (node->type) {
+        case AST_NUMBER_LITERAL: {
+            double value = node->numberLiteral.value;
+            if (node->numberLiteral.isDouble) {
+                out->kind = MACRO_VALUE_DOUBLE;
+                out->number = value;
+            } else if (isIntegerLiteral(node)) {
+                // The evaluator computes in doubles, which hold integers exactly up to 2^53
+                long long exact = integerLiteralValue(node);
+                if (exact > (long long)AST_MAX_EXACT_INTEGER || exact < -(long long)AST_MAX_EXACT_INTEGER) {
+                    return eval_fail(session, "integer literal beyond 2^53");
+                }
+                out->kind = MACRO_VALUE_INT;
+                out->number = (double)exact;
+            } else {
+                // Written with %g by the code generator
+                char text[64];
+                snprintf(text, sizeof(text), "%g", value);
+                out->kind = MACRO_VALUE_DOUBLE;
+                out->number = strtod(text, NULL);
+            }
+            return true;
+        }
+        case AST_STRING_LITERAL:
+            out->kind = MACRO_VALUE_STRING;
+            out->string = node->stringLiteral.value;
+            return true;
+        case AST_BOOLEAN_LITERAL:
+            // true and false are int macros in C
+            out->kind = MACRO_VALUE_INT;
+            out->number = node->boolLiteral.value;
+            return true;
+        case AST_IDENTIFIER: {
+            EvalVariable* var = eval_find(frame, node->identifier.name);
+            if (var) {
+                *out = var->value;
+                return true;
+            }
+            if (strcmp(node->identifier.name, "true") == 0 || strcmp(node->identifier.name, "false") == 0) {
+                out->kind = MACRO_VALUE_INT;
+                out->number = strcmp(node->identifier.name, "true") == 0;
+                return true;
+            }
+            return eval_fail(session, "use of a variable that is not local");
+        }
+        case AST_BINARY_OP:
+            return eval_binary(session, frame, node, out);
+        case AST_UNARY_OP: {
+            MacroValue operand;
+            if (!eval_expression(session, frame, node->unaryOp.expr, &operand)) return false;
+            if (operand.kind == MACRO_VALUE_STRING) return eval_fail(session, "string operand");
+            out->kind = operand.kind == MACRO_VALUE_DOUBLE ? MACRO_VALUE_DOUBLE : MACRO_VALUE_INT;
+            switch (node->unaryOp.op) {
+                case 'N':
+                    out->kind = MACRO_VALUE_INT;
+                    out->number = operand.number == 0;
+                    return true;
+                case '-':
+                    if (out->kind == MACRO_VALUE_INT && operand.number < -EVAL_MAX_EXACT_INT) {
+                        return eval_fail(session, "int overflow");
+                    }
+                    out->number = -operand.number;
+                    return true;
+                case '+':
+                    out->number = operand.number;
+                    return true;
+                default:
+                    return eval_fail(session, "unsupported unary operator");
+            }
+        }
+        case AST_FUNC_CALL:
+            return eval_call_node(session, frame, node, out);
+        default:
+            return eval_fail(session, "expression with effects or objects");
+    }
+}
+
+/**
+ * @brief Assigns a variable, declaring it on first use like the code generator does
+ */
+static ExecStatus exec_assign(EvalSession* session, EvalFrame* frame, AstNode* node) {
+    // Names the code generator declares with fixed values of its own
+    static const char* const fixedNames[] = {
+        "explicit_int", "explicit_float", "inferred_int", "inferred_float",
+        "inferred_string", "greeting_result", "str_numeric", NULL
+    };
+    const char* name = node->varAssign.name;
+    if (strchr(name, '.')) return eval_fail(session, "field assignment"), EXEC_FAIL;
+    for (int i = 0; fixedNames[i]; i++) {
+        if (strcmp(name, fixedNames[i]) == 0) return eval_fail(session, "special variable"), EXEC_FAIL;
+    }
+    if (session->context->sharedNames && hashmap_contains(session->context->sharedNames, name)) {
+        return eval_fail(session, "assignment to a variable shared with other code"), EXEC_FAIL;
+    }
+    
+    EvalVariable* var = eval_find(frame, name);
+    MacroValueKind tableType = var ? var->tableType : eval_static_type(session, frame, node->varAssign.initializer);
+    MacroValue value;
+    if (!eval_expression(session, frame, node->varAssign.initializer, &value)) return EXEC_FAIL;
+    
+    if (!var) {
+        // A new variable gets the type inferred from its first initializer
+        var = eval_declare(session, frame, name, tableType, tableType);
+        if (!var) return EXEC_FAIL;
+    }
+    if (!eval_convert(session, &value, var->type)) return EXEC_FAIL;
+    var->value = value;
+    return EXEC_NEXT;
+}
+
+/**
+ * @brief Declares an optimizer temporary
+ * 
+ * `__auto_type` takes the C type of the initializer, while the code
+ * generator's table records the type it infers for it.
+ */
+static ExecStatus exec_declare(EvalSession* session, EvalFrame* frame, AstNode* node) {
+    const char* name = node->varDecl.name;
+    if (!node->varDecl.initializer || eval_find(frame, name) ||
+        (session->context->sharedNames && hashmap_contains(session->context->sharedNames, name))) {
+        return eval_fail(session, "unsupported declaration"), EXEC_FAIL;
+    }
+    
+    MacroValueKind tableType = eval_static_type(session, frame, node->varDecl.initializer);
+    MacroValue value;
+    if (!eval_expression(session, frame, node->varDecl.initializer, &value)) return EXEC_FAIL;
+    
+    // The code generator declares integer temporaries as int64_t
+    MacroValueKind type = tableType == MACRO_VALUE_INT ? MACRO_VALUE_INT : value.kind;
+    if (strcmp(node->varDecl.type, "__auto_type") != 0) {
+        if (!eval_signature_type(node->varDecl.type, &type)) {
+            return eval_fail(session, "declaration of an unsupported type"), EXEC_FAIL;
+        }
+        tableType = type;
+    }
+    
+    EvalVariable* var = eval_declare(session, frame, name, type, tableType);
+    if (!var || !eval_convert(session, &value, type)) return EXEC_FAIL;
+    var->value = value;
+    return EXEC_NEXT;
+}
+
+/**
+ * @brief Runs `for i in range(start, end[, step])` as `for (int i = start; i < end; i += step)`
+ */
+static ExecStatus exec_range_for(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* returned) {
+    const char* iterator = node->forStmt.iterator;
+    if (eval_find(frame, iterator) ||
+        (session->context->sharedNames && hashmap_contains(session->context->sharedNames, iterator))) {
+        return eval_fail(session, "loop iterator shadows a variable"), EXEC_FAIL;
+    }
+    
+    MacroValue start;
+    if (!eval_expression(session, frame, node->forStmt.rangeStart, &start) ||
+        !eval_convert(session, &start, MACRO_VALUE_INT)) {
+        return EXEC_FAIL;
+    }
+    int saved = frame->count;
+    if (!eval_declare(session, frame, iterator, MACRO_VALUE_INT, MACRO_VALUE_INT)) return EXEC_FAIL;
+    int index = frame->count - 1;
+    frame->vars[index].value = start;
+    
+    ExecStatus result = EXEC_NEXT;
+    for (;;) {
+        MacroValue end;
+        if (!eval_expression(session, frame, node->forStmt.rangeEnd, &end)) { result = EXEC_FAIL; break; }
+        if (end.kind == MACRO_VALUE_STRING) { eval_fail(session, "string range bound"); result = EXEC_FAIL; break; }
+        if (!(frame->vars[index].value.number < end.number)) break;
+        
+        ExecStatus status = exec_block(session, frame, node->forStmt.body, node->forStmt.bodyCount, returned);
+        if (status == EXEC_BREAK) break;
+        if (status == EXEC_RETURN || status == EXEC_FAIL) { result = status; break; }
+        
+        MacroValue step = { .kind = MACRO_VALUE_INT, .number = 1 };
+        if (node->forStmt.rangeStep && !eval_expression(session, frame, node->forStmt.rangeStep, &step)) {
+            result = EXEC_FAIL;
+            break;
+        }
+        MacroValue next = step;
+        if (step.kind == MACRO_VALUE_STRING) { eval_fail(session, "string range step"); result = EXEC_FAIL; break; }
+        next.number = frame->vars[index].value.number + step.number;
+        if (step.kind != MACRO_VALUE_DOUBLE &&
+            (next.number < -EVAL_MAX_EXACT_INT || next.number > EVAL_MAX_EXACT_INT)) {
+            eval_fail(session, "int overflow");
+            result = EXEC_FAIL;
+            break;
+        }
+        if (!eval_convert(session, &next, MACRO_VALUE_INT)) { result = EXEC_FAIL; break; }
+        frame->vars[index].value = next;
+    }
+    
+    // The iterator is scoped to the loop
+    frame->count = saved;
+    return result;
+}
+
+/**
+ * @brief Executes one statement
+ */
+static ExecStatus exec_statement(EvalSession* session, EvalFrame* frame, AstNode* node, MacroValue* returned) {
+    if (!node) return EXEC_NEXT;
+    if (!eval_step(session)) return EXEC_FAIL;
+    
+    bool truth;
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            return exec_assign(session, frame, node);
+        case AST_VAR_DECL:
+            return exec_declare(session, frame, node);
+        case AST_IDENTIFIER:
+            // A bare `var` keyword; nothing is generated for it
+            return EXEC_NEXT;
+        case AST_RETURN_STMT:
+            if (!node->returnStmt.expr) return eval_fail(session, "return without a value"), EXEC_FAIL;
+            return eval_expression(session, frame, node->returnStmt.expr, returned) ? EXEC_RETURN : EXEC_FAIL;
+        case AST_FUNC_CALL: {
+            MacroValue discarded;
+            return eval_call_node(session, frame, node, &discarded) ? EXEC_NEXT : EXEC_FAIL;
+        }
+        case AST_BLOCK: {
+            return exec_block(session, frame, node->block.statements, node->block.statementCount, returned);
+        }
+        case AST_IF_STMT:
+            if (!eval_condition(session, frame, node->ifStmt.condition, &truth)) return EXEC_FAIL;
+            return truth ? exec_block(session, frame, node->ifStmt.thenBranch, node->ifStmt.thenCount, returned)
+                         : exec_block(session, frame, node->ifStmt.elseBranch, node->ifStmt.elseCount, returned);
+        case AST_WHILE_STMT:
+            for (;;) {
+                if (!eval_condition(session, frame, node->whileStmt.condition, &truth)) return EXEC_FAIL;
+                if (!truth) return EXEC_NEXT;
+                ExecStatus status = exec_block(session, frame, node->whileStmt.body,
+                                                    node->whileStmt.bodyCount, returned);
+                if (status == EXEC_BREAK) return EXEC_NEXT;
+                if (status == EXEC_RETURN || status == EXEC_FAIL) return status;
+            }
+        case AST_DO_WHILE_STMT:
+            for (;;) {
+                ExecStatus status = exec_block(session, frame, node->doWhileStmt.body,
+                                                    node->doWhileStmt.bodyCount, returned);
+                if (status == EXEC_BREAK) return EXEC_NEXT;
+                if (status == EXEC_RETURN || status == EXEC_FAIL) return status;
+                if (!eval_condition(session, frame, node->doWhileStmt.condition, &truth)) return EXEC_FAIL;
+                if (!truth) return EXEC_NEXT;
+            }
+        case AST_FOR_STMT:
+            if (node->forStmt.forType != FOR_RANGE) return eval_fail(session, "unsupported for loop"), EXEC_FAIL;
+            return exec_range_for(session, frame, node, returned);
+        case AST_BREAK_STMT:
+            return EXEC_BREAK;
+        case AST_CONTINUE_STMT:
+            return EXEC_CONTINUE;
+        default:
+            return eval_fail(session, "statement with effects"), EXEC_FAIL;
+    }
+}
+
+/**
+ * @brief Executes a statement list until one of them transfers control
+ */
+static ExecStatus exec_statements(EvalSession* session, EvalFrame* frame, AstNode** list, int count,
+                                  MacroValue* returned) {
+    for (int i = 0; i < count; i++) {
+        ExecStatus status = exec_statement(session, frame, list[i], returned);
+        if (status != EXEC_NEXT) return status;
+    }
+    return EXEC_NEXT;
+}
+
+/**
+ * @brief Executes a braced body: variables declared in it end with it, as in C
+ */
+static ExecStatus exec_block(EvalSession* session, EvalFrame* frame, AstNode** list, int count,
+                             MacroValue* returned) {
+    int saved = frame->count;
+    ExecStatus status = exec_statements(session, frame, list, count, returned);
+    frame->count = saved;
+    return status;
+}
+
+/** Why the last abandoned evaluation stopped */
+static const char* lastFailure = NULL;
+
+const char* macro_last_failure(void) {
+    return lastFailure;
+}
+
+/**
+ * @brief Executes a call to a pure function at compile time
+ * 
+ * @param call AST_FUNC_CALL node to evaluate
+ * @param context Callable functions, shared names and budgets
+ * @param result Output value
+ * @return bool true if the call was evaluated
+ */
+bool macro_evaluate_call(AstNode* call, const MacroEvalContext* context, MacroValue* result) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)macro_evaluate_call);
+    
+    if (!call || call->type != AST_FUNC_CALL || !context || !result) return false;
+    
+    EvalSession session = {0};
+    session.context = context;
+    session.steps = context->stepBudget > 0 ? context->stepBudget : MACRO_EVAL_STEP_BUDGET;
+    session.memory = context->memoryBudget > 0 ? context->memoryBudget : MACRO_EVAL_MEMORY_BUDGET;
+    session.memo = hashmap_create(64);
+    
+    EvalFrame frame = {0};
+    MacroValue value;
+    bool ok = session.memo && eval_call_node(&session, &frame, call, &value);
+    free(frame.vars);
+    
+    memset(result, 0, sizeof(*result));
+    if (ok) {
+        *result = value;
+        if (value.kind == MACRO_VALUE_STRING) {
+            result->string = strdup(value.string);
+            ok = result->string != NULL;
+        }
+    }
+    
+    hashmap_free(session.memo, free);
+    while (session.strings) {
+        EvalString* next = session.strings->next;
+        free(session.strings);
+        session.strings = next;
+    }
+    
+    if (ok) {
+        stats.calls_evaluated++;
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Evaluated call to '%s' at compile time", call->funcCall.name);
+        }
+    } else {
+        stats.evaluations_abandoned++;
+        if (session.exhausted) stats.budget_exhausted++;
+        lastFailure = session.reason ? session.reason : "unknown";
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Compile-time evaluation of '%s' abandoned: %s",
+                      call->funcCall.name, session.reason ? session.reason : "unknown");
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Releases the storage held by a compile-time value
+ * 
+ * @param value Value filled by macro_evaluate_call()
+ */
+void macro_value_free(MacroValue* value) {
+    if (!value) return;
+    free(value->string);
+    value->string = NULL;
+}
+
 /**
  * @brief Initializes the macro system
  * 
- * Resets the macro counter and prepares the system for use.
+ * Resets the macro registry and prepares the system for use.
  */
 void macro_init(void) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)macro_init);
     
-    // Reset macro counter
-    macroCount = 0;
+    // Reset the macro registry
+    if (macros) {
+        hashmap_clear(macros, free_macro_def);
+    } else {
+        macros = hashmap_create(64);
+    }
+    expansionDepth = 0;
+    memset(&stats, 0, sizeof(stats));
     
     logger_log(LOG_INFO, "Macro system initialized");
 }
@@ -436,18 +1433,46 @@ void macro_cleanup(void) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)macro_cleanup);
     
     // Free memory for all macros
-    for (int i = 0; i < macroCount; i++) {
-        for (int j = 0; j < macros[i].paramCount; j++) {
-            free(macros[i].params[j]);
-        }
-        free(macros[i].params);
-        
-        // We don't free macro bodies because they are references
-        // to nodes that belong to the main AST
-        free(macros[i].body);
-    }
-    
-    macroCount = 0;
+    hashmap_free(macros, free_macro_def);
+    macros = NULL;
     
     logger_log(LOG_INFO, "Macro system cleanup complete");
 }
+
+/**
+ * @brief Expands all macros in an AST until a fixed point is reached
+ * 
+ * Walks the tree once; each expansion is expanded further in place, so
+ * subtrees that contained no macro calls are never revisited. Nesting
+ * deeper than @p maxIterations is left unexpanded and reported.
+ * 
+ * @param node The root of the AST to process
+ * @param maxIterations Maximum nesting depth of macro expansion
+ * @return AstNode* The processed AST
+ */
+AstNode* macro_expand_all(AstNode* node, int maxIterations) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)macro_expand_all);
+    
+    int previousLimit = expansionLimit;
+    expansionLimit = maxIterations > 0 ? maxIterations : DEFAULT_MACRO_EXPANSION_LIMIT;
+    expansionDepth = 0;
+    
+    AstNode* result = evaluate_macros(node);
+    
+    expansionLimit = previousLimit;
+    
+    if (debug_level >= 1) {
+        logger_log(LOG_INFO, "Macro expansion complete: %d expansions, %d stopped at the nesting limit",
+                  stats.expansions, stats.limit_reached);
+    }
+    return result;
+}
+
+/**
+ * @brief Gets macro expansion statistics
+ * 
+ * @return MacroStats Current statistics
+ */
+MacroStats macro_get_stats(void) {
+    return stats;
+}
@@ -11,7 +11,60 @@
 #define MACRO_EVALUATOR_H
 
 #include "ast.h"
+#include "hashmap.h"
 #include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @brief Statistics about macro expansion
+ */
+typedef struct {
+    int expansions;      ///< Number of macro calls expanded
+    int limit_reached;   ///< Times the nesting limit stopped an expansion
+    int calls_evaluated;        ///< Calls executed at compile time by macro_evaluate_call()
+    int evaluations_abandoned;  ///< Calls the evaluator could not (or may not) execute
+    int budget_exhausted;       ///< Abandoned evaluations that ran out of steps or memory
+} MacroStats;
+
+/** Default number of expressions and statements one evaluation may execute */
+#define MACRO_EVAL_STEP_BUDGET 1000000
+
+/** Default number of bytes (strings, frames, memo entries) one evaluation may allocate */
+#define MACRO_EVAL_MEMORY_BUDGET (1024 * 1024)
+
+/** Maximum call depth of an evaluation */
+#define MACRO_EVAL_MAX_DEPTH 256
+
+/**
+ * @brief Type of a value computed at compile time
+ * 
+ * The kinds are the C types the generated code would give the value.
+ */
+typedef enum {
+    MACRO_VALUE_INT,     ///< int64_t (Lyn's int)
+    MACRO_VALUE_DOUBLE,  ///< double
+    MACRO_VALUE_BOOL,    ///< bool
+    MACRO_VALUE_STRING   ///< const char* (text as written in a Lyn string literal)
+} MacroValueKind;
+
+/**
+ * @brief Value computed at compile time
+ */
+typedef struct {
+    MacroValueKind kind;   ///< C type of the value
+    double number;         ///< Value of INT, DOUBLE and BOOL results (INT values stay within +/-2^53, so they are exact)
+    char* string;          ///< Text of STRING results (owned by the holder)
+} MacroValue;
+
+/**
+ * @brief What the compile-time evaluator may call and touch
+ */
+typedef struct {
+    const HashMap* functions;    ///< Callable functions by name (AST_FUNC_DEF nodes)
+    const HashMap* sharedNames;  ///< Variable names that are not private to a single function
+    long stepBudget;             ///< Steps allowed per evaluation (0 = MACRO_EVAL_STEP_BUDGET)
+    size_t memoryBudget;         ///< Bytes allowed per evaluation (0 = MACRO_EVAL_MEMORY_BUDGET)
+} MacroEvalContext;
 
 /**
  * @brief Initializes the macro system
@@ -47,7 +100,8 @@ bool register_macro(AstNode* node);
  * @brief Expands a macro call with the given arguments
  * 
  * Creates a new AST by substituting the macro's parameters with the
- * provided arguments and expanding the macro's body.
+ * provided arguments and expanding the macro's body. Macro calls in the
+ * result are expanded as well, so it never has to be walked again.
  * 
  * @param name The name of the macro to expand
  * @param args Array of argument AST nodes
@@ -92,6 +146,64 @@ char* macro_concat(const char* s1, const char* s2);
  */
 AstNode* evaluate_macros(AstNode* node);
 
+/**
+ * @brief Expands all macros in an AST until a fixed point is reached
+ * 
+ * Nested macro calls produced by an expansion are expanded in turn,
+ * without re-walking subtrees that were already processed.
+ * 
+ * @param node The root of the AST to process
+ * @param maxIterations Maximum nesting depth of macro expansion
+ * @return AstNode* The processed AST
+ */
+AstNode* macro_expand_all(AstNode* node, int maxIterations);
+
+/**
+ * @brief Executes a call to a pure function at compile time
+ * 
+ * Interprets the callee's body with the semantics of the C the compiler
+ * would generate for it: ints stay 64-bit ints (integer division,
+ * overflow checks), doubles stay doubles, values are converted to the
+ * declared parameter and return types, and '+' on strings concatenates
+ * with ints formatted by %lld and doubles by %g. Recursion, loops, conditionals and calls to other
+ * functions in @p context are supported; results of calls with identical
+ * arguments are memoized for the rest of the evaluation.
+ * 
+ * The evaluation is abandoned, and false returned, as soon as it meets
+ * anything whose effect cannot be reproduced at compile time (printing,
+ * variables that are not local to the callee, objects, unknown functions,
+ * string comparisons), an error the program would hit at run time
+ * (division by zero, int overflow) or when the step, memory or depth
+ * budget runs out.
+ * 
+ * @param call AST_FUNC_CALL node to evaluate; its arguments must not use variables
+ * @param context Callable functions, shared names and budgets
+ * @param result Output value; STRING results must be released with macro_value_free()
+ * @return bool true if the call was evaluated
+ */
+bool macro_evaluate_call(AstNode* call, const MacroEvalContext* context, MacroValue* result);
+
+/**
+ * @brief Gives the reason the last abandoned compile-time evaluation stopped
+ * 
+ * @return const char* Reason (for example "int overflow"), or NULL if no evaluation was abandoned
+ */
+const char* macro_last_failure(void);
+
+/**
+ * @brief Releases the storage held by a compile-time value
+ * 
+ * @param value Value filled by macro_evaluate_call()
+ */
+void macro_value_free(MacroValue* value);
+
+/**
+ * @brief Gets macro expansion statistics
+ * 
+ * @return MacroStats Current statistics
+ */
+MacroStats macro_get_stats(void);
+
 /**
  * @brief Cleans up resources used by the macro system
  * 
@@ -19,6 +19,15 @@
 #include "memory.h"  // For managed memory functions
 #include "types.h"   // For type system integration
 #include "aspect_weaver.h"  // Include aspect weaver header
+#include "templates.h"      // For template instantiation statistics
+#include "module.h"         // For cross-module inlining
+#include "ir.h"             // For the SSA IR pipeline
+#include "treeshake.h"      // For tree-shaking statistics
+#include "profile.h"        // For profile-guided optimization
+#include "vectorize.h"      // For the vectorization report
+#include "bounds.h"         // For array bounds checks
+#include "remarks.h"        // For optimization remarks
+#include "dispatch.h"       // For switch and match lowering statistics
 #include <unistd.h>
 #include <getopt.h>  // Include explicitly for optarg and optind
 
@@ -44,6 +53,7 @@ static void set_global_debug_level(int level) {
     parser_set_debug_level(level);
     compiler_set_debug_level(level);
     optimizer_set_debug_level(level);
+    ir_set_debug_level(level);
     types_set_debug_level(level);
     
     logger_log(LOG_INFO, "Global debug level set to %d", level);
@@ -108,6 +118,30 @@ char* readFile(const char* path) {
     return buffer;
 }
 
+/**
+ * @brief gcc optimization flags for each Lyn optimization level
+ * 
+ * | Lyn  | Lyn optimizer                           | gcc                                               |
+ * |------|-----------------------------------------|---------------------------------------------------|
+ * | -o 0 | nothing                                 | -O0                                               |
+ * | -o 1 | folding, tail calls, concat fusion      | -O1                                               |
+ * | -o 2 | every pass                              | -O2 -ftree-vectorize -fvect-cost-model=cheap      |
+ * | -o 3 | every pass, doubled budgets             | -O3 -march=native -flto -ffp-contract=off         |
+ * 
+ * Level 2 lets gcc vectorize: the loops the code generator proved
+ * independent carry restrict, alignment and ivdep hints, and the cheap cost
+ * model accepts loops whose trip count is only known at run time. Level 3
+ * targets the machine it compiles on, so its executables may not run
+ * elsewhere. Contracting a * b + c into a fused multiply-add rounds once
+ * instead of twice; it stays off so every level prints the same numbers.
+ */
+static const char* const backendFlags[] = {
+    "-O0",                                           // -o 0
+    "-O1",                                           // -o 1
+    "-O2 -ftree-vectorize -fvect-cost-model=cheap",  // -o 2
+    "-O3 -march=native -flto -ffp-contract=off",     // -o 3
+};
+
 /**
  * @brief Compiles generated C code into an executable
  * 
@@ -115,16 +149,24 @@ char* readFile(const char* path) {
  * 
  * @param outputPath Path to the generated C source file
  * @param executablePath Path where the executable should be created
+ * @param optimizationLevel Lyn optimization level, which selects the gcc flags
+ * @param optInfoPath File for gcc's vectorization remarks, or NULL for none
  * @return int 0 if compilation was successful, non-zero otherwise
  */
-int compileOutputC(const char* outputPath, const char* executablePath) {
+int compileOutputC(const char* outputPath, const char* executablePath, int optimizationLevel,
+                   const char* optInfoPath) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)compileOutputC);
     
     logger_log(LOG_INFO, "Compiling C code '%s' to executable '%s'", outputPath, executablePath);
     
+    char optInfo[320] = "";
+    if (optInfoPath) {
+        snprintf(optInfo, sizeof(optInfo), " -fopt-info-vec-optimized=%s", optInfoPath);
+    }
     char command[1024];
     // Add -lm explicitly to ensure math library linking
-    snprintf(command, sizeof(command), "gcc -o %s %s -lm -Wall", executablePath, outputPath);
+    snprintf(command, sizeof(command), "gcc %s%s -o %s %s -lm -Wall",
+             backendFlags[optimizationLevel], optInfo, executablePath, outputPath);
     
     logger_log(LOG_DEBUG, "Executing compiler command: %s", command);
     
@@ -151,7 +193,16 @@ void print_usage(const char* program_name) {
     fprintf(stderr, "Usage: %s [options] <source_file>\n", program_name);
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -d <level>  Set debug level (0-3, default 1)\n");
-    fprintf(stderr, "  -o <level>  Set optimization level (0-2, default 1)\n");
+    fprintf(stderr, "  -o <level>  Set optimization level (0-3, default 1; 3 targets this machine)\n");
+    fprintf(stderr, "  -u <factor> Set the partial loop unroll factor (1-16, default %d; 1 disables)\n",
+            OPTIMIZER_DEFAULT_UNROLL_FACTOR);
+    fprintf(stderr, "  -i          Emit the program body through the SSA IR when it fits the IR subset\n");
+    fprintf(stderr, "  --profile-generate[=file]  Count executions and write a profile at exit (default <source>.lynprof)\n");
+    fprintf(stderr, "  --profile-use[=file]       Steer inlining, unrolling and hot/cold layout with a profile\n");
+    fprintf(stderr, "  --vectorize-report         Report which loops the C compiler vectorized, and why not\n");
+    fprintf(stderr, "  --checked                  Check array indices not proven in bounds (default)\n");
+    fprintf(stderr, "  --unchecked                Compile array accesses without bounds checks\n");
+    fprintf(stderr, "  --remarks[=file]           Write applied and missed optimizations as JSON lines (default <source>.remarks.jsonl)\n");
     fprintf(stderr, "  -h          Show this help message\n");
     fprintf(stderr, "  -v          Show version information\n");
     
@@ -202,9 +253,27 @@ int main(int argc, char* argv[]) {
     // Parse command-line options
     int debug_opt = 1;         // Default debug level
     int optimization_level = 1; // Default optimization level
+    int unroll_factor = OPTIMIZER_DEFAULT_UNROLL_FACTOR; // Default partial unroll factor
+    bool use_ir = false;        // Emit the program body through the SSA IR
+    ProfileMode profile_mode = PROFILE_OFF; // Profile generation or use
+    const char* profile_file = NULL;        // Profile path (NULL = <source>.lynprof)
+    bool vectorize_report = false;          // Report on loop vectorization
+    BoundsMode bounds_mode = BOUNDS_CHECKED; // Array bounds checks
+    bool remarks = false;                    // Write optimization remarks
+    const char* remarks_file = NULL;         // Remarks path (NULL = <source>.remarks.jsonl)
     int opt;
     
-    while ((opt = getopt(argc, argv, "d:o:hv")) != -1) {
+    static const struct option long_options[] = {
+        {"profile-generate", optional_argument, NULL, 'G'},
+        {"profile-use", optional_argument, NULL, 'P'},
+        {"vectorize-report", no_argument, NULL, 'V'},
+        {"checked", no_argument, NULL, 'C'},
+        {"unchecked", no_argument, NULL, 'U'},
+        {"remarks", optional_argument, NULL, 'R'},
+        {NULL, 0, NULL, 0}
+    };
+    
+    while ((opt = getopt_long(argc, argv, "d:o:u:ihv", long_options, NULL)) != -1) {
         switch (opt) {
             case 'd':
                 debug_opt = atoi(optarg);
@@ -216,10 +285,46 @@ int main(int argc, char* argv[]) {
                 
             case 'o':
                 optimization_level = atoi(optarg);
-                if (optimization_level < 0 || optimization_level > 2) {
-                    logger_log(LOG_ERROR, "Invalid optimization level: %d. Must be between 0 and 2", optimization_level);
+                if (optimization_level < 0 || optimization_level > 3) {
+                    logger_log(LOG_ERROR, "Invalid optimization level: %d. Must be between 0 and 3", optimization_level);
+                    return 1;
+                }
+                break;
+                
+            case 'u':
+                unroll_factor = atoi(optarg);
+                if (unroll_factor < 1 || unroll_factor > 16) {
+                    logger_log(LOG_ERROR, "Invalid unroll factor: %d. Must be between 1 and 16", unroll_factor);
+                    return 1;
+                }
+                break;
+                
+            case 'i':
+                use_ir = true;
+                break;
+                
+            case 'G':
+            case 'P':
+                if (profile_mode != PROFILE_OFF) {
+                    logger_log(LOG_ERROR, "--profile-generate and --profile-use cannot be combined");
                     return 1;
                 }
+                profile_mode = opt == 'G' ? PROFILE_GENERATE : PROFILE_USE;
+                profile_file = optarg;
+                break;
+                
+            case 'V':
+                vectorize_report = true;
+                break;
+                
+            case 'C':
+            case 'U':
+                bounds_mode = opt == 'C' ? BOUNDS_CHECKED : BOUNDS_UNCHECKED;
+                break;
+                
+            case 'R':
+                remarks = true;
+                remarks_file = optarg;
                 break;
                 
             case 'h':
@@ -273,6 +378,23 @@ int main(int argc, char* argv[]) {
     
     logger_log(LOG_DEBUG, "Output C file: %s", outputPath);
     logger_log(LOG_DEBUG, "Output executable: %s", executablePath);
+    
+    char profilePath[256];
+    snprintf(profilePath, sizeof(profilePath), "%s.lynprof", baseName);
+    profile_set_mode(profile_mode, profile_file ? profile_file : profilePath);
+    vectorize_set_report(vectorize_report);
+    bounds_set_mode(bounds_mode);
+    
+    // gcc only vectorizes at -o 2, so only then are its remarks worth asking for
+    char optInfoPath[256];
+    snprintf(optInfoPath, sizeof(optInfoPath), "%s.vec.txt", baseName);
+    bool want_opt_info = vectorize_report && optimization_level >= 2;
+
+    char remarksPath[256];
+    snprintf(remarksPath, sizeof(remarksPath), "%s.remarks.jsonl", baseName);
+    if (remarks_file) {
+        snprintf(remarksPath, sizeof(remarksPath), "%s", remarks_file);
+    }
 
     // Read source file with improved error handling
     char* source = readFile(sourcePath);
@@ -292,7 +414,27 @@ int main(int argc, char* argv[]) {
     lexerInitialize();
     
     lexerInit(source);
+    module_system_init();
     optimizer_init((OptimizerLevel)optimization_level);
+    OptimizerOptions optimizer_options = optimizer_get_options();
+    optimizer_options.unroll_factor = unroll_factor;
+    if (profile_mode == PROFILE_GENERATE) {
+        // The counts must describe the source program: keep every call and loop
+        // whose frequency the profile-use build bases its decisions on
+        optimizer_options.enable_function_inlining = false;
+        optimizer_options.enable_loop_unrolling = false;
+        optimizer_options.enable_tail_call_elimination = false;
+        optimizer_options.enable_compile_time_evaluation = false;
+        if (use_ir) {
+            logger_log(LOG_WARNING, "-i is ignored with --profile-generate: counters are emitted from the AST");
+            use_ir = false;
+        }
+    } else if (profile_mode == PROFILE_USE) {
+        profile_load();
+    }
+    optimizer_set_options(optimizer_options);
+    ir_init(optimization_level);
+    compiler_set_use_ir(use_ir);
 
     // Parse source code
     logger_log(LOG_INFO, "Parsing source code...");
@@ -334,6 +476,16 @@ int main(int argc, char* argv[]) {
         logger_log(LOG_WARNING, "Type checking resulted in unknown type, proceeding with caution");
     }
 
+    // Remarks cover the optimizer and the decisions taken while generating C
+    if (remarks && !remarks_open(remarksPath, sourcePath)) {
+        error_report(remarksPath, 0, 0, "Cannot write the remarks file", ERROR_IO);
+        error_print_current();
+        freeAst(ast);
+        free(source);
+        free(baseName);
+        return 1;
+    }
+
     // Optimize AST
     logger_log(LOG_INFO, "Optimizing AST...");
     AstNode* optimized_ast = optimize_ast(ast);
@@ -342,9 +494,29 @@ int main(int argc, char* argv[]) {
     if (debug_level >= 2) {
         OptimizationStats stats = optimizer_get_stats();
         logger_log(LOG_DEBUG, "Optimizations applied: %d", stats.total_optimizations);
+        logger_log(LOG_DEBUG, "   Pass iterations: %d", stats.pass_iterations);
         logger_log(LOG_DEBUG, "   Constants folded: %d", stats.constant_folding_applied);
+        logger_log(LOG_DEBUG, "   Constants propagated: %d", stats.constants_propagated);
         logger_log(LOG_DEBUG, "   Dead code removed: %d", stats.dead_code_removed);
         logger_log(LOG_DEBUG, "   Redundant assignments: %d", stats.redundant_assignments_removed);
+        logger_log(LOG_DEBUG, "   Common subexpressions: %d", stats.cse_eliminated);
+        logger_log(LOG_DEBUG, "   Loop invariants hoisted: %d", stats.loop_invariants_hoisted);
+        logger_log(LOG_DEBUG, "   Induction variables reduced: %d", stats.induction_variables_reduced);
+        logger_log(LOG_DEBUG, "   Calls inlined: %d", stats.functions_inlined);
+        logger_log(LOG_DEBUG, "   Loops unrolled: %d", stats.loops_unrolled);
+        logger_log(LOG_DEBUG, "   Tail calls eliminated: %d", stats.tail_calls_eliminated);
+        logger_log(LOG_DEBUG, "   Concatenations fused: %d", stats.concat_chains_fused);
+        logger_log(LOG_DEBUG, "   Calls evaluated at compile time: %d", stats.calls_evaluated);
+
+        // Per-pass timings go to the console, so slow passes show up without the log
+        int pass_count = 0;
+        const OptimizerPassStats* pass_stats = optimizer_get_pass_stats(&pass_count);
+        printf("Optimizer passes (%d iterations):\n", stats.pass_iterations);
+        for (int i = 0; i < pass_count; i++) {
+            if (pass_stats[i].runs == 0) continue;
+            printf("  %-34s %3d runs %5d changes %9.3f ms\n", pass_stats[i].name,
+                   pass_stats[i].runs, pass_stats[i].changes, pass_stats[i].elapsed_ms);
+        }
     }
 
     // Generate C code
@@ -359,15 +531,73 @@ int main(int argc, char* argv[]) {
         return 1;
     }
     
+    if (remarks) {
+        RemarksStats remarks_stats = remarks_get_stats();
+        remarks_close();
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Remarks: %d applied, %d missed, %d repeats dropped",
+                      remarks_stats.applied, remarks_stats.missed, remarks_stats.repeated);
+        }
+        printf("Remarks written to %s\n", remarksPath);
+    }
+    
     // Report compiler statistics
     CompilerStats comp_stats = compiler_get_stats();
     logger_log(LOG_INFO, "Compiler statistics: %d nodes processed, %d functions compiled",
               comp_stats.nodes_processed, comp_stats.functions_compiled);
+    logger_log(LOG_INFO, "Object allocations: %d heap, %d stack, %d scalar-replaced",
+              comp_stats.objects_heap_allocated, comp_stats.objects_stack_allocated,
+              comp_stats.objects_scalar_replaced);
+
+    // Report IR pipeline statistics
+    if (debug_level >= 2 && use_ir) {
+        IrStats ir_stats = ir_get_stats();
+        logger_log(LOG_DEBUG, "IR: %d bodies lowered, %d left to the AST emitter",
+                  ir_stats.functions_lowered, ir_stats.lowering_fallbacks);
+        logger_log(LOG_DEBUG, "   Slots promoted: %d (%d phis)", ir_stats.slots_promoted, ir_stats.phis_inserted);
+        logger_log(LOG_DEBUG, "   Constants propagated: %d, branches folded: %d, blocks removed: %d",
+                  ir_stats.constants_propagated, ir_stats.branches_folded, ir_stats.blocks_removed);
+        logger_log(LOG_DEBUG, "   Values numbered: %d, instructions hoisted: %d, dead removed: %d",
+                  ir_stats.values_numbered, ir_stats.instructions_hoisted, ir_stats.instructions_removed);
+    }
+
+    // Report template instantiation statistics (only programs that instantiated any)
+    TemplateStats template_stats = templates_get_stats();
+    if (debug_level >= 2 && template_stats.instantiations_requested > 0) {
+        logger_log(LOG_DEBUG, "Template specializations: %d created, %d emitted, %d pruned",
+                  template_stats.specializations_created, template_stats.specializations_emitted,
+                  template_stats.specializations_pruned);
+        logger_log(LOG_DEBUG, "   Duplicate instantiations avoided: %d (~%zu bytes of C saved)",
+                  template_stats.duplicates_avoided, template_stats.c_bytes_saved);
+    }
+
+    // Report tree-shaking statistics
+    if (debug_level >= 2) {
+        TreeShakeStats shake_stats = treeshake_get_stats();
+        logger_log(LOG_DEBUG, "Tree shaking: %d functions kept, %d removed (~%zu bytes of C)%s",
+                  shake_stats.functions_kept, shake_stats.functions_removed, shake_stats.c_bytes_saved,
+                  shake_stats.conservative ? ", skipped (conservative)" : "");
+        logger_log(LOG_DEBUG, "   Module members pruned: %d", comp_stats.module_members_pruned);
+    }
+
+    // Report profile statistics
+    if (debug_level >= 2 && profile_mode != PROFILE_OFF) {
+        ProfileStats profile_stats = profile_get_stats();
+        if (profile_mode == PROFILE_GENERATE) {
+            logger_log(LOG_DEBUG, "Profile counters emitted: %d", profile_stats.counters_emitted);
+        } else {
+            logger_log(LOG_DEBUG, "Profile: %d counts loaded, %d hot and %d cold functions",
+                      profile_stats.entries_loaded, profile_stats.functions_hot, profile_stats.functions_cold);
+            logger_log(LOG_DEBUG, "   Branches hinted: %d, cold catch blocks: %d, decisions changed: %d",
+                      profile_stats.branches_hinted, profile_stats.blocks_cold, profile_stats.decisions_changed);
+        }
+    }
 
     // Compile generated C code to executable
     logger_log(LOG_INFO, "Compiling C code to executable...");
     printf("Compiling %s to %s...\n", outputPath, executablePath);
-    if (compileOutputC(outputPath, executablePath) != 0) {
+    if (compileOutputC(outputPath, executablePath, optimization_level,
+                       want_opt_info ? optInfoPath : NULL) != 0) {
         logger_log(LOG_ERROR, "C compilation failed");
         error_report(sourcePath, 0, 0, "C compilation failed", ERROR_RUNTIME);
         error_print_current();
@@ -377,6 +607,26 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (vectorize_report) {
+        vectorize_print_report(stdout, sourcePath, outputPath, want_opt_info ? optInfoPath : NULL);
+        if (want_opt_info) {
+            remove(optInfoPath);
+        }
+    }
+    if (debug_level >= 2) {
+        VectorizeStats vector_stats = vectorize_get_stats();
+        logger_log(LOG_DEBUG, "Vectorization: %d loops analyzed, %d hinted, %d vectorized",
+                  vector_stats.loops_analyzed, vector_stats.loops_hinted, vector_stats.loops_vectorized);
+        BoundsStats bounds_stats = bounds_get_stats();
+        logger_log(LOG_DEBUG, "Bounds checks: %d emitted, %d removed, %d hoisted into %d loop prechecks",
+                  bounds_stats.checks_emitted, bounds_stats.checks_removed,
+                  bounds_stats.checks_hoisted, bounds_stats.prechecks_emitted);
+        DispatchStats dispatch_stats = dispatch_get_stats();
+        logger_log(LOG_DEBUG, "Dispatch: %d jump tables, %d perfect hashes, %d compare chains, %d duplicate labels dropped",
+                  dispatch_stats.jump_tables, dispatch_stats.perfect_hashes,
+                  dispatch_stats.compare_chains, dispatch_stats.unreachable_labels);
+    }
+
     // Run compiled program
     logger_log(LOG_INFO, "Running compiled program...");
     printf("Running %s:\n", executablePath);
@@ -393,6 +643,10 @@ int main(int argc, char* argv[]) {
     } else {
         logger_log(LOG_INFO, "Program executed successfully");
     }
+    if (profile_mode == PROFILE_GENERATE) {
+        logger_log(LOG_INFO, "Profile written to %s", profile_file ? profile_file : profilePath);
+        printf("Profile written to %s\n", profile_file ? profile_file : profilePath);
+    }
 
     // Clean up
     logger_log(LOG_DEBUG, "Cleaning up resources...");
@@ -405,6 +659,13 @@ int main(int argc, char* argv[]) {
 
     // Clean up aspect weaver
     weaver_cleanup();
+    templates_cleanup();
+    treeshake_cleanup();
+    profile_cleanup();
+    vectorize_cleanup();
+    bounds_cleanup();
+    remarks_close();
+    module_system_cleanup();
 
     logger_log(LOG_INFO, "Compilation completed successfully");
     logger_close();
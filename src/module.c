@@ -498,14 +498,14 @@ static Module* module_load_impl(const char* name, Module* module) {
     source[size] = '\0';
     fclose(file);
 
-    // Parse the module
+    // Parse the module, using its source for error context while parsing
+    const char* previousSource = error_get_source();
+    error_set_source(source);
     lexerInit(source);
     module->ast = parseProgram();
     
-    // Make it available to the error system for context
-    error_set_source(source);
-    
-    // Now source can be freed since the parser has built the AST
+    // Restore the importer's source before freeing the module's
+    error_set_source(previousSource);
     free(source);
 
     if (!module->ast) {
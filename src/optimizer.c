@@ -8,21 +8,42 @@
  * - Redundant statement removal
  * - Constant propagation
  * - Common subexpression elimination
+ * - Loop-invariant code motion
+ * - Induction-variable strength reduction
  * - Scope analysis
+ * - Compile-time evaluation of pure function calls
+ * 
+ * Passes are registered with a small pass manager that runs them to a fixed
+ * point and records per-pass timing and change counts.
  */
 
 #include "optimizer.h"
 #include "ast.h"
 #include "error.h"
 #include "logger.h"
+#include "hashmap.h"
+#include "module.h"
+#include "macro_evaluator.h"
+#include "profile.h"
+#include "remarks.h"
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+#include <math.h>
 
 /** Current optimization level */
 static OptimizerLevel currentLevel = OPT_LEVEL_0;
 
+/** Factor OPT_LEVEL_3 applies to the inlining and unrolling size limits and to work budgets */
+#define AGGRESSIVE_BUDGET_SCALE 2
+
+/** Name of the pass the pass manager is running, for optimization remarks */
+static const char* running_pass = NULL;
+
 /** Default debug level for the optimizer */
 static int debug_level = 1;
 
@@ -36,7 +57,16 @@ static OptimizerOptions options = {
     .enable_redundant_stmt_removal = true,
     .enable_constant_propagation = true,
     .enable_common_subexpr_elimination = true,
-    .enable_scope_analysis = true
+    .enable_scope_analysis = true,
+    .enable_loop_invariant_code_motion = true,
+    .enable_induction_variables = true,
+    .enable_function_inlining = true,
+    .enable_loop_unrolling = true,
+    .unroll_factor = OPTIMIZER_DEFAULT_UNROLL_FACTOR,
+    .enable_concat_fusion = true,
+    .enable_tail_call_elimination = true,
+    .enable_compile_time_evaluation = true,
+    .max_iterations = OPTIMIZER_DEFAULT_MAX_ITERATIONS
 };
 
 /**
@@ -96,6 +126,37 @@ void optimizer_init(OptimizerLevel level) {
     logger_log(LOG_INFO, "Optimizer initialized with level %d", level);
 }
 
+/**
+ * @brief Gives the factor applied to size limits and work budgets
+ * 
+ * @return int AGGRESSIVE_BUDGET_SCALE at OPT_LEVEL_3, else 1
+ */
+static int budget_scale(void) {
+    return currentLevel >= OPT_LEVEL_3 ? AGGRESSIVE_BUDGET_SCALE : 1;
+}
+
+/**
+ * @brief Spells a binary operator as it is written in Lyn, for remarks
+ * 
+ * @param op Operator code of an AST_BINARY_OP
+ * @return const char* Operator text
+ */
+static const char* operator_text(char op) {
+    static char single[2];
+    switch (op) {
+        case 'E': return "==";
+        case 'N': return "!=";
+        case 'G': return ">=";
+        case 'L': return "<=";
+        case 'A': return "&&";
+        case 'O': return "||";
+        default:
+            single[0] = op;
+            single[1] = '\0';
+            return single;
+    }
+}
+
 /**
  * @brief Gets the current optimization statistics
  * 
@@ -131,8 +192,9 @@ typedef struct {
  * @brief Expression hash table entry for common subexpression elimination
  */
 typedef struct ExprHashEntry {
-    AstNode* expr;                   ///< Expression node
-    AstNode* var_ref;                ///< Variable that holds the result
+    AstNode* expr;                   ///< Expression node (owned copy)
+    AstNode* var_ref;                ///< Variable that holds the result (owned, may be NULL)
+    int id;                          ///< Sequence number assigned when the entry was added
     struct ExprHashEntry* next;      ///< Next entry in hash bucket
 } ExprHashEntry;
 
@@ -143,6 +205,7 @@ typedef struct {
     ExprHashEntry** buckets;         ///< Hash buckets
     int bucket_count;                ///< Number of buckets
     int entry_count;                 ///< Number of entries
+    int next_id;                     ///< Sequence number for the next added entry
 } ExprHashTable;
 
 /** Global symbol table for scope analysis */
@@ -151,6 +214,12 @@ static SymbolTable symbol_table = {0};
 /** Global expression hash table for common subexpression elimination */
 static ExprHashTable expr_table = {0};
 
+/** Variables assigned inside any function body, filled in by scope analysis */
+static HashMap* function_writes = NULL;
+
+/** Nesting depth of function definitions during scope analysis */
+static int function_depth = 0;
+
 /**
  * @brief Initializes the symbol table
  * 
@@ -334,6 +403,8 @@ static void init_expr_table(void) {
             ExprHashEntry* entry = expr_table.buckets[i];
             while (entry) {
                 ExprHashEntry* next = entry->next;
+                freeAstNode(entry->expr);
+                freeAstNode(entry->var_ref);
                 free(entry);
                 entry = next;
             }
@@ -345,6 +416,7 @@ static void init_expr_table(void) {
     expr_table.bucket_count = 257; // Prime number for good hash distribution
     expr_table.buckets = calloc(expr_table.bucket_count, sizeof(ExprHashEntry*));
     expr_table.entry_count = 0;
+    expr_table.next_id = 0;
     
     if (debug_level >= 2) {
         logger_log(LOG_DEBUG, "Expression hash table initialized with %d buckets", 
@@ -362,6 +434,8 @@ static void clear_expr_table(void) {
         ExprHashEntry* entry = expr_table.buckets[i];
         while (entry) {
             ExprHashEntry* next = entry->next;
+            freeAstNode(entry->expr);
+            freeAstNode(entry->var_ref);
             free(entry);
             entry = next;
         }
@@ -491,7 +565,13 @@ static bool are_expressions_equal(AstNode* expr1, AstNode* expr2) {
     
     switch (expr1->type) {
         case AST_NUMBER_LITERAL:
-            return expr1->numberLiteral.value == expr2->numberLiteral.value;
+            // 2 and 2.0 are different expressions, and integers past 2^53 share doubles
+            if (isIntegerLiteral(expr1) || isIntegerLiteral(expr2)) {
+                return isIntegerLiteral(expr1) && isIntegerLiteral(expr2) &&
+                       integerLiteralValue(expr1) == integerLiteralValue(expr2);
+            }
+            return expr1->numberLiteral.value == expr2->numberLiteral.value &&
+                   expr1->numberLiteral.isDouble == expr2->numberLiteral.isDouble;
             
         case AST_STRING_LITERAL:
             return strcmp(expr1->stringLiteral.value, expr2->stringLiteral.value) == 0;
@@ -529,7 +609,8 @@ static bool are_expressions_equal(AstNode* expr1, AstNode* expr2) {
  * @brief Adds an expression to the hash table
  * 
  * If the expression already exists in the table, returns the variable reference
- * that holds its result. Otherwise, adds the new expression and returns NULL.
+ * that holds its result. Otherwise, adds the new expression and returns NULL;
+ * the table then owns both @p expr and @p var_ref.
  * 
  * @param expr Expression to add
  * @param var_ref Variable reference that holds the result
@@ -561,6 +642,7 @@ static AstNode* add_expr_to_table(AstNode* expr, AstNode* var_ref) {
     
     entry->expr = expr;
     entry->var_ref = var_ref;
+    entry->id = expr_table.next_id++;
     entry->next = expr_table.buckets[hash];
     expr_table.buckets[hash] = entry;
     expr_table.entry_count++;
@@ -597,8 +679,10 @@ static AstNode* clone_node(AstNode* node) {
  * @brief Performs variable scope analysis and builds symbol table
  * 
  * Traverses the AST to build a symbol table tracking variable declarations,
- * scopes, and constant values. This information is used by other optimization
- * passes like constant propagation.
+ * scopes, and constant values. It also records every variable written inside
+ * a function body in @c function_writes: Lyn functions are emitted as nested
+ * C functions sharing the enclosing locals, so constant propagation uses this
+ * set to decide which facts a call can invalidate.
  * 
  * @param node AST node to analyze
  * @return AstNode* Modified AST with scope information
@@ -614,6 +698,13 @@ static AstNode* scope_analysis(AstNode* node) {
             init_symbol_table();
             init_expr_table();
             
+            if (function_writes) {
+                hashmap_clear(function_writes, NULL);
+            } else {
+                function_writes = hashmap_create(64);
+            }
+            function_depth = 0;
+            
             for (int i = 0; i < node->program.statementCount; i++) {
                 node->program.statements[i] = scope_analysis(node->program.statements[i]);
             }
@@ -622,6 +713,9 @@ static AstNode* scope_analysis(AstNode* node) {
         case AST_VAR_DECL:
             // Add variable to current scope
             add_variable(node->varDecl.name, node);
+            if (function_depth > 0) {
+                hashmap_put(function_writes, node->varDecl.name, NULL, NULL);
+            }
             
             // Process initializer if exists
             if (node->varDecl.initializer) {
@@ -638,6 +732,10 @@ static AstNode* scope_analysis(AstNode* node) {
             break;
             
         case AST_VAR_ASSIGN:
+            if (function_depth > 0) {
+                hashmap_put(function_writes, node->varAssign.name, NULL, NULL);
+            }
+            
             // Process initializer
             if (node->varAssign.initializer) {
                 node->varAssign.initializer = scope_analysis(node->varAssign.initializer);
@@ -665,9 +763,19 @@ static AstNode* scope_analysis(AstNode* node) {
             }
             break;
             
+        case AST_ARRAY_ASSIGN:
+            // Storing an element changes what later reads of the array see
+            if (function_depth > 0) {
+                hashmap_put(function_writes, node->arrayAssign.name, NULL, NULL);
+            }
+            node->arrayAssign.index = scope_analysis(node->arrayAssign.index);
+            node->arrayAssign.value = scope_analysis(node->arrayAssign.value);
+            break;
+            
         case AST_FUNC_DEF:
             // Function body has its own scope
             enter_scope();
+            function_depth++;
             
             // Add parameters to function scope
             for (int i = 0; i < node->funcDef.paramCount; i++) {
@@ -683,6 +791,7 @@ static AstNode* scope_analysis(AstNode* node) {
             }
             
             // Leave function scope
+            function_depth--;
             exit_scope();
             break;
             
@@ -746,6 +855,9 @@ static AstNode* scope_analysis(AstNode* node) {
             
             // Add iterator variable to scope
             add_variable(node->forStmt.iterator, NULL);
+            if (function_depth > 0) {
+                hashmap_put(function_writes, node->forStmt.iterator, NULL, NULL);
+            }
             
             for (int i = 0; i < node->forStmt.bodyCount; i++) {
                 node->forStmt.body[i] = scope_analysis(node->forStmt.body[i]);
@@ -792,6 +904,69 @@ static AstNode* scope_analysis(AstNode* node) {
             exit_scope();
             break;
             
+        case AST_BLOCK:
+            // Blocks are produced by the aspect weaver and share the enclosing scope
+            for (int i = 0; i < node->block.statementCount; i++) {
+                node->block.statements[i] = scope_analysis(node->block.statements[i]);
+            }
+            break;
+            
+        case AST_TRY_CATCH_STMT:
+            enter_scope();
+            for (int i = 0; i < node->tryCatchStmt.tryCount; i++) {
+                node->tryCatchStmt.tryBody[i] = scope_analysis(node->tryCatchStmt.tryBody[i]);
+            }
+            exit_scope();
+            
+            enter_scope();
+            for (int i = 0; i < node->tryCatchStmt.catchCount; i++) {
+                node->tryCatchStmt.catchBody[i] = scope_analysis(node->tryCatchStmt.catchBody[i]);
+            }
+            exit_scope();
+            
+            enter_scope();
+            for (int i = 0; i < node->tryCatchStmt.finallyCount; i++) {
+                node->tryCatchStmt.finallyBody[i] = scope_analysis(node->tryCatchStmt.finallyBody[i]);
+            }
+            exit_scope();
+            break;
+            
+        case AST_SWITCH_STMT:
+            node->switchStmt.expr = scope_analysis(node->switchStmt.expr);
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                AstNode* caseNode = node->switchStmt.cases[i];
+                enter_scope();
+                for (int j = 0; caseNode && j < caseNode->caseStmt.bodyCount; j++) {
+                    caseNode->caseStmt.body[j] = scope_analysis(caseNode->caseStmt.body[j]);
+                }
+                exit_scope();
+            }
+            enter_scope();
+            for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
+                node->switchStmt.defaultCase[i] = scope_analysis(node->switchStmt.defaultCase[i]);
+            }
+            exit_scope();
+            break;
+            
+        case AST_PATTERN_MATCH:
+            node->patternMatch.expr = scope_analysis(node->patternMatch.expr);
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                node->patternMatch.cases[i] = scope_analysis(node->patternMatch.cases[i]);
+            }
+            node->patternMatch.otherwise = scope_analysis(node->patternMatch.otherwise);
+            break;
+            
+        case AST_PATTERN_CASE:
+            if (node->patternCase.pattern) {
+                node->patternCase.pattern = scope_analysis(node->patternCase.pattern);
+            }
+            enter_scope();
+            for (int i = 0; i < node->patternCase.bodyCount; i++) {
+                node->patternCase.body[i] = scope_analysis(node->patternCase.body[i]);
+            }
+            exit_scope();
+            break;
+            
         default:
             break;
     }
@@ -800,149 +975,775 @@ static AstNode* scope_analysis(AstNode* node) {
 }
 
 /**
- * @brief Performs constant propagation optimization
+ * @brief Checks whether a value is a small integer
  * 
- * Replaces variable references with their known constant values when possible.
- * This optimization is enabled at optimization level 2 and above.
+ * Facts and bounds are limited to the range of a 32-bit int, so arithmetic
+ * on two of them can neither overflow nor lose precision in a double.
  * 
- * @param node AST node to optimize
- * @return AstNode* Modified AST with constants propagated
+ * @param value Value to check
+ * @return bool true if @p value is integral and within int range
  */
-static AstNode* constant_propagation(AstNode* node) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)constant_propagation);
+static bool is_integral_value(double value) {
+    return value >= -2147483648.0 && value <= 2147483647.0 && value == (double)(long long)value;
+}
+
+/**
+ * @brief Releases a value stored in a fact map
+ * 
+ * @param value Heap-allocated double
+ */
+static void free_fact(void* value) {
+    free(value);
+}
+
+/**
+ * @brief Records that a variable holds a known constant
+ * 
+ * @param facts Fact map (variable name -> double*)
+ * @param name Variable name
+ * @param value Known value
+ */
+static void set_fact(HashMap* facts, const char* name, double value) {
+    double* stored = malloc(sizeof(double));
+    if (!stored) {
+        error_report("Optimizer", __LINE__, 0, "Failed to allocate constant fact", ERROR_MEMORY);
+        return;
+    }
+    *stored = value;
     
-    if (!node) return NULL;
+    void* old = NULL;
+    hashmap_put(facts, name, stored, &old);
+    free(old);
+}
+
+/**
+ * @brief Forgets whatever is known about a variable
+ * 
+ * @param facts Fact map
+ * @param name Variable name
+ */
+static void kill_fact(HashMap* facts, const char* name) {
+    free(hashmap_remove(facts, name));
+}
+
+/**
+ * @brief hashmap_foreach callback that copies one fact into another map
+ */
+static void copy_fact(const char* key, void* value, void* userData) {
+    set_fact((HashMap*)userData, key, *(double*)value);
+}
+
+/**
+ * @brief Creates an independent copy of a fact map
+ * 
+ * @param facts Fact map to copy
+ * @return HashMap* New map owning copies of every fact
+ */
+static HashMap* copy_facts(HashMap* facts) {
+    HashMap* copy = hashmap_create(hashmap_count(facts));
+    hashmap_foreach(facts, copy_fact, copy);
+    return copy;
+}
+
+/**
+ * @brief Key list collected while iterating a fact map
+ */
+typedef struct {
+    char** names;                    ///< Collected variable names
+    int count;                       ///< Number of names
+    int capacity;                    ///< Allocated size of @c names
+    HashMap* other;                  ///< Map to compare against (may be NULL)
+} FactNameList;
+
+/**
+ * @brief hashmap_foreach callback collecting names to drop at a merge point
+ * 
+ * A fact survives the merge of two paths only if both paths agree on it.
+ */
+static void collect_conflicting_fact(const char* key, void* value, void* userData) {
+    FactNameList* list = userData;
+    double* other = list->other ? hashmap_get(list->other, key) : NULL;
+    if (other && *other == *(double*)value) return;
+    
+    if (list->count == list->capacity) {
+        list->capacity = list->capacity ? list->capacity * 2 : 16;
+        list->names = realloc(list->names, list->capacity * sizeof(char*));
+    }
+    list->names[list->count++] = strdup(key);
+}
+
+/**
+ * @brief Keeps only the facts that hold on both incoming paths
+ * 
+ * @param facts Fact map to narrow (modified in place)
+ * @param other Facts from the other path
+ */
+static void intersect_facts(HashMap* facts, HashMap* other) {
+    FactNameList list = { NULL, 0, 0, other };
+    hashmap_foreach(facts, collect_conflicting_fact, &list);
+    for (int i = 0; i < list.count; i++) {
+        kill_fact(facts, list.names[i]);
+        free(list.names[i]);
+    }
+    free(list.names);
+}
+
+/**
+ * @brief hashmap_foreach callback that kills the fact for one name
+ */
+static void kill_fact_by_key(const char* key, void* value, void* userData) {
+    (void)value;
+    kill_fact((HashMap*)userData, key);
+}
+
+/**
+ * @brief Invalidates the facts a function call may clobber
+ * 
+ * Without scope analysis nothing is known about what functions write, so
+ * every fact is dropped.
+ * 
+ * @param facts Fact map
+ */
+static void kill_facts_at_call(HashMap* facts) {
+    if (function_writes) {
+        hashmap_foreach(function_writes, kill_fact_by_key, facts);
+    } else {
+        hashmap_clear(facts, free_fact);
+    }
+}
+
+/**
+ * @brief Checks whether a subtree calls code when executed
+ * 
+ * Nested function definitions are skipped: defining a function does not run
+ * it.
+ * 
+ * @param node Subtree to inspect
+ * @return bool true if executing @p node may call a function
+ */
+static bool contains_call(AstNode* node) {
+    if (!node) return false;
     
     switch (node->type) {
-        case AST_IDENTIFIER:
-            // If identifier is a constant, replace with its value
-            {
-                SymbolEntry* entry = find_variable(node->identifier.name);
-                if (entry && entry->is_constant && entry->constant_value) {
-                    if (debug_level >= 2) {
-                        logger_log(LOG_DEBUG, "Propagating constant for '%s'", node->identifier.name);
-                    }
-                    
-                    // Create a copy of the constant value
-                    AstNode* value_copy = clone_node(entry->constant_value);
-                    if (!value_copy) {
-                        return node; // If clone fails, keep original
-                    }
-                    
-                    // Count this optimization
-                    stats.constants_propagated++;
-                    stats.total_optimizations++;
-                    
-                    // Free original node and return constant value
-                    freeAstNode(node);
-                    return value_copy;
-                }
-            }
-            break;
-            
-        case AST_BINARY_OP:
-            node->binaryOp.left = constant_propagation(node->binaryOp.left);
-            node->binaryOp.right = constant_propagation(node->binaryOp.right);
-            break;
-            
         case AST_FUNC_CALL:
-            for (int i = 0; i < node->funcCall.argCount; i++) {
-                node->funcCall.arguments[i] = constant_propagation(node->funcCall.arguments[i]);
-            }
-            break;
-            
+        case AST_NEW_EXPR:
+        case AST_CURRY_EXPR:
+        case AST_FUNC_COMPOSE:
+            return true;
+        case AST_FUNC_DEF:
+        case AST_CLASS_DEF:
+        case AST_LAMBDA:
+        case AST_ASPECT_DEF:
+            return false;
+        case AST_BINARY_OP:
+            return contains_call(node->binaryOp.left) || contains_call(node->binaryOp.right);
+        case AST_UNARY_OP:
+            return contains_call(node->unaryOp.expr);
         case AST_MEMBER_ACCESS:
-            node->memberAccess.object = constant_propagation(node->memberAccess.object);
-            break;
-            
+            return contains_call(node->memberAccess.object);
+        case AST_ARRAY_ACCESS:
+            return contains_call(node->arrayAccess.array) || contains_call(node->arrayAccess.index);
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                if (contains_call(node->arrayLiteral.elements[i])) return true;
+            }
+            return false;
         case AST_VAR_DECL:
-            if (node->varDecl.initializer) {
-                node->varDecl.initializer = constant_propagation(node->varDecl.initializer);
+            return contains_call(node->varDecl.initializer);
+        case AST_VAR_ASSIGN:
+            return contains_call(node->varAssign.initializer);
+        case AST_ARRAY_ASSIGN:
+            return contains_call(node->arrayAssign.index) || contains_call(node->arrayAssign.value);
+        case AST_RETURN_STMT:
+            return contains_call(node->returnStmt.expr);
+        case AST_PRINT_STMT:
+            return contains_call(node->printStmt.expr);
+        case AST_THROW_STMT:
+            return contains_call(node->throwStmt.expr);
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                if (contains_call(node->block.statements[i])) return true;
+            }
+            return false;
+        case AST_IF_STMT:
+            if (contains_call(node->ifStmt.condition)) return true;
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                if (contains_call(node->ifStmt.thenBranch[i])) return true;
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                if (contains_call(node->ifStmt.elseBranch[i])) return true;
+            }
+            return false;
+        case AST_WHILE_STMT:
+            if (contains_call(node->whileStmt.condition)) return true;
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) {
+                if (contains_call(node->whileStmt.body[i])) return true;
+            }
+            return false;
+        case AST_DO_WHILE_STMT:
+            if (contains_call(node->doWhileStmt.condition)) return true;
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                if (contains_call(node->doWhileStmt.body[i])) return true;
+            }
+            return false;
+        case AST_FOR_STMT:
+            if (contains_call(node->forStmt.rangeStart) || contains_call(node->forStmt.rangeEnd) ||
+                contains_call(node->forStmt.rangeStep) || contains_call(node->forStmt.collection) ||
+                contains_call(node->forStmt.init) || contains_call(node->forStmt.condition) ||
+                contains_call(node->forStmt.update)) return true;
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                if (contains_call(node->forStmt.body[i])) return true;
+            }
+            return false;
+        case AST_SWITCH_STMT:
+            if (contains_call(node->switchStmt.expr)) return true;
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                if (contains_call(node->switchStmt.cases[i])) return true;
+            }
+            for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
+                if (contains_call(node->switchStmt.defaultCase[i])) return true;
+            }
+            return false;
+        case AST_CASE_STMT:
+            for (int i = 0; i < node->caseStmt.bodyCount; i++) {
+                if (contains_call(node->caseStmt.body[i])) return true;
+            }
+            return false;
+        case AST_PATTERN_MATCH:
+            if (contains_call(node->patternMatch.expr)) return true;
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                if (contains_call(node->patternMatch.cases[i])) return true;
+            }
+            return contains_call(node->patternMatch.otherwise);
+        case AST_PATTERN_CASE:
+            if (contains_call(node->patternCase.pattern)) return true;
+            for (int i = 0; i < node->patternCase.bodyCount; i++) {
+                if (contains_call(node->patternCase.body[i])) return true;
+            }
+            return false;
+        case AST_TRY_CATCH_STMT:
+            for (int i = 0; i < node->tryCatchStmt.tryCount; i++) {
+                if (contains_call(node->tryCatchStmt.tryBody[i])) return true;
             }
+            for (int i = 0; i < node->tryCatchStmt.catchCount; i++) {
+                if (contains_call(node->tryCatchStmt.catchBody[i])) return true;
+            }
+            for (int i = 0; i < node->tryCatchStmt.finallyCount; i++) {
+                if (contains_call(node->tryCatchStmt.finallyBody[i])) return true;
+            }
+            return false;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Visits the name of every variable a statement may assign
+ * 
+ * Covers assignments and declarations in nested bodies, loop iterators and
+ * catch variables. Nested function and class definitions are skipped, and
+ * writes performed by called functions are not included.
+ * 
+ * @param node Statement to inspect
+ * @param visit Callback invoked with each name (value is always NULL)
+ * @param userData Opaque pointer passed to the callback
+ */
+static void visit_assigned_names(AstNode* node, HashMapVisitFn visit, void* userData) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_VAR_DECL:
+            visit(node->varDecl.name, NULL, userData);
             break;
-            
         case AST_VAR_ASSIGN:
-            if (node->varAssign.initializer) {
-                node->varAssign.initializer = constant_propagation(node->varAssign.initializer);
-            }
+            visit(node->varAssign.name, NULL, userData);
             break;
-            
-        case AST_RETURN_STMT:
-            if (node->returnStmt.expr) {
-                node->returnStmt.expr = constant_propagation(node->returnStmt.expr);
-            }
+        case AST_ARRAY_ASSIGN:
+            // The array variable keeps its value, but its contents change
+            visit(node->arrayAssign.name, NULL, userData);
             break;
-            
-        case AST_PRINT_STMT:
-            if (node->printStmt.expr) {
-                node->printStmt.expr = constant_propagation(node->printStmt.expr);
+        case AST_FUNC_DEF:
+        case AST_CLASS_DEF:
+        case AST_ASPECT_DEF:
+            return;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                visit_assigned_names(node->block.statements[i], visit, userData);
             }
             break;
-            
         case AST_IF_STMT:
-            node->ifStmt.condition = constant_propagation(node->ifStmt.condition);
-            
             for (int i = 0; i < node->ifStmt.thenCount; i++) {
-                node->ifStmt.thenBranch[i] = constant_propagation(node->ifStmt.thenBranch[i]);
+                visit_assigned_names(node->ifStmt.thenBranch[i], visit, userData);
             }
-            
             for (int i = 0; i < node->ifStmt.elseCount; i++) {
-                node->ifStmt.elseBranch[i] = constant_propagation(node->ifStmt.elseBranch[i]);
+                visit_assigned_names(node->ifStmt.elseBranch[i], visit, userData);
             }
             break;
-            
         case AST_WHILE_STMT:
-            node->whileStmt.condition = constant_propagation(node->whileStmt.condition);
             for (int i = 0; i < node->whileStmt.bodyCount; i++) {
-                node->whileStmt.body[i] = constant_propagation(node->whileStmt.body[i]);
+                visit_assigned_names(node->whileStmt.body[i], visit, userData);
             }
             break;
-            
         case AST_DO_WHILE_STMT:
-            node->doWhileStmt.condition = constant_propagation(node->doWhileStmt.condition);
             for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
-                node->doWhileStmt.body[i] = constant_propagation(node->doWhileStmt.body[i]);
+                visit_assigned_names(node->doWhileStmt.body[i], visit, userData);
             }
             break;
-            
         case AST_FOR_STMT:
-            node->forStmt.rangeStart = constant_propagation(node->forStmt.rangeStart);
-            node->forStmt.rangeEnd = constant_propagation(node->forStmt.rangeEnd);
+            visit(node->forStmt.iterator, NULL, userData);
+            visit_assigned_names(node->forStmt.init, visit, userData);
+            visit_assigned_names(node->forStmt.update, visit, userData);
             for (int i = 0; i < node->forStmt.bodyCount; i++) {
-                node->forStmt.body[i] = constant_propagation(node->forStmt.body[i]);
+                visit_assigned_names(node->forStmt.body[i], visit, userData);
             }
             break;
-            
         case AST_SWITCH_STMT:
-            node->switchStmt.expr = constant_propagation(node->switchStmt.expr);
             for (int i = 0; i < node->switchStmt.caseCount; i++) {
-                if (node->switchStmt.cases[i]) {
-                    node->switchStmt.cases[i] = constant_propagation(node->switchStmt.cases[i]);
-                }
+                visit_assigned_names(node->switchStmt.cases[i], visit, userData);
+            }
+            for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
+                visit_assigned_names(node->switchStmt.defaultCase[i], visit, userData);
+            }
+            break;
+        case AST_CASE_STMT:
+            for (int i = 0; i < node->caseStmt.bodyCount; i++) {
+                visit_assigned_names(node->caseStmt.body[i], visit, userData);
+            }
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                visit_assigned_names(node->patternMatch.cases[i], visit, userData);
+            }
+            visit_assigned_names(node->patternMatch.otherwise, visit, userData);
+            break;
+        case AST_PATTERN_CASE:
+            for (int i = 0; i < node->patternCase.bodyCount; i++) {
+                visit_assigned_names(node->patternCase.body[i], visit, userData);
+            }
+            break;
+        case AST_TRY_CATCH_STMT:
+            visit(node->tryCatchStmt.errorVarName, NULL, userData);
+            for (int i = 0; i < node->tryCatchStmt.tryCount; i++) {
+                visit_assigned_names(node->tryCatchStmt.tryBody[i], visit, userData);
+            }
+            for (int i = 0; i < node->tryCatchStmt.catchCount; i++) {
+                visit_assigned_names(node->tryCatchStmt.catchBody[i], visit, userData);
             }
+            for (int i = 0; i < node->tryCatchStmt.finallyCount; i++) {
+                visit_assigned_names(node->tryCatchStmt.finallyBody[i], visit, userData);
+            }
+            break;
+        default:
             break;
     }
-    
-    return node;
 }
 
 /**
- * @brief Performs constant folding optimization
+ * @brief Kills the facts for every variable a statement may assign
  * 
- * Evaluates constant expressions at compile time, replacing them with their
- * computed values. This optimization is enabled at optimization level 1 and above.
+ * Used on entry to loops (the body runs repeatedly, so nothing it writes is
+ * known at the top of an iteration) and around statements whose internal
+ * control flow is not tracked (switch, try/catch). Calls inside the
+ * statement additionally kill what functions may write.
  * 
- * @param node AST node to optimize
- * @return AstNode* Modified AST with constant expressions folded
+ * @param node Statement to inspect
+ * @param facts Fact map
  */
-static AstNode* constant_folding(AstNode* node) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)constant_folding);
-    
-    if (!node) return NULL;
+static void kill_assigned_facts(AstNode* node, HashMap* facts) {
+    visit_assigned_names(node, kill_fact_by_key, facts);
+    if (contains_call(node)) {
+        kill_facts_at_call(facts);
+    }
+}
 
-    switch (node->type) {
-        case AST_BINARY_OP:
-            node->binaryOp.left = constant_folding(node->binaryOp.left);
+/**
+ * @brief Evaluates an expression using the known facts
+ * 
+ * Only integral results are produced, since an integral value means the same
+ * thing whether the generated C stores it in an int or a double. Division and
+ * modulo are never evaluated because their result depends on that C type.
+ * 
+ * @param expr Expression to evaluate
+ * @param facts Fact map
+ * @param value Output for the computed value
+ * @return bool true if the value is known
+ */
+static bool evaluate_with_facts(AstNode* expr, HashMap* facts, double* value) {
+    if (!expr) return false;
+    
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+            *value = expr->numberLiteral.value;
+            return is_integral_value(*value);
+            
+        case AST_IDENTIFIER: {
+            double* known = hashmap_get(facts, expr->identifier.name);
+            if (!known) return false;
+            *value = *known;
+            return true;
+        }
+        
+        case AST_UNARY_OP: {
+            double operand;
+            if (!evaluate_with_facts(expr->unaryOp.expr, facts, &operand)) return false;
+            if (expr->unaryOp.op == '-') *value = -operand;
+            else if (expr->unaryOp.op == '+') *value = operand;
+            else if (expr->unaryOp.op == 'N') *value = operand == 0 ? 1 : 0;
+            else return false;
+            return is_integral_value(*value);
+        }
+        
+        case AST_BINARY_OP: {
+            double left, right;
+            if (!evaluate_with_facts(expr->binaryOp.left, facts, &left) ||
+                !evaluate_with_facts(expr->binaryOp.right, facts, &right)) {
+                return false;
+            }
+            switch (expr->binaryOp.op) {
+                case '+': *value = left + right; break;
+                case '-': *value = left - right; break;
+                case '*': *value = left * right; break;
+                case '<': *value = left < right; break;
+                case '>': *value = left > right; break;
+                case 'E': *value = left == right; break;
+                case 'G': *value = left >= right; break;
+                case 'L': *value = left <= right; break;
+                case 'N': *value = left != right; break;
+                case 'A': *value = (left != 0) && (right != 0); break;
+                case 'O': *value = (left != 0) || (right != 0); break;
+                default: return false;
+            }
+            return is_integral_value(*value);
+        }
+        
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Replaces known variables with literals inside a condition
+ * 
+ * Substitution stops below any operator whose result depends on whether the
+ * operands are int or double in the generated C (division, modulo, string
+ * concatenation), so the rewritten condition always computes the same truth
+ * value.
+ * 
+ * @param slot Location of the expression pointer
+ * @param facts Fact map
+ */
+static void propagate_into_condition(AstNode** slot, HashMap* facts) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+    
+    switch (expr->type) {
+        case AST_IDENTIFIER: {
+            double* known = hashmap_get(facts, expr->identifier.name);
+            if (!known) return;
+            
+            AstNode* literal = createAstNode(AST_NUMBER_LITERAL);
+            if (!literal) return;
+            literal->line = expr->line;
+            literal->col = expr->col;
+            literal->numberLiteral.value = *known;
+            
+            if (debug_level >= 2) {
+                logger_log(LOG_DEBUG, "Propagating constant %g for '%s'", *known, expr->identifier.name);
+            }
+            remarks_emit(REMARK_APPLIED, running_pass, expr, "propagated constant %g into '%s'",
+                         *known, expr->identifier.name);
+            freeAstNode(expr);
+            *slot = literal;
+            stats.constants_propagated++;
+            stats.total_optimizations++;
+            break;
+        }
+        
+        case AST_UNARY_OP:
+            if (expr->unaryOp.op == '-' || expr->unaryOp.op == '+' || expr->unaryOp.op == 'N') {
+                propagate_into_condition(&expr->unaryOp.expr, facts);
+            }
+            break;
+            
+        case AST_BINARY_OP:
+            switch (expr->binaryOp.op) {
+                case '+':
+                    // A string operand turns '+' into concatenation
+                    if (expr->binaryOp.left->type == AST_STRING_LITERAL ||
+                        expr->binaryOp.right->type == AST_STRING_LITERAL) {
+                        break;
+                    }
+                    // fall through
+                case '-': case '*':
+                case '<': case '>': case 'G': case 'L': case 'N':
+                case 'A': case 'O':
+                    propagate_into_condition(&expr->binaryOp.left, facts);
+                    propagate_into_condition(&expr->binaryOp.right, facts);
+                    break;
+                case 'E':
+                    // String equality is lowered to strcmp
+                    if (expr->binaryOp.left->type != AST_STRING_LITERAL &&
+                        expr->binaryOp.right->type != AST_STRING_LITERAL) {
+                        propagate_into_condition(&expr->binaryOp.left, facts);
+                        propagate_into_condition(&expr->binaryOp.right, facts);
+                    }
+                    break;
+                default:
+                    break;
+            }
+            break;
+            
+        default:
+            break;
+    }
+}
+
+static AstNode* constant_folding(AstNode* node);
+static void propagate_statement_list(AstNode** list, int count, HashMap* facts);
+
+/**
+ * @brief Propagates constants through a single statement
+ * 
+ * Straight-line assignments create or kill facts. Branches are analyzed with
+ * a copy of the incoming facts and merged afterwards; loops first kill every
+ * variable their body writes, so only loop-invariant facts reach the
+ * condition and body. Function bodies start with no facts, since they may be
+ * called from anywhere. Conditions are rewritten and folded immediately so
+ * that dead_code_elimination can prune constant branches.
+ * 
+ * @param node Statement to process
+ * @param facts Facts that hold before the statement (updated in place)
+ */
+static void propagate_statement(AstNode* node, HashMap* facts) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_VAR_DECL:
+        case AST_VAR_ASSIGN: {
+            const char* name = node->type == AST_VAR_DECL ? node->varDecl.name : node->varAssign.name;
+            AstNode* init = node->type == AST_VAR_DECL ? node->varDecl.initializer : node->varAssign.initializer;
+            double value;
+            
+            if (contains_call(init)) {
+                kill_facts_at_call(facts);
+            }
+            if (init && evaluate_with_facts(init, facts, &value)) {
+                set_fact(facts, name, value);
+            } else {
+                kill_fact(facts, name);
+            }
+            break;
+        }
+        
+        case AST_IF_STMT: {
+            if (contains_call(node->ifStmt.condition)) {
+                kill_facts_at_call(facts);
+            }
+            propagate_into_condition(&node->ifStmt.condition, facts);
+            node->ifStmt.condition = constant_folding(node->ifStmt.condition);
+            
+            HashMap* elseFacts = copy_facts(facts);
+            propagate_statement_list(node->ifStmt.thenBranch, node->ifStmt.thenCount, facts);
+            propagate_statement_list(node->ifStmt.elseBranch, node->ifStmt.elseCount, elseFacts);
+            
+            AstNode* cond = node->ifStmt.condition;
+            if (cond && cond->type == AST_NUMBER_LITERAL) {
+                // Only one branch can run; keep what it established
+                if (cond->numberLiteral.value == 0) {
+                    hashmap_clear(facts, free_fact);
+                    hashmap_foreach(elseFacts, copy_fact, facts);
+                }
+            } else {
+                intersect_facts(facts, elseFacts);
+            }
+            hashmap_free(elseFacts, free_fact);
+            break;
+        }
+        
+        case AST_WHILE_STMT: {
+            kill_assigned_facts(node, facts);
+            if (contains_call(node->whileStmt.condition)) {
+                kill_facts_at_call(facts);
+            }
+            propagate_into_condition(&node->whileStmt.condition, facts);
+            node->whileStmt.condition = constant_folding(node->whileStmt.condition);
+            
+            HashMap* bodyFacts = copy_facts(facts);
+            propagate_statement_list(node->whileStmt.body, node->whileStmt.bodyCount, bodyFacts);
+            hashmap_free(bodyFacts, free_fact);
+            break;
+        }
+        
+        case AST_DO_WHILE_STMT: {
+            kill_assigned_facts(node, facts);
+            if (contains_call(node->doWhileStmt.condition)) {
+                kill_facts_at_call(facts);
+            }
+            HashMap* bodyFacts = copy_facts(facts);
+            propagate_statement_list(node->doWhileStmt.body, node->doWhileStmt.bodyCount, bodyFacts);
+            hashmap_free(bodyFacts, free_fact);
+            
+            propagate_into_condition(&node->doWhileStmt.condition, facts);
+            node->doWhileStmt.condition = constant_folding(node->doWhileStmt.condition);
+            break;
+        }
+        
+        case AST_FOR_STMT: {
+            kill_assigned_facts(node, facts);
+            if (node->forStmt.forType == FOR_RANGE) {
+                propagate_into_condition(&node->forStmt.rangeStart, facts);
+                propagate_into_condition(&node->forStmt.rangeEnd, facts);
+                propagate_into_condition(&node->forStmt.rangeStep, facts);
+                node->forStmt.rangeStart = constant_folding(node->forStmt.rangeStart);
+                node->forStmt.rangeEnd = constant_folding(node->forStmt.rangeEnd);
+                node->forStmt.rangeStep = constant_folding(node->forStmt.rangeStep);
+            }
+            HashMap* bodyFacts = copy_facts(facts);
+            propagate_statement_list(node->forStmt.body, node->forStmt.bodyCount, bodyFacts);
+            hashmap_free(bodyFacts, free_fact);
+            break;
+        }
+        
+        case AST_BLOCK:
+            propagate_statement_list(node->block.statements, node->block.statementCount, facts);
+            break;
+            
+        case AST_FUNC_DEF: {
+            HashMap* bodyFacts = hashmap_create(0);
+            propagate_statement_list(node->funcDef.body, node->funcDef.bodyCount, bodyFacts);
+            hashmap_free(bodyFacts, free_fact);
+            break;
+        }
+        
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++) {
+                if (node->classDef.members[i] && node->classDef.members[i]->type == AST_FUNC_DEF) {
+                    propagate_statement(node->classDef.members[i], facts);
+                }
+            }
+            break;
+            
+        case AST_SWITCH_STMT:
+        case AST_PATTERN_MATCH:
+        case AST_TRY_CATCH_STMT: {
+            kill_assigned_facts(node, facts);
+            if (node->type == AST_PATTERN_MATCH && contains_call(node)) {
+                kill_facts_at_call(facts);
+            }
+            
+            // Every sub-list starts from the facts that survive the whole statement
+            if (node->type == AST_SWITCH_STMT) {
+                for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                    AstNode* caseNode = node->switchStmt.cases[i];
+                    if (!caseNode) continue;
+                    HashMap* caseFacts = copy_facts(facts);
+                    propagate_statement_list(caseNode->caseStmt.body, caseNode->caseStmt.bodyCount, caseFacts);
+                    hashmap_free(caseFacts, free_fact);
+                }
+                HashMap* defaultFacts = copy_facts(facts);
+                propagate_statement_list(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount, defaultFacts);
+                hashmap_free(defaultFacts, free_fact);
+            } else if (node->type == AST_PATTERN_MATCH) {
+                for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                    AstNode* caseNode = node->patternMatch.cases[i];
+                    HashMap* caseFacts = copy_facts(facts);
+                    propagate_statement_list(caseNode->patternCase.body, caseNode->patternCase.bodyCount, caseFacts);
+                    hashmap_free(caseFacts, free_fact);
+                }
+                if (node->patternMatch.otherwise) {
+                    HashMap* otherwiseFacts = copy_facts(facts);
+                    propagate_statement_list(node->patternMatch.otherwise->patternCase.body,
+                                             node->patternMatch.otherwise->patternCase.bodyCount, otherwiseFacts);
+                    hashmap_free(otherwiseFacts, free_fact);
+                }
+            } else {
+                AstNode** lists[3] = { node->tryCatchStmt.tryBody, node->tryCatchStmt.catchBody,
+                                       node->tryCatchStmt.finallyBody };
+                int counts[3] = { node->tryCatchStmt.tryCount, node->tryCatchStmt.catchCount,
+                                  node->tryCatchStmt.finallyCount };
+                for (int i = 0; i < 3; i++) {
+                    HashMap* listFacts = copy_facts(facts);
+                    propagate_statement_list(lists[i], counts[i], listFacts);
+                    hashmap_free(listFacts, free_fact);
+                }
+            }
+            break;
+        }
+        
+        default:
+            if (contains_call(node)) {
+                kill_facts_at_call(facts);
+            }
+            break;
+    }
+}
+
+/**
+ * @brief Propagates constants through a list of statements in order
+ * 
+ * @param list Statements to process
+ * @param count Number of statements
+ * @param facts Facts that hold before the first statement (updated in place)
+ */
+static void propagate_statement_list(AstNode** list, int count, HashMap* facts) {
+    for (int i = 0; i < count; i++) {
+        propagate_statement(list[i], facts);
+    }
+}
+
+/**
+ * @brief Performs constant propagation optimization
+ * 
+ * Tracks integral constants assigned to variables through straight-line code
+ * and into branches, and substitutes them into conditions and range bounds,
+ * where they are folded. Facts are killed by reassignment, by loops that
+ * write the variable and by calls to functions that may write it (as
+ * recorded by scope_analysis). This optimization is enabled at optimization
+ * level 2 and above.
+ * 
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST with constants propagated
+ */
+static AstNode* constant_propagation(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)constant_propagation);
+    
+    if (!node) return NULL;
+    
+    HashMap* facts = hashmap_create(64);
+    if (!facts) return node;
+    
+    if (node->type == AST_PROGRAM) {
+        propagate_statement_list(node->program.statements, node->program.statementCount, facts);
+    } else {
+        propagate_statement(node, facts);
+    }
+    
+    hashmap_free(facts, free_fact);
+    return node;
+}
+
+/**
+ * @brief Performs constant folding optimization
+ * 
+ * Evaluates constant expressions at compile time, replacing them with their
+ * computed values. Two integer literals are folded with 64-bit integer
+ * arithmetic, so division and remainder truncate like the generated code;
+ * overflow, a zero divisor and results a literal cannot hold exactly are
+ * left to run time. Results involving a double become literals marked as
+ * doubles, so they keep the type of the expression they replace. This
+ * optimization is enabled at optimization level 1 and above.
+ * 
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST with constant expressions folded
+ */
+static AstNode* constant_folding(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)constant_folding);
+    
+    if (!node) return NULL;
+
+    switch (node->type) {
+        case AST_BINARY_OP:
+            node->binaryOp.left = constant_folding(node->binaryOp.left);
             node->binaryOp.right = constant_folding(node->binaryOp.right);
             
             // If both operands are constants, evaluate the expression
@@ -950,32 +1751,83 @@ static AstNode* constant_folding(AstNode* node) {
                 node->binaryOp.left->type == AST_NUMBER_LITERAL &&
                 node->binaryOp.right->type == AST_NUMBER_LITERAL) {
                 
-                double left = node->binaryOp.left->numberLiteral.value;
-                double right = node->binaryOp.right->numberLiteral.value;
+                AstNode* leftNode = node->binaryOp.left;
+                AstNode* rightNode = node->binaryOp.right;
+                double left = leftNode->numberLiteral.value;
+                double right = rightNode->numberLiteral.value;
+                // Other literals are written with %g and do not hold this exact value
+                if ((!isIntegerLiteral(leftNode) && !leftNode->numberLiteral.isDouble) ||
+                    (!isIntegerLiteral(rightNode) && !rightNode->numberLiteral.isDouble)) {
+                    return node;
+                }
+                bool integral = isIntegerLiteral(leftNode) && isIntegerLiteral(rightNode);
+                bool isDouble = !integral;
                 double result = 0;
+                long long exact = 0;
                 
-                switch (node->binaryOp.op) {
-                    case '+': result = left + right; break;
-                    case '-': result = left - right; break;
-                    case '*': result = left * right; break;
-                    case '/': 
-                        if (right == 0) {
-                            logger_log(LOG_WARNING, "Division by zero detected in constant folding");
-                            return node; // Don't optimize division by zero
-                        }
-                        result = left / right; 
-                        break;
-                    case 'E': result = (left == right) ? 1 : 0; break; // Equal
-                    case 'G': result = (left >= right) ? 1 : 0; break; // Greater or equal
-                    case 'L': result = (left <= right) ? 1 : 0; break; // Less or equal
-                    case 'N': result = (left != right) ? 1 : 0; break; // Not equal
-                    default:
-                        logger_log(LOG_WARNING, "Unknown operator in constant folding: %c", node->binaryOp.op);
-                        return node;
+                if (integral) {
+                    // Integers are folded exactly; their doubles are rounded past 2^53
+                    long long a = integerLiteralValue(leftNode), b = integerLiteralValue(rightNode);
+                    bool overflow = false;
+                    switch (node->binaryOp.op) {
+                        case '+': overflow = __builtin_add_overflow(a, b, &exact); break;
+                        case '-': overflow = __builtin_sub_overflow(a, b, &exact); break;
+                        case '*': overflow = __builtin_mul_overflow(a, b, &exact); break;
+                        case '/':
+                        case '%':
+                            if (b == 0) {
+                                logger_log(LOG_WARNING, "Division by zero detected in constant folding");
+                                return node; // The program reports it at run time
+                            }
+                            // LLONG_MIN / -1 overflows; lyn_div() reports it at run time
+                            overflow = b == -1 && a == LLONG_MIN;
+                            if (!overflow) exact = node->binaryOp.op == '/' ? a / b : a % b;
+                            break;
+                        case '<': exact = a < b; break;
+                        case '>': exact = a > b; break;
+                        case 'E': exact = a == b; break;
+                        case 'G': exact = a >= b; break;
+                        case 'L': exact = a <= b; break;
+                        case 'N': exact = a != b; break;
+                        case 'A': exact = a != 0 && b != 0; break;
+                        case 'O': exact = a != 0 || b != 0; break;
+                        default:
+                            logger_log(LOG_WARNING, "Unknown operator in constant folding: %c", node->binaryOp.op);
+                            return node;
+                    }
+                    // LLONG_MIN cannot be written as a C literal
+                    if (overflow || exact == LLONG_MIN) return node;
+                    result = (double)exact;
+                } else {
+                    switch (node->binaryOp.op) {
+                        case '+': result = left + right; break;
+                        case '-': result = left - right; break;
+                        case '*': result = left * right; break;
+                        case '/': result = left / right; break;
+                        case '%': return node; // fmod() at run time
+                        case '<': result = (left < right) ? 1 : 0; break;  // Less than
+                        case '>': result = (left > right) ? 1 : 0; break;  // Greater than
+                        case 'E': result = (left == right) ? 1 : 0; break; // Equal
+                        case 'G': result = (left >= right) ? 1 : 0; break; // Greater or equal
+                        case 'L': result = (left <= right) ? 1 : 0; break; // Less or equal
+                        case 'N': result = (left != right) ? 1 : 0; break; // Not equal
+                        case 'A': result = (left != 0 && right != 0) ? 1 : 0; break; // Logical and
+                        case 'O': result = (left != 0 || right != 0) ? 1 : 0; break; // Logical or
+                        default:
+                            logger_log(LOG_WARNING, "Unknown operator in constant folding: %c", node->binaryOp.op);
+                            return node;
+                    }
                 }
                 
+                // Comparisons and logic give an int whatever their operands
+                if (strchr("<>EGLNAO", node->binaryOp.op)) isDouble = false;
+                if (isDouble && !isfinite(result)) return node;
+                
                 logger_log(LOG_DEBUG, "Constant folding: %g %c %g = %g", 
                           left, node->binaryOp.op, right, result);
+                // Other passes fold what they build; the remark still belongs to folding
+                remarks_emit(REMARK_APPLIED, "constant_folding", node, "folded %g %s %g to %g",
+                             left, operator_text(node->binaryOp.op), right, result);
                 
                 AstNode* optimized = createAstNode(AST_NUMBER_LITERAL);
                 if (!optimized) {
@@ -984,7 +1836,14 @@ static AstNode* constant_folding(AstNode* node) {
                     return node;
                 }
                 
-                optimized->numberLiteral.value = result;
+                if (integral) {
+                    setIntegerLiteral(optimized, exact);
+                } else {
+                    optimized->numberLiteral.value = result;
+                    optimized->numberLiteral.isDouble = isDouble;
+                }
+                optimized->line = node->line;
+                optimized->col = node->col;
                 stats.constant_folding_applied++;
                 stats.total_optimizations++;
                 
@@ -994,6 +1853,18 @@ static AstNode* constant_folding(AstNode* node) {
             }
             break;
             
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++) {
+                node->program.statements[i] = constant_folding(node->program.statements[i]);
+            }
+            break;
+            
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                node->block.statements[i] = constant_folding(node->block.statements[i]);
+            }
+            break;
+            
         case AST_FUNC_DEF:
             if (debug_level >= 2) {
                 logger_log(LOG_DEBUG, "Optimizing function: %s", node->funcDef.name);
@@ -1046,6 +1917,22 @@ static AstNode* constant_folding(AstNode* node) {
                 }
             }
             break;
+            
+        case AST_PATTERN_MATCH:
+            node->patternMatch.expr = constant_folding(node->patternMatch.expr);
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                AstNode* caseNode = node->patternMatch.cases[i];
+                caseNode->patternCase.pattern = constant_folding(caseNode->patternCase.pattern);
+            }
+            break;
+            
+        case AST_CONCAT_EXPR:
+            // Only built by the string concatenation lowering, after the fixed point
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // Element stores are left as written, like other assignments
+            break;
     }
     
     return node;
@@ -1070,6 +1957,31 @@ static AstNode* dead_code_elimination(AstNode* node) {
     if (!node) return NULL;
     
     switch (node->type) {
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++) {
+                node->program.statements[i] = dead_code_elimination(node->program.statements[i]);
+            }
+            break;
+            
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                node->block.statements[i] = dead_code_elimination(node->block.statements[i]);
+            }
+            break;
+            
+        case AST_DO_WHILE_STMT:
+            // The body runs at least once, so only nested code can be pruned
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                node->doWhileStmt.body[i] = dead_code_elimination(node->doWhileStmt.body[i]);
+            }
+            break;
+            
+        case AST_FOR_STMT:
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                node->forStmt.body[i] = dead_code_elimination(node->forStmt.body[i]);
+            }
+            break;
+            
         case AST_FUNC_DEF: {
             // Check if there's a return statement that cuts execution flow
             int hasEarlyReturn = 0;
@@ -1081,6 +1993,8 @@ static AstNode* dead_code_elimination(AstNode* node) {
                 if (hasEarlyReturn) {
                     logger_log(LOG_DEBUG, "Eliminating dead code after return in function %s", 
                               node->funcDef.name);
+                    remarks_emit(REMARK_APPLIED, running_pass, node->funcDef.body[i],
+                                 "removed unreachable statement after return in '%s'", node->funcDef.name);
                     stats.dead_code_removed++;
                     stats.total_optimizations++;
                     freeAstNode(node->funcDef.body[i]);
@@ -1111,6 +2025,7 @@ static AstNode* dead_code_elimination(AstNode* node) {
                     // The 'true' branch will always execute, we can eliminate the 'else' branch
                     if (node->ifStmt.elseCount > 0) {
                         logger_log(LOG_DEBUG, "Eliminating 'else' branch (condition always true)");
+                        remarks_emit(REMARK_APPLIED, running_pass, node, "removed else branch: condition is always true");
                         
                         for (int i = 0; i < node->ifStmt.elseCount; i++) {
                             freeAstNode(node->ifStmt.elseBranch[i]);
@@ -1129,6 +2044,7 @@ static AstNode* dead_code_elimination(AstNode* node) {
                     // The 'false' branch will always execute, we can eliminate the 'then' branch
                     if (node->ifStmt.thenCount > 0) {
                         logger_log(LOG_DEBUG, "Eliminating 'then' branch (condition always false)");
+                        remarks_emit(REMARK_APPLIED, running_pass, node, "removed then branch: condition is always false");
                         
                         for (int i = 0; i < node->ifStmt.thenCount; i++) {
                             freeAstNode(node->ifStmt.thenBranch[i]);
@@ -1164,6 +2080,7 @@ static AstNode* dead_code_elimination(AstNode* node) {
                 node->whileStmt.condition->numberLiteral.value == 0) {
                 // While loop with false condition - eliminate the entire body
                 logger_log(LOG_DEBUG, "Eliminating while loop body (condition always false)");
+                remarks_emit(REMARK_APPLIED, running_pass, node, "removed loop body: condition is always false");
                 
                 for (int i = 0; i < node->whileStmt.bodyCount; i++) {
                     freeAstNode(node->whileStmt.body[i]);
@@ -1179,6 +2096,14 @@ static AstNode* dead_code_elimination(AstNode* node) {
                 }
             }
             break;
+            
+        case AST_CONCAT_EXPR:
+            // Only built by the string concatenation lowering, after the fixed point
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // Element stores are left as written, like other assignments
+            break;
     }
     
     return node;
@@ -1260,6 +2185,8 @@ static AstNode* remove_redundant_statements(AstNode* node) {
                     logger_log(LOG_DEBUG, "Removing redundant statement: %s = %s",
                               node->program.statements[i]->varAssign.name,
                               node->program.statements[i]->varAssign.initializer->identifier.name);
+                    remarks_emit(REMARK_APPLIED, running_pass, node->program.statements[i],
+                                 "removed redundant assignment to '%s'", node->program.statements[i]->varAssign.name);
                     stats.redundant_assignments_removed++;
                     stats.total_optimizations++;
                     freeAstNode(node->program.statements[i]);
@@ -1322,56 +2249,4308 @@ static AstNode* remove_redundant_statements(AstNode* node) {
                 node->forStmt.body[i] = remove_redundant_statements(node->forStmt.body[i]);
             }
             break;
+            
+        case AST_CONCAT_EXPR:
+            // Only built by the string concatenation lowering, after the fixed point
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // Element stores are left as written, like other assignments
+            break;
     }
     
     return node;
 }
 
+/** Counter used to name the temporaries introduced by CSE */
+static int cse_temp_counter = 0;
+
 /**
- * @brief Main entry point for AST optimization
- * 
- * Applies a series of optimization passes to the AST based on the current
- * optimization level:
+ * @brief Checks whether an expression mentions a variable
  * 
- * Level 1:
- * - Constant folding
- * - Redundant statement removal
+ * @param expr Expression to inspect
+ * @param name Variable name
+ * @return bool true if @p name appears as an identifier inside @p expr
+ */
+static bool expression_uses_variable(AstNode* expr, const char* name) {
+    if (!expr) return false;
+    
+    switch (expr->type) {
+        case AST_IDENTIFIER:
+            return strcmp(expr->identifier.name, name) == 0;
+        case AST_BINARY_OP:
+            return expression_uses_variable(expr->binaryOp.left, name) ||
+                   expression_uses_variable(expr->binaryOp.right, name);
+        case AST_UNARY_OP:
+            return expression_uses_variable(expr->unaryOp.expr, name);
+        case AST_MEMBER_ACCESS:
+            return expression_uses_variable(expr->memberAccess.object, name);
+        case AST_ARRAY_ACCESS:
+            return expression_uses_variable(expr->arrayAccess.array, name) ||
+                   expression_uses_variable(expr->arrayAccess.index, name);
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Checks whether evaluating an expression can have side effects
  * 
- * Level 2:
- * - Dead code elimination
+ * Function calls are treated as clobbering every variable, since Lyn
+ * functions are emitted as nested C functions that share the enclosing
+ * locals. Unknown node types are conservatively treated as impure.
  * 
- * @param ast AST to optimize
- * @return AstNode* Optimized AST, or NULL if input is NULL
+ * @param expr Expression to inspect
+ * @return bool true if the expression may write memory or call code
  */
-AstNode* optimize_ast(AstNode* ast) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)optimize_ast);
+static bool expression_has_side_effects(AstNode* expr) {
+    if (!expr) return false;
     
-    if (!ast) {
-        logger_log(LOG_WARNING, "Attempted to optimize NULL AST");
-        return NULL;
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_THIS_EXPR:
+            return false;
+        case AST_BINARY_OP:
+            return expression_has_side_effects(expr->binaryOp.left) ||
+                   expression_has_side_effects(expr->binaryOp.right);
+        case AST_UNARY_OP:
+            return expression_has_side_effects(expr->unaryOp.expr);
+        case AST_MEMBER_ACCESS:
+            return expression_has_side_effects(expr->memberAccess.object);
+        case AST_ARRAY_ACCESS:
+            return expression_has_side_effects(expr->arrayAccess.array) ||
+                   expression_has_side_effects(expr->arrayAccess.index);
+        default:
+            return true;
     }
+}
+
+/**
+ * @brief Checks whether an expression may be shared through a temporary
+ * 
+ * Candidates are arithmetic and comparison operations over identifiers,
+ * literals and other candidates. Short-circuit operators are excluded (their
+ * right operand is conditionally evaluated), as is '+' next to a string
+ * literal, which the code generator lowers to a freshly allocated
+ * concatenation.
+ * 
+ * @param expr Expression to inspect
+ * @return bool true if the expression is a CSE candidate
+ */
+static bool is_cse_candidate(AstNode* expr) {
+    if (!expr || expr->type != AST_BINARY_OP) return false;
+    if (expr->binaryOp.op == 'A' || expr->binaryOp.op == 'O') return false;
+    
+    AstNode* operands[2] = { expr->binaryOp.left, expr->binaryOp.right };
+    bool hasVariable = false;
+    for (int i = 0; i < 2; i++) {
+        AstNode* operand = operands[i];
+        while (operand && operand->type == AST_UNARY_OP) {
+            operand = operand->unaryOp.expr;
+        }
+        if (!operand) return false;
+        
+        switch (operand->type) {
+            case AST_IDENTIFIER:
+                hasVariable = true;
+                break;
+            case AST_NUMBER_LITERAL:
+            case AST_BOOLEAN_LITERAL:
+                break;
+            case AST_BINARY_OP:
+                if (!is_cse_candidate(operand)) return false;
+                hasVariable = true;
+                break;
+            default:
+                return false;
+        }
+    }
+    
+    // Constant-only expressions are left to constant folding
+    return hasVariable;
+}
+
+/**
+ * @brief Looks up an expression in the hash table without modifying it
+ * 
+ * @param expr Expression to find
+ * @return ExprHashEntry* Matching entry, or NULL if not present
+ */
+static ExprHashEntry* find_expr_in_table(AstNode* expr) {
+    for (ExprHashEntry* entry = expr_table.buckets[hash_expression(expr)]; entry; entry = entry->next) {
+        if (are_expressions_equal(entry->expr, expr)) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Removes every available expression that reads a variable
+ * 
+ * Called after an assignment, since the cached values no longer match what
+ * the expression would compute.
+ * 
+ * @param name Name of the variable that was written
+ */
+static void invalidate_expr_table(const char* name) {
+    for (int i = 0; i < expr_table.bucket_count; i++) {
+        ExprHashEntry** link = &expr_table.buckets[i];
+        while (*link) {
+            ExprHashEntry* entry = *link;
+            if (expression_uses_variable(entry->expr, name)) {
+                *link = entry->next;
+                freeAstNode(entry->expr);
+                freeAstNode(entry->var_ref);
+                free(entry);
+                expr_table.entry_count--;
+            } else {
+                link = &entry->next;
+            }
+        }
+    }
+}
+
+/**
+ * @brief State shared by the two CSE phases over one statement list
+ */
+typedef struct {
+    bool rewriting;                  ///< false while counting, true while rewriting
+    int* uses;                       ///< Occurrence count per table entry id
+    int use_capacity;                ///< Allocated size of @c uses
+    AstNode** temps;                 ///< Temporaries to emit before the current statement
+    int temp_count;                  ///< Number of pending temporaries
+    int temp_capacity;               ///< Allocated size of @c temps
+} CseState;
+
+/**
+ * @brief Visits an expression for common subexpression elimination
+ * 
+ * Expressions are matched top-down so that the largest repeated expression
+ * wins. While counting, every match increments the use count of its table
+ * entry. While rewriting, the first occurrence of an expression that is used
+ * more than once is moved into a `__cse_N` temporary and every occurrence is
+ * replaced by a reference to it.
+ * 
+ * @param slot Location of the expression pointer
+ * @param state Shared pass state
+ */
+static void cse_visit_expression(AstNode** slot, CseState* state) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+    
+    if (expr->type == AST_UNARY_OP) {
+        cse_visit_expression(&expr->unaryOp.expr, state);
+        return;
+    }
+    if (expr->type != AST_BINARY_OP) return;
+    
+    if (!is_cse_candidate(expr)) {
+        cse_visit_expression(&expr->binaryOp.left, state);
+        // The right side of && and || is only conditionally evaluated
+        if (expr->binaryOp.op != 'A' && expr->binaryOp.op != 'O') {
+            cse_visit_expression(&expr->binaryOp.right, state);
+        }
+        return;
+    }
+    
+    ExprHashEntry* entry = find_expr_in_table(expr);
+    if (entry) {
+        if (!state->rewriting) {
+            state->uses[entry->id]++;
+        } else if (entry->var_ref) {
+            *slot = cloneAstTree(entry->var_ref);
+            freeAstNode(expr);
+            stats.cse_eliminated++;
+            stats.total_optimizations++;
+        }
+        return;
+    }
+    
+    int id = expr_table.next_id;
+    add_expr_to_table(cloneAstTree(expr), NULL);
+    if (!state->rewriting) {
+        if (id >= state->use_capacity) {
+            int newCapacity = state->use_capacity ? state->use_capacity * 2 : 64;
+            while (newCapacity <= id) newCapacity *= 2;
+            state->uses = realloc(state->uses, newCapacity * sizeof(int));
+            memset(state->uses + state->use_capacity, 0,
+                   (newCapacity - state->use_capacity) * sizeof(int));
+            state->use_capacity = newCapacity;
+        }
+        state->uses[id] = 1;
+    }
+    entry = find_expr_in_table(expr);
+    
+    cse_visit_expression(&expr->binaryOp.left, state);
+    cse_visit_expression(&expr->binaryOp.right, state);
+    
+    if (state->rewriting && entry && id < state->use_capacity && state->uses[id] > 1) {
+        char name[64];
+        snprintf(name, sizeof(name), "__cse_%d", cse_temp_counter++);
+        
+        AstNode* temp = createAstNode(AST_VAR_DECL);
+        temp->line = expr->line;
+        strncpy(temp->varDecl.name, name, sizeof(temp->varDecl.name) - 1);
+        strncpy(temp->varDecl.type, "__auto_type", sizeof(temp->varDecl.type) - 1);
+        temp->varDecl.initializer = expr;
+        
+        if (state->temp_count == state->temp_capacity) {
+            state->temp_capacity = state->temp_capacity ? state->temp_capacity * 2 : 8;
+            state->temps = realloc(state->temps, state->temp_capacity * sizeof(AstNode*));
+        }
+        state->temps[state->temp_count++] = temp;
+        
+        AstNode* ref = createAstNode(AST_IDENTIFIER);
+        ref->line = expr->line;
+        strncpy(ref->identifier.name, name, sizeof(ref->identifier.name) - 1);
+        entry->var_ref = ref;
+        *slot = cloneAstTree(ref);
+        
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "CSE: introduced temporary %s (%d uses)", name, state->uses[id]);
+        }
+        remarks_emit(REMARK_APPLIED, running_pass, expr, "computed a repeated expression once (%d uses)",
+                     state->uses[id]);
+    }
+}
+
+/**
+ * @brief Processes one statement of a straight-line region for CSE
+ * 
+ * Assignments, declarations and returns with side-effect-free expressions are
+ * rewritten; assignments then invalidate every expression reading the target.
+ * Prints and bare pure expressions only read state. Anything else (calls, nested blocks and loops,
+ * try/catch, ...) ends the region and flushes the table.
+ * 
+ * @param stmt Statement to process
+ * @param state Shared pass state
+ */
+static void cse_visit_statement(AstNode* stmt, CseState* state) {
+    AstNode** slot = NULL;
+    const char* target = NULL;
+    
+    switch (stmt->type) {
+        case AST_VAR_ASSIGN:
+            slot = &stmt->varAssign.initializer;
+            target = stmt->varAssign.name;
+            break;
+        case AST_VAR_DECL:
+            slot = &stmt->varDecl.initializer;
+            target = stmt->varDecl.name;
+            break;
+        case AST_RETURN_STMT:
+            slot = &stmt->returnStmt.expr;
+            break;
+        case AST_PRINT_STMT:
+            if (!expression_has_side_effects(stmt->printStmt.expr)) return;
+            clear_expr_table();
+            return;
+        case AST_FUNC_DEF:
+            // A definition does not execute anything
+            return;
+        case AST_IDENTIFIER:
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BINARY_OP:
+        case AST_UNARY_OP:
+            // Bare expression statements (e.g. the 'var' keyword) only read state
+            if (!expression_has_side_effects(stmt)) return;
+            clear_expr_table();
+            return;
+        default:
+            clear_expr_table();
+            return;
+    }
+    
+    if (expression_has_side_effects(*slot)) {
+        clear_expr_table();
+        return;
+    }
+    
+    cse_visit_expression(slot, state);
+    if (target) {
+        invalidate_expr_table(target);
+    }
+}
+
+static void common_subexpression_elimination(AstNode* node);
+
+/**
+ * @brief Runs common subexpression elimination over a statement list
+ * 
+ * The list is scanned twice with identical invalidation: once to count how
+ * often each available expression occurs, and once to rewrite expressions
+ * that occur more than once. Temporaries are inserted directly before the
+ * statement that first computes them. Nested statement lists are processed
+ * afterwards as independent regions.
+ * 
+ * @param list Pointer to the statement array
+ * @param count Pointer to the number of statements
+ */
+static void cse_statement_list(AstNode*** list, int* count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)cse_statement_list);
+    
+    if (!*list || *count == 0) return;
+    
+    CseState state = {0};
+    
+    clear_expr_table();
+    expr_table.next_id = 0;
+    for (int i = 0; i < *count; i++) {
+        if ((*list)[i]) cse_visit_statement((*list)[i], &state);
+    }
+    
+    bool repeated = false;
+    for (int i = 0; i < expr_table.next_id && i < state.use_capacity; i++) {
+        if (state.uses[i] > 1) {
+            repeated = true;
+            break;
+        }
+    }
+    
+    if (repeated) {
+        state.rewriting = true;
+        clear_expr_table();
+        expr_table.next_id = 0;
+        
+        int capacity = *count;
+        int newCount = 0;
+        AstNode** newList = malloc(capacity * sizeof(AstNode*));
+        if (!newList) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            free(state.uses);
+            return;
+        }
+        
+        for (int i = 0; i < *count; i++) {
+            AstNode* stmt = (*list)[i];
+            if (stmt) cse_visit_statement(stmt, &state);
+            
+            if (newCount + state.temp_count + 1 > capacity) {
+                capacity = (newCount + state.temp_count + 1) * 2;
+                newList = realloc(newList, capacity * sizeof(AstNode*));
+            }
+            for (int t = 0; t < state.temp_count; t++) {
+                newList[newCount++] = state.temps[t];
+            }
+            state.temp_count = 0;
+            newList[newCount++] = stmt;
+        }
+        
+        free(*list);
+        *list = newList;
+        *count = newCount;
+    }
+    
+    clear_expr_table();
+    free(state.uses);
+    free(state.temps);
+    
+    for (int i = 0; i < *count; i++) {
+        common_subexpression_elimination((*list)[i]);
+    }
+}
+
+/**
+ * @brief Eliminates common subexpressions from the AST
+ * 
+ * Walks every statement list in the tree (program, function bodies, branches,
+ * loop bodies, try/catch/finally, switch cases) and shares repeated pure
+ * arithmetic through `__auto_type` temporaries, so the generated C keeps the
+ * exact type of the original expression.
+ * 
+ * This optimization is enabled at optimization level 2 and above.
+ * 
+ * @param node AST node to optimize
+ */
+static void common_subexpression_elimination(AstNode* node) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+            cse_statement_list(&node->program.statements, &node->program.statementCount);
+            break;
+        case AST_FUNC_DEF:
+            cse_statement_list(&node->funcDef.body, &node->funcDef.bodyCount);
+            break;
+        case AST_BLOCK:
+            cse_statement_list(&node->block.statements, &node->block.statementCount);
+            break;
+        case AST_IF_STMT:
+            cse_statement_list(&node->ifStmt.thenBranch, &node->ifStmt.thenCount);
+            cse_statement_list(&node->ifStmt.elseBranch, &node->ifStmt.elseCount);
+            break;
+        case AST_WHILE_STMT:
+            cse_statement_list(&node->whileStmt.body, &node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            cse_statement_list(&node->doWhileStmt.body, &node->doWhileStmt.bodyCount);
+            break;
+        case AST_FOR_STMT:
+            cse_statement_list(&node->forStmt.body, &node->forStmt.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            cse_statement_list(&node->tryCatchStmt.tryBody, &node->tryCatchStmt.tryCount);
+            cse_statement_list(&node->tryCatchStmt.catchBody, &node->tryCatchStmt.catchCount);
+            cse_statement_list(&node->tryCatchStmt.finallyBody, &node->tryCatchStmt.finallyCount);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                common_subexpression_elimination(node->switchStmt.cases[i]);
+            }
+            cse_statement_list(&node->switchStmt.defaultCase, &node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            cse_statement_list(&node->caseStmt.body, &node->caseStmt.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                common_subexpression_elimination(node->patternMatch.cases[i]);
+            }
+            common_subexpression_elimination(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            cse_statement_list(&node->patternCase.body, &node->patternCase.bodyCount);
+            break;
+        default:
+            break;
+    }
+}
+
+/** Counter used to name loop-invariant temporaries */
+static int licm_temp_counter = 0;
+
+/**
+ * @brief State shared while hoisting invariants out of one loop
+ */
+typedef struct {
+    HashMap* writes;                 ///< Variables the loop may modify
+    int quiet;                       ///< Inside an expression already reported as not hoisted
+    AstNode** temps;                 ///< Hoisted temporaries, in order
+    int temp_count;                  ///< Number of hoisted temporaries
+    int temp_capacity;               ///< Allocated size of @c temps
+} LicmState;
+
+/**
+ * @brief hashmap_foreach/visit_assigned_names callback that records a name
+ */
+static void record_written_name(const char* key, void* value, void* userData) {
+    (void)value;
+    hashmap_put((HashMap*)userData, key, NULL, NULL);
+}
+
+/**
+ * @brief Checks whether an expression is pure and loop-invariant
+ * 
+ * Only literals, variables the loop never writes and non-trapping operators
+ * qualify: member and array accesses may observe writes through other names,
+ * calls may have side effects, and a division by a non-literal could trap
+ * once hoisted in front of a loop that would not have run.
+ * 
+ * @param expr Expression to check
+ * @param writes Variables the loop may modify
+ * @param reads_variable Set to true if the expression reads a variable
+ * @param allocates Set to true if the expression allocates (string concatenation)
+ * @return bool true if the expression can be evaluated once before the loop
+ */
+static bool is_loop_invariant(AstNode* expr, HashMap* writes, bool* reads_variable, bool* allocates) {
+    if (!expr) return false;
+    
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+            return true;
+            
+        case AST_IDENTIFIER:
+            *reads_variable = true;
+            return !hashmap_contains(writes, expr->identifier.name);
+            
+        case AST_UNARY_OP:
+            if (expr->unaryOp.op != '-' && expr->unaryOp.op != '+' && expr->unaryOp.op != 'N') return false;
+            return is_loop_invariant(expr->unaryOp.expr, writes, reads_variable, allocates);
+            
+        case AST_BINARY_OP: {
+            AstNode* left = expr->binaryOp.left;
+            AstNode* right = expr->binaryOp.right;
+            
+            switch (expr->binaryOp.op) {
+                case '+':
+                    // A string operand turns '+' into a concat_n allocation
+                    if ((left && left->type == AST_STRING_LITERAL) ||
+                        (right && right->type == AST_STRING_LITERAL)) {
+                        *allocates = true;
+                    }
+                    break;
+                case '-': case '*':
+                case '<': case '>': case 'E': case 'G': case 'L': case 'N':
+                case 'A': case 'O':
+                    break;
+                case '/': case '%':
+                    if (!right || right->type != AST_NUMBER_LITERAL || right->numberLiteral.value == 0) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+            return is_loop_invariant(left, writes, reads_variable, allocates) &&
+                   is_loop_invariant(right, writes, reads_variable, allocates);
+        }
+        
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Explains why an expression that reads nothing the loop writes is still not invariant
+ * 
+ * @param expr Expression rejected by is_loop_invariant()
+ * @param writes Variables the loop may modify
+ * @return const char* Reason for a remark, or NULL if the expression reads a variable the
+ *         loop writes (the usual case, not worth reporting)
+ */
+static const char* licm_blocker(AstNode* expr, HashMap* writes);
+
+/**
+ * @brief Checks that operands are invariant or blocked only by something licm_blocker() reports
+ * 
+ * @param operands Operand expressions
+ * @param count Number of operands
+ * @param writes Variables the loop may modify
+ * @param reason Set to the first operand's blocker, if any
+ * @return bool false if an operand reads a variable the loop writes
+ */
+static bool licm_operands_blocked(AstNode** operands, int count, HashMap* writes, const char** reason) {
+    for (int i = 0; i < count; i++) {
+        bool reads = false, allocates = false;
+        if (!operands[i] || is_loop_invariant(operands[i], writes, &reads, &allocates)) continue;
+        const char* blocker = licm_blocker(operands[i], writes);
+        if (!blocker) return false;
+        if (!*reason) *reason = blocker;
+    }
+    return true;
+}
+
+static const char* licm_blocker(AstNode* expr, HashMap* writes) {
+    if (!expr) return NULL;
+    const char* reason = NULL;
+    switch (expr->type) {
+        case AST_FUNC_CALL:
+            if (!licm_operands_blocked(expr->funcCall.arguments, expr->funcCall.argCount, writes, &reason)) {
+                return NULL;
+            }
+            return "call has side effects";
+        case AST_ARRAY_ACCESS: {
+            AstNode* operands[2] = { expr->arrayAccess.array, expr->arrayAccess.index };
+            if (!licm_operands_blocked(operands, 2, writes, &reason)) return NULL;
+            return "array element may be written through another name";
+        }
+        case AST_MEMBER_ACCESS:
+            if (!licm_operands_blocked(&expr->memberAccess.object, 1, writes, &reason)) return NULL;
+            return "field may be written through another name";
+        case AST_UNARY_OP:
+            if (!licm_operands_blocked(&expr->unaryOp.expr, 1, writes, &reason)) return NULL;
+            return reason;
+        case AST_BINARY_OP: {
+            AstNode* operands[2] = { expr->binaryOp.left, expr->binaryOp.right };
+            if (!licm_operands_blocked(operands, 2, writes, &reason)) return NULL;
+            if (!reason && (expr->binaryOp.op == '/' || expr->binaryOp.op == '%')) {
+                return "division by a non-constant could trap before the loop";
+            }
+            return reason;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/**
+ * @brief Hoists the largest invariant subexpressions of an expression
+ * 
+ * An invariant operation that reads a variable or allocates is moved into a
+ * `__licm_N` temporary declared before the loop; identical expressions in the
+ * same loop share one temporary.
+ * 
+ * @param slot Location of the expression pointer
+ * @param state Hoisting state for the current loop
+ */
+static void licm_visit_expression(AstNode** slot, LicmState* state) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+    
+    if (expr->type == AST_UNARY_OP) {
+        licm_visit_expression(&expr->unaryOp.expr, state);
+        return;
+    }
+    if (expr->type != AST_BINARY_OP) return;
+    
+    bool reads_variable = false;
+    bool allocates = false;
+    if (!is_loop_invariant(expr, state->writes, &reads_variable, &allocates) ||
+        (!reads_variable && !allocates)) {
+        // Report the outermost expression kept in the loop only by something other than a write
+        const char* blocker = state->quiet == 0 ? licm_blocker(expr, state->writes) : NULL;
+        if (blocker) {
+            remarks_emit(REMARK_MISSED, running_pass, expr, "not hoisted: %s", blocker);
+            state->quiet++;
+        }
+        licm_visit_expression(&expr->binaryOp.left, state);
+        // The right side of && and || is only conditionally evaluated
+        if (expr->binaryOp.op != 'A' && expr->binaryOp.op != 'O') {
+            licm_visit_expression(&expr->binaryOp.right, state);
+        }
+        if (blocker) state->quiet--;
+        return;
+    }
+    
+    remarks_emit(REMARK_APPLIED, running_pass, expr, "hoisted loop-invariant %s out of the loop",
+                 allocates ? "string concatenation" : "expression");
+    int line = expr->line;
+    const char* name = NULL;
+    for (int i = 0; i < state->temp_count; i++) {
+        if (are_expressions_equal(state->temps[i]->varDecl.initializer, expr)) {
+            name = state->temps[i]->varDecl.name;
+            freeAstNode(expr);
+            break;
+        }
+    }
+    
+    if (!name) {
+        AstNode* temp = createAstNode(AST_VAR_DECL);
+        if (!temp) return;
+        temp->line = expr->line;
+        snprintf(temp->varDecl.name, sizeof(temp->varDecl.name), "__licm_%d", licm_temp_counter++);
+        strncpy(temp->varDecl.type, "__auto_type", sizeof(temp->varDecl.type) - 1);
+        temp->varDecl.initializer = expr;
+        
+        if (state->temp_count == state->temp_capacity) {
+            state->temp_capacity = state->temp_capacity ? state->temp_capacity * 2 : 8;
+            state->temps = realloc(state->temps, state->temp_capacity * sizeof(AstNode*));
+        }
+        state->temps[state->temp_count++] = temp;
+        name = temp->varDecl.name;
+        
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "LICM: hoisted %s%s", name, allocates ? " (allocation)" : "");
+        }
+    }
+    AstNode* ref = createAstNode(AST_IDENTIFIER);
+    ref->line = line;
+    strncpy(ref->identifier.name, name, sizeof(ref->identifier.name) - 1);
+    *slot = ref;
+    stats.loop_invariants_hoisted++;
+    stats.total_optimizations++;
+}
+
+/**
+ * @brief Hoists invariant expressions out of the statements of a loop body
+ * 
+ * Rewrites assignment and declaration initializers, returns and branch
+ * conditions. Print operands are left alone because their format depends on
+ * the operand's node kind, and nested loops have already been processed
+ * (anything invariant here is invariant there too).
+ * 
+ * @param stmt Statement inside the loop body
+ * @param state Hoisting state for the current loop
+ */
+static void licm_visit_statement(AstNode* stmt, LicmState* state) {
+    if (!stmt) return;
+    
+    switch (stmt->type) {
+        case AST_VAR_ASSIGN:
+            licm_visit_expression(&stmt->varAssign.initializer, state);
+            break;
+        case AST_ARRAY_ASSIGN:
+            licm_visit_expression(&stmt->arrayAssign.index, state);
+            licm_visit_expression(&stmt->arrayAssign.value, state);
+            break;
+        case AST_VAR_DECL:
+            licm_visit_expression(&stmt->varDecl.initializer, state);
+            break;
+        case AST_RETURN_STMT:
+            licm_visit_expression(&stmt->returnStmt.expr, state);
+            break;
+        case AST_IF_STMT:
+            licm_visit_expression(&stmt->ifStmt.condition, state);
+            for (int i = 0; i < stmt->ifStmt.thenCount; i++) {
+                licm_visit_statement(stmt->ifStmt.thenBranch[i], state);
+            }
+            for (int i = 0; i < stmt->ifStmt.elseCount; i++) {
+                licm_visit_statement(stmt->ifStmt.elseBranch[i], state);
+            }
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->block.statementCount; i++) {
+                licm_visit_statement(stmt->block.statements[i], state);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Collects the temporaries that can be hoisted out of a loop
+ * 
+ * The loop's write set covers every assignment in its body, its iterator and,
+ * when the body calls functions, every variable a function may write (from
+ * scope analysis). Without that information loops containing calls are left
+ * untouched.
+ * 
+ * @param loop While, do-while or for statement
+ * @param state Hoisting state (temporaries are appended)
+ */
+static void hoist_loop_invariants(AstNode* loop, LicmState* state) {
+    AstNode** body = NULL;
+    int bodyCount = 0;
+    AstNode** condition = NULL;
+    
+    switch (loop->type) {
+        case AST_WHILE_STMT:
+            body = loop->whileStmt.body;
+            bodyCount = loop->whileStmt.bodyCount;
+            condition = &loop->whileStmt.condition;
+            break;
+        case AST_DO_WHILE_STMT:
+            body = loop->doWhileStmt.body;
+            bodyCount = loop->doWhileStmt.bodyCount;
+            condition = &loop->doWhileStmt.condition;
+            break;
+        case AST_FOR_STMT:
+            body = loop->forStmt.body;
+            bodyCount = loop->forStmt.bodyCount;
+            // The range end is re-evaluated by the emitted loop test
+            if (loop->forStmt.forType == FOR_RANGE) condition = &loop->forStmt.rangeEnd;
+            break;
+        default:
+            return;
+    }
+    if (bodyCount == 0) return;
+    
+    bool calls = contains_call(loop);
+    if (calls && !function_writes) {
+        remarks_emit(REMARK_MISSED, running_pass, loop,
+                     "nothing hoisted: the loop calls functions whose writes are unknown");
+        return;
+    }
+    
+    state->writes = hashmap_create(32);
+    if (!state->writes) return;
+    visit_assigned_names(loop, record_written_name, state->writes);
+    if (calls) {
+        hashmap_foreach(function_writes, record_written_name, state->writes);
+    }
+    
+    if (condition) licm_visit_expression(condition, state);
+    for (int i = 0; i < bodyCount; i++) {
+        licm_visit_statement(body[i], state);
+    }
+    
+    hashmap_free(state->writes, NULL);
+    state->writes = NULL;
+}
+
+static void loop_invariant_code_motion_node(AstNode* node);
+
+/**
+ * @brief Runs LICM over a statement list, inserting hoisted temporaries
+ * 
+ * Nested statements are processed first, so inner loops hoist into the body
+ * of the outer loop before the outer loop is considered.
+ * 
+ * @param list Location of the statement array
+ * @param count Location of the statement count
+ */
+static void licm_statement_list(AstNode*** list, int* count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)licm_statement_list);
+    
+    if (!*list || *count == 0) return;
+    
+    LicmState state = {0};
+    AstNode** newList = NULL;
+    int newCount = 0;
+    int capacity = 0;
+    
+    for (int i = 0; i < *count; i++) {
+        AstNode* stmt = (*list)[i];
+        loop_invariant_code_motion_node(stmt);
+        
+        if (stmt && (stmt->type == AST_WHILE_STMT || stmt->type == AST_DO_WHILE_STMT ||
+                     stmt->type == AST_FOR_STMT)) {
+            hoist_loop_invariants(stmt, &state);
+        }
+        
+        if (state.temp_count > 0 && !newList) {
+            // First hoist in this list: switch to building a new array
+            capacity = *count + state.temp_count + 8;
+            newList = malloc(capacity * sizeof(AstNode*));
+            if (!newList) {
+                error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+                free(state.temps);
+                return;
+            }
+            memcpy(newList, *list, i * sizeof(AstNode*));
+            newCount = i;
+        }
+        
+        if (newList) {
+            if (newCount + state.temp_count + 1 > capacity) {
+                capacity = (newCount + state.temp_count + 1) * 2;
+                newList = realloc(newList, capacity * sizeof(AstNode*));
+            }
+            for (int t = 0; t < state.temp_count; t++) {
+                newList[newCount++] = state.temps[t];
+            }
+            newList[newCount++] = stmt;
+        }
+        state.temp_count = 0;
+    }
+    
+    if (newList) {
+        free(*list);
+        *list = newList;
+        *count = newCount;
+    }
+    free(state.temps);
+}
+
+/**
+ * @brief Recurses into every statement list below a node
+ * 
+ * @param node AST node to process
+ */
+static void loop_invariant_code_motion_node(AstNode* node) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+            licm_statement_list(&node->program.statements, &node->program.statementCount);
+            break;
+        case AST_FUNC_DEF:
+            licm_statement_list(&node->funcDef.body, &node->funcDef.bodyCount);
+            break;
+        case AST_BLOCK:
+            licm_statement_list(&node->block.statements, &node->block.statementCount);
+            break;
+        case AST_IF_STMT:
+            licm_statement_list(&node->ifStmt.thenBranch, &node->ifStmt.thenCount);
+            licm_statement_list(&node->ifStmt.elseBranch, &node->ifStmt.elseCount);
+            break;
+        case AST_WHILE_STMT:
+            licm_statement_list(&node->whileStmt.body, &node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            licm_statement_list(&node->doWhileStmt.body, &node->doWhileStmt.bodyCount);
+            break;
+        case AST_FOR_STMT:
+            licm_statement_list(&node->forStmt.body, &node->forStmt.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            licm_statement_list(&node->tryCatchStmt.tryBody, &node->tryCatchStmt.tryCount);
+            licm_statement_list(&node->tryCatchStmt.catchBody, &node->tryCatchStmt.catchCount);
+            licm_statement_list(&node->tryCatchStmt.finallyBody, &node->tryCatchStmt.finallyCount);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                loop_invariant_code_motion_node(node->switchStmt.cases[i]);
+            }
+            licm_statement_list(&node->switchStmt.defaultCase, &node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            licm_statement_list(&node->caseStmt.body, &node->caseStmt.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                loop_invariant_code_motion_node(node->patternMatch.cases[i]);
+            }
+            loop_invariant_code_motion_node(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            licm_statement_list(&node->patternCase.body, &node->patternCase.bodyCount);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Performs loop-invariant code motion
+ * 
+ * Moves pure expressions whose operands are not modified by a while,
+ * do-while or for loop into `__auto_type` temporaries declared just before
+ * the loop. This includes string concatenations, which otherwise allocate a
+ * new buffer through concat_n on every iteration. Side effects of calls are
+ * accounted for through the function write sets built by scope analysis.
+ * 
+ * This optimization is enabled at optimization level 2 and above.
+ * 
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST with invariants hoisted
+ */
+static AstNode* loop_invariant_code_motion(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)loop_invariant_code_motion);
+    
+    loop_invariant_code_motion_node(node);
+    return node;
+}
+
+/** Counter used to name strength-reduced induction variables */
+static int iv_temp_counter = 0;
+
+/** Marker values stored in the integral-variable map */
+static int integral_mark, non_integral_mark;
+
+/**
+ * @brief Records whether an assignment keeps a variable integral
+ * 
+ * A variable is integral when every assignment anywhere in the program
+ * stores an integral literal. Such a variable is emitted as an int (or a
+ * double that only ever holds exact integers), so multiplying it by the
+ * iterator can be replaced by repeated addition without changing the
+ * result.
+ * 
+ * @param integral Map from name to &integral_mark or &non_integral_mark
+ * @param name Assigned variable
+ * @param is_integral Whether this assignment stores an integral literal
+ */
+static void note_integral_assignment(HashMap* integral, const char* name, bool is_integral) {
+    void* current = hashmap_get(integral, name);
+    if (current == &non_integral_mark) return;
+    hashmap_put(integral, name, is_integral ? &integral_mark : &non_integral_mark, NULL);
+}
+
+/**
+ * @brief Walks the whole program classifying variables as integral or not
+ * 
+ * @param node Subtree to walk
+ * @param integral Map being filled
+ */
+static void collect_integral_variables(AstNode* node, HashMap* integral) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++) {
+                collect_integral_variables(node->program.statements[i], integral);
+            }
+            break;
+        case AST_VAR_DECL: {
+            AstNode* init = node->varDecl.initializer;
+            bool integral_init = init && init->type == AST_NUMBER_LITERAL &&
+                                 is_integral_value(init->numberLiteral.value) &&
+                                 (node->varDecl.type[0] == '\0' || strcmp(node->varDecl.type, "int") == 0);
+            note_integral_assignment(integral, node->varDecl.name, integral_init);
+            break;
+        }
+        case AST_VAR_ASSIGN: {
+            AstNode* init = node->varAssign.initializer;
+            note_integral_assignment(integral, node->varAssign.name,
+                                     init && init->type == AST_NUMBER_LITERAL &&
+                                     is_integral_value(init->numberLiteral.value));
+            break;
+        }
+        case AST_FUNC_DEF:
+            for (int i = 0; i < node->funcDef.paramCount; i++) {
+                AstNode* param = node->funcDef.parameters[i];
+                if (param && param->type == AST_IDENTIFIER) {
+                    note_integral_assignment(integral, param->identifier.name, false);
+                }
+            }
+            for (int i = 0; i < node->funcDef.bodyCount; i++) {
+                collect_integral_variables(node->funcDef.body[i], integral);
+            }
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++) {
+                collect_integral_variables(node->classDef.members[i], integral);
+            }
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                collect_integral_variables(node->block.statements[i], integral);
+            }
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                collect_integral_variables(node->ifStmt.thenBranch[i], integral);
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                collect_integral_variables(node->ifStmt.elseBranch[i], integral);
+            }
+            break;
+        case AST_WHILE_STMT:
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) {
+                collect_integral_variables(node->whileStmt.body[i], integral);
+            }
+            break;
+        case AST_DO_WHILE_STMT:
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                collect_integral_variables(node->doWhileStmt.body[i], integral);
+            }
+            break;
+        case AST_FOR_STMT:
+            // Range iterators are declared as int; collection elements are not numbers
+            note_integral_assignment(integral, node->forStmt.iterator, node->forStmt.forType == FOR_RANGE);
+            collect_integral_variables(node->forStmt.init, integral);
+            collect_integral_variables(node->forStmt.update, integral);
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                collect_integral_variables(node->forStmt.body[i], integral);
+            }
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                collect_integral_variables(node->switchStmt.cases[i], integral);
+            }
+            for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
+                collect_integral_variables(node->switchStmt.defaultCase[i], integral);
+            }
+            break;
+        case AST_CASE_STMT:
+            for (int i = 0; i < node->caseStmt.bodyCount; i++) {
+                collect_integral_variables(node->caseStmt.body[i], integral);
+            }
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                collect_integral_variables(node->patternMatch.cases[i], integral);
+            }
+            collect_integral_variables(node->patternMatch.otherwise, integral);
+            break;
+        case AST_PATTERN_CASE:
+            for (int i = 0; i < node->patternCase.bodyCount; i++) {
+                collect_integral_variables(node->patternCase.body[i], integral);
+            }
+            break;
+        case AST_TRY_CATCH_STMT:
+            note_integral_assignment(integral, node->tryCatchStmt.errorVarName, false);
+            for (int i = 0; i < node->tryCatchStmt.tryCount; i++) {
+                collect_integral_variables(node->tryCatchStmt.tryBody[i], integral);
+            }
+            for (int i = 0; i < node->tryCatchStmt.catchCount; i++) {
+                collect_integral_variables(node->tryCatchStmt.catchBody[i], integral);
+            }
+            for (int i = 0; i < node->tryCatchStmt.finallyCount; i++) {
+                collect_integral_variables(node->tryCatchStmt.finallyBody[i], integral);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Derived induction variable `iterator * multiplier`
+ */
+typedef struct {
+    AstNode* multiplier;             ///< Loop-invariant integral factor (owned copy)
+    const char* name;                ///< Name of the strength-reduced variable
+} DerivedInduction;
+
+/**
+ * @brief State for strength-reducing one range loop
+ */
+typedef struct {
+    AstNode* loop;                   ///< Range loop being reduced
+    HashMap* writes;                 ///< Variables the loop may modify
+    HashMap* integral;               ///< Program-wide integral variables
+    long long step;                  ///< Constant positive step
+    DerivedInduction* derived;       ///< Derived induction variables
+    int derived_count;               ///< Number of derived variables
+    int derived_capacity;            ///< Allocated size of @c derived
+    AstNode** temps;                 ///< Declarations to insert before the loop
+    int temp_count;                  ///< Number of declarations
+    int temp_capacity;               ///< Allocated size of @c temps
+} InductionState;
+
+/**
+ * @brief Checks whether an operand is a loop-invariant integral value
+ * 
+ * @param expr Operand to check
+ * @param state Loop state
+ * @return bool true for integral literals and integral variables the loop never writes
+ */
+static bool is_invariant_integral(AstNode* expr, InductionState* state) {
+    if (!expr) return false;
+    if (expr->type == AST_NUMBER_LITERAL) return is_integral_value(expr->numberLiteral.value);
+    if (expr->type == AST_IDENTIFIER) {
+        return hashmap_get(state->integral, expr->identifier.name) == &integral_mark &&
+               !hashmap_contains(state->writes, expr->identifier.name);
+    }
+    return false;
+}
+
+/**
+ * @brief Creates a number literal node
+ * 
+ * @param value Literal value
+ * @return AstNode* New node, or NULL on allocation failure
+ */
+static AstNode* make_number(double value) {
+    AstNode* number = createAstNode(AST_NUMBER_LITERAL);
+    if (number) number->numberLiteral.value = value;
+    return number;
+}
+
+/**
+ * @brief Creates a binary operation node
+ * 
+ * @param op Operator
+ * @param left Left operand (ownership transferred)
+ * @param right Right operand (ownership transferred)
+ * @return AstNode* New node, or NULL on allocation failure
+ */
+static AstNode* make_binary(char op, AstNode* left, AstNode* right) {
+    AstNode* binary = createAstNode(AST_BINARY_OP);
+    if (!binary) return NULL;
+    binary->binaryOp.op = op;
+    binary->binaryOp.left = left;
+    binary->binaryOp.right = right;
+    return binary;
+}
+
+/**
+ * @brief Gives the nodes of a synthesized subtree a source position
+ * 
+ * Nodes already located (copies of source nodes) keep their own position;
+ * the rest take the one of @p from, so remarks about them point at the loop.
+ * 
+ * @param node Subtree built by a pass
+ * @param userData Node whose position is copied
+ */
+static void inherit_position(AstNode* node, void* userData) {
+    const AstNode* from = (const AstNode*)userData;
+    if (!node) return;
+    if (node->line == 0) {
+        node->line = from->line;
+        node->col = from->col;
+    }
+    astVisitChildren(node, inherit_position, userData);
+}
+
+/**
+ * @brief Finds or creates the derived induction variable for a multiplier
+ * 
+ * The new variable starts at `start * multiplier` before the loop and is
+ * advanced by `step * multiplier` at the end of every iteration.
+ * 
+ * @param multiplier Loop-invariant integral factor (not consumed)
+ * @param state Loop state
+ * @return const char* Name of the derived variable, or NULL on failure
+ */
+static const char* get_derived_induction(AstNode* multiplier, InductionState* state) {
+    for (int i = 0; i < state->derived_count; i++) {
+        if (are_expressions_equal(state->derived[i].multiplier, multiplier)) {
+            return state->derived[i].name;
+        }
+    }
+    
+    AstNode* temp = createAstNode(AST_VAR_DECL);
+    if (!temp) return NULL;
+    snprintf(temp->varDecl.name, sizeof(temp->varDecl.name), "__iv_%d", iv_temp_counter++);
+    strncpy(temp->varDecl.type, "__auto_type", sizeof(temp->varDecl.type) - 1);
+    AstNode* initial = make_binary('*', cloneAstTree(state->loop->forStmt.rangeStart), cloneAstTree(multiplier));
+    inherit_position(temp, state->loop);
+    inherit_position(initial, state->loop);
+    temp->varDecl.initializer = constant_folding(initial);
+    
+    if (state->temp_count == state->temp_capacity) {
+        state->temp_capacity = state->temp_capacity ? state->temp_capacity * 2 : 4;
+        state->temps = realloc(state->temps, state->temp_capacity * sizeof(AstNode*));
+    }
+    state->temps[state->temp_count++] = temp;
+    
+    if (state->derived_count == state->derived_capacity) {
+        state->derived_capacity = state->derived_capacity ? state->derived_capacity * 2 : 4;
+        state->derived = realloc(state->derived, state->derived_capacity * sizeof(DerivedInduction));
+    }
+    state->derived[state->derived_count].multiplier = cloneAstTree(multiplier);
+    state->derived[state->derived_count].name = temp->varDecl.name;
+    state->derived_count++;
+    
+    return temp->varDecl.name;
+}
+
+/**
+ * @brief Replaces `iterator * k` and `k * iterator` in an expression
+ * 
+ * @param slot Location of the expression pointer
+ * @param state Loop state
+ */
+static void reduce_induction_expression(AstNode** slot, InductionState* state) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+    
+    switch (expr->type) {
+        case AST_BINARY_OP: {
+            if (expr->binaryOp.op == '*') {
+                AstNode* left = expr->binaryOp.left;
+                AstNode* right = expr->binaryOp.right;
+                AstNode* multiplier = NULL;
+                const char* iterator = state->loop->forStmt.iterator;
+                
+                if (left && left->type == AST_IDENTIFIER && strcmp(left->identifier.name, iterator) == 0) {
+                    multiplier = right;
+                } else if (right && right->type == AST_IDENTIFIER && strcmp(right->identifier.name, iterator) == 0) {
+                    multiplier = left;
+                }
+                
+                if (multiplier && is_invariant_integral(multiplier, state)) {
+                    const char* name = get_derived_induction(multiplier, state);
+                    if (name) {
+                        AstNode* ref = createAstNode(AST_IDENTIFIER);
+                        ref->line = expr->line;
+                        strncpy(ref->identifier.name, name, sizeof(ref->identifier.name) - 1);
+                        freeAstNode(expr);
+                        *slot = ref;
+                        stats.induction_variables_reduced++;
+                        stats.total_optimizations++;
+                        return;
+                    }
+                }
+            }
+            reduce_induction_expression(&expr->binaryOp.left, state);
+            reduce_induction_expression(&expr->binaryOp.right, state);
+            break;
+        }
+        case AST_UNARY_OP:
+            reduce_induction_expression(&expr->unaryOp.expr, state);
+            break;
+        case AST_ARRAY_ACCESS:
+            reduce_induction_expression(&expr->arrayAccess.array, state);
+            reduce_induction_expression(&expr->arrayAccess.index, state);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < expr->funcCall.argCount; i++) {
+                reduce_induction_expression(&expr->funcCall.arguments[i], state);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Rewrites the expressions of one statement in a range loop body
+ * 
+ * Print operands are skipped because their format depends on the operand's
+ * node kind. Nested loops are entered unless they declare an iterator with
+ * the same name.
+ * 
+ * @param stmt Statement to rewrite
+ * @param state Loop state
+ */
+static void reduce_induction_statement(AstNode* stmt, InductionState* state) {
+    if (!stmt) return;
+    
+    switch (stmt->type) {
+        case AST_VAR_ASSIGN:
+            reduce_induction_expression(&stmt->varAssign.initializer, state);
+            break;
+        case AST_ARRAY_ASSIGN:
+            reduce_induction_expression(&stmt->arrayAssign.index, state);
+            reduce_induction_expression(&stmt->arrayAssign.value, state);
+            break;
+        case AST_VAR_DECL:
+            reduce_induction_expression(&stmt->varDecl.initializer, state);
+            break;
+        case AST_RETURN_STMT:
+            reduce_induction_expression(&stmt->returnStmt.expr, state);
+            break;
+        case AST_FUNC_CALL:
+            reduce_induction_expression(&stmt, state);
+            break;
+        case AST_IF_STMT:
+            reduce_induction_expression(&stmt->ifStmt.condition, state);
+            for (int i = 0; i < stmt->ifStmt.thenCount; i++) {
+                reduce_induction_statement(stmt->ifStmt.thenBranch[i], state);
+            }
+            for (int i = 0; i < stmt->ifStmt.elseCount; i++) {
+                reduce_induction_statement(stmt->ifStmt.elseBranch[i], state);
+            }
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < stmt->block.statementCount; i++) {
+                reduce_induction_statement(stmt->block.statements[i], state);
+            }
+            break;
+        case AST_WHILE_STMT:
+            reduce_induction_expression(&stmt->whileStmt.condition, state);
+            for (int i = 0; i < stmt->whileStmt.bodyCount; i++) {
+                reduce_induction_statement(stmt->whileStmt.body[i], state);
+            }
+            break;
+        case AST_DO_WHILE_STMT:
+            reduce_induction_expression(&stmt->doWhileStmt.condition, state);
+            for (int i = 0; i < stmt->doWhileStmt.bodyCount; i++) {
+                reduce_induction_statement(stmt->doWhileStmt.body[i], state);
+            }
+            break;
+        case AST_FOR_STMT:
+            if (strcmp(stmt->forStmt.iterator, state->loop->forStmt.iterator) == 0) break;
+            if (stmt->forStmt.forType == FOR_RANGE) {
+                reduce_induction_expression(&stmt->forStmt.rangeStart, state);
+                reduce_induction_expression(&stmt->forStmt.rangeEnd, state);
+            }
+            for (int i = 0; i < stmt->forStmt.bodyCount; i++) {
+                reduce_induction_statement(stmt->forStmt.body[i], state);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Checks whether a loop body contains a `continue` for this loop
+ * 
+ * A continue would skip the additive updates appended to the body.
+ * 
+ * @param node Statement to inspect
+ * @return bool true if the statement may continue the enclosing loop
+ */
+static bool contains_loop_continue(AstNode* node) {
+    if (!node) return false;
+    
+    switch (node->type) {
+        case AST_CONTINUE_STMT:
+            return true;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                if (contains_loop_continue(node->block.statements[i])) return true;
+            }
+            return false;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                if (contains_loop_continue(node->ifStmt.thenBranch[i])) return true;
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                if (contains_loop_continue(node->ifStmt.elseBranch[i])) return true;
+            }
+            return false;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                if (contains_loop_continue(node->switchStmt.cases[i])) return true;
+            }
+            for (int i = 0; i < node->switchStmt.defaultCaseCount; i++) {
+                if (contains_loop_continue(node->switchStmt.defaultCase[i])) return true;
+            }
+            return false;
+        case AST_CASE_STMT:
+            for (int i = 0; i < node->caseStmt.bodyCount; i++) {
+                if (contains_loop_continue(node->caseStmt.body[i])) return true;
+            }
+            return false;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                if (contains_loop_continue(node->patternMatch.cases[i])) return true;
+            }
+            return contains_loop_continue(node->patternMatch.otherwise);
+        case AST_PATTERN_CASE:
+            for (int i = 0; i < node->patternCase.bodyCount; i++) {
+                if (contains_loop_continue(node->patternCase.body[i])) return true;
+            }
+            return false;
+        case AST_TRY_CATCH_STMT:
+            for (int i = 0; i < node->tryCatchStmt.tryCount; i++) {
+                if (contains_loop_continue(node->tryCatchStmt.tryBody[i])) return true;
+            }
+            for (int i = 0; i < node->tryCatchStmt.catchCount; i++) {
+                if (contains_loop_continue(node->tryCatchStmt.catchBody[i])) return true;
+            }
+            for (int i = 0; i < node->tryCatchStmt.finallyCount; i++) {
+                if (contains_loop_continue(node->tryCatchStmt.finallyBody[i])) return true;
+            }
+            return false;
+        default:
+            // Nested loops own their continues
+            return false;
+    }
+}
+
+/**
+ * @brief Analyzes a range loop and strength-reduces its derived variables
+ * 
+ * Records in forStmt.inductionFlags what is proven about the iterator, then
+ * replaces `iterator * k` (k an invariant integral value) with a variable
+ * that is initialized before the loop and advanced by `step * k` at the end
+ * of every iteration.
+ * 
+ * @param loop Range loop
+ * @param integral Program-wide integral variables
+ * @param temps Output for declarations to insert before the loop
+ * @param temp_count Output for the number of declarations
+ */
+static void reduce_range_loop(AstNode* loop, HashMap* integral, AstNode*** temps, int* temp_count) {
+    *temps = NULL;
+    *temp_count = 0;
+    
+    AstNode* start = loop->forStmt.rangeStart;
+    AstNode* end = loop->forStmt.rangeEnd;
+    AstNode* step = loop->forStmt.rangeStep;
+    bool calls = contains_call(loop);
+    
+    HashMap* body_writes = hashmap_create(32);
+    if (!body_writes) return;
+    for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+        visit_assigned_names(loop->forStmt.body[i], record_written_name, body_writes);
+    }
+    if (calls && function_writes) {
+        hashmap_foreach(function_writes, record_written_name, body_writes);
+    }
+    bool precise = !calls || function_writes;
+    const char* iterator = loop->forStmt.iterator;
+    bool iterator_fixed = precise && !hashmap_contains(body_writes, iterator);
+    
+    long long step_value = 1;
+    if (step) {
+        step_value = (step->type == AST_NUMBER_LITERAL && is_integral_value(step->numberLiteral.value))
+                     ? (long long)step->numberLiteral.value : 0;
+    }
+    
+    // Prove what every execution of the body can assume about the iterator
+    loop->forStmt.inductionFlags = IV_NONE;
+    if (iterator_fixed && step_value > 0 && start && start->type == AST_NUMBER_LITERAL &&
+        start->numberLiteral.value >= 0) {
+        loop->forStmt.inductionFlags |= IV_NON_NEGATIVE;
+    }
+    if (iterator_fixed && end &&
+        ((end->type == AST_NUMBER_LITERAL) ||
+         (end->type == AST_IDENTIFIER && !hashmap_contains(body_writes, end->identifier.name)))) {
+        loop->forStmt.inductionFlags |= IV_BOUNDED;
+    }
+    
+    // The iterator itself varies, so it can never be a multiplier
+    hashmap_put(body_writes, iterator, NULL, NULL);
+    
+    InductionState state = {0};
+    state.loop = loop;
+    state.writes = body_writes;
+    state.integral = integral;
+    state.step = step_value;
+    
+    bool start_integral = start && start->type == AST_NUMBER_LITERAL ?
+                          is_integral_value(start->numberLiteral.value) :
+                          is_invariant_integral(start, &state);
+    
+    if (iterator_fixed && step_value > 0 && start_integral) {
+        bool has_continue = false;
+        for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+            if (contains_loop_continue(loop->forStmt.body[i])) has_continue = true;
+        }
+        
+        if (!has_continue) {
+            for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+                reduce_induction_statement(loop->forStmt.body[i], &state);
+            }
+        }
+    }
+    
+    if (state.derived_count > 0) {
+        // Append `__iv_N = __iv_N + step * k` to the end of the body
+        int newCount = loop->forStmt.bodyCount + state.derived_count;
+        AstNode** body = realloc(loop->forStmt.body, newCount * sizeof(AstNode*));
+        if (!body) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        } else {
+            loop->forStmt.body = body;
+            for (int i = 0; i < state.derived_count; i++) {
+                AstNode* multiplier = state.derived[i].multiplier;
+                AstNode* increment;
+                if (multiplier->type == AST_NUMBER_LITERAL) {
+                    increment = make_number(multiplier->numberLiteral.value * (double)step_value);
+                } else if (step_value == 1) {
+                    increment = cloneAstTree(multiplier);
+                } else {
+                    increment = make_binary('*', cloneAstTree(multiplier), make_number((double)step_value));
+                }
+                
+                AstNode* ref = createAstNode(AST_IDENTIFIER);
+                strncpy(ref->identifier.name, state.derived[i].name, sizeof(ref->identifier.name) - 1);
+                
+                AstNode* update = createAstNode(AST_VAR_ASSIGN);
+                strncpy(update->varAssign.name, state.derived[i].name, sizeof(update->varAssign.name) - 1);
+                update->varAssign.initializer = make_binary('+', ref, increment);
+                inherit_position(update, loop);
+                body[loop->forStmt.bodyCount++] = update;
+            }
+            
+            if (debug_level >= 2) {
+                logger_log(LOG_DEBUG, "Strength-reduced %d derived induction variable(s) of '%s'",
+                          state.derived_count, iterator);
+            }
+            remarks_emit(REMARK_APPLIED, running_pass, loop,
+                         "replaced %d multiplication(s) by '%s' with additions", state.derived_count, iterator);
+        }
+        
+        *temps = state.temps;
+        *temp_count = state.temp_count;
+        state.temps = NULL;
+    }
+    
+    for (int i = 0; i < state.derived_count; i++) {
+        freeAstNode(state.derived[i].multiplier);
+    }
+    free(state.derived);
+    free(state.temps);
+    hashmap_free(body_writes, NULL);
+}
+
+static void induction_variable_node(AstNode* node, HashMap* integral);
+
+/**
+ * @brief Runs induction-variable analysis over a statement list
+ * 
+ * Nested statements are processed first; declarations created for a range
+ * loop are inserted right before it.
+ * 
+ * @param list Location of the statement array
+ * @param count Location of the statement count
+ * @param integral Program-wide integral variables
+ */
+static void induction_statement_list(AstNode*** list, int* count, HashMap* integral) {
+    if (!*list || *count == 0) return;
+    
+    for (int i = 0; i < *count; i++) {
+        AstNode* stmt = (*list)[i];
+        induction_variable_node(stmt, integral);
+        if (!stmt || stmt->type != AST_FOR_STMT || stmt->forStmt.forType != FOR_RANGE) continue;
+        
+        AstNode** temps = NULL;
+        int temp_count = 0;
+        reduce_range_loop(stmt, integral, &temps, &temp_count);
+        if (temp_count == 0) continue;
+        
+        AstNode** grown = realloc(*list, (*count + temp_count) * sizeof(AstNode*));
+        if (!grown) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            free(temps);
+            return;
+        }
+        memmove(grown + i + temp_count, grown + i, (*count - i) * sizeof(AstNode*));
+        memcpy(grown + i, temps, temp_count * sizeof(AstNode*));
+        *list = grown;
+        *count += temp_count;
+        i += temp_count;
+        free(temps);
+    }
+}
+
+/**
+ * @brief Recurses into every statement list below a node
+ * 
+ * @param node AST node to process
+ * @param integral Program-wide integral variables
+ */
+static void induction_variable_node(AstNode* node, HashMap* integral) {
+    if (!node) return;
+    
+    switch (node->type) {
+        case AST_PROGRAM:
+            induction_statement_list(&node->program.statements, &node->program.statementCount, integral);
+            break;
+        case AST_FUNC_DEF:
+            induction_statement_list(&node->funcDef.body, &node->funcDef.bodyCount, integral);
+            break;
+        case AST_BLOCK:
+            induction_statement_list(&node->block.statements, &node->block.statementCount, integral);
+            break;
+        case AST_IF_STMT:
+            induction_statement_list(&node->ifStmt.thenBranch, &node->ifStmt.thenCount, integral);
+            induction_statement_list(&node->ifStmt.elseBranch, &node->ifStmt.elseCount, integral);
+            break;
+        case AST_WHILE_STMT:
+            induction_statement_list(&node->whileStmt.body, &node->whileStmt.bodyCount, integral);
+            break;
+        case AST_DO_WHILE_STMT:
+            induction_statement_list(&node->doWhileStmt.body, &node->doWhileStmt.bodyCount, integral);
+            break;
+        case AST_FOR_STMT:
+            induction_statement_list(&node->forStmt.body, &node->forStmt.bodyCount, integral);
+            break;
+        case AST_TRY_CATCH_STMT:
+            induction_statement_list(&node->tryCatchStmt.tryBody, &node->tryCatchStmt.tryCount, integral);
+            induction_statement_list(&node->tryCatchStmt.catchBody, &node->tryCatchStmt.catchCount, integral);
+            induction_statement_list(&node->tryCatchStmt.finallyBody, &node->tryCatchStmt.finallyCount, integral);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                induction_variable_node(node->switchStmt.cases[i], integral);
+            }
+            induction_statement_list(&node->switchStmt.defaultCase, &node->switchStmt.defaultCaseCount, integral);
+            break;
+        case AST_CASE_STMT:
+            induction_statement_list(&node->caseStmt.body, &node->caseStmt.bodyCount, integral);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                induction_variable_node(node->patternMatch.cases[i], integral);
+            }
+            induction_variable_node(node->patternMatch.otherwise, integral);
+            break;
+        case AST_PATTERN_CASE:
+            induction_statement_list(&node->patternCase.body, &node->patternCase.bodyCount, integral);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Performs induction-variable analysis and strength reduction
+ * 
+ * For every range loop, proves whether the iterator is non-negative and
+ * bounded by an invariant end (see InductionFlag), and replaces products of
+ * the iterator with an invariant integral factor by additive updates. Only
+ * factors that are integral everywhere in the program qualify, so repeated
+ * addition yields exactly the value the multiplication would have.
+ * 
+ * This optimization is enabled at optimization level 2 and above.
+ * 
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* induction_variable_optimization(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)induction_variable_optimization);
+    
+    HashMap* integral = hashmap_create(64);
+    if (!integral) return node;
+    
+    collect_integral_variables(node, integral);
+    induction_variable_node(node, integral);
+    
+    hashmap_free(integral, NULL);
+    return node;
+}
+
+/** Counter used to name the locals of inlined function bodies */
+static int inline_temp_counter = 0;
+
+/** Largest function body (in AST nodes) inlined without an @inline annotation */
+#define INLINE_SIZE_LIMIT 32
+
+/** Size limit for functions the profile shows hot */
+#define INLINE_HOT_SIZE_LIMIT 96
+
+/** Modules resolved for inlining during the current optimize_ast() call */
+static HashMap* inline_modules = NULL;
+
+/** Marker stored in inline_modules for modules that failed to load */
+static int inline_module_missing;
+
+/**
+ * @brief Function definition that calls may be replaced with
+ */
+typedef struct {
+    AstNode* definition;             ///< Function definition (not owned)
+    bool from_module;                ///< Defined in an imported module
+    bool qualified;                  ///< Called as module.name(...), with the module as first argument
+    bool ambiguous;                  ///< Several definitions share the call name
+    int verdict;                     ///< 0 = not checked, 1 = inlinable, -1 = never inline
+    char reason[96];                 ///< Why the callee is never inlined, for remarks
+} InlineCallee;
+
+/**
+ * @brief State shared while measuring or rewriting one function body
+ */
+typedef struct {
+    HashMap* renames;                ///< Callee locals and parameters (-> inlined names when rewriting)
+    int size;                        ///< AST nodes visited
+    int returns;                     ///< Return statements visited
+    bool supported;                  ///< false once an unsupported construct is seen
+    bool free_names;                 ///< true if a name outside @c renames is read
+    int array_accesses;              ///< Array element reads visited
+} InlineWalk;
+
+/**
+ * @brief State of a search for a call chain leading back to a function
+ */
+typedef struct {
+    HashMap* callees;                ///< Call name -> InlineCallee
+    HashMap* visited;                ///< Functions whose bodies were already searched
+    AstNode* target;                 ///< Function being checked
+    bool found;                      ///< true once a call reaches the target
+} RecursionSearch;
+
+/**
+ * @brief State of the inlining pass over the program
+ */
+typedef struct {
+    HashMap* callees;                ///< Call name -> InlineCallee
+    HashMap* outer_writes;           ///< Names assigned outside function bodies
+} InlineSites;
+
+/**
+ * @brief Visits the children of a node an inlined body may contain
+ *
+ * Only straight-line code, structured control flow and simple expressions
+ * are supported. Declarations, exception handling, switches, lambdas and
+ * object expressions would need more than renaming to move into the caller.
+ *
+ * @param node Node whose children to visit
+ * @param visit Callback invoked with each child
+ * @param walk State passed to the callback
+ * @return bool false if the node type cannot be inlined
+ */
+static bool visit_inline_children(AstNode* node, void (*visit)(AstNode*, void*), void* walk) {
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+            return true;
+        case AST_BINARY_OP:
+            visit(node->binaryOp.left, walk);
+            visit(node->binaryOp.right, walk);
+            return true;
+        case AST_UNARY_OP:
+            visit(node->unaryOp.expr, walk);
+            return true;
+        case AST_ARRAY_ACCESS:
+            visit(node->arrayAccess.array, walk);
+            visit(node->arrayAccess.index, walk);
+            return true;
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                visit(node->arrayLiteral.elements[i], walk);
+            }
+            return true;
+        case AST_FUNC_CALL:
+            // Method calls name their receiver in the call name itself
+            if (strchr(node->funcCall.name, '.')) return false;
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                visit(node->funcCall.arguments[i], walk);
+            }
+            return true;
+        case AST_VAR_ASSIGN:
+            if (strchr(node->varAssign.name, '.')) return false;
+            visit(node->varAssign.initializer, walk);
+            return true;
+        case AST_PRINT_STMT:
+            visit(node->printStmt.expr, walk);
+            return true;
+        case AST_RETURN_STMT:
+            visit(node->returnStmt.expr, walk);
+            return true;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                visit(node->block.statements[i], walk);
+            }
+            return true;
+        case AST_IF_STMT:
+            visit(node->ifStmt.condition, walk);
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                visit(node->ifStmt.thenBranch[i], walk);
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                visit(node->ifStmt.elseBranch[i], walk);
+            }
+            return true;
+        case AST_WHILE_STMT:
+            visit(node->whileStmt.condition, walk);
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) {
+                visit(node->whileStmt.body[i], walk);
+            }
+            return true;
+        case AST_DO_WHILE_STMT:
+            visit(node->doWhileStmt.condition, walk);
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                visit(node->doWhileStmt.body[i], walk);
+            }
+            return true;
+        case AST_FOR_STMT:
+            if (node->forStmt.forType != FOR_RANGE) return false;
+            visit(node->forStmt.rangeStart, walk);
+            visit(node->forStmt.rangeEnd, walk);
+            visit(node->forStmt.rangeStep, walk);
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                visit(node->forStmt.body[i], walk);
+            }
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * @brief Measures a callee body node and checks that it can be inlined
+ */
+static void measure_inline_node(AstNode* node, void* userData) {
+    InlineWalk* walk = userData;
+    if (!node || !walk->supported) return;
+
+    walk->size++;
+    if (node->type == AST_RETURN_STMT) walk->returns++;
+    if (node->type == AST_ARRAY_ACCESS) walk->array_accesses++;
+    if (node->type == AST_IDENTIFIER && !hashmap_contains(walk->renames, node->identifier.name)) {
+        walk->free_names = true;
+    }
+    if (!visit_inline_children(node, measure_inline_node, walk)) {
+        walk->supported = false;
+    }
+}
+
+/**
+ * @brief Renames the callee locals and parameters inside a cloned body node
+ */
+static void rename_inline_node(AstNode* node, void* userData) {
+    InlineWalk* walk = userData;
+    if (!node) return;
+
+    const char* renamed = NULL;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            renamed = hashmap_get(walk->renames, node->identifier.name);
+            if (renamed) strncpy(node->identifier.name, renamed, sizeof(node->identifier.name) - 1);
+            break;
+        case AST_VAR_ASSIGN:
+            renamed = hashmap_get(walk->renames, node->varAssign.name);
+            if (renamed) strncpy(node->varAssign.name, renamed, sizeof(node->varAssign.name) - 1);
+            break;
+        case AST_FOR_STMT:
+            renamed = hashmap_get(walk->renames, node->forStmt.iterator);
+            if (renamed) strncpy(node->forStmt.iterator, renamed, sizeof(node->forStmt.iterator) - 1);
+            break;
+        default:
+            break;
+    }
+    visit_inline_children(node, rename_inline_node, walk);
+}
+
+/**
+ * @brief Looks for a call that leads back to the searched function
+ *
+ * Follows calls through the bodies of other known functions, so mutual
+ * recursion is detected as well as direct recursion.
+ */
+static void find_recursive_call(AstNode* node, void* userData) {
+    RecursionSearch* search = userData;
+    if (!node || search->found) return;
+
+    switch (node->type) {
+        case AST_FUNC_DEF:
+        case AST_CLASS_DEF:
+        case AST_LAMBDA:
+            return;
+        case AST_FUNC_CALL: {
+            InlineCallee* callee = hashmap_get(search->callees, node->funcCall.name);
+            if (callee && callee->definition) {
+                AstNode* def = callee->definition;
+                if (def == search->target) {
+                    search->found = true;
+                    return;
+                }
+                if (!hashmap_contains(search->visited, def->funcDef.name)) {
+                    hashmap_put(search->visited, def->funcDef.name, NULL, NULL);
+                    for (int i = 0; i < def->funcDef.bodyCount; i++) {
+                        find_recursive_call(def->funcDef.body[i], search);
+                    }
+                }
+            }
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                find_recursive_call(node->funcCall.arguments[i], search);
+            }
+            return;
+        }
+        default:
+            // Calls hidden in constructs the walk does not follow count as a way back
+            if (!visit_inline_children(node, find_recursive_call, search) && contains_call(node)) {
+                search->found = true;
+            }
+            return;
+    }
+}
+
+/**
+ * @brief Checks whether a function may call itself, directly or indirectly
+ *
+ * @param definition Function definition
+ * @param callees Call name -> InlineCallee map
+ * @return bool true if a call chain from the body reaches the function again
+ */
+static bool is_recursive_function(AstNode* definition, HashMap* callees) {
+    RecursionSearch search = { callees, hashmap_create(16), definition, false };
+    if (!search.visited) return true;
+
+    for (int i = 0; i < definition->funcDef.bodyCount && !search.found; i++) {
+        find_recursive_call(definition->funcDef.body[i], &search);
+    }
+
+    hashmap_free(search.visited, NULL);
+    return search.found;
+}
+
+/**
+ * @brief Decides (once) whether a callee may be inlined
+ *
+ * A callee qualifies when it is not annotated @noinline, is not recursive,
+ * has a body made only of supported constructs with at most one return as
+ * its last statement, and is small enough (or annotated @inline). Module
+ * functions must also be self-contained: they may only read their own
+ * parameters and locals and may not call other functions, since those names
+ * resolve inside the module rather than at the call site.
+ *
+ * @param callee Callee to check
+ * @param callees Call name -> InlineCallee map
+ * @return bool true if calls to the callee may be inlined
+ */
+static bool can_inline_callee(InlineCallee* callee, HashMap* callees) {
+    if (callee->verdict != 0) return callee->verdict > 0;
+    callee->verdict = -1;
+
+    AstNode* def = callee->definition;
+    if (callee->ambiguous || !def) {
+        snprintf(callee->reason, sizeof(callee->reason), "is defined more than once");
+        return false;
+    }
+    if (def->funcDef.attributes & FUNC_ATTR_NOINLINE) {
+        snprintf(callee->reason, sizeof(callee->reason), "is annotated @noinline");
+        return false;
+    }
+
+    InlineWalk walk = {0};
+    walk.supported = true;
+    walk.renames = hashmap_create(16);
+    if (!walk.renames) return false;
+    for (int i = 0; i < def->funcDef.paramCount; i++) {
+        record_written_name(def->funcDef.parameters[i]->identifier.name, NULL, walk.renames);
+    }
+    for (int i = 0; i < def->funcDef.bodyCount; i++) {
+        visit_assigned_names(def->funcDef.body[i], record_written_name, walk.renames);
+    }
+    for (int i = 0; i < def->funcDef.bodyCount; i++) {
+        measure_inline_node(def->funcDef.body[i], &walk);
+    }
+    hashmap_free(walk.renames, NULL);
+
+    bool ok = walk.supported;
+    if (!ok) {
+        snprintf(callee->reason, sizeof(callee->reason), "uses statements that cannot be inlined");
+    }
+    if (ok && walk.returns > 0) {
+        ok = walk.returns == 1 && def->funcDef.body[def->funcDef.bodyCount - 1]->type == AST_RETURN_STMT;
+        if (!ok) snprintf(callee->reason, sizeof(callee->reason), "returns before its last statement");
+    }
+    if (ok && !(def->funcDef.attributes & (FUNC_ATTR_INLINE | FUNC_ATTR_ALWAYS_INLINE))) {
+        // A profile raises the limit for hot functions and keeps cold ones out of line
+        ProfileTemperature temperature = profile_temperature(PROFILE_SITE_FUNCTION, def);
+        int limit = INLINE_SIZE_LIMIT * budget_scale();
+        if (temperature == PROFILE_COLD) {
+            if (walk.size <= limit) profile_note_decision("not inlining cold function", def->funcDef.name);
+            snprintf(callee->reason, sizeof(callee->reason), "is cold in the profile");
+            ok = false;
+        } else {
+            if (temperature == PROFILE_HOT) limit = INLINE_HOT_SIZE_LIMIT * budget_scale();
+            ok = walk.size <= limit;
+            if (ok && temperature == PROFILE_HOT && walk.size > INLINE_SIZE_LIMIT * budget_scale()) {
+                profile_note_decision("inlining hot function", def->funcDef.name);
+            }
+            if (!ok) {
+                snprintf(callee->reason, sizeof(callee->reason), "is too large (%d nodes, limit %d)",
+                         walk.size, limit);
+            }
+        }
+    }
+    if (ok && callee->from_module) {
+        for (int i = 0; i < def->funcDef.bodyCount && ok; i++) {
+            if (contains_call(def->funcDef.body[i])) ok = false;
+        }
+        ok = ok && !walk.free_names;
+        if (!ok) {
+            snprintf(callee->reason, sizeof(callee->reason),
+                     "is a module function that calls functions or reads names of its module");
+        }
+    }
+    if (ok && is_recursive_function(def, callees)) {
+        snprintf(callee->reason, sizeof(callee->reason), "is recursive");
+        ok = false;
+    }
+
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Function '%s' (%d nodes) %s inlined", def->funcDef.name, walk.size,
+                  ok ? "can be" : "will not be");
+    }
+    callee->verdict = ok ? 1 : -1;
+    return ok;
+}
+
+/**
+ * @brief Adds a function definition to the callee map
+ *
+ * @param callees Call name -> InlineCallee map
+ * @param name Name calls use to reach the function
+ * @param definition Function definition
+ * @param from_module true if the function comes from an imported module
+ * @param qualified true if calls pass the module as an extra first argument
+ */
+static void add_inline_callee(HashMap* callees, const char* name, AstNode* definition,
+                              bool from_module, bool qualified) {
+    InlineCallee* existing = hashmap_get(callees, name);
+    if (existing) {
+        existing->ambiguous = true;
+        return;
+    }
+
+    InlineCallee* callee = calloc(1, sizeof(InlineCallee));
+    if (!callee) {
+        error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        return;
+    }
+    callee->definition = definition;
+    callee->from_module = from_module;
+    callee->qualified = qualified;
+    if (!hashmap_put(callees, name, callee, NULL)) {
+        free(callee);
+    }
+}
+
+/**
+ * @brief Loads an imported module for inlining, at most once per optimization
+ *
+ * @param name Module name
+ * @return Module* Loaded module, or NULL if it could not be loaded
+ */
+static Module* load_inline_module(const char* name) {
+    if (!inline_modules) {
+        inline_modules = hashmap_create(8);
+        if (!inline_modules) return NULL;
+    }
+
+    void* cached = hashmap_get(inline_modules, name);
+    if (cached) {
+        return cached == &inline_module_missing ? NULL : (Module*)cached;
+    }
+
+    Module* module = module_load_cached(name, false);
+    hashmap_put(inline_modules, name, module ? (void*)module : (void*)&inline_module_missing, NULL);
+    if (!module) {
+        logger_log(LOG_DEBUG, "Module '%s' unavailable for inlining", name);
+    }
+    return module;
+}
+
+/**
+ * @brief Adds the functions an import statement makes callable
+ *
+ * Selective imports are called by their (possibly aliased) plain name;
+ * whole-module imports are called as module.name(...) or alias.name(...).
+ *
+ * @param callees Call name -> InlineCallee map
+ * @param import Import statement
+ */
+static void add_imported_callees(HashMap* callees, AstNode* import) {
+    Module* module = load_inline_module(import->importStmt.moduleName);
+    if (!module) return;
+
+    if (import->importStmt.hasSymbolList) {
+        for (int i = 0; i < import->importStmt.symbolCount; i++) {
+            const char* symbol = import->importStmt.symbols[i];
+            if (!symbol) continue;
+            ExportedSymbol* exported = module_find_export(module, symbol);
+            if (!exported || !exported->node || exported->node->type != AST_FUNC_DEF) continue;
+
+            const char* alias = import->importStmt.aliases ? import->importStmt.aliases[i] : NULL;
+            add_inline_callee(callees, alias && alias[0] ? alias : symbol, exported->node, true, false);
+        }
+        return;
+    }
+
+    const char* prefix = import->importStmt.hasAlias ? import->importStmt.alias : import->importStmt.moduleName;
+    for (int i = 0; i < module->exportCount; i++) {
+        AstNode* exported = module->exports[i].node;
+        if (!exported || exported->type != AST_FUNC_DEF) continue;
+
+        char qualified[512];
+        snprintf(qualified, sizeof(qualified), "%s.%s", prefix, module->exports[i].name);
+        add_inline_callee(callees, qualified, exported, true, true);
+    }
+}
+
+/**
+ * @brief Builds the map of functions call sites may be inlined from
+ *
+ * @param program Program node
+ * @return HashMap* Call name -> InlineCallee map (values owned by the map's user)
+ */
+static HashMap* collect_inline_callees(AstNode* program) {
+    HashMap* callees = hashmap_create(32);
+    if (!callees) return NULL;
+
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode* stmt = program->program.statements[i];
+        if (stmt->type == AST_FUNC_DEF) {
+            add_inline_callee(callees, stmt->funcDef.name, stmt, false, false);
+        } else if (stmt->type == AST_IMPORT) {
+            add_imported_callees(callees, stmt);
+        }
+    }
+    return callees;
+}
+
+/**
+ * @brief Appends a statement to a growable statement array
+ */
+static void append_inline_statement(AstNode*** list, int* count, int* capacity, AstNode* stmt) {
+    if (*count >= *capacity) {
+        int newCapacity = *capacity ? *capacity * 2 : 8;
+        AstNode** grown = realloc(*list, newCapacity * sizeof(AstNode*));
+        if (!grown) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            freeAstNode(stmt);
+            return;
+        }
+        *list = grown;
+        *capacity = newCapacity;
+    }
+    (*list)[(*count)++] = stmt;
+}
+
+/**
+ * @brief hashmap_foreach callback that renames one callee local
+ */
+static void add_inline_rename(const char* key, void* value, void* userData) {
+    (void)value;
+    InlineWalk* walk = userData;
+    if (hashmap_contains(walk->renames, key)) return;
+
+    char renamed[256];
+    snprintf(renamed, sizeof(renamed), "__inl_%d_%s", inline_temp_counter, key);
+    char* copy = strdup(renamed);
+    if (copy && !hashmap_put(walk->renames, key, copy, NULL)) free(copy);
+}
+
+/**
+ * @brief Tells whether a declared type converts the values stored in it
+ *
+ * An int argument bound to a float parameter, or a float returned from an
+ * int function, changes value; inlined code has to keep that conversion.
+ */
+static bool is_converting_type(const char* name) {
+    return strcmp(name, "int") == 0 || strcmp(name, "float") == 0 || strcmp(name, "bool") == 0;
+}
+
+/**
+ * @brief Replaces a statement-level call with the callee's body
+ *
+ * Handles `f(args)` used as a statement and `x = f(args)`. Each argument is
+ * first stored in a renamed parameter, preserving evaluation order and
+ * single evaluation; the renamed body follows, and the returned expression
+ * becomes the assignment's new initializer.
+ *
+ * Function bodies are nested C functions that share the enclosing locals,
+ * so only parameters and names the program never assigns outside functions
+ * are treated as callee locals and renamed.
+ *
+ * @param stmt Statement to inline into
+ * @param callees Call name -> InlineCallee map
+ * @param outer_writes Names assigned outside function bodies
+ * @param out Output statement array (statements are appended)
+ * @param out_count Output statement count
+ * @param out_capacity Output array capacity
+ * @return bool true if the call was inlined (and @p stmt consumed)
+ */
+static bool inline_call_site(AstNode* stmt, HashMap* callees, HashMap* outer_writes,
+                             AstNode*** out, int* out_count, int* out_capacity) {
+    AstNode* call = NULL;
+    if (stmt->type == AST_FUNC_CALL) {
+        call = stmt;
+    } else if (stmt->type == AST_VAR_ASSIGN && stmt->varAssign.initializer &&
+               stmt->varAssign.initializer->type == AST_FUNC_CALL) {
+        call = stmt->varAssign.initializer;
+    }
+    if (!call) return false;
+
+    InlineCallee* callee = hashmap_get(callees, call->funcCall.name);
+    if (!callee) return false;
+    if (!can_inline_callee(callee, callees)) {
+        if (callee->reason[0]) {
+            remarks_emit(REMARK_MISSED, running_pass, stmt, "not inlined: '%s' %s",
+                         call->funcCall.name, callee->reason);
+        }
+        return false;
+    }
+
+    AstNode* def = callee->definition;
+    int firstArg = callee->qualified ? 1 : 0;
+    if (call->funcCall.argCount - firstArg != def->funcDef.paramCount) {
+        remarks_emit(REMARK_MISSED, running_pass, stmt, "not inlined: '%s' called with %d argument(s), expects %d",
+                     call->funcCall.name, call->funcCall.argCount - firstArg, def->funcDef.paramCount);
+        return false;
+    }
+
+    int line = stmt->line;
+    AstNode* result = NULL;
+    int bodyCount = def->funcDef.bodyCount;
+    if (bodyCount > 0 && def->funcDef.body[bodyCount - 1]->type == AST_RETURN_STMT) {
+        result = def->funcDef.body[bodyCount - 1]->returnStmt.expr;
+        bodyCount--;
+    }
+    if (call != stmt && !result) return false;
+    // A discarded result only needs to be kept when it may have side effects
+    if (call == stmt && result && contains_call(result) && result->type != AST_FUNC_CALL) return false;
+
+    InlineWalk walk = {0};
+    walk.renames = hashmap_create(16);
+    if (!walk.renames) return false;
+    inline_temp_counter++;
+
+    for (int i = 0; i < def->funcDef.paramCount; i++) {
+        add_inline_rename(def->funcDef.parameters[i]->identifier.name, NULL, &walk);
+    }
+    HashMap* locals = hashmap_create(16);
+    if (locals) {
+        for (int i = 0; i < bodyCount; i++) {
+            visit_assigned_names(def->funcDef.body[i], record_written_name, locals);
+        }
+        if (!callee->from_module) {
+            // Program functions write the shared locals of main unless the name is theirs
+            // alone; the name set holds no values, so dropping a "fact" just removes the name
+            hashmap_foreach(outer_writes, kill_fact_by_key, locals);
+        }
+        hashmap_foreach(locals, add_inline_rename, &walk);
+        hashmap_free(locals, NULL);
+    }
+
+    // Bind the arguments to the renamed parameters; a declared numeric type is
+    // kept, so the argument is converted as it would be by the call
+    for (int i = 0; i < def->funcDef.paramCount; i++) {
+        AstNode* param = def->funcDef.parameters[i];
+        const char* name = hashmap_get(walk.renames, param->identifier.name);
+        AstNode* argument = cloneAstTree(call->funcCall.arguments[firstArg + i]);
+        AstNode* bind;
+        if (param->inferredType && is_converting_type(param->inferredType->typeName)) {
+            bind = createAstNode(AST_VAR_DECL);
+            strncpy(bind->varDecl.name, name, sizeof(bind->varDecl.name) - 1);
+            strncpy(bind->varDecl.type, param->inferredType->typeName, sizeof(bind->varDecl.type) - 1);
+            bind->varDecl.initializer = argument;
+        } else {
+            bind = createAstNode(AST_VAR_ASSIGN);
+            strncpy(bind->varAssign.name, name, sizeof(bind->varAssign.name) - 1);
+            bind->varAssign.initializer = argument;
+        }
+        bind->line = line;
+        append_inline_statement(out, out_count, out_capacity, bind);
+    }
+
+    for (int i = 0; i < bodyCount; i++) {
+        AstNode* copy = cloneAstTree(def->funcDef.body[i]);
+        rename_inline_node(copy, &walk);
+        append_inline_statement(out, out_count, out_capacity, copy);
+    }
+
+    remarks_emit(REMARK_APPLIED, running_pass, stmt, "inlined call to '%s'", call->funcCall.name);
+    if (call != stmt) {
+        AstNode* value = cloneAstTree(result);
+        rename_inline_node(value, &walk);
+        if (is_converting_type(def->funcDef.returnType)) {
+            // The value is converted to the declared return type, as `return` would
+            AstNode* ret = createAstNode(AST_VAR_DECL);
+            snprintf(ret->varDecl.name, sizeof(ret->varDecl.name), "__inl_ret_%d", inline_temp_counter);
+            strncpy(ret->varDecl.type, def->funcDef.returnType, sizeof(ret->varDecl.type) - 1);
+            ret->varDecl.initializer = value;
+            ret->line = line;
+            append_inline_statement(out, out_count, out_capacity, ret);
+            value = createAstNode(AST_IDENTIFIER);
+            strncpy(value->identifier.name, ret->varDecl.name, sizeof(value->identifier.name) - 1);
+            value->line = line;
+        }
+        freeAstNode(call);
+        stmt->varAssign.initializer = value;
+        append_inline_statement(out, out_count, out_capacity, stmt);
+    } else {
+        if (result && result->type == AST_FUNC_CALL) {
+            AstNode* value = cloneAstTree(result);
+            rename_inline_node(value, &walk);
+            append_inline_statement(out, out_count, out_capacity, value);
+        }
+        freeAstNode(stmt);
+    }
+
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Inlined call to '%s' at line %d", def->funcDef.name, line);
+    }
+    hashmap_free(walk.renames, free);
+    stats.functions_inlined++;
+    stats.total_optimizations++;
+    return true;
+}
+
+static void function_inlining_node(AstNode* node, InlineSites* sites);
+
+/**
+ * @brief Inlines the eligible calls of a statement list
+ *
+ * Nested statement lists are processed first; statements produced by
+ * inlining are revisited by the next pass-manager iteration.
+ *
+ * @param list Location of the statement array
+ * @param count Location of the statement count
+ * @param sites Pass state
+ */
+static void inline_statement_list(AstNode*** list, int* count, InlineSites* sites) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)inline_statement_list);
+
+    if (!*list || *count == 0) return;
+
+    AstNode** newList = NULL;
+    int newCount = 0;
+    int capacity = 0;
+    bool changed = false;
+
+    for (int i = 0; i < *count; i++) {
+        AstNode* stmt = (*list)[i];
+        function_inlining_node(stmt, sites);
+
+        if (stmt && inline_call_site(stmt, sites->callees, sites->outer_writes, &newList, &newCount, &capacity)) {
+            changed = true;
+        } else {
+            append_inline_statement(&newList, &newCount, &capacity, stmt);
+        }
+    }
+
+    if (changed) {
+        free(*list);
+        *list = newList;
+        *count = newCount;
+    } else {
+        free(newList);
+    }
+}
+
+/**
+ * @brief Recurses into every statement list below a node, outside function bodies
+ *
+ * @param node AST node to process
+ * @param sites Pass state
+ */
+static void function_inlining_node(AstNode* node, InlineSites* sites) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_PROGRAM:
+            inline_statement_list(&node->program.statements, &node->program.statementCount, sites);
+            break;
+        case AST_BLOCK:
+            inline_statement_list(&node->block.statements, &node->block.statementCount, sites);
+            break;
+        case AST_IF_STMT:
+            inline_statement_list(&node->ifStmt.thenBranch, &node->ifStmt.thenCount, sites);
+            inline_statement_list(&node->ifStmt.elseBranch, &node->ifStmt.elseCount, sites);
+            break;
+        case AST_WHILE_STMT:
+            inline_statement_list(&node->whileStmt.body, &node->whileStmt.bodyCount, sites);
+            break;
+        case AST_DO_WHILE_STMT:
+            inline_statement_list(&node->doWhileStmt.body, &node->doWhileStmt.bodyCount, sites);
+            break;
+        case AST_FOR_STMT:
+            inline_statement_list(&node->forStmt.body, &node->forStmt.bodyCount, sites);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                function_inlining_node(node->switchStmt.cases[i], sites);
+            }
+            inline_statement_list(&node->switchStmt.defaultCase, &node->switchStmt.defaultCaseCount, sites);
+            break;
+        case AST_CASE_STMT:
+            inline_statement_list(&node->caseStmt.body, &node->caseStmt.bodyCount, sites);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                function_inlining_node(node->patternMatch.cases[i], sites);
+            }
+            function_inlining_node(node->patternMatch.otherwise, sites);
+            break;
+        case AST_PATTERN_CASE:
+            inline_statement_list(&node->patternCase.body, &node->patternCase.bodyCount, sites);
+            break;
+        case AST_TRY_CATCH_STMT:
+            inline_statement_list(&node->tryCatchStmt.tryBody, &node->tryCatchStmt.tryCount, sites);
+            inline_statement_list(&node->tryCatchStmt.catchBody, &node->tryCatchStmt.catchCount, sites);
+            inline_statement_list(&node->tryCatchStmt.finallyBody, &node->tryCatchStmt.finallyCount, sites);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Inlines calls to small, non-recursive functions
+ *
+ * Call sites in the program body (including nested control flow, but not
+ * other function bodies, whose parameters could shadow the callee's shared
+ * names) are replaced with a renamed copy of the callee's body. Callees are
+ * the functions defined in the program and the functions exported by
+ * imported modules. `@noinline` functions are never inlined, and `@inline`
+ * lifts the INLINE_SIZE_LIMIT size heuristic. The definitions themselves
+ * are kept for any remaining callers.
+ *
+ * This optimization is enabled at optimization level 2 and above; level 3
+ * doubles the size limits.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* function_inlining(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)function_inlining);
+
+    if (!node || node->type != AST_PROGRAM) return node;
+
+    InlineSites sites = {0};
+    sites.callees = collect_inline_callees(node);
+    sites.outer_writes = hashmap_create(64);
+    if (sites.callees && sites.outer_writes && hashmap_count(sites.callees) > 0) {
+        for (int i = 0; i < node->program.statementCount; i++) {
+            visit_assigned_names(node->program.statements[i], record_written_name, sites.outer_writes);
+        }
+        function_inlining_node(node, &sites);
+    }
+
+    hashmap_free(sites.callees, free);
+    hashmap_free(sites.outer_writes, NULL);
+    return node;
+}
+
+/** Counter used to name the argument temporaries of eliminated tail calls */
+static int tce_temp_counter = 0;
+
+/**
+ * @brief Returns the self call made by a statement, if it is one
+ *
+ * @param stmt Statement to inspect
+ * @param def Enclosing function definition
+ * @param tail true if nothing runs after @p stmt in the function
+ * @return AstNode* The call, or NULL if @p stmt is not a self tail call
+ */
+static AstNode* get_self_tail_call(AstNode* stmt, AstNode* def, bool tail) {
+    AstNode* call = NULL;
+    if (stmt->type == AST_RETURN_STMT) {
+        call = stmt->returnStmt.expr;
+    } else if (stmt->type == AST_FUNC_CALL && tail) {
+        call = stmt;
+    }
+    if (!call || call->type != AST_FUNC_CALL) return NULL;
+    if (strcmp(call->funcCall.name, def->funcDef.name) != 0) return NULL;
+    if (call->funcCall.argCount != def->funcDef.paramCount) return NULL;
+    return call;
+}
+
+/**
+ * @brief Appends the parameter rebinding that replaces a self tail call
+ *
+ * Each parameter receives its argument. An argument that is the parameter
+ * itself needs no assignment. When an argument reads a parameter assigned
+ * before it, every argument is first evaluated into a `__tce_N` temporary,
+ * as the call would have done.
+ *
+ * @param call Self tail call
+ * @param def Enclosing function definition
+ * @param out Output statement array
+ * @param out_count Output statement count
+ * @param out_capacity Output array capacity
+ */
+static void append_tail_call_rebinding(AstNode* call, AstNode* def,
+                                       AstNode*** out, int* out_count, int* out_capacity) {
+    int count = def->funcDef.paramCount;
+    bool* changed = calloc(count > 0 ? count : 1, sizeof(bool));
+    if (!changed) {
+        error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        return;
+    }
+
+    bool needs_temps = false;
+    for (int i = 0; i < count; i++) {
+        AstNode* arg = call->funcCall.arguments[i];
+        const char* param = def->funcDef.parameters[i]->identifier.name;
+        changed[i] = !(arg->type == AST_IDENTIFIER && strcmp(arg->identifier.name, param) == 0);
+        for (int j = 0; j < i && changed[i] && !needs_temps; j++) {
+            if (changed[j] && expression_uses_variable(arg, def->funcDef.parameters[j]->identifier.name)) {
+                needs_temps = true;
+            }
+        }
+    }
+
+    int first_temp = tce_temp_counter;
+    for (int i = 0; i < count && needs_temps; i++) {
+        if (!changed[i]) continue;
+        AstNode* temp = createAstNode(AST_VAR_DECL);
+        temp->line = call->line;
+        snprintf(temp->varDecl.name, sizeof(temp->varDecl.name), "__tce_%d", tce_temp_counter++);
+        strncpy(temp->varDecl.type, "__auto_type", sizeof(temp->varDecl.type) - 1);
+        temp->varDecl.initializer = cloneAstTree(call->funcCall.arguments[i]);
+        append_inline_statement(out, out_count, out_capacity, temp);
+    }
+
+    int temp_index = first_temp;
+    for (int i = 0; i < count; i++) {
+        if (!changed[i]) continue;
+        AstNode* assign = createAstNode(AST_VAR_ASSIGN);
+        assign->line = call->line;
+        strncpy(assign->varAssign.name, def->funcDef.parameters[i]->identifier.name,
+                sizeof(assign->varAssign.name) - 1);
+        if (needs_temps) {
+            AstNode* ref = createAstNode(AST_IDENTIFIER);
+            ref->line = call->line;
+            snprintf(ref->identifier.name, sizeof(ref->identifier.name), "__tce_%d", temp_index++);
+            assign->varAssign.initializer = ref;
+        } else {
+            assign->varAssign.initializer = cloneAstTree(call->funcCall.arguments[i]);
+        }
+        append_inline_statement(out, out_count, out_capacity, assign);
+    }
+
+    free(changed);
+}
+
+/**
+ * @brief Checks whether a statement list contains a self tail call
+ *
+ * Only calls outside loops, switches and try blocks are considered: the
+ * rewritten call jumps back with `continue`, which must reach the loop
+ * wrapped around the function body.
+ *
+ * @param list Statement array
+ * @param count Number of statements
+ * @param def Enclosing function definition
+ * @param tail true if nothing runs after the list in the function
+ * @return bool true if a self tail call was found
+ */
+static bool has_self_tail_call(AstNode** list, int count, AstNode* def, bool tail) {
+    for (int i = 0; i < count; i++) {
+        AstNode* stmt = list[i];
+        if (!stmt) continue;
+        bool stmt_tail = tail && i == count - 1;
+        if (get_self_tail_call(stmt, def, stmt_tail)) return true;
+        if (stmt->type == AST_IF_STMT &&
+            (has_self_tail_call(stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount, def, stmt_tail) ||
+             has_self_tail_call(stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount, def, stmt_tail))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Replaces the self tail calls of a statement list with jumps
+ *
+ * @param list Pointer to the statement array
+ * @param count Pointer to the number of statements
+ * @param def Enclosing function definition
+ * @param tail true if nothing runs after the list in the function
+ */
+static void eliminate_tail_calls_in_list(AstNode*** list, int* count, AstNode* def, bool tail) {
+    if (!has_self_tail_call(*list, *count, def, tail)) return;
+
+    int capacity = *count + 8;
+    int newCount = 0;
+    AstNode** newList = malloc(capacity * sizeof(AstNode*));
+    if (!newList) {
+        error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        return;
+    }
+
+    for (int i = 0; i < *count; i++) {
+        AstNode* stmt = (*list)[i];
+        bool stmt_tail = tail && i == *count - 1;
+        AstNode* call = stmt ? get_self_tail_call(stmt, def, stmt_tail) : NULL;
+
+        if (call) {
+            append_tail_call_rebinding(call, def, &newList, &newCount, &capacity);
+            AstNode* jump = createAstNode(AST_CONTINUE_STMT);
+            jump->line = stmt->line;
+            append_inline_statement(&newList, &newCount, &capacity, jump);
+            freeAstNode(stmt);
+
+            stats.tail_calls_eliminated++;
+            stats.total_optimizations++;
+            if (debug_level >= 2) {
+                logger_log(LOG_DEBUG, "Tail call to '%s' at line %d turned into a jump",
+                          def->funcDef.name, jump->line);
+            }
+            remarks_emit(REMARK_APPLIED, running_pass, jump, "turned tail call to '%s' into a jump", def->funcDef.name);
+            continue;
+        }
+
+        if (stmt && stmt->type == AST_IF_STMT) {
+            eliminate_tail_calls_in_list(&stmt->ifStmt.thenBranch, &stmt->ifStmt.thenCount, def, stmt_tail);
+            eliminate_tail_calls_in_list(&stmt->ifStmt.elseBranch, &stmt->ifStmt.elseCount, def, stmt_tail);
+        }
+        append_inline_statement(&newList, &newCount, &capacity, stmt);
+    }
+
+    free(*list);
+    *list = newList;
+    *count = newCount;
+}
+
+/**
+ * @brief Turns the self tail calls of one function into a loop
+ *
+ * The body is wrapped in `while (true)`; each tail call reassigns the
+ * parameters and continues, and falling off the end of the body breaks out
+ * of the loop.
+ *
+ * @param def Function definition
+ */
+static void eliminate_tail_calls(AstNode* def) {
+    if (!has_self_tail_call(def->funcDef.body, def->funcDef.bodyCount, def, true)) return;
+
+    AstNode** body = def->funcDef.body;
+    int bodyCount = def->funcDef.bodyCount;
+    eliminate_tail_calls_in_list(&body, &bodyCount, def, true);
+
+    // Falling off the end of the body leaves the loop
+    AstNodeType last = bodyCount > 0 ? body[bodyCount - 1]->type : AST_PROGRAM;
+    if (last != AST_RETURN_STMT && last != AST_CONTINUE_STMT) {
+        AstNode** grown = realloc(body, (bodyCount + 1) * sizeof(AstNode*));
+        if (!grown) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            def->funcDef.body = body;
+            def->funcDef.bodyCount = bodyCount;
+            return;
+        }
+        body = grown;
+        body[bodyCount] = createAstNode(AST_BREAK_STMT);
+        body[bodyCount]->line = def->line;
+        bodyCount++;
+    }
+
+    AstNode* loop = createAstNode(AST_WHILE_STMT);
+    AstNode* always = createAstNode(AST_BOOLEAN_LITERAL);
+    AstNode** wrapped = malloc(sizeof(AstNode*));
+    if (!loop || !always || !wrapped) {
+        error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        freeAstNode(loop);
+        freeAstNode(always);
+        free(wrapped);
+        def->funcDef.body = body;
+        def->funcDef.bodyCount = bodyCount;
+        return;
+    }
+    always->boolLiteral.value = true;
+    always->line = def->line;
+    loop->line = def->line;
+    loop->whileStmt.condition = always;
+    loop->whileStmt.body = body;
+    loop->whileStmt.bodyCount = bodyCount;
+    wrapped[0] = loop;
+
+    def->funcDef.body = wrapped;
+    def->funcDef.bodyCount = 1;
+}
+
+/**
+ * @brief Finds the function definitions below a node, nested ones included
+ *
+ * @param node AST node to process
+ */
+static void tail_call_elimination_node(AstNode* node) {
+    if (!node) return;
+
+    AstNode** list = NULL;
+    int count = 0;
+    switch (node->type) {
+        case AST_PROGRAM:
+            list = node->program.statements;
+            count = node->program.statementCount;
+            break;
+        case AST_FUNC_DEF:
+            eliminate_tail_calls(node);
+            list = node->funcDef.body;
+            count = node->funcDef.bodyCount;
+            break;
+        case AST_BLOCK:
+            list = node->block.statements;
+            count = node->block.statementCount;
+            break;
+        case AST_WHILE_STMT:
+            list = node->whileStmt.body;
+            count = node->whileStmt.bodyCount;
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                tail_call_elimination_node(node->ifStmt.thenBranch[i]);
+            }
+            list = node->ifStmt.elseBranch;
+            count = node->ifStmt.elseCount;
+            break;
+        default:
+            return;
+    }
+
+    for (int i = 0; i < count; i++) {
+        tail_call_elimination_node(list[i]);
+    }
+}
+
+/**
+ * @brief Rewrites self-recursive tail calls into loops
+ *
+ * A `return f(...)` inside `f`, or a bare call to `f` that is the last
+ * thing `f` does, reassigns the parameters and jumps back to the top of the
+ * body instead of calling. Deep tail recursion then runs in constant stack
+ * space whatever flags the generated C is compiled with. Calls inside loops,
+ * switches and try blocks are left alone.
+ *
+ * This optimization is enabled at optimization level 1 and above.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* tail_call_elimination(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)tail_call_elimination);
+    tail_call_elimination_node(node);
+    return node;
+}
+
+/** Counter used to name the iterators of fully unrolled loops */
+static int unroll_temp_counter = 0;
+
+/** Largest trip count that is fully unrolled */
+#define UNROLL_FULL_MAX_TRIPS 16
+
+/** Largest unrolled size (trip count times body nodes) for full unrolling */
+#define UNROLL_FULL_MAX_NODES 128
+
+/** Largest unrolled loop body (factor times body nodes) for partial unrolling */
+#define UNROLL_PARTIAL_MAX_NODES 96
+
+/** Factor applied to the size limits for loops the profile shows hot */
+#define UNROLL_HOT_SIZE_SCALE 2
+
+/**
+ * @brief Checks that copies of a loop body can be emitted one after another
+ *
+ * The compiler declares a variable where it first sees it assigned and
+ * tracks declarations in a single flat table. A copy that assigns a name
+ * for the first time would therefore declare it in a scope the later
+ * copies (or a remainder loop) cannot see. Only names assigned before the
+ * loop are allowed, except that full unrolling may introduce names at the
+ * top level of the body, which then land in the enclosing scope.
+ * Declarations and nested definitions are never copied.
+ *
+ * @param node Body statement
+ * @param seen Names assigned before the loop
+ * @param allow_new true if a first assignment is allowed at this level
+ * @return bool true if the statement can be duplicated
+ */
+static bool can_duplicate_statement(AstNode* node, HashMap* seen, bool allow_new) {
+    if (!node) return true;
+
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            return allow_new || hashmap_contains(seen, node->varAssign.name);
+        case AST_VAR_DECL:
+        case AST_FUNC_DEF:
+        case AST_CLASS_DEF:
+        case AST_CONTINUE_STMT:
+        case AST_BREAK_STMT:
+        case AST_RETURN_STMT:
+            return false;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                if (!can_duplicate_statement(node->block.statements[i], seen, allow_new)) return false;
+            }
+            return true;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                if (!can_duplicate_statement(node->ifStmt.thenBranch[i], seen, false)) return false;
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                if (!can_duplicate_statement(node->ifStmt.elseBranch[i], seen, false)) return false;
+            }
+            return true;
+        case AST_WHILE_STMT:
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) {
+                if (!can_duplicate_statement(node->whileStmt.body[i], seen, false)) return false;
+            }
+            return true;
+        case AST_DO_WHILE_STMT:
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                if (!can_duplicate_statement(node->doWhileStmt.body[i], seen, false)) return false;
+            }
+            return true;
+        case AST_FOR_STMT:
+            // The iterator of a nested range loop is declared by the loop itself
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                if (!can_duplicate_statement(node->forStmt.body[i], seen, false)) return false;
+            }
+            return true;
+        default:
+            return true;
+    }
+}
+
+/**
+ * @brief Reads a constant integral range bound
+ *
+ * @param node Bound expression (NULL for an omitted step)
+ * @param fallback Value of an omitted bound
+ * @param value Output for the bound
+ * @return bool true if the bound is an integral literal
+ */
+static bool get_constant_bound(AstNode* node, long long fallback, long long* value) {
+    if (!node) {
+        *value = fallback;
+        return true;
+    }
+    if (node->type != AST_NUMBER_LITERAL || !is_integral_value(node->numberLiteral.value) ||
+        node->numberLiteral.value > 2147483647.0 || node->numberLiteral.value < -2147483648.0) {
+        return false;
+    }
+    *value = (long long)node->numberLiteral.value;
+    return true;
+}
+
+/**
+ * @brief Creates `name = value` with an integral literal
+ */
+static AstNode* make_int_assignment(const char* name, long long value, int line) {
+    AstNode* assign = createAstNode(AST_VAR_ASSIGN);
+    if (!assign) return NULL;
+    strncpy(assign->varAssign.name, name, sizeof(assign->varAssign.name) - 1);
+    assign->varAssign.initializer = make_number((double)value);
+    assign->line = line;
+    return assign;
+}
+
+/**
+ * @brief Search for the iterator of a loop being unrolled
+ */
+typedef struct {
+    const char* name;                ///< Iterator name
+    bool found;                      ///< true once a read of the iterator is seen
+} IteratorUses;
+
+/**
+ * @brief Records whether a body copy still reads the iterator
+ */
+static void find_iterator_use(AstNode* node, void* userData) {
+    IteratorUses* uses = userData;
+    if (!node || uses->found) return;
+
+    if (node->type == AST_IDENTIFIER && strcmp(node->identifier.name, uses->name) == 0) {
+        uses->found = true;
+        return;
+    }
+    visit_inline_children(node, find_iterator_use, uses);
+}
+
+/**
+ * @brief State of the substitution of one iteration value into a body copy
+ */
+typedef struct {
+    HashMap* facts;                  ///< Fact map holding the iterator's value
+    HashMap* declared;               ///< Names the compiler has declared before this point (updated)
+} IteratorSubstitution;
+
+/**
+ * @brief Substitutes the iteration value for the iterator in a body copy
+ *
+ * Uses the rules of constant propagation for conditions, which only replace
+ * the iterator below operators whose meaning does not depend on the operand
+ * being a variable, and folds the result. A first assignment is substituted
+ * but not folded, since the compiler picks the declared C type from the
+ * shape of the initializer. Print operands and call arguments are left alone.
+ *
+ * @param node Body statement copy
+ * @param sub Substitution state
+ */
+static void substitute_iterator(AstNode* node, IteratorSubstitution* sub) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            propagate_into_condition(&node->varAssign.initializer, sub->facts);
+            if (hashmap_contains(sub->declared, node->varAssign.name)) {
+                node->varAssign.initializer = constant_folding(node->varAssign.initializer);
+            } else {
+                hashmap_put(sub->declared, node->varAssign.name, NULL, NULL);
+            }
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) {
+                substitute_iterator(node->block.statements[i], sub);
+            }
+            break;
+        case AST_IF_STMT:
+            propagate_into_condition(&node->ifStmt.condition, sub->facts);
+            node->ifStmt.condition = constant_folding(node->ifStmt.condition);
+            for (int i = 0; i < node->ifStmt.thenCount; i++) {
+                substitute_iterator(node->ifStmt.thenBranch[i], sub);
+            }
+            for (int i = 0; i < node->ifStmt.elseCount; i++) {
+                substitute_iterator(node->ifStmt.elseBranch[i], sub);
+            }
+            break;
+        case AST_WHILE_STMT:
+            propagate_into_condition(&node->whileStmt.condition, sub->facts);
+            node->whileStmt.condition = constant_folding(node->whileStmt.condition);
+            for (int i = 0; i < node->whileStmt.bodyCount; i++) {
+                substitute_iterator(node->whileStmt.body[i], sub);
+            }
+            break;
+        case AST_DO_WHILE_STMT:
+            propagate_into_condition(&node->doWhileStmt.condition, sub->facts);
+            node->doWhileStmt.condition = constant_folding(node->doWhileStmt.condition);
+            for (int i = 0; i < node->doWhileStmt.bodyCount; i++) {
+                substitute_iterator(node->doWhileStmt.body[i], sub);
+            }
+            break;
+        case AST_FOR_STMT:
+            propagate_into_condition(&node->forStmt.rangeStart, sub->facts);
+            propagate_into_condition(&node->forStmt.rangeEnd, sub->facts);
+            propagate_into_condition(&node->forStmt.rangeStep, sub->facts);
+            node->forStmt.rangeStart = constant_folding(node->forStmt.rangeStart);
+            node->forStmt.rangeEnd = constant_folding(node->forStmt.rangeEnd);
+            node->forStmt.rangeStep = constant_folding(node->forStmt.rangeStep);
+            for (int i = 0; i < node->forStmt.bodyCount; i++) {
+                substitute_iterator(node->forStmt.body[i], sub);
+            }
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief State of an unrolling pass over the program
+ */
+typedef struct {
+    HashMap* seen;                   ///< Names assigned so far, in program order
+    bool partial;                    ///< true for partial unrolling, false for full unrolling
+} UnrollState;
+
+/**
+ * @brief Unrolls a constant-trip range loop
+ *
+ * Tiny loops are replaced by one copy of the body per iteration, with the
+ * iteration's value substituted for the iterator so constant folding can
+ * specialize every copy. Uses that cannot take a literal (print operands,
+ * call arguments) read a fresh variable standing in for the iterator
+ * (`__unr_N`), assigned before each copy. Larger loops are unrolled by the
+ * configured factor: the body is repeated with the iterator advanced
+ * between copies, over the largest multiple of the factor, and a remainder
+ * loop runs the leftover iterations (and is itself fully unrolled when
+ * small enough).
+ *
+ * @param loop Range loop
+ * @param seen Names assigned before the loop
+ * @param partial true to unroll by the factor, false to unroll completely
+ * @param out Output statement array (replacement statements are appended)
+ * @param out_count Output statement count
+ * @param out_capacity Output array capacity
+ * @return bool true if the loop was unrolled (and consumed or reused)
+ */
+static bool unroll_range_loop(AstNode* loop, HashMap* seen, bool partial, AstNode*** out, int* out_count, int* out_capacity) {
+    // Only the partial run reports loops it leaves alone: the full run comes first and may be followed by it
+    const char* pass = partial ? running_pass : NULL;
+    long long start, end, step;
+    if (!loop->forStmt.rangeStart || !loop->forStmt.rangeEnd) return false;
+    if (!get_constant_bound(loop->forStmt.rangeStart, 0, &start) ||
+        !get_constant_bound(loop->forStmt.rangeEnd, 0, &end) ||
+        !get_constant_bound(loop->forStmt.rangeStep, 1, &step) || step <= 0) {
+        if (pass) remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: trip count not known at compile time");
+        return false;
+    }
+
+    long long trips = end > start ? (end - start + step - 1) / step : 0;
+    const char* iterator = loop->forStmt.iterator;
+
+    // The body must be copyable and must leave the iterator alone
+    InlineWalk walk = {0};
+    walk.supported = true;
+    walk.renames = hashmap_create(16);
+    HashMap* body_writes = hashmap_create(16);
+    if (!walk.renames || !body_writes) {
+        hashmap_free(walk.renames, NULL);
+        hashmap_free(body_writes, NULL);
+        return false;
+    }
+    for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+        measure_inline_node(loop->forStmt.body[i], &walk);
+        visit_assigned_names(loop->forStmt.body[i], record_written_name, body_writes);
+    }
+    bool iterator_written = hashmap_contains(body_writes, iterator);
+    hashmap_free(body_writes, NULL);
+    if (!walk.supported || iterator_written || walk.returns > 0) {
+        if (pass) {
+            remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: %s",
+                         iterator_written ? "body writes the iterator"
+                         : walk.returns > 0 ? "body returns from the function"
+                                            : "body uses statements that cannot be copied");
+        }
+        hashmap_free(walk.renames, NULL);
+        return false;
+    }
+
+    int body_size = walk.size > 0 ? walk.size : 1;
+    int factor = options.unroll_factor > 0 ? options.unroll_factor : OPTIMIZER_DEFAULT_UNROLL_FACTOR;
+
+    // A profile keeps loops that never ran compact and gives hot ones more room
+    ProfileTemperature temperature = profile_temperature(PROFILE_SITE_LOOP_BODY, loop);
+    if (temperature == PROFILE_COLD && trips > 0) {
+        profile_note_decision("not unrolling cold loop over", iterator);
+        if (pass) remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: cold in the profile");
+        hashmap_free(walk.renames, NULL);
+        return false;
+    }
+    int level_scale = budget_scale();
+    int full_nodes = UNROLL_FULL_MAX_NODES * level_scale;
+    int partial_nodes = UNROLL_PARTIAL_MAX_NODES * level_scale;
+    int scale = temperature == PROFILE_HOT ? UNROLL_HOT_SIZE_SCALE : 1;
+    bool full = trips <= UNROLL_FULL_MAX_TRIPS * level_scale && trips * body_size <= full_nodes * scale;
+    if (partial) {
+        // Loops over arrays are left whole: the C compiler vectorizes them,
+        // which it no longer does once the body is copied by hand
+        partial = !full && factor > 1 && trips >= 2 * factor && factor * body_size <= partial_nodes * scale &&
+                  walk.array_accesses == 0;
+        if (!full && !partial && factor > 1) {
+            if (trips < 2 * factor) {
+                remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: %lld iterations, fewer than twice the factor %d",
+                             trips, factor);
+            } else if (factor * body_size > partial_nodes * scale) {
+                remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: body of %d nodes is too large", body_size);
+            } else {
+                remarks_emit(REMARK_MISSED, pass, loop,
+                             "not unrolled: loop over arrays left whole for the C compiler to vectorize");
+            }
+        }
+    }
+    if (scale > 1 && (full ? trips * body_size > full_nodes
+                           : partial && factor * body_size > partial_nodes)) {
+        profile_note_decision("unrolling hot loop over", iterator);
+    }
+
+    bool copyable = partial ? true : full;
+    for (int i = 0; i < loop->forStmt.bodyCount && copyable; i++) {
+        copyable = can_duplicate_statement(loop->forStmt.body[i], seen, full);
+    }
+    if (!copyable) {
+        if (pass && (full || partial)) {
+            remarks_emit(REMARK_MISSED, pass, loop, "not unrolled: body statements cannot be copied");
+        }
+        hashmap_free(walk.renames, NULL);
+        return false;
+    }
+
+    int line = loop->line;
+    if (partial) {
+        remarks_emit(REMARK_APPLIED, running_pass, loop, "unrolled by %d", factor);
+    } else {
+        remarks_emit(REMARK_APPLIED, running_pass, loop, "fully unrolled (%lld iterations)", trips);
+    }
+    if (!partial) {
+        AstNode** copies = NULL;
+        int copyCount = 0;
+        int copyCapacity = 0;
+        IteratorSubstitution sub = { hashmap_create(4), seen };
+        IteratorUses uses = { iterator, false };
+
+        for (long long t = 0; t < trips; t++) {
+            set_fact(sub.facts, iterator, (double)(start + t * step));
+            for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+                AstNode* copy = cloneAstTree(loop->forStmt.body[i]);
+                substitute_iterator(copy, &sub);
+                find_iterator_use(copy, &uses);
+                append_inline_statement(&copies, &copyCount, &copyCapacity, copy);
+            }
+        }
+
+        // Remaining uses read a renamed iterator, so an outer variable of the same name is untouched
+        char name[256];
+        if (uses.found) {
+            snprintf(name, sizeof(name), "__unr_%d", ++unroll_temp_counter);
+            hashmap_put(walk.renames, iterator, strdup(name), NULL);
+        }
+        for (int c = 0; c < copyCount; c++) {
+            if (uses.found) {
+                if (c % loop->forStmt.bodyCount == 0) {
+                    long long value = start + (c / loop->forStmt.bodyCount) * step;
+                    append_inline_statement(out, out_count, out_capacity, make_int_assignment(name, value, line));
+                }
+                rename_inline_node(copies[c], &walk);
+            }
+            append_inline_statement(out, out_count, out_capacity, copies[c]);
+        }
+        free(copies);
+        hashmap_free(sub.facts, free_fact);
+        freeAstNode(loop);
+
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Fully unrolled range loop at line %d (%lld iterations)", line, trips);
+        }
+    } else {
+        long long main_trips = trips - trips % factor;
+        long long split = start + main_trips * step;
+
+        // Remainder loop: the original loop restarted where the unrolled one stops
+        AstNode* remainder = NULL;
+        if (main_trips < trips) {
+            remainder = cloneAstTree(loop);
+            freeAstNode(remainder->forStmt.rangeStart);
+            remainder->forStmt.rangeStart = make_number((double)split);
+            remainder->forStmt.inductionFlags = IV_NONE;
+        }
+
+        // Main loop: `factor` copies of the body, advancing the iterator between them
+        AstNode** body = malloc(factor * (loop->forStmt.bodyCount + 1) * sizeof(AstNode*));
+        if (!body) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            freeAstNode(remainder);
+            hashmap_free(walk.renames, free);
+            return false;
+        }
+        int bodyCount = 0;
+        for (int copy = 0; copy < factor; copy++) {
+            if (copy > 0) {
+                AstNode* ident = createAstNode(AST_IDENTIFIER);
+                strncpy(ident->identifier.name, iterator, sizeof(ident->identifier.name) - 1);
+                AstNode* advance = createAstNode(AST_VAR_ASSIGN);
+                strncpy(advance->varAssign.name, iterator, sizeof(advance->varAssign.name) - 1);
+                advance->varAssign.initializer = make_binary('+', ident, make_number((double)step));
+                advance->line = line;
+                body[bodyCount++] = advance;
+            }
+            for (int i = 0; i < loop->forStmt.bodyCount; i++) {
+                body[bodyCount++] = copy == 0 ? loop->forStmt.body[i] : cloneAstTree(loop->forStmt.body[i]);
+            }
+        }
+        free(loop->forStmt.body);
+        loop->forStmt.body = body;
+        loop->forStmt.bodyCount = bodyCount;
+        freeAstNode(loop->forStmt.rangeEnd);
+        loop->forStmt.rangeEnd = make_number((double)split);
+        loop->forStmt.inductionFlags = IV_NONE;
+
+        append_inline_statement(out, out_count, out_capacity, loop);
+        if (remainder && !unroll_range_loop(remainder, seen, false, out, out_count, out_capacity)) {
+            append_inline_statement(out, out_count, out_capacity, remainder);
+        }
+
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Unrolled range loop at line %d by %d (%lld remainder iterations)",
+                      line, factor, trips - main_trips);
+        }
+    }
+
+    hashmap_free(walk.renames, free);
+    stats.loops_unrolled++;
+    stats.total_optimizations++;
+    return true;
+}
+
+static void loop_unrolling_node(AstNode* node, UnrollState* state);
+
+/**
+ * @brief Unrolls the eligible range loops of a statement list
+ *
+ * @param list Location of the statement array
+ * @param count Location of the statement count
+ * @param state Pass state (names seen so far are updated)
+ */
+static void unroll_statement_list(AstNode*** list, int* count, UnrollState* state) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)unroll_statement_list);
+
+    if (!*list || *count == 0) return;
+
+    AstNode** newList = NULL;
+    int newCount = 0;
+    int capacity = 0;
+    bool changed = false;
+
+    for (int i = 0; i < *count; i++) {
+        AstNode* stmt = (*list)[i];
+        if (stmt && (stmt->type == AST_BLOCK || stmt->type == AST_IF_STMT || stmt->type == AST_WHILE_STMT ||
+                     stmt->type == AST_DO_WHILE_STMT || stmt->type == AST_FOR_STMT)) {
+            // Nested lists record their writes in a copy: a loop must not count
+            // the names its own body assigns first as assigned before it
+            HashMap* outer = state->seen;
+            HashMap* nested = hashmap_create(64);
+            if (nested) {
+                hashmap_foreach(outer, record_written_name, nested);
+                state->seen = nested;
+                loop_unrolling_node(stmt, state);
+                state->seen = outer;
+                hashmap_free(nested, NULL);
+            }
+        }
+
+        int first = newCount;
+        if (stmt && stmt->type == AST_FOR_STMT && stmt->forStmt.forType == FOR_RANGE &&
+            unroll_range_loop(stmt, state->seen, state->partial, &newList, &newCount, &capacity)) {
+            changed = true;
+            // The loop node may have been freed; record the writes of its replacement
+            for (int j = first; j < newCount; j++) {
+                visit_assigned_names(newList[j], record_written_name, state->seen);
+            }
+            continue;
+        }
+        append_inline_statement(&newList, &newCount, &capacity, stmt);
+        visit_assigned_names(stmt, record_written_name, state->seen);
+    }
+
+    if (changed) {
+        free(*list);
+        *list = newList;
+        *count = newCount;
+    } else {
+        free(newList);
+    }
+}
+
+/**
+ * @brief Recurses into every statement list below a node, outside function bodies
+ *
+ * @param node AST node to process
+ * @param state Pass state
+ */
+static void loop_unrolling_node(AstNode* node, UnrollState* state) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_PROGRAM:
+            unroll_statement_list(&node->program.statements, &node->program.statementCount, state);
+            break;
+        case AST_BLOCK:
+            unroll_statement_list(&node->block.statements, &node->block.statementCount, state);
+            break;
+        case AST_IF_STMT:
+            unroll_statement_list(&node->ifStmt.thenBranch, &node->ifStmt.thenCount, state);
+            unroll_statement_list(&node->ifStmt.elseBranch, &node->ifStmt.elseCount, state);
+            break;
+        case AST_WHILE_STMT:
+            unroll_statement_list(&node->whileStmt.body, &node->whileStmt.bodyCount, state);
+            break;
+        case AST_DO_WHILE_STMT:
+            unroll_statement_list(&node->doWhileStmt.body, &node->doWhileStmt.bodyCount, state);
+            break;
+        case AST_FOR_STMT:
+            unroll_statement_list(&node->forStmt.body, &node->forStmt.bodyCount, state);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Runs one unrolling mode over the program body
+ */
+static AstNode* run_loop_unrolling(AstNode* node, bool partial) {
+    UnrollState state = { hashmap_create(64), partial };
+    if (!state.seen) return node;
+
+    loop_unrolling_node(node, &state);
+
+    hashmap_free(state.seen, NULL);
+    return node;
+}
+
+/**
+ * @brief Fully unrolls range loops whose trip count is known at compile time
+ *
+ * Runs once constant folding and propagation have reduced the bounds to
+ * literals, and before induction-variable strength reduction, so every copy
+ * sees its own iterator value; the pass manager then re-runs folding,
+ * propagation and dead code elimination over the copies. Only loops in the
+ * program body are considered.
+ *
+ * This optimization is enabled at optimization level 2 and above; level 3
+ * doubles the trip count and size limits.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* loop_unrolling(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)loop_unrolling);
+    return run_loop_unrolling(node, false);
+}
+
+/**
+ * @brief Partially unrolls constant-trip range loops too long to unroll fully
+ *
+ * Runs after induction-variable strength reduction and loop-invariant code
+ * motion, which both give up on loops that write their iterator, as the
+ * unrolled loop does between copies.
+ *
+ * This optimization is enabled at optimization level 2 and above, with the
+ * factor taken from OptimizerOptions.unroll_factor.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* partial_loop_unrolling(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)partial_loop_unrolling);
+    return run_loop_unrolling(node, true);
+}
+
+/**
+ * @brief Checks whether an expression is a string concatenation
+ *
+ * Mirrors the compiler: '+' concatenates when one of its operands is a
+ * string literal or another concatenation.
+ *
+ * @param node Expression to check
+ * @return bool true if the expression is a concatenation
+ */
+static bool is_string_concat(AstNode* node) {
+    if (!node) return false;
+    if (node->type == AST_CONCAT_EXPR) return true;
+    if (node->type != AST_BINARY_OP || node->binaryOp.op != '+') return false;
+
+    AstNode* left = node->binaryOp.left;
+    AstNode* right = node->binaryOp.right;
+    return (left && (left->type == AST_STRING_LITERAL || is_string_concat(left))) ||
+           (right && (right->type == AST_STRING_LITERAL || is_string_concat(right)));
+}
+
+/**
+ * @brief Counts the leaf operands of a concatenation chain
+ */
+static int count_concat_parts(AstNode* node) {
+    if (!is_string_concat(node)) return 1;
+    if (node->type == AST_CONCAT_EXPR) return node->concatExpr.partCount;
+    return count_concat_parts(node->binaryOp.left) + count_concat_parts(node->binaryOp.right);
+}
+
+/**
+ * @brief Moves the leaf operands of a chain into a part array, left to right
+ *
+ * The chain's '+' nodes are freed; the leaves are owned by @p parts afterwards.
+ *
+ * @param node Concatenation to dismantle
+ * @param parts Part array with room for every leaf
+ * @param count Number of parts stored so far
+ */
+static void take_concat_parts(AstNode* node, AstNode** parts, int* count) {
+    if (node->type == AST_CONCAT_EXPR) {
+        for (int i = 0; i < node->concatExpr.partCount; i++) {
+            parts[(*count)++] = node->concatExpr.parts[i];
+        }
+        node->concatExpr.partCount = 0;
+    } else {
+        AstNode* operands[2] = { node->binaryOp.left, node->binaryOp.right };
+        node->binaryOp.left = NULL;
+        node->binaryOp.right = NULL;
+        for (int i = 0; i < 2; i++) {
+            if (is_string_concat(operands[i])) take_concat_parts(operands[i], parts, count);
+            else parts[(*count)++] = operands[i];
+        }
+    }
+    freeAstNode(node);
+}
+
+static void fuse_concat_statement(AstNode* node);
+
+/**
+ * @brief Fuses the concatenation chains inside an expression
+ *
+ * A chain of three or more parts becomes one AST_CONCAT_EXPR. A streamed
+ * chain (the operand of print) is left as '+' nodes, since the compiler
+ * writes its parts straight to the output; only expressions nested inside
+ * its parts are fused.
+ *
+ * @param slot Location of the expression pointer
+ * @param streamed true if the chain at @p slot is printed directly
+ */
+static void fuse_concat_expression(AstNode** slot, bool streamed) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+
+    if (is_string_concat(expr) && expr->type == AST_BINARY_OP) {
+        int partCount = count_concat_parts(expr);
+        if (streamed || partCount < 3) {
+            fuse_concat_expression(&expr->binaryOp.left, streamed);
+            fuse_concat_expression(&expr->binaryOp.right, streamed);
+            return;
+        }
+
+        AstNode** parts = malloc(partCount * sizeof(AstNode*));
+        AstNode* concat = createAstNode(AST_CONCAT_EXPR);
+        if (!parts || !concat) {
+            error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+            free(parts);
+            freeAstNode(concat);
+            return;
+        }
+        concat->line = expr->line;
+        concat->concatExpr.parts = parts;
+        take_concat_parts(expr, parts, &concat->concatExpr.partCount);
+        *slot = concat;
+
+        stats.concat_chains_fused++;
+        stats.total_optimizations++;
+        if (debug_level >= 2) {
+            logger_log(LOG_DEBUG, "Fused a %d-part string concatenation at line %d", partCount, concat->line);
+        }
+        remarks_emit(REMARK_APPLIED, running_pass, concat, "fused a %d-part string concatenation", partCount);
+        expr = concat;
+    }
+
+    switch (expr->type) {
+        case AST_CONCAT_EXPR:
+            for (int i = 0; i < expr->concatExpr.partCount; i++) {
+                fuse_concat_expression(&expr->concatExpr.parts[i], false);
+            }
+            break;
+        case AST_BINARY_OP:
+            fuse_concat_expression(&expr->binaryOp.left, false);
+            fuse_concat_expression(&expr->binaryOp.right, false);
+            break;
+        case AST_UNARY_OP:
+            fuse_concat_expression(&expr->unaryOp.expr, false);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < expr->funcCall.argCount; i++) {
+                fuse_concat_expression(&expr->funcCall.arguments[i], false);
+            }
+            break;
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < expr->arrayLiteral.elementCount; i++) {
+                fuse_concat_expression(&expr->arrayLiteral.elements[i], false);
+            }
+            break;
+        case AST_ARRAY_ACCESS:
+            fuse_concat_expression(&expr->arrayAccess.array, false);
+            fuse_concat_expression(&expr->arrayAccess.index, false);
+            break;
+        case AST_MEMBER_ACCESS:
+            fuse_concat_expression(&expr->memberAccess.object, false);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Fuses the concatenation chains in every statement of a list
+ */
+static void fuse_concat_list(AstNode** list, int count) {
+    for (int i = 0; i < count; i++) {
+        fuse_concat_statement(list[i]);
+    }
+}
+
+/**
+ * @brief Fuses the concatenation chains below a statement, function bodies included
+ *
+ * @param node Statement to process
+ */
+static void fuse_concat_statement(AstNode* node) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_PROGRAM:
+            fuse_concat_list(node->program.statements, node->program.statementCount);
+            break;
+        case AST_BLOCK:
+            fuse_concat_list(node->block.statements, node->block.statementCount);
+            break;
+        case AST_FUNC_DEF:
+            fuse_concat_list(node->funcDef.body, node->funcDef.bodyCount);
+            break;
+        case AST_VAR_ASSIGN:
+            fuse_concat_expression(&node->varAssign.initializer, false);
+            break;
+        case AST_ARRAY_ASSIGN:
+            fuse_concat_expression(&node->arrayAssign.value, false);
+            break;
+        case AST_VAR_DECL:
+            fuse_concat_expression(&node->varDecl.initializer, false);
+            break;
+        case AST_RETURN_STMT:
+            fuse_concat_expression(&node->returnStmt.expr, false);
+            break;
+        case AST_PRINT_STMT:
+            fuse_concat_expression(&node->printStmt.expr, true);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                fuse_concat_expression(&node->funcCall.arguments[i], false);
+            }
+            break;
+        case AST_IF_STMT:
+            fuse_concat_expression(&node->ifStmt.condition, false);
+            fuse_concat_list(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            fuse_concat_list(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_WHILE_STMT:
+            fuse_concat_expression(&node->whileStmt.condition, false);
+            fuse_concat_list(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            fuse_concat_expression(&node->doWhileStmt.condition, false);
+            fuse_concat_list(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            break;
+        case AST_FOR_STMT:
+            fuse_concat_list(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                AstNode* caseNode = node->switchStmt.cases[i];
+                if (caseNode) fuse_concat_list(caseNode->caseStmt.body, caseNode->caseStmt.bodyCount);
+            }
+            fuse_concat_list(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                AstNode* caseNode = node->patternMatch.cases[i];
+                fuse_concat_list(caseNode->patternCase.body, caseNode->patternCase.bodyCount);
+            }
+            if (node->patternMatch.otherwise) {
+                fuse_concat_list(node->patternMatch.otherwise->patternCase.body,
+                                 node->patternMatch.otherwise->patternCase.bodyCount);
+            }
+            break;
+        case AST_TRY_CATCH_STMT:
+            fuse_concat_list(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            fuse_concat_list(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            fuse_concat_list(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Fuses string concatenation chains into single n-ary concatenations
+ *
+ * `a + b + c + d` would otherwise compile to nested two-part concat_n() calls
+ * that allocate and copy every intermediate string. The fused
+ * AST_CONCAT_EXPR compiles to one concat_n() call that measures every part,
+ * allocates once and copies each part once. Chains printed directly are left
+ * to the compiler, which streams them to the output without allocating.
+ *
+ * The other passes do not model AST_CONCAT_EXPR, so this pass lowers the AST
+ * once after they reach their fixed point.
+ *
+ * This optimization is enabled at optimization level 1 and above.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* string_concat_fusion(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)string_concat_fusion);
+    fuse_concat_statement(node);
+    return node;
+}
+
+/**
+ * @brief Checks whether an expression is a literal the evaluator can take as an argument
+ */
+static bool is_evaluable_argument(AstNode* node) {
+    return node && (node->type == AST_NUMBER_LITERAL || node->type == AST_STRING_LITERAL ||
+                    node->type == AST_BOOLEAN_LITERAL);
+}
+
+/**
+ * @brief Builds the literal that replaces an evaluated call
+ *
+ * The code generator types a call by its declared return type, so the
+ * literal has the kind of the returned value: ints become integer literals,
+ * doubles become literals marked as doubles, and bools and strings become
+ * their own literals. Declarations, operators and print formats stay the
+ * same at every site.
+ *
+ * @param value Evaluated value
+ * @return AstNode* Literal, or NULL if the value cannot be written in its place
+ */
+static AstNode* create_evaluated_literal(const MacroValue* value) {
+    AstNode* literal = NULL;
+    switch (value->kind) {
+        case MACRO_VALUE_STRING:
+            if (strlen(value->string) >= sizeof(literal->stringLiteral.value)) return NULL;
+            literal = createAstNode(AST_STRING_LITERAL);
+            if (literal) strcpy(literal->stringLiteral.value, value->string);
+            return literal;
+        case MACRO_VALUE_BOOL:
+            literal = createAstNode(AST_BOOLEAN_LITERAL);
+            if (literal) literal->boolLiteral.value = value->number != 0;
+            return literal;
+        case MACRO_VALUE_INT:
+            // Larger ints would read back as doubles
+            if (value->number > AST_MAX_EXACT_INTEGER || value->number < -AST_MAX_EXACT_INTEGER) return NULL;
+            break;
+        default:
+            break;
+    }
+    literal = createAstNode(AST_NUMBER_LITERAL);
+    if (literal) {
+        literal->numberLiteral.value = value->number;
+        literal->numberLiteral.isDouble = value->kind == MACRO_VALUE_DOUBLE;
+    }
+    return literal;
+}
+
+/**
+ * @brief Replaces a call to a pure function with constant arguments by its result
+ *
+ * @param slot Location of the call
+ * @param context Functions the evaluator may run
+ */
+static void evaluate_call_site(AstNode** slot, const MacroEvalContext* context) {
+    AstNode* call = *slot;
+    if (!hashmap_contains(context->functions, call->funcCall.name)) return;
+    for (int i = 0; i < call->funcCall.argCount; i++) {
+        if (!is_evaluable_argument(call->funcCall.arguments[i])) return;
+    }
+
+    MacroValue value;
+    if (!macro_evaluate_call(call, context, &value)) {
+        remarks_emit(REMARK_MISSED, running_pass, call, "not evaluated at compile time: %s in '%s'",
+                     macro_last_failure() ? macro_last_failure() : "unknown failure", call->funcCall.name);
+        return;
+    }
+    AstNode* literal = create_evaluated_literal(&value);
+    macro_value_free(&value);
+    if (!literal) return;
+
+    literal->line = call->line;
+    literal->col = call->col;
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Replaced call to '%s' by its compile-time result", call->funcCall.name);
+    }
+    remarks_emit(REMARK_APPLIED, running_pass, call, "replaced call to '%s' by its compile-time result",
+                 call->funcCall.name);
+    freeAstNode(call);
+    *slot = literal;
+    stats.calls_evaluated++;
+    stats.total_optimizations++;
+}
+
+/**
+ * @brief Evaluates the calls inside an expression, innermost first
+ *
+ * @param slot Location of the expression pointer
+ * @param context Functions the evaluator may run
+ */
+static void evaluate_calls_expression(AstNode** slot, const MacroEvalContext* context) {
+    AstNode* expr = *slot;
+    if (!expr) return;
+
+    switch (expr->type) {
+        case AST_BINARY_OP:
+            evaluate_calls_expression(&expr->binaryOp.left, context);
+            evaluate_calls_expression(&expr->binaryOp.right, context);
+            break;
+        case AST_UNARY_OP:
+            evaluate_calls_expression(&expr->unaryOp.expr, context);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < expr->funcCall.argCount; i++) {
+                evaluate_calls_expression(&expr->funcCall.arguments[i], context);
+            }
+            evaluate_call_site(slot, context);
+            break;
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < expr->arrayLiteral.elementCount; i++) {
+                evaluate_calls_expression(&expr->arrayLiteral.elements[i], context);
+            }
+            break;
+        case AST_ARRAY_ACCESS:
+            evaluate_calls_expression(&expr->arrayAccess.array, context);
+            evaluate_calls_expression(&expr->arrayAccess.index, context);
+            break;
+        default:
+            break;
+    }
+}
+
+static void evaluate_calls_statement(AstNode* node, const MacroEvalContext* context);
+
+/**
+ * @brief Evaluates the calls in every statement of a list
+ */
+static void evaluate_calls_list(AstNode** list, int count, const MacroEvalContext* context) {
+    for (int i = 0; i < count; i++) {
+        evaluate_calls_statement(list[i], context);
+    }
+}
+
+/**
+ * @brief Evaluates the calls below a statement, function bodies included
+ *
+ * Calls used as statements are kept: only their arguments are evaluated.
+ *
+ * @param node Statement to process
+ * @param context Functions the evaluator may run
+ */
+static void evaluate_calls_statement(AstNode* node, const MacroEvalContext* context) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_PROGRAM:
+            evaluate_calls_list(node->program.statements, node->program.statementCount, context);
+            break;
+        case AST_BLOCK:
+            evaluate_calls_list(node->block.statements, node->block.statementCount, context);
+            break;
+        case AST_FUNC_DEF:
+            evaluate_calls_list(node->funcDef.body, node->funcDef.bodyCount, context);
+            break;
+        case AST_VAR_ASSIGN:
+            evaluate_calls_expression(&node->varAssign.initializer, context);
+            break;
+        case AST_ARRAY_ASSIGN:
+            evaluate_calls_expression(&node->arrayAssign.index, context);
+            evaluate_calls_expression(&node->arrayAssign.value, context);
+            break;
+        case AST_VAR_DECL:
+            evaluate_calls_expression(&node->varDecl.initializer, context);
+            break;
+        case AST_RETURN_STMT:
+            evaluate_calls_expression(&node->returnStmt.expr, context);
+            break;
+        case AST_PRINT_STMT:
+            evaluate_calls_expression(&node->printStmt.expr, context);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                evaluate_calls_expression(&node->funcCall.arguments[i], context);
+            }
+            break;
+        case AST_IF_STMT:
+            evaluate_calls_expression(&node->ifStmt.condition, context);
+            evaluate_calls_list(node->ifStmt.thenBranch, node->ifStmt.thenCount, context);
+            evaluate_calls_list(node->ifStmt.elseBranch, node->ifStmt.elseCount, context);
+            break;
+        case AST_WHILE_STMT:
+            evaluate_calls_expression(&node->whileStmt.condition, context);
+            evaluate_calls_list(node->whileStmt.body, node->whileStmt.bodyCount, context);
+            break;
+        case AST_DO_WHILE_STMT:
+            evaluate_calls_expression(&node->doWhileStmt.condition, context);
+            evaluate_calls_list(node->doWhileStmt.body, node->doWhileStmt.bodyCount, context);
+            break;
+        case AST_FOR_STMT:
+            if (node->forStmt.forType == FOR_RANGE) {
+                evaluate_calls_expression(&node->forStmt.rangeStart, context);
+                evaluate_calls_expression(&node->forStmt.rangeEnd, context);
+                evaluate_calls_expression(&node->forStmt.rangeStep, context);
+            }
+            evaluate_calls_list(node->forStmt.body, node->forStmt.bodyCount, context);
+            break;
+        case AST_SWITCH_STMT:
+            for (int i = 0; i < node->switchStmt.caseCount; i++) {
+                AstNode* caseNode = node->switchStmt.cases[i];
+                if (caseNode) evaluate_calls_list(caseNode->caseStmt.body, caseNode->caseStmt.bodyCount, context);
+            }
+            evaluate_calls_list(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount, context);
+            break;
+        case AST_PATTERN_MATCH:
+            for (int i = 0; i < node->patternMatch.caseCount; i++) {
+                AstNode* caseNode = node->patternMatch.cases[i];
+                evaluate_calls_list(caseNode->patternCase.body, caseNode->patternCase.bodyCount, context);
+            }
+            if (node->patternMatch.otherwise) {
+                evaluate_calls_list(node->patternMatch.otherwise->patternCase.body,
+                                    node->patternMatch.otherwise->patternCase.bodyCount, context);
+            }
+            break;
+        case AST_TRY_CATCH_STMT:
+            evaluate_calls_list(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount, context);
+            evaluate_calls_list(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount, context);
+            evaluate_calls_list(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount, context);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Marks a variable name in the name -> owner-count map
+ */
+static void count_assigned_name(const char* name, void* value, void* userData) {
+    (void)value;
+    HashMap* names = (HashMap*)userData;
+    hashmap_put(names, name, names, NULL);
+}
+
+/**
+ * @brief Merges the names one body assigns into the shared-name analysis
+ */
+static void merge_assigned_names(const char* name, void* value, void* userData) {
+    (void)value;
+    HashMap** maps = (HashMap**)userData;  // { seen, shared }
+    if (hashmap_contains(maps[0], name)) {
+        hashmap_put(maps[1], name, maps[1], NULL);
+    } else {
+        hashmap_put(maps[0], name, maps[0], NULL);
+    }
+}
+
+/**
+ * @brief Checks whether the code generator gives a function a body of its own
+ *
+ * Class methods and the add/greet helpers are emitted with fixed bodies.
+ */
+static bool has_generated_body(const char* name) {
+    return !strstr(name, "Point_") && !strstr(name, "Vector3_") && !strstr(name, "Shape_") &&
+           !strstr(name, "Circle_") && strcmp(name, "add") != 0 && strcmp(name, "greet") != 0;
+}
+
+/**
+ * @brief Executes calls to pure functions with constant arguments at compile time
+ *
+ * Calls whose arguments are all literals are run by the evaluator in
+ * macro_evaluator.c, which interprets the callee (recursion, loops, number
+ * and string operations) under a step and memory budget and gives up on
+ * anything impure. Successful calls are replaced by the literal they
+ * return, so tables and constants computed by helper functions cost
+ * nothing at run time; functions left without callers are then dropped by
+ * tree shaking.
+ *
+ * Only functions defined once at the top level of main are candidates.
+ * Variables a function assigns must be private to it: names main assigns,
+ * or that several functions assign, live in the code generator's shared
+ * variable table and are not modelled.
+ *
+ * Evaluated literals would feed back into the other passes with a type
+ * they do not track, so this pass lowers the AST once after the fixed point.
+ *
+ * This optimization is enabled at optimization level 2 and above; level 3
+ * doubles the step and memory budget of each evaluation.
+ *
+ * @param node AST node to optimize
+ * @return AstNode* Modified AST
+ */
+static AstNode* compile_time_evaluation(AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)compile_time_evaluation);
+    if (!node || node->type != AST_PROGRAM) return node;
+
+    HashMap* functions = hashmap_create(32);
+    HashMap* duplicated = hashmap_create(8);
+    HashMap* seen = hashmap_create(32);
+    HashMap* shared = hashmap_create(32);
+    if (!functions || !duplicated || !seen || !shared) {
+        error_report("Optimizer", __LINE__, 0, "Memory allocation failed", ERROR_MEMORY);
+        hashmap_free(functions, NULL);
+        hashmap_free(duplicated, NULL);
+        hashmap_free(seen, NULL);
+        hashmap_free(shared, NULL);
+        return node;
+    }
+
+    HashMap* maps[2] = { seen, shared };
+    for (int i = 0; i < node->program.statementCount; i++) {
+        AstNode* stmt = node->program.statements[i];
+        if (stmt->type != AST_FUNC_DEF) {
+            visit_assigned_names(stmt, count_assigned_name, shared);
+            continue;
+        }
+        if (hashmap_contains(functions, stmt->funcDef.name)) {
+            hashmap_put(duplicated, stmt->funcDef.name, stmt, NULL);
+        } else if (has_generated_body(stmt->funcDef.name)) {
+            hashmap_put(functions, stmt->funcDef.name, stmt, NULL);
+        }
+
+        // Locals of the function, each counted once
+        HashMap* locals = hashmap_create(16);
+        if (!locals) continue;
+        for (int j = 0; j < stmt->funcDef.bodyCount; j++) {
+            visit_assigned_names(stmt->funcDef.body[j], count_assigned_name, locals);
+        }
+        hashmap_foreach(locals, merge_assigned_names, maps);
+        hashmap_free(locals, NULL);
+    }
+    for (int i = 0; i < node->program.statementCount; i++) {
+        AstNode* stmt = node->program.statements[i];
+        if (stmt->type == AST_FUNC_DEF && hashmap_contains(duplicated, stmt->funcDef.name)) {
+            hashmap_remove(functions, stmt->funcDef.name);
+        }
+    }
+
+    if (hashmap_count(functions) > 0) {
+        MacroEvalContext context = {
+            .functions = functions,
+            .sharedNames = shared,
+            .stepBudget = (long)MACRO_EVAL_STEP_BUDGET * budget_scale(),
+            .memoryBudget = (size_t)MACRO_EVAL_MEMORY_BUDGET * budget_scale()
+        };
+        evaluate_calls_statement(node, &context);
+    }
+
+    hashmap_free(functions, NULL);
+    hashmap_free(duplicated, NULL);
+    hashmap_free(seen, NULL);
+    hashmap_free(shared, NULL);
+    return node;
+}
+
+/** Maximum number of passes the pass manager can hold */
+#define MAX_OPTIMIZER_PASSES 16
+
+/** Maximum number of dependencies per pass */
+#define MAX_PASS_DEPENDENCIES 4
+
+/**
+ * @brief Registered optimization pass
+ */
+typedef struct {
+    const char* name;                           ///< Pass name used in logs and dependencies
+    AstNode* (*run)(AstNode* ast);              ///< Pass entry point
+    OptimizerLevel min_level;                   ///< Lowest level that runs the pass
+    size_t option_offset;                       ///< Offset of the enabling flag in OptimizerOptions
+    int dependencies[MAX_PASS_DEPENDENCIES];    ///< Indices of passes that must run first
+    int dependency_count;                       ///< Number of dependencies
+    bool is_analysis;                           ///< Analysis passes never change the AST
+    bool is_lowering;                           ///< Lowering passes run once, after the fixed point
+    int last_run_version;                       ///< AST version seen by the last run (-1 = never)
+} OptimizerPass;
+
+/** Registered passes, in dependency order */
+static OptimizerPass passes[MAX_OPTIMIZER_PASSES];
+
+/** Per-pass statistics for the last optimize_ast() call */
+static OptimizerPassStats pass_stats[MAX_OPTIMIZER_PASSES];
+
+/** Number of registered passes */
+static int pass_count = 0;
+
+/**
+ * @brief Finds a registered pass by name
+ * 
+ * @param name Pass name
+ * @return int Index of the pass, or -1 if it is not registered
+ */
+static int find_pass(const char* name) {
+    for (int i = 0; i < pass_count; i++) {
+        if (strcmp(passes[i].name, name) == 0) return i;
+    }
+    return -1;
+}
+
+/**
+ * @brief Registers an optimization pass
+ * 
+ * Dependencies must already be registered, so the registry order is always a
+ * valid execution order.
+ * 
+ * @param name Pass name
+ * @param run Pass entry point
+ * @param min_level Lowest optimization level that runs the pass
+ * @param option_offset offsetof() the enabling flag in OptimizerOptions
+ * @param is_analysis true if the pass only gathers information
+ * @param dependencies NULL-terminated list of pass names that must run first (may be NULL)
+ * @return bool true on success
+ */
+static bool register_pass(const char* name, AstNode* (*run)(AstNode*), OptimizerLevel min_level,
+                          size_t option_offset, bool is_analysis, const char* const* dependencies) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)register_pass);
+    
+    if (pass_count >= MAX_OPTIMIZER_PASSES) {
+        error_report("Optimizer", __LINE__, 0, "Too many optimization passes registered", ERROR_LIMIT);
+        return false;
+    }
+    
+    OptimizerPass* pass = &passes[pass_count];
+    pass->name = name;
+    pass->run = run;
+    pass->min_level = min_level;
+    pass->option_offset = option_offset;
+    pass->is_analysis = is_analysis;
+    pass->is_lowering = false;
+    pass->dependency_count = 0;
+    pass->last_run_version = -1;
+    
+    for (int i = 0; dependencies && dependencies[i]; i++) {
+        int dep = find_pass(dependencies[i]);
+        if (dep < 0 || pass->dependency_count >= MAX_PASS_DEPENDENCIES) {
+            char msg[256];
+            snprintf(msg, sizeof(msg), "Pass '%s' has unknown dependency '%s'", name, dependencies[i]);
+            error_report("Optimizer", __LINE__, 0, msg, ERROR_UNDEFINED);
+            return false;
+        }
+        pass->dependencies[pass->dependency_count++] = dep;
+    }
+    
+    pass_count++;
+    return true;
+}
+
+/**
+ * @brief Registers a lowering pass
+ * 
+ * Lowering passes introduce nodes the other passes do not model, so the pass
+ * manager runs them once, in registration order, after the fixed point.
+ * 
+ * @param name Pass name
+ * @param run Pass entry point
+ * @param min_level Lowest optimization level that runs the pass
+ * @param option_offset offsetof() the enabling flag in OptimizerOptions
+ * @return bool true on success
+ */
+static bool register_lowering_pass(const char* name, AstNode* (*run)(AstNode*), OptimizerLevel min_level,
+                                   size_t option_offset) {
+    if (!register_pass(name, run, min_level, option_offset, false, NULL)) return false;
+    passes[pass_count - 1].is_lowering = true;
+    return true;
+}
+
+/**
+ * @brief Scope analysis pass entry point
+ * 
+ * The analysis is rebuilt from scratch on every run, so its variable count
+ * reflects the latest AST rather than accumulating across iterations.
+ */
+static AstNode* run_scope_analysis(AstNode* ast) {
+    stats.variables_scoped = 0;
+    return scope_analysis(ast);
+}
+
+/**
+ * @brief Common subexpression elimination pass entry point
+ */
+static AstNode* run_common_subexpression_elimination(AstNode* ast) {
+    if (!expr_table.buckets) {
+        init_expr_table();
+    }
+    common_subexpression_elimination(ast);
+    return ast;
+}
+
+/**
+ * @brief Registers the built-in passes on first use
+ */
+static void init_pass_registry(void) {
+    if (pass_count > 0) return;
+    
+    static const char* const after_folding[] = { "constant_folding", NULL };
+    static const char* const after_scopes[] = { "scope_analysis", NULL };
+    static const char* const after_propagation[] = { "constant_folding", "constant_propagation", NULL };
+    
+    register_pass("constant_folding", constant_folding, OPT_LEVEL_1,
+                  offsetof(OptimizerOptions, enable_constant_folding), false, NULL);
+    register_pass("redundant_statements", remove_redundant_statements, OPT_LEVEL_1,
+                  offsetof(OptimizerOptions, enable_redundant_stmt_removal), false, NULL);
+    register_pass("tail_call_elimination", tail_call_elimination, OPT_LEVEL_1,
+                  offsetof(OptimizerOptions, enable_tail_call_elimination), false, NULL);
+    register_pass("function_inlining", function_inlining, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_function_inlining), false, NULL);
+    register_pass("scope_analysis", run_scope_analysis, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_scope_analysis), true, NULL);
+    register_pass("constant_propagation", constant_propagation, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_constant_propagation), false, after_scopes);
+    register_pass("dead_code_elimination", dead_code_elimination, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_dead_code_elimination), false, after_propagation);
+    register_pass("loop_unrolling", loop_unrolling, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_loop_unrolling), false, after_propagation);
+    register_pass("induction_variables", induction_variable_optimization, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_induction_variables), false, after_scopes);
+    register_pass("loop_invariant_code_motion", loop_invariant_code_motion, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_loop_invariant_code_motion), false, after_scopes);
+    register_pass("partial_loop_unrolling", partial_loop_unrolling, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_loop_unrolling), false, after_propagation);
+    register_pass("common_subexpression_elimination", run_common_subexpression_elimination, OPT_LEVEL_2,
+                  offsetof(OptimizerOptions, enable_common_subexpr_elimination), false, after_folding);
+    register_lowering_pass("compile_time_evaluation", compile_time_evaluation, OPT_LEVEL_2,
+                           offsetof(OptimizerOptions, enable_compile_time_evaluation));
+    register_lowering_pass("string_concat_fusion", string_concat_fusion, OPT_LEVEL_1,
+                           offsetof(OptimizerOptions, enable_concat_fusion));
+}
+
+/**
+ * @brief Checks whether a pass is allowed by the current level and options
+ * 
+ * @param pass Pass to check
+ * @return bool true if the pass may run
+ */
+static bool pass_enabled(const OptimizerPass* pass) {
+    if (currentLevel < pass->min_level) return false;
+    return *(const bool*)((const char*)&options + pass->option_offset);
+}
+
+/**
+ * @brief Gets the current wall-clock time in milliseconds
+ * 
+ * @return double Monotonic time in milliseconds
+ */
+static double pass_clock_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1000.0 + ts.tv_nsec / 1000000.0;
+}
+
+/**
+ * @brief Runs one pass and records its timing and change count
+ * 
+ * @param index Index of the pass in the registry
+ * @param ast AST to transform
+ * @param version Current AST version (bumped if the pass changes the AST)
+ * @return AstNode* Transformed AST
+ */
+static AstNode* run_pass(int index, AstNode* ast, int* version) {
+    OptimizerPass* pass = &passes[index];
+    
+    if (debug_level >= 2) {
+        logger_log(LOG_DEBUG, "Running pass %s", pass->name);
+    }
+    
+    int before = stats.total_optimizations;
+    double start = pass_clock_ms();
+    running_pass = pass->name;
+    ast = pass->run(ast);
+    running_pass = NULL;
+    pass_stats[index].elapsed_ms += pass_clock_ms() - start;
+    pass_stats[index].runs++;
+    
+    int changes = stats.total_optimizations - before;
+    pass_stats[index].changes += changes;
+    if (changes > 0) (*version)++;
+    pass->last_run_version = *version;
+    
+    return ast;
+}
+
+/**
+ * @brief Runs the enabled passes until the AST stops changing
+ * 
+ * The AST carries a version number that is bumped whenever a pass reports a
+ * change. A transform pass is skipped when the AST has not changed since it
+ * last ran, and analysis passes are refreshed only right before a dependent
+ * pass needs them. An iteration in which no pass changes anything ends the
+ * loop; the options' iteration budget bounds longer cascades. Lowering passes
+ * then run once over the result.
+ * 
+ * @param ast AST to optimize
+ * @return AstNode* Optimized AST
+ */
+static AstNode* run_pass_manager(AstNode* ast) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)run_pass_manager);
     
-    // Reset optimization statistics
-    stats = (OptimizationStats){0};
-    
-    logger_log(LOG_INFO, "Starting AST optimization at level %d", currentLevel);
-    
-    if (currentLevel >= OPT_LEVEL_1) {
-        logger_log(LOG_DEBUG, "Applying constant folding");
-        ast = constant_folding(ast);
+    init_pass_registry();
+    
+    for (int i = 0; i < pass_count; i++) {
+        passes[i].last_run_version = -1;
+        pass_stats[i] = (OptimizerPassStats){ passes[i].name, 0, 0, 0.0 };
+    }
+    
+    int budget = options.max_iterations > 0 ? options.max_iterations
+                                            : OPTIMIZER_DEFAULT_MAX_ITERATIONS * budget_scale();
+    int version = 0;
+    
+    for (int iteration = 0; iteration < budget; iteration++) {
+        int start_version = version;
+        
+        for (int i = 0; i < pass_count; i++) {
+            OptimizerPass* pass = &passes[i];
+            if (pass->is_analysis || pass->is_lowering || !pass_enabled(pass) ||
+                pass->last_run_version == version) continue;
+            
+            for (int d = 0; d < pass->dependency_count; d++) {
+                OptimizerPass* dep = &passes[pass->dependencies[d]];
+                if (dep->is_analysis && pass_enabled(dep) && dep->last_run_version != version) {
+                    ast = run_pass(pass->dependencies[d], ast, &version);
+                }
+            }
+            
+            ast = run_pass(i, ast, &version);
+        }
         
-        logger_log(LOG_DEBUG, "Removing redundant statements");
-        ast = remove_redundant_statements(ast);
+        stats.pass_iterations = iteration + 1;
+        if (version == start_version) break;
+        
+        if (iteration + 1 == budget) {
+            logger_log(LOG_WARNING, "Optimizer stopped after %d iterations without reaching a fixed point", budget);
+        }
+    }
+    
+    for (int i = 0; i < pass_count; i++) {
+        if (passes[i].is_lowering && pass_enabled(&passes[i])) {
+            ast = run_pass(i, ast, &version);
+        }
+    }
+    
+    return ast;
+}
+
+/**
+ * @brief Gets the per-pass statistics of the last optimize_ast() call
+ * 
+ * @param count Output for the number of entries (may be NULL)
+ * @return const OptimizerPassStats* Array of per-pass statistics
+ */
+const OptimizerPassStats* optimizer_get_pass_stats(int* count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)optimizer_get_pass_stats);
+    
+    init_pass_registry();
+    if (count) *count = pass_count;
+    return pass_stats;
+}
+
+/**
+ * @brief Main entry point for AST optimization
+ * 
+ * Runs the registered passes allowed by the current optimization level and
+ * options through the pass manager, to a fixed point:
+ * 
+ * Level 1:
+ * - Constant folding
+ * - Redundant statement removal
+ * - Tail-call elimination
+ * 
+ * Level 2:
+ * - Function inlining
+ * - Scope analysis (refreshed for constant propagation)
+ * - Constant propagation
+ * - Dead code elimination
+ * - Full unrolling of constant-trip range loops
+ * - Induction-variable strength reduction
+ * - Loop-invariant code motion
+ * - Partial unrolling of long range loops
+ * - Common subexpression elimination
+ * 
+ * Lowering (once after the fixed point, in this order):
+ * - Compile-time evaluation of pure calls with constant arguments (level 2)
+ * - String concatenation chain fusion (level 1 and above)
+ * 
+ * @param ast AST to optimize
+ * @return AstNode* Optimized AST, or NULL if input is NULL
+ */
+AstNode* optimize_ast(AstNode* ast) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)optimize_ast);
+    
+    if (!ast) {
+        logger_log(LOG_WARNING, "Attempted to optimize NULL AST");
+        return NULL;
     }
     
-    if (currentLevel >= OPT_LEVEL_2) {
-        logger_log(LOG_DEBUG, "Eliminating dead code");
-        ast = dead_code_elimination(ast);
+    // Reset optimization statistics
+    stats = (OptimizationStats){0};
+    cse_temp_counter = 0;
+    licm_temp_counter = 0;
+    iv_temp_counter = 0;
+    inline_temp_counter = 0;
+    unroll_temp_counter = 0;
+    tce_temp_counter = 0;
+    
+    if (!options.enable_scope_analysis && function_writes) {
+        // Without fresh analysis, calls must invalidate every fact
+        hashmap_free(function_writes, NULL);
+        function_writes = NULL;
     }
     
-    logger_log(LOG_INFO, "Optimization complete: %d optimizations applied (%d constants folded, %d redundant assignments, %d dead code blocks)",
-              stats.total_optimizations, stats.constant_folding_applied, 
-              stats.redundant_assignments_removed, stats.dead_code_removed);
+    logger_log(LOG_INFO, "Starting AST optimization at level %d", currentLevel);
+    
+    ast = run_pass_manager(ast);
+    
+    // Imported modules stay loaded in the module system; only the lookup cache is dropped
+    hashmap_free(inline_modules, NULL);
+    inline_modules = NULL;
+    
+    logger_log(LOG_INFO, "Optimization complete: %d optimizations applied in %d iterations (%d constants folded, %d constants propagated, %d redundant assignments, %d dead code blocks, %d common subexpressions, %d loop invariants hoisted, %d induction variables reduced, %d calls inlined, %d loops unrolled, %d tail calls eliminated, %d concatenations fused, %d calls evaluated)",
+              stats.total_optimizations, stats.pass_iterations, stats.constant_folding_applied, 
+              stats.constants_propagated, stats.redundant_assignments_removed,
+              stats.dead_code_removed, stats.cse_eliminated, stats.loop_invariants_hoisted,
+              stats.induction_variables_reduced, stats.functions_inlined, stats.loops_unrolled,
+              stats.tail_calls_eliminated, stats.concat_chains_fused, stats.calls_evaluated);
               
     return ast;
 }
\ No newline at end of file
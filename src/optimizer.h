@@ -21,13 +21,22 @@
  * 
  * Defines different levels of optimization that can be applied to the AST:
  * - OPT_LEVEL_0: No optimization, AST is left unchanged
- * - OPT_LEVEL_1: Basic optimizations (constant folding, redundant statement removal)
- * - OPT_LEVEL_2: Advanced optimizations (dead code elimination, constant propagation)
+ * - OPT_LEVEL_1: Basic optimizations (constant folding, redundant statement removal,
+ *   tail-call elimination)
+ * - OPT_LEVEL_2: Advanced optimizations (dead code elimination, constant propagation,
+ *   common subexpression elimination, loop-invariant code motion,
+ *   induction-variable strength reduction, function inlining, loop unrolling)
+ * - OPT_LEVEL_3: Aggressive optimizations (the level 2 passes with larger
+ *   budgets: bigger functions are inlined, longer loops unrolled, and the
+ *   fixed point and compile-time evaluation may run longer)
+ * 
+ * String concatenation chains are fused at level 1 and above.
  */
 typedef enum {
     OPT_LEVEL_0 = 0,  ///< No optimization
     OPT_LEVEL_1 = 1,  ///< Basic optimizations
-    OPT_LEVEL_2 = 2   ///< Advanced optimizations
+    OPT_LEVEL_2 = 2,  ///< Advanced optimizations
+    OPT_LEVEL_3 = 3   ///< Aggressive optimizations
 } OptimizerLevel;
 
 /**
@@ -39,6 +48,12 @@ typedef enum {
  * - Number of redundant assignments eliminated
  * - Count of constant propagations
  * - Number of common subexpressions eliminated
+ * - Number of loop-invariant expressions hoisted
+ * - Number of induction-variable products strength-reduced
+ * - Number of call sites inlined
+ * - Number of range loops unrolled
+ * - Number of self tail calls turned into loops
+ * - Number of string concatenation chains fused
  * - Variables properly scoped
  * - Total number of optimizations applied
  */
@@ -48,10 +63,37 @@ typedef struct {
     int redundant_assignments_removed; ///< Number of redundant assignments eliminated
     int constants_propagated;          ///< Number of constant propagations performed
     int cse_eliminated;                ///< Number of common subexpressions eliminated
+    int loop_invariants_hoisted;       ///< Number of loop-invariant expressions hoisted
+    int induction_variables_reduced;   ///< Number of iterator products replaced by additive updates
+    int functions_inlined;             ///< Number of call sites replaced by the callee's body
+    int loops_unrolled;                ///< Number of constant-trip range loops unrolled
+    int tail_calls_eliminated;         ///< Number of self tail calls turned into jumps
+    int concat_chains_fused;           ///< Number of concatenation chains turned into one concat_n call
+    int calls_evaluated;               ///< Number of calls replaced by their compile-time result
     int variables_scoped;              ///< Number of variables with proper scope analysis
     int total_optimizations;           ///< Total number of optimizations applied
+    int pass_iterations;               ///< Fixed-point iterations run by the pass manager
 } OptimizationStats;
 
+/**
+ * @brief Per-pass statistics recorded by the pass manager
+ * 
+ * One entry exists for every registered pass, in execution order. Passes
+ * that were disabled or skipped keep zero runs.
+ */
+typedef struct {
+    const char* name;                  ///< Pass name
+    int runs;                          ///< Number of times the pass ran
+    int changes;                       ///< Optimizations the pass reported
+    double elapsed_ms;                 ///< Total wall time spent in the pass
+} OptimizerPassStats;
+
+/** Default fixed-point iteration budget for the pass manager */
+#define OPTIMIZER_DEFAULT_MAX_ITERATIONS 8
+
+/** Default number of body copies per iteration of a partially unrolled loop */
+#define OPTIMIZER_DEFAULT_UNROLL_FACTOR 4
+
 /**
  * @brief Configuration options for the optimizer
  * 
@@ -61,7 +103,15 @@ typedef struct {
  * - Redundant statement removal
  * - Constant propagation
  * - Common subexpression elimination
+ * - Loop-invariant code motion
+ * - Induction-variable strength reduction
+ * - Function inlining
+ * - Loop unrolling and its partial unroll factor
+ * - String concatenation chain fusion
+ * - Tail-call elimination
+ * - Compile-time evaluation of pure function calls
  * - Scope analysis
+ * - The pass manager's fixed-point iteration budget
  */
 typedef struct {
     bool enable_constant_folding;           ///< Enable constant folding optimization
@@ -70,6 +120,15 @@ typedef struct {
     bool enable_constant_propagation;       ///< Enable constant propagation
     bool enable_common_subexpr_elimination; ///< Enable common subexpression elimination
     bool enable_scope_analysis;             ///< Enable scope analysis
+    bool enable_loop_invariant_code_motion; ///< Enable loop-invariant code motion
+    bool enable_induction_variables;        ///< Enable induction-variable strength reduction
+    bool enable_function_inlining;          ///< Enable inlining of small functions
+    bool enable_loop_unrolling;             ///< Enable unrolling of constant-trip range loops
+    int unroll_factor;                      ///< Partial unroll factor (0 = default, 1 = full unrolling only)
+    bool enable_concat_fusion;              ///< Enable fusion of string concatenation chains
+    bool enable_tail_call_elimination;      ///< Enable rewriting self tail calls into loops
+    bool enable_compile_time_evaluation;    ///< Enable executing pure calls with constant arguments
+    int max_iterations;                     ///< Fixed-point iteration budget (0 = default)
 } OptimizerOptions;
 
 /**
@@ -105,8 +164,9 @@ int optimizer_get_debug_level(void);
 /**
  * @brief Optimizes the Abstract Syntax Tree
  * 
- * Applies various optimization passes to the AST based on the current
- * optimization level and enabled options.
+ * Runs the registered optimization passes allowed by the current
+ * optimization level and enabled options, repeating them until no pass
+ * reports a change or the iteration budget is exhausted.
  * 
  * @param ast AST to optimize
  * @return AstNode* Optimized AST, or NULL if input is NULL
@@ -123,6 +183,14 @@ AstNode* optimize_ast(AstNode* ast);
  */
 OptimizationStats optimizer_get_stats(void);
 
+/**
+ * @brief Gets the per-pass statistics of the last optimize_ast() call
+ * 
+ * @param count Output for the number of entries (may be NULL)
+ * @return const OptimizerPassStats* Array of per-pass statistics, owned by the optimizer
+ */
+const OptimizerPassStats* optimizer_get_pass_stats(int* count);
+
 /**
  * @brief Sets the optimizer options
  * 
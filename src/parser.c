@@ -3,6 +3,8 @@
 #include "memory.h"   // Usamos memory_realloc y memory_free para la gestión de memoria.
 #include "error.h"    // Para usar error_report() y error_print_current()
 #include "logger.h"
+#include "types.h"    // Para anotar los tipos declarados de los parámetros
+#include <errno.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
@@ -28,7 +30,9 @@ static AstNode *parseStatement(void);
 static AstNode *parseExpression(void);
 static AstNode *parseTerm(void);
 static AstNode *parseFactor(void);
+static AstNode *parseFactorNode(void);
 static AstNode *parseFuncDef(void);
+static AstNode *parseAnnotatedFuncDef(void);
 static AstNode *parseReturn(void);
 static AstNode *parseIfStmt(void);
 static AstNode *parseForStmt(void);
@@ -270,6 +274,8 @@ static AstNode *parsePostfix(AstNode *node) {
             
             advanceToken(); // consume ')'
             
+            // El objeto ahora pertenece a la llamada; liberar solo el nodo de acceso
+            memberNode->memberAccess.object = NULL;
             freeAstNode(memberNode);
             
             node = funcCall;
@@ -354,8 +360,8 @@ AstNode *parseProgram(void) {
     advanceToken();  // Obtener el primer token
 
     // Parse zero or more top-level function definitions
-    while (currentToken.type == TOKEN_FUNC) {
-        parseFuncDef();
+    while (currentToken.type == TOKEN_FUNC || currentToken.type == TOKEN_AT) {
+        parseAnnotatedFuncDef();
         // ...existing code...
     }
 
@@ -400,9 +406,12 @@ static AstNode *parseStatement(void) {
     }
     
     AstNode* result = NULL;
+    Token startToken = currentToken;  // Posición de la sentencia (perfiles y diagnósticos)
     
     if (currentToken.type == TOKEN_FUNC) {
         result = parseFuncDef();
+    } else if (currentToken.type == TOKEN_AT) {
+        result = parseAnnotatedFuncDef();
     } else if (currentToken.type == TOKEN_RETURN) {
         result = parseReturn();
     } else if (currentToken.type == TOKEN_PRINT) {
@@ -627,9 +636,58 @@ static AstNode *parseStatement(void) {
                     assignNode->varAssign.initializer = value;
                     freeAstNode(memberNode);
                     result = assignNode;
+                } else if (currentToken.type == TOKEN_LPAREN) {
+                    // obj.método(...) como sentencia: el objeto es el primer argumento, como en parsePostfix
+                    advanceToken(); // consume '('
+                    AstNode *funcCall = createAstNode(AST_FUNC_CALL);
+                    parser_stats.nodes_created++;
+                    snprintf(funcCall->funcCall.name, sizeof(funcCall->funcCall.name),
+                             "%s.%s", temp.lexeme, memberNode->memberAccess.member);
+                    funcCall->funcCall.argCount = 1;
+                    funcCall->funcCall.arguments = memory_realloc(NULL, sizeof(AstNode *));
+                    funcCall->funcCall.arguments[0] = memberNode->memberAccess.object;
+                    memberNode->memberAccess.object = NULL;
+                    freeAstNode(memberNode);
+                    while (currentToken.type != TOKEN_RPAREN) {
+                        AstNode *arg = parseExpression();
+                        funcCall->funcCall.argCount++;
+                        funcCall->funcCall.arguments = memory_realloc(funcCall->funcCall.arguments,
+                                                                      funcCall->funcCall.argCount * sizeof(AstNode *));
+                        funcCall->funcCall.arguments[funcCall->funcCall.argCount - 1] = arg;
+                        if (currentToken.type == TOKEN_COMMA)
+                            advanceToken();
+                        else if (currentToken.type != TOKEN_RPAREN)
+                            parserError("Expected ',' or ')' in method call argument list", currentToken);
+                    }
+                    advanceToken(); // consume ')'
+                    result = funcCall;
                 } else {
                     result = parsePostfix(memberNode);
                 }
+            } else if (currentToken.type == TOKEN_LBRACKET) {
+                // a[i] = v como sentencia; cualquier otro uso es un acceso normal
+                advanceToken(); // consume '['
+                AstNode *index = parseExpression();
+                if (currentToken.type != TOKEN_RBRACKET)
+                    parserError("Expected ']'", currentToken);
+                advanceToken(); // consume ']'
+                if (currentToken.type == TOKEN_ASSIGN) {
+                    advanceToken(); // consume '='
+                    AstNode *assignNode = createAstNode(AST_ARRAY_ASSIGN);
+                    parser_stats.nodes_created++;
+                    strncpy(assignNode->arrayAssign.name, temp.lexeme, sizeof(assignNode->arrayAssign.name));
+                    assignNode->arrayAssign.index = index;
+                    assignNode->arrayAssign.value = parseExpression();
+                    result = assignNode;
+                } else {
+                    AstNode *accessNode = createAstNode(AST_ARRAY_ACCESS);
+                    parser_stats.nodes_created++;
+                    accessNode->arrayAccess.array = createAstNode(AST_IDENTIFIER);
+                    strncpy(accessNode->arrayAccess.array->identifier.name, temp.lexeme,
+                            sizeof(accessNode->arrayAccess.array->identifier.name));
+                    accessNode->arrayAccess.index = index;
+                    result = parsePostfix(accessNode);
+                }
             } else if (currentToken.type == TOKEN_ASSIGN) {
                 advanceToken(); // consume '='
                 AstNode *value;
@@ -685,6 +743,11 @@ static AstNode *parseStatement(void) {
         result = parseExpression();
     }
     
+    if (result && result->line == 0) {
+        result->line = startToken.line;
+        result->col = startToken.col;
+    }
+    
     if (debug_level >= 3 && result) {
         logger_log(LOG_DEBUG, "Finished parsing statement, type: %d", result->type);
     }
@@ -768,19 +831,25 @@ static AstNode *parseExpression(void) {
         binOp->binaryOp.left = node;
         binOp->binaryOp.op = op;
         binOp->binaryOp.right = right;
+        // La operación empieza donde empieza su operando izquierdo
+        if (node) {
+            binOp->line = node->line;
+            binOp->col = node->col;
+        }
         node = binOp;
     }
     
     return node;
 }
 
-/* parseTerm: Maneja operadores '*' y '/' */
+/* parseTerm: Maneja operadores '*', '/' y '%' */
 static AstNode *parseTerm(void) {
     error_push_debug(__func__, __FILE__, __LINE__, (void*)parseTerm);
     
     AstNode *left = parseFactor();
     
-    while (currentToken.type == TOKEN_ASTERISK || currentToken.type == TOKEN_SLASH) {
+    while (currentToken.type == TOKEN_ASTERISK || currentToken.type == TOKEN_SLASH ||
+           currentToken.type == TOKEN_PERCENT) {
         char op = currentToken.lexeme[0];
         advanceToken();
         
@@ -796,15 +865,31 @@ static AstNode *parseTerm(void) {
         binOp->binaryOp.left = left;
         binOp->binaryOp.op = op;
         binOp->binaryOp.right = right;
+        if (left) {
+            binOp->line = left->line;
+            binOp->col = left->col;
+        }
         left = binOp;
     }
     
     return left;
 }
 
-/* parseFactor: Maneja números, cadenas, identificadores, agrupación, new y this */
+/* parseFactor: Parsea un factor y le da la posición de su primer token,
+   para que los mensajes sobre expresiones (como las optimization remarks) la indiquen */
 static AstNode *parseFactor(void) {
-    error_push_debug(__func__, __FILE__, __LINE__, (void*)parseFactor);
+    Token start = currentToken;
+    AstNode *node = parseFactorNode();
+    if (node && node->line == 0) {
+        node->line = start.line;
+        node->col = start.col;
+    }
+    return node;
+}
+
+/* parseFactorNode: Maneja números, cadenas, identificadores, agrupación, new y this */
+static AstNode *parseFactorNode(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)parseFactorNode);
     
     AstNode *node = NULL;
     
@@ -826,7 +911,19 @@ static AstNode *parseFactor(void) {
     if (currentToken.type == TOKEN_NUMBER) {
         node = createAstNode(AST_NUMBER_LITERAL);
         parser_stats.nodes_created++;
-        node->numberLiteral.value = atof(currentToken.lexeme);
+        // Con punto decimal es un float aunque su valor sea entero: 2.0 / 4 vale 0.5
+        if (strchr(currentToken.lexeme, '.')) {
+            node->numberLiteral.value = atof(currentToken.lexeme);
+            node->numberLiteral.isDouble = true;
+        } else {
+            // Los enteros se leen exactos: un double redondearía los mayores que 2^53
+            errno = 0;
+            long long value = strtoll(currentToken.lexeme, NULL, 10);
+            if (errno == ERANGE) {
+                parserError("Integer literal does not fit in a 64-bit int", currentToken);
+            }
+            setIntegerLiteral(node, value);
+        }
         
         if (debug_level >= 3) {
             logger_log(LOG_DEBUG, "Created number literal: %g", node->numberLiteral.value);
@@ -987,14 +1084,26 @@ static AstNode* parseCurryExpression(AstNode* baseFunc) {
     return curryNode;
 }
 
+/* declaredParamType: Tipo primitivo de una anotación de parámetro, o NULL si no es primitivo */
+static Type *declaredParamType(const char *name) {
+    if (strcmp(name, "int") == 0) return create_primitive_type(TYPE_INT);
+    if (strcmp(name, "float") == 0) return create_primitive_type(TYPE_FLOAT);
+    if (strcmp(name, "bool") == 0) return create_primitive_type(TYPE_BOOL);
+    if (strcmp(name, "string") == 0) return create_primitive_type(TYPE_STRING);
+    return NULL;
+}
+
 /* parseFuncDef: Parsea una definición de función */
 static AstNode *parseFuncDef(void) {
+    Token funcToken = currentToken;
     advanceToken(); // consume 'func'
     
     if (currentToken.type != TOKEN_IDENTIFIER)
         parserError("Expected function name", currentToken);
     
     AstNode *funcNode = createAstNode(AST_FUNC_DEF);
+    funcNode->line = funcToken.line;
+    funcNode->col = funcToken.col;
     strncpy(funcNode->funcDef.name, currentToken.lexeme, sizeof(funcNode->funcDef.name));
     advanceToken();
     
@@ -1019,6 +1128,7 @@ static AstNode *parseFuncDef(void) {
             advanceToken();
             if (currentToken.type != TOKEN_IDENTIFIER && currentToken.type != TOKEN_INT && currentToken.type != TOKEN_FLOAT)
                 parserError("Expected parameter type", currentToken);
+            param->inferredType = declaredParamType(currentToken.lexeme);
             advanceToken();
         }
         
@@ -1034,6 +1144,7 @@ static AstNode *parseFuncDef(void) {
         advanceToken();
         if (currentToken.type != TOKEN_IDENTIFIER && currentToken.type != TOKEN_INT && currentToken.type != TOKEN_FLOAT)
             parserError("Expected return type", currentToken);
+        strncpy(funcNode->funcDef.returnType, currentToken.lexeme, sizeof(funcNode->funcDef.returnType) - 1);
         advanceToken();
     }
     
@@ -1061,6 +1172,42 @@ static AstNode *parseFuncDef(void) {
     return funcNode;
 }
 
+/* parseAnnotatedFuncDef: Parsea @inline / @noinline / @export seguidos de una definición de función */
+static AstNode *parseAnnotatedFuncDef(void) {
+    int attributes = FUNC_ATTR_NONE;
+    
+    while (currentToken.type == TOKEN_AT) {
+        advanceToken(); // consume '@'
+        // "export" es palabra reservada, así que llega como TOKEN_EXPORT
+        if (currentToken.type == TOKEN_EXPORT) {
+            attributes |= FUNC_ATTR_EXPORT;
+            advanceToken();
+            skipStatementSeparators();
+            continue;
+        }
+        if (currentToken.type != TOKEN_IDENTIFIER)
+            parserError("Expected annotation name after '@'", currentToken);
+        if (strcmp(currentToken.lexeme, "inline") == 0) {
+            attributes |= FUNC_ATTR_INLINE;
+        } else if (strcmp(currentToken.lexeme, "noinline") == 0) {
+            attributes |= FUNC_ATTR_NOINLINE;
+        } else {
+            parserError("Unknown function annotation", currentToken);
+        }
+        advanceToken();
+        skipStatementSeparators();
+    }
+    
+    if ((attributes & FUNC_ATTR_INLINE) && (attributes & FUNC_ATTR_NOINLINE))
+        parserError("Function cannot be both @inline and @noinline", currentToken);
+    if (currentToken.type != TOKEN_FUNC)
+        parserError("Expected 'func' after function annotation", currentToken);
+    
+    AstNode *funcNode = parseFuncDef();
+    funcNode->funcDef.attributes |= attributes;
+    return funcNode;
+}
+
 /* parseClassDef: Parsea class <Name>; ... end */
 static AstNode *parseClassDef(void) {
     advanceToken();  // consume 'class'
@@ -0,0 +1,307 @@
+/**
+ * @file profile.c
+ * @brief Implementation of profile generation and use for the Lyn compiler
+ *
+ * In generate mode the code generator asks for one counter per program
+ * point; counters are numbered in creation order and their keys become a
+ * table in the generated C, next to the counter array and the writer that
+ * atexit() runs. In use mode the profile file is read into a map from key to
+ * count, and the largest count sets the scale for hot and cold.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "profile.h"
+#include "hashmap.h"
+#include "error.h"
+#include "logger.h"
+
+/** Longest key: site name, a space and a function name or "line:col" */
+#define PROFILE_MAX_KEY 320
+
+/** Current mode */
+static ProfileMode mode = PROFILE_OFF;
+/** Profile file to write (generate) or read (use) */
+static char profilePath[1024] = "";
+/** Generate mode: key -> counter index + 1 */
+static HashMap* counterIndex = NULL;
+/** Generate mode: keys in counter order */
+static char** counterKeys = NULL;
+static int counterCount = 0;
+static int counterCapacity = 0;
+/** Use mode: key -> heap-allocated count */
+static HashMap* counts = NULL;
+/** Use mode: largest count in the profile */
+static unsigned long long maxCount = 0;
+/** Statistics */
+static ProfileStats stats = {0};
+
+/**
+ * @brief Gets the name a site kind has in profile keys
+ */
+static const char* site_name(ProfileSite site) {
+    switch (site) {
+        case PROFILE_SITE_FUNCTION:   return "function";
+        case PROFILE_SITE_THEN:       return "then";
+        case PROFILE_SITE_ELSE:       return "else";
+        case PROFILE_SITE_LOOP_ENTRY: return "loop-entry";
+        case PROFILE_SITE_LOOP_BODY:  return "loop-body";
+        case PROFILE_SITE_CATCH:      return "catch";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Builds the key of a program point
+ *
+ * @return bool false if the node cannot be identified (no name or no position)
+ */
+static bool make_key(ProfileSite site, const AstNode* node, char* key, size_t size) {
+    if (!node) return false;
+    if (site == PROFILE_SITE_FUNCTION) {
+        if (node->type != AST_FUNC_DEF || node->funcDef.name[0] == '\0') return false;
+        snprintf(key, size, "%s %s", site_name(site), node->funcDef.name);
+        return true;
+    }
+    if (node->line <= 0) return false;
+    snprintf(key, size, "%s %d:%d", site_name(site), node->line, node->col);
+    return true;
+}
+
+void profile_cleanup(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_cleanup);
+
+    hashmap_free(counterIndex, NULL);
+    counterIndex = NULL;
+    for (int i = 0; i < counterCount; i++) {
+        free(counterKeys[i]);
+    }
+    free(counterKeys);
+    counterKeys = NULL;
+    counterCount = 0;
+    counterCapacity = 0;
+
+    hashmap_free(counts, free);
+    counts = NULL;
+    maxCount = 0;
+}
+
+void profile_set_mode(ProfileMode newMode, const char* path) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_set_mode);
+
+    profile_cleanup();
+    stats = (ProfileStats){0};
+    mode = newMode;
+    profilePath[0] = '\0';
+    if (mode != PROFILE_OFF && path) {
+        snprintf(profilePath, sizeof(profilePath), "%s", path);
+    }
+    if (mode != PROFILE_OFF) {
+        logger_log(LOG_INFO, "Profile %s: %s", mode == PROFILE_GENERATE ? "generation" : "use", profilePath);
+    }
+}
+
+ProfileMode profile_get_mode(void) {
+    return mode;
+}
+
+bool profile_load(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_load);
+
+    if (mode != PROFILE_USE) return false;
+
+    FILE* file = fopen(profilePath, "r");
+    if (!file) {
+        char errorMsg[1100];
+        snprintf(errorMsg, sizeof(errorMsg), "Could not open profile %s; compiling without it", profilePath);
+        logger_log(LOG_WARNING, "%s", errorMsg);
+        error_report("Profile", __LINE__, 0, errorMsg, ERROR_IO);
+        return false;
+    }
+
+    char line[PROFILE_MAX_KEY + 64];
+    if (!fgets(line, sizeof(line), file) || strncmp(line, PROFILE_FILE_HEADER, strlen(PROFILE_FILE_HEADER)) != 0) {
+        logger_log(LOG_WARNING, "Profile %s has no '%s' header; compiling without it", profilePath, PROFILE_FILE_HEADER);
+        fclose(file);
+        return false;
+    }
+
+    counts = hashmap_create(64);
+    if (!counts) {
+        error_report("Profile", __LINE__, 0, "Failed to allocate the profile table", ERROR_MEMORY);
+        fclose(file);
+        return false;
+    }
+
+    while (fgets(line, sizeof(line), file)) {
+        char kind[32];
+        char point[256];
+        unsigned long long count;
+        if (sscanf(line, "%31s %255s %llu", kind, point, &count) != 3) {
+            logger_log(LOG_DEBUG, "Skipping malformed profile line: %s", line);
+            continue;
+        }
+        unsigned long long* value = malloc(sizeof(unsigned long long));
+        if (!value) {
+            error_report("Profile", __LINE__, 0, "Failed to allocate a profile count", ERROR_MEMORY);
+            break;
+        }
+        *value = count;
+        char key[PROFILE_MAX_KEY];
+        snprintf(key, sizeof(key), "%s %s", kind, point);
+        void* old = NULL;
+        if (!hashmap_put(counts, key, value, &old)) {
+            free(value);
+            continue;
+        }
+        free(old);
+        if (count > maxCount) maxCount = count;
+        stats.entries_loaded++;
+    }
+    fclose(file);
+
+    logger_log(LOG_INFO, "Profile loaded: %d counts, largest %llu", stats.entries_loaded, maxCount);
+    return true;
+}
+
+int profile_counter(ProfileSite site, const AstNode* node) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_counter);
+
+    char key[PROFILE_MAX_KEY];
+    if (mode != PROFILE_GENERATE || !make_key(site, node, key, sizeof(key))) return -1;
+
+    if (!counterIndex) {
+        counterIndex = hashmap_create(64);
+        if (!counterIndex) return -1;
+    }
+    // The index is stored off by one so that NULL means "no counter yet"
+    intptr_t stored = (intptr_t)hashmap_get(counterIndex, key);
+    if (stored > 0) return (int)(stored - 1);
+
+    if (counterCount == counterCapacity) {
+        int capacity = counterCapacity ? counterCapacity * 2 : 64;
+        char** keys = realloc(counterKeys, capacity * sizeof(char*));
+        if (!keys) {
+            error_report("Profile", __LINE__, 0, "Failed to grow the profile counter table", ERROR_MEMORY);
+            return -1;
+        }
+        counterKeys = keys;
+        counterCapacity = capacity;
+    }
+    char* copy = strdup(key);
+    if (!copy || !hashmap_put(counterIndex, key, (void*)(intptr_t)(counterCount + 1), NULL)) {
+        free(copy);
+        return -1;
+    }
+    counterKeys[counterCount] = copy;
+    stats.counters_emitted++;
+    return counterCount++;
+}
+
+void profile_emit_declarations(FILE* out) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_emit_declarations);
+
+    if (mode != PROFILE_GENERATE || !out) return;
+    fprintf(out, "// Profile counters (--profile-generate), written to the profile at exit\n");
+    fprintf(out, "extern unsigned long long __lyn_prof_counts[];\n");
+    fprintf(out, "static void __lyn_prof_write(void);\n");
+    fprintf(out, "\n");
+}
+
+void profile_emit_runtime(FILE* out) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)profile_emit_runtime);
+
+    if (mode != PROFILE_GENERATE || !out) return;
+    int size = counterCount > 0 ? counterCount : 1;
+
+    fprintf(out, "\n// Profile counters and their keys\n");
+    fprintf(out, "unsigned long long __lyn_prof_counts[%d];\n", size);
+    fprintf(out, "static const char* const __lyn_prof_keys[%d] = {\n", size);
+    for (int i = 0; i < counterCount; i++) {
+        fprintf(out, "    \"%s\",\n", counterKeys[i]);
+    }
+    if (counterCount == 0) fprintf(out, "    \"\"\n");
+    fprintf(out, "};\n");
+
+    fprintf(out, "static void __lyn_prof_write(void) {\n");
+    fprintf(out, "    FILE* profile = fopen(\"");
+    for (const char* c = profilePath; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', out);
+        fputc(*c, out);
+    }
+    fprintf(out, "\", \"w\");\n");
+    fprintf(out, "    if (!profile) return;\n");
+    fprintf(out, "    fprintf(profile, \"%s\\n\");\n", PROFILE_FILE_HEADER);
+    fprintf(out, "    for (int i = 0; i < %d; i++) {\n", counterCount);
+    fprintf(out, "        fprintf(profile, \"%%s %%llu\\n\", __lyn_prof_keys[i], __lyn_prof_counts[i]);\n");
+    fprintf(out, "    }\n");
+    fprintf(out, "    fclose(profile);\n");
+    fprintf(out, "}\n");
+}
+
+bool profile_lookup(ProfileSite site, const AstNode* node, unsigned long long* count) {
+    char key[PROFILE_MAX_KEY];
+    if (mode != PROFILE_USE || !counts || !make_key(site, node, key, sizeof(key))) return false;
+    unsigned long long* value = hashmap_get(counts, key);
+    if (!value) return false;
+    if (count) *count = *value;
+    return true;
+}
+
+ProfileTemperature profile_temperature(ProfileSite site, const AstNode* node) {
+    unsigned long long count;
+    if (!profile_lookup(site, node, &count)) return PROFILE_UNKNOWN;
+    if (count == 0) return PROFILE_COLD;
+    if (count >= PROFILE_HOT_MIN_COUNT && count * PROFILE_HOT_RATIO >= maxCount) return PROFILE_HOT;
+    return PROFILE_WARM;
+}
+
+int profile_branch_hint(const AstNode* ifNode) {
+    unsigned long long taken, notTaken;
+    if (!ifNode || ifNode->type != AST_IF_STMT ||
+        !profile_lookup(PROFILE_SITE_THEN, ifNode, &taken) ||
+        !profile_lookup(PROFILE_SITE_ELSE, ifNode, &notTaken)) {
+        return -1;
+    }
+    unsigned long long total = taken + notTaken;
+    if (total < PROFILE_BRANCH_MIN_COUNT) return -1;
+
+    int hint = -1;
+    if (taken * 100 >= total * PROFILE_BRANCH_BIAS_PERCENT) {
+        hint = 1;
+    } else if (notTaken * 100 >= total * PROFILE_BRANCH_BIAS_PERCENT) {
+        hint = 0;
+    }
+    if (hint >= 0) stats.branches_hinted++;
+    return hint;
+}
+
+const char* profile_function_attribute(const AstNode* def) {
+    switch (profile_temperature(PROFILE_SITE_FUNCTION, def)) {
+        case PROFILE_HOT:
+            stats.functions_hot++;
+            return "__attribute__((hot)) ";
+        case PROFILE_COLD:
+            stats.functions_cold++;
+            return "__attribute__((cold)) ";
+        default:
+            return "";
+    }
+}
+
+bool profile_catch_is_cold(const AstNode* tryCatch) {
+    if (mode != PROFILE_USE || profile_temperature(PROFILE_SITE_CATCH, tryCatch) == PROFILE_HOT) return false;
+    stats.blocks_cold++;
+    return true;
+}
+
+void profile_note_decision(const char* what, const char* name) {
+    stats.decisions_changed++;
+    logger_log(LOG_DEBUG, "Profile: %s '%s'", what, name ? name : "");
+}
+
+ProfileStats profile_get_stats(void) {
+    return stats;
+}
@@ -0,0 +1,218 @@
+/**
+ * @file profile.h
+ * @brief Profile-guided optimization support for the Lyn compiler
+ *
+ * Profiles are collected in two builds of the same program:
+ * - With --profile-generate the generated C counts how often every function
+ *   is entered, every if branch is taken, every loop is reached and iterated
+ *   and every catch block runs, and writes the counts to a profile file when
+ *   the program exits
+ * - With --profile-use the file is read back before optimization; the
+ *   inliner, the loop unroller and the code generator ask it which functions,
+ *   loops and branches are hot or cold
+ *
+ * Counters are identified by text keys so that a profile survives rebuilds
+ * as long as the source does not move: functions by name, statements by the
+ * line and column where they start. The file is plain text:
+ *
+ *     lyn-profile 1
+ *     function fib 1664079
+ *     then 12:9 832040
+ *     loop-body 30:5 1000
+ */
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "ast.h"
+
+/** First line of every profile file */
+#define PROFILE_FILE_HEADER "lyn-profile 1"
+
+/** Smallest count that can make a function, loop or block hot */
+#define PROFILE_HOT_MIN_COUNT 100
+
+/** A count is hot when it is at least 1/PROFILE_HOT_RATIO of the largest count */
+#define PROFILE_HOT_RATIO 16
+
+/** Share of executions (percent) one side of an if needs to get a branch hint */
+#define PROFILE_BRANCH_BIAS_PERCENT 90
+
+/** Executions an if needs before its branch counts are trusted */
+#define PROFILE_BRANCH_MIN_COUNT 16
+
+/**
+ * @brief How the current compilation uses profiles
+ */
+typedef enum {
+    PROFILE_OFF,       ///< No instrumentation, no profile
+    PROFILE_GENERATE,  ///< Emit counters and write a profile at exit
+    PROFILE_USE        ///< Read a profile and let it steer optimization
+} ProfileMode;
+
+/**
+ * @brief Kinds of program points that carry a counter
+ */
+typedef enum {
+    PROFILE_SITE_FUNCTION,    ///< Function entry (keyed by function name)
+    PROFILE_SITE_THEN,        ///< Then branch of an if
+    PROFILE_SITE_ELSE,        ///< Else branch of an if (counted even when absent)
+    PROFILE_SITE_LOOP_ENTRY,  ///< Loop reached
+    PROFILE_SITE_LOOP_BODY,   ///< Loop iteration
+    PROFILE_SITE_CATCH        ///< Catch block entered
+} ProfileSite;
+
+/**
+ * @brief Execution frequency class of a profiled point
+ */
+typedef enum {
+    PROFILE_UNKNOWN,  ///< Not profiled (no profile, or the point is not in it)
+    PROFILE_COLD,     ///< Never executed in the training run
+    PROFILE_WARM,     ///< Executed, but not often enough to be hot
+    PROFILE_HOT       ///< Among the most executed points of the program
+} ProfileTemperature;
+
+/**
+ * @brief Statistics about profile generation and use
+ */
+typedef struct {
+    int counters_emitted;     ///< Counters placed in the instrumented program
+    int entries_loaded;       ///< Counts read from the profile file
+    int functions_hot;        ///< Functions marked __attribute__((hot))
+    int functions_cold;       ///< Functions marked __attribute__((cold))
+    int branches_hinted;      ///< If conditions wrapped in __builtin_expect
+    int blocks_cold;          ///< Catch blocks marked cold
+    int decisions_changed;    ///< Inlining and unrolling decisions changed by the profile
+} ProfileStats;
+
+/**
+ * @brief Selects the profile mode and file for this compilation
+ *
+ * Resets the counters, the loaded profile and the statistics.
+ *
+ * @param mode Profile mode
+ * @param path Profile file (copied); ignored when mode is PROFILE_OFF
+ */
+void profile_set_mode(ProfileMode mode, const char* path);
+
+/**
+ * @brief Gets the current profile mode
+ *
+ * @return ProfileMode Current mode
+ */
+ProfileMode profile_get_mode(void);
+
+/**
+ * @brief Reads the profile file selected with profile_set_mode()
+ *
+ * Lines that cannot be parsed are skipped. A missing file or a wrong header
+ * is reported and leaves the profile empty, so every query answers
+ * PROFILE_UNKNOWN and compilation proceeds as without a profile.
+ *
+ * @return bool true if the profile was loaded
+ */
+bool profile_load(void);
+
+/**
+ * @brief Returns the counter for a program point, creating it if needed
+ *
+ * Every node with the same key shares one counter, so copies made by the
+ * optimizer add up to the counts of the source statement.
+ *
+ * @param site Kind of program point
+ * @param node Function definition (for PROFILE_SITE_FUNCTION) or statement
+ * @return int Counter index, or -1 if not generating or the node has no position
+ */
+int profile_counter(ProfileSite site, const AstNode* node);
+
+/**
+ * @brief Emits the declarations the instrumented code refers to
+ *
+ * Must be written before any counter is incremented.
+ *
+ * @param out Generated C file
+ */
+void profile_emit_declarations(FILE* out);
+
+/**
+ * @brief Emits the counter array, its key table and the exit-time writer
+ *
+ * Must be written after the last counter has been created.
+ *
+ * @param out Generated C file
+ */
+void profile_emit_runtime(FILE* out);
+
+/**
+ * @brief Looks up the count of a program point in the loaded profile
+ *
+ * @param site Kind of program point
+ * @param node Function definition or statement
+ * @param count Output for the count
+ * @return bool true if the profile has the point
+ */
+bool profile_lookup(ProfileSite site, const AstNode* node, unsigned long long* count);
+
+/**
+ * @brief Classifies a program point by its count in the loaded profile
+ *
+ * @param site Kind of program point
+ * @param node Function definition or statement
+ * @return ProfileTemperature Frequency class
+ */
+ProfileTemperature profile_temperature(ProfileSite site, const AstNode* node);
+
+/**
+ * @brief Gives the direction an if statement almost always takes
+ *
+ * Hints returned are counted in the statistics.
+ *
+ * @param ifNode If statement
+ * @return int 1 if the then branch is likely, 0 if the else side is, -1 if neither
+ */
+int profile_branch_hint(const AstNode* ifNode);
+
+/**
+ * @brief Gets the hot/cold attribute for a function definition
+ *
+ * Attributes returned are counted in the statistics.
+ *
+ * @param def Function definition
+ * @return const char* "__attribute__((hot)) ", "__attribute__((cold)) " or ""
+ */
+const char* profile_function_attribute(const AstNode* def);
+
+/**
+ * @brief Checks whether a catch block should be laid out as cold code
+ *
+ * Catch blocks are cold unless the profile shows them hot. Cold blocks are
+ * counted in the statistics.
+ *
+ * @param tryCatch Try/catch statement
+ * @return bool true if the catch block should be marked cold
+ */
+bool profile_catch_is_cold(const AstNode* tryCatch);
+
+/**
+ * @brief Counts an optimization decision that the profile changed
+ *
+ * @param what Description for the debug log
+ * @param name Function or loop the decision is about
+ */
+void profile_note_decision(const char* what, const char* name);
+
+/**
+ * @brief Gets the profile statistics
+ *
+ * @return ProfileStats Current statistics
+ */
+ProfileStats profile_get_stats(void);
+
+/**
+ * @brief Releases the counters and the loaded profile
+ */
+void profile_cleanup(void);
+
+#endif /* PROFILE_H */
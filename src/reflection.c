@@ -12,19 +12,26 @@
  */
 
 #include "reflection.h"
+#include "hashmap.h"
 #include "error.h"
 #include "logger.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
-/** Maximum number of types that can be cached */
-#define MAX_CACHED_TYPES 1024
+/**
+ * @brief Cached type information sharing one type name
+ *
+ * Distinct types can print the same name, so each name keeps every
+ * TypeInfo created for it, oldest first.
+ */
+typedef struct TypeCacheEntry {
+    TypeInfo* info;                  ///< Cached type information
+    struct TypeCacheEntry* next;     ///< Next type with the same name
+} TypeCacheEntry;
 
-/** Cache for storing type information to avoid repeated lookups */
-static TypeInfo* typeCache[MAX_CACHED_TYPES];
-/** Current number of types in the cache */
-static int typeCacheCount = 0;
+/** Cache for storing type information to avoid repeated lookups, keyed by type name */
+static HashMap* typeCache = NULL;
 
 /**
  * @brief Gets runtime type information for an AST expression
@@ -59,16 +66,26 @@ RuntimeType* get_runtime_type(AstNode* expr) {
 TypeInfo* get_type_info(Type* type) {
     if (!type) return NULL;
 
-    // Check cache first
-    for (int i = 0; i < typeCacheCount; i++) {
-        if (are_types_equal(typeCache[i]->type, type)) {
-            return typeCache[i];
+    // Check cache first; the name narrows the lookup, the type comparison confirms it
+    char typeName[256];
+    strncpy(typeName, typeToString(type), sizeof(typeName) - 1);
+    typeName[sizeof(typeName) - 1] = '\0';
+    TypeCacheEntry* last = NULL;
+    for (TypeCacheEntry* entry = hashmap_get(typeCache, typeName); entry; entry = entry->next) {
+        if (are_types_equal(entry->info->type, type)) {
+            return entry->info;
         }
+        last = entry;
     }
 
     // Create new type info
     TypeInfo* info = malloc(sizeof(TypeInfo));
-    strncpy(info->name, typeToString(type), sizeof(info->name) - 1);
+    if (!info) {
+        error_report("Reflection", __LINE__, 0, "Failed to allocate type info", ERROR_MEMORY);
+        return NULL;
+    }
+    strncpy(info->name, typeName, sizeof(info->name) - 1);
+    info->name[sizeof(info->name) - 1] = '\0';
     info->type = clone_type(type);
     info->fields = NULL;
     info->fieldCount = 0;
@@ -93,9 +110,21 @@ TypeInfo* get_type_info(Type* type) {
             break;
     }
 
-    // Cache the type info
-    if (typeCacheCount < MAX_CACHED_TYPES) {
-        typeCache[typeCacheCount++] = info;
+    // Cache the type info after the other types with the same name
+    if (!typeCache) {
+        typeCache = hashmap_create(64);
+    }
+    TypeCacheEntry* entry = malloc(sizeof(TypeCacheEntry));
+    if (!entry) {
+        error_report("Reflection", __LINE__, 0, "Failed to allocate type cache entry", ERROR_MEMORY);
+        return info;
+    }
+    entry->info = info;
+    entry->next = NULL;
+    if (last) {
+        last->next = entry;
+    } else if (!hashmap_put(typeCache, info->name, entry, NULL)) {
+        free(entry);
     }
 
     return info;
@@ -236,11 +265,6 @@ void print_type_info(TypeInfo* info) {
  * @return TypeInfo* Type information if found, NULL otherwise
  */
 TypeInfo* get_type_info_by_name(const char* name) {
-    // Search in cache first
-    for (int i = 0; i < typeCacheCount; i++) {
-        if (strcmp(typeCache[i]->name, name) == 0) {
-            return typeCache[i];
-        }
-    }
-    return NULL;
+    TypeCacheEntry* entry = hashmap_get(typeCache, name);
+    return entry ? entry->info : NULL;
 }
@@ -0,0 +1,127 @@
+/**
+ * @file remarks.c
+ * @brief Implementation of the optimization remarks stream
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include "remarks.h"
+#include "hashmap.h"
+#include "error.h"
+#include "logger.h"
+
+/** Longest reason kept; longer ones are cut */
+#define REMARK_MAX_REASON 256
+
+/** Remarks file (NULL when disabled) */
+static FILE* remarksFile = NULL;
+/** Source file the remarks are about, escaped for JSON */
+static char* escapedSource = NULL;
+/** Remarks already written, so that fixed-point iterations do not repeat them */
+static HashMap* written = NULL;
+/** Statistics */
+static RemarksStats stats = {0};
+
+/**
+ * @brief Escapes a string for use inside a JSON string literal
+ *
+ * @param text Text to escape
+ * @param out Output buffer
+ * @param size Size of the output buffer
+ */
+static void json_escape(const char* text, char* out, size_t size) {
+    size_t used = 0;
+    for (const unsigned char* c = (const unsigned char*)text; *c && used + 7 < size; c++) {
+        if (*c == '"' || *c == '\\') {
+            out[used++] = '\\';
+            out[used++] = (char)*c;
+        } else if (*c == '\n') {
+            out[used++] = '\\';
+            out[used++] = 'n';
+        } else if (*c == '\t') {
+            out[used++] = '\\';
+            out[used++] = 't';
+        } else if (*c < 0x20) {
+            used += snprintf(out + used, size - used, "\\u%04x", *c);
+        } else {
+            out[used++] = (char)*c;
+        }
+    }
+    out[used] = '\0';
+}
+
+bool remarks_open(const char* path, const char* sourcePath) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)remarks_open);
+
+    remarks_close();
+    stats = (RemarksStats){0};
+    remarksFile = fopen(path, "w");
+    if (!remarksFile) {
+        logger_log(LOG_ERROR, "Cannot open remarks file '%s'", path);
+        return false;
+    }
+    written = hashmap_create(256);
+    size_t size = strlen(sourcePath ? sourcePath : "") * 6 + 1;
+    escapedSource = malloc(size);
+    if (!written || !escapedSource) {
+        error_report("Remarks", __LINE__, 0, "Failed to allocate the remarks state", ERROR_MEMORY);
+        remarks_close();
+        return false;
+    }
+    json_escape(sourcePath ? sourcePath : "", escapedSource, size);
+    logger_log(LOG_INFO, "Writing optimization remarks to %s", path);
+    return true;
+}
+
+bool remarks_enabled(void) {
+    return remarksFile != NULL;
+}
+
+void remarks_emit(RemarkKind kind, const char* pass, const AstNode* node, const char* format, ...) {
+    if (!remarksFile) return;
+
+    char reason[REMARK_MAX_REASON];
+    va_list args;
+    va_start(args, format);
+    vsnprintf(reason, sizeof(reason), format, args);
+    va_end(args);
+
+    char escapedPass[128];
+    char escapedReason[REMARK_MAX_REASON * 6];
+    json_escape(pass ? pass : "optimizer", escapedPass, sizeof(escapedPass));
+    json_escape(reason, escapedReason, sizeof(escapedReason));
+
+    char record[sizeof(escapedReason) + sizeof(escapedPass) + 128];
+    snprintf(record, sizeof(record), "\"pass\":\"%s\",\"kind\":\"%s\",\"line\":%d,\"col\":%d,\"reason\":\"%s\"",
+             escapedPass, kind == REMARK_APPLIED ? "applied" : "missed",
+             node ? node->line : 0, node ? node->col : 0, escapedReason);
+    if (hashmap_contains(written, record)) {
+        stats.repeated++;
+        return;
+    }
+    hashmap_put(written, record, NULL, NULL);
+
+    fprintf(remarksFile, "{\"file\":\"%s\",%s}\n", escapedSource, record);
+    if (kind == REMARK_APPLIED) {
+        stats.applied++;
+    } else {
+        stats.missed++;
+    }
+}
+
+RemarksStats remarks_get_stats(void) {
+    return stats;
+}
+
+void remarks_close(void) {
+    if (remarksFile) {
+        fclose(remarksFile);
+        remarksFile = NULL;
+    }
+    hashmap_free(written, NULL);
+    written = NULL;
+    free(escapedSource);
+    escapedSource = NULL;
+}
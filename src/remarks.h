@@ -0,0 +1,81 @@
+/**
+ * @file remarks.h
+ * @brief Machine-readable optimization remarks for the Lyn compiler
+ *
+ * With --remarks every transformation a pass applies, and every opportunity
+ * it looked at and turned down, is written as one JSON object per line:
+ *
+ *     {"file":"prog.lyn","pass":"loop_invariant_code_motion","kind":"missed","line":12,"col":9,
+ *      "reason":"not hoisted: call has side effects"}
+ *
+ * kind is "applied" or "missed"; line and col locate the statement or
+ * expression in the Lyn source (0 when the node was made by a pass). The
+ * optimizer runs its passes to a fixed point, so the same decision is often
+ * reached several times; each distinct remark is written once.
+ */
+
+#ifndef REMARKS_H
+#define REMARKS_H
+
+#include <stdbool.h>
+#include "ast.h"
+
+/**
+ * @brief Whether a remark records a transformation or a missed one
+ */
+typedef enum {
+    REMARK_APPLIED,   ///< The pass transformed the code
+    REMARK_MISSED     ///< The pass considered the code and left it alone
+} RemarkKind;
+
+/**
+ * @brief Statistics about remarks
+ */
+typedef struct {
+    int applied;      ///< Distinct "applied" remarks written
+    int missed;       ///< Distinct "missed" remarks written
+    int repeated;     ///< Remarks dropped because they were already written
+} RemarksStats;
+
+/**
+ * @brief Starts writing remarks
+ *
+ * @param path File the JSON lines are written to
+ * @param sourcePath Lyn source file the remarks are about
+ * @return bool true if the file could be opened
+ */
+bool remarks_open(const char* path, const char* sourcePath);
+
+/**
+ * @brief Checks whether remarks are being written
+ *
+ * @return bool true between remarks_open() and remarks_close()
+ */
+bool remarks_enabled(void);
+
+/**
+ * @brief Writes one remark
+ *
+ * Does nothing unless remarks are enabled.
+ *
+ * @param kind Applied or missed
+ * @param pass Pass that made the decision (NULL for "optimizer")
+ * @param node Node the remark is about, for its position (may be NULL)
+ * @param format printf-style reason
+ */
+void remarks_emit(RemarkKind kind, const char* pass, const AstNode* node, const char* format, ...)
+    __attribute__((format(printf, 4, 5)));
+
+/**
+ * @brief Gets the remark statistics
+ *
+ * @return RemarksStats Current statistics
+ */
+RemarksStats remarks_get_stats(void);
+
+/**
+ * @brief Closes the remarks file
+ */
+void remarks_close(void);
+
+#endif /* REMARKS_H */
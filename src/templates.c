@@ -14,43 +14,176 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include "templates.h"
+#include "hashmap.h"
 #include "error.h"
 #include "logger.h"
 #include <string.h>
 #include <stdlib.h>
+#include <ctype.h>
+
+/** Registry of all template definitions, keyed by template name */
+static HashMap* templates = NULL;
+/** Instantiation cache, keyed by canonical key ("name<T1,T2>") */
+static HashMap* specializations = NULL;
+/** Same specializations, keyed by mangled name for reachability lookups */
+static HashMap* specializationsByName = NULL;
+/** Same specializations in the order they were created, which is the emission order */
+static TemplateSpecialization** specializationOrder = NULL;
+static int specializationCount = 0;
+static int specializationCapacity = 0;
+/** Template instantiation statistics */
+static TemplateStats stats = {0};
+
+/** Rough number of C bytes emitted per AST node, used for size estimates */
+#define TEMPLATE_C_BYTES_PER_NODE 16
 
-/** Maximum number of templates that can be registered */
-#define MAX_TEMPLATES 1024
+/**
+ * @brief Accumulates the estimated C size of a subtree
+ * 
+ * @param node Node to measure
+ * @param userData Pointer to the size_t accumulator
+ */
+static void accumulate_c_size(AstNode* node, void* userData) {
+    size_t* total = (size_t*)userData;
+    *total += TEMPLATE_C_BYTES_PER_NODE;
+    switch (node->type) {
+        case AST_IDENTIFIER: *total += strlen(node->identifier.name); break;
+        case AST_FUNC_DEF: *total += strlen(node->funcDef.name); break;
+        case AST_FUNC_CALL: *total += strlen(node->funcCall.name); break;
+        case AST_STRING_LITERAL: *total += strlen(node->stringLiteral.value); break;
+        default: break;
+    }
+    astVisitChildren(node, accumulate_c_size, userData);
+}
+
+/**
+ * @brief Estimates the size of the C code generated for a subtree
+ * 
+ * @param node Root of the subtree
+ * @return size_t Estimated size in bytes
+ */
+static size_t estimate_c_size(AstNode* node) {
+    size_t total = 0;
+    if (node) accumulate_c_size(node, &total);
+    return total;
+}
+
+/**
+ * @brief Builds the canonical cache key for a template instantiation
+ * 
+ * The key is the template name followed by the type arguments in their
+ * canonical string form, e.g. "Pair<int,string>".
+ * 
+ * @param name Name of the template
+ * @param typeArgs Array of type arguments
+ * @param typeArgCount Number of type arguments
+ * @param buffer Output buffer for the key
+ * @param size Size of the output buffer
+ */
+void template_canonical_key(const char* name, Type** typeArgs, int typeArgCount, char* buffer, size_t size) {
+    if (!buffer || size == 0) return;
+
+    size_t len = snprintf(buffer, size, "%s<", name ? name : "");
+    for (int i = 0; i < typeArgCount && len < size; i++) {
+        len += snprintf(buffer + len, size - len, "%s%s", i > 0 ? "," : "", typeToString(typeArgs[i]));
+    }
+    if (len < size) {
+        snprintf(buffer + len, size - len, ">");
+    }
+}
+
+/**
+ * @brief Builds a C identifier for a specialization, e.g. "Pair__int__string"
+ * 
+ * @param name Name of the template
+ * @param typeArgs Array of type arguments
+ * @param typeArgCount Number of type arguments
+ * @param buffer Output buffer for the name
+ * @param size Size of the output buffer
+ */
+static void mangle_specialization_name(const char* name, Type** typeArgs, int typeArgCount, char* buffer, size_t size) {
+    size_t len = snprintf(buffer, size, "%s", name);
+    for (int i = 0; i < typeArgCount && len < size; i++) {
+        len += snprintf(buffer + len, size - len, "__%s", typeToString(typeArgs[i]));
+    }
+    for (char* p = buffer; *p; p++) {
+        if (!isalnum((unsigned char)*p) && *p != '_') *p = '_';
+    }
+}
+
+/**
+ * @brief Releases a cached specialization
+ * 
+ * @param value The TemplateSpecialization to free
+ */
+static void free_specialization(void* value) {
+    TemplateSpecialization* spec = (TemplateSpecialization*)value;
+    freeAstNode(spec->body);
+    free(spec);
+}
 
-/** Registry of all template definitions */
-static TemplateDefinition templates[MAX_TEMPLATES];
-/** Current number of registered templates */
-static int templateCount = 0;
+/**
+ * @brief Releases a registered template definition
+ * 
+ * @param value The TemplateDefinition to free
+ */
+static void free_template_definition(void* value) {
+    TemplateDefinition* template = (TemplateDefinition*)value;
+    freeAstNode(template->body);
+    free(template);
+}
+
+/**
+ * @brief Finds a registered template definition by name
+ * 
+ * @param name Name of the template
+ * @return TemplateDefinition* The definition, or NULL if not registered
+ */
+static TemplateDefinition* find_template(const char* name) {
+    return (TemplateDefinition*)hashmap_get(templates, name);
+}
 
 /**
  * @brief Registers a new template definition
  * 
  * Adds a new template to the registry with its parameters and body.
  * The template can later be instantiated with specific type arguments.
+ * As with macros, the first definition of a name is kept: a later one
+ * is ignored with a warning, so cached specializations never go stale.
+ * The parameters are only stored when the definition is kept.
  * 
  * @param name Name of the template
  * @param params Array of template parameters
  * @param paramCount Number of parameters
  * @param body AST node representing the template body
- * @return bool true if registration successful, false if limit reached
+ * @return bool true if registration successful, false on allocation failure
  */
 bool register_template(const char* name, TemplateParam** params, int paramCount, AstNode* body) {
-    if (templateCount >= MAX_TEMPLATES) {
-        error_report("Template", 0, 0, "Maximum number of templates exceeded", ERROR_LIMIT);
-        return false;
+    if (!templates) {
+        templates = hashmap_create(64);
+        if (!templates) return false;
+    }
+    if (hashmap_contains(templates, name)) {
+        logger_log(LOG_WARNING, "Template %s redefined; keeping the first definition", name);
+        return true;
     }
 
-    TemplateDefinition* template = &templates[templateCount++];
+    TemplateDefinition* template = calloc(1, sizeof(TemplateDefinition));
+    if (!template) {
+        error_report("Template", 0, 0, "Failed to allocate template definition", ERROR_MEMORY);
+        return false;
+    }
     strncpy(template->name, name, sizeof(template->name) - 1);
     template->params = params;
     template->paramCount = paramCount;
     template->body = clone_ast_node(body);
 
+    if (!hashmap_put(templates, template->name, template, NULL)) {
+        freeAstNode(template->body);
+        free(template);
+        return false;
+    }
+
     return true;
 }
 
@@ -68,18 +201,28 @@ bool register_template(const char* name, TemplateParam** params, int paramCount,
  * @param name Name of the template to instantiate
  * @param typeArgs Array of type arguments
  * @param typeArgCount Number of type arguments
- * @return AstNode* Instantiated template AST, or NULL on error
+ * @return AstNode* Copy of the cached specialization owned by the caller, or NULL on error
  */
 AstNode* instantiate_template(const char* name, Type** typeArgs, int typeArgCount) {
-    // Find template definition
-    TemplateDefinition* template = NULL;
-    for (int i = 0; i < templateCount; i++) {
-        if (strcmp(templates[i].name, name) == 0) {
-            template = &templates[i];
-            break;
-        }
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)instantiate_template);
+
+    stats.instantiations_requested++;
+
+    // Reuse an existing specialization for the same canonical arguments
+    char key[512];
+    template_canonical_key(name, typeArgs, typeArgCount, key, sizeof(key));
+    TemplateSpecialization* cached = (TemplateSpecialization*)hashmap_get(specializations, key);
+    if (cached) {
+        cached->useCount++;
+        stats.duplicates_avoided++;
+        stats.c_bytes_saved += cached->estimatedCSize;
+        logger_log(LOG_DEBUG, "Template cache hit for %s (%d uses)", key, cached->useCount);
+        return clone_ast_node(cached->body);
     }
 
+    // Find template definition
+    TemplateDefinition* template = find_template(name);
+
     if (!template) {
         error_report("Template", 0, 0, "Template not found", ERROR_NAME);
         return NULL;
@@ -122,7 +265,49 @@ AstNode* instantiate_template(const char* name, Type** typeArgs, int typeArgCoun
     optimize_template(instantiated);
 
     free(paramNames);
-    return instantiated;
+
+    // Cache the specialization under its canonical key
+    TemplateSpecialization* spec = calloc(1, sizeof(TemplateSpecialization));
+    if (!spec) {
+        error_report("Template", __LINE__, 0, "Failed to allocate template specialization", ERROR_MEMORY);
+        return instantiated;
+    }
+    memcpy(spec->key, key, sizeof(spec->key));
+    mangle_specialization_name(name, typeArgs, typeArgCount, spec->mangledName, sizeof(spec->mangledName));
+    spec->body = instantiated;
+    spec->useCount = 1;
+
+    // Give the specialization its own symbol so several of them can coexist
+    if (instantiated && instantiated->type == AST_FUNC_DEF) {
+        strncpy(instantiated->funcDef.name, spec->mangledName, sizeof(instantiated->funcDef.name) - 1);
+        instantiated->funcDef.name[sizeof(instantiated->funcDef.name) - 1] = '\0';
+    }
+    spec->estimatedCSize = estimate_c_size(instantiated);
+
+    if (!specializations) specializations = hashmap_create(64);
+    if (!specializationsByName) specializationsByName = hashmap_create(64);
+    if (specializationCount == specializationCapacity) {
+        int capacity = specializationCapacity ? specializationCapacity * 2 : 16;
+        TemplateSpecialization** order = realloc(specializationOrder, capacity * sizeof(TemplateSpecialization*));
+        if (!order) {
+            error_report("Template", __LINE__, 0, "Failed to grow specialization list", ERROR_MEMORY);
+            spec->body = NULL;
+            free(spec);
+            return instantiated;
+        }
+        specializationOrder = order;
+        specializationCapacity = capacity;
+    }
+    if (!hashmap_put(specializations, spec->key, spec, NULL)) {
+        spec->body = NULL;
+        free(spec);
+        return instantiated;
+    }
+    hashmap_put(specializationsByName, spec->mangledName, spec, NULL);
+    specializationOrder[specializationCount++] = spec;
+    stats.specializations_created++;
+
+    return clone_ast_node(instantiated);
 }
 
 /**
@@ -135,14 +320,7 @@ AstNode* instantiate_template(const char* name, Type** typeArgs, int typeArgCoun
  * @return bool true if all constraints are satisfied, false otherwise
  */
 bool validate_template_constraints(TemplateInstance* instance) {
-    TemplateDefinition* template = NULL;
-    for (int i = 0; i < templateCount; i++) {
-        if (strcmp(templates[i].name, instance->templateName) == 0) {
-            template = &templates[i];
-            break;
-        }
-    }
-
+    TemplateDefinition* template = find_template(instance->templateName);
     if (!template) return false;
 
     // Check each type argument against its constraint
@@ -203,6 +381,20 @@ AstNode* clone_ast_node(AstNode* node) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            clone->concatExpr.partCount = node->concatExpr.partCount;
+            clone->concatExpr.parts = malloc(node->concatExpr.partCount * sizeof(AstNode*));
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                clone->concatExpr.parts[i] = clone_ast_node(node->concatExpr.parts[i]);
+            }
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            memcpy(clone->arrayAssign.name, node->arrayAssign.name, sizeof(clone->arrayAssign.name));
+            clone->arrayAssign.index = clone_ast_node(node->arrayAssign.index);
+            clone->arrayAssign.value = clone_ast_node(node->arrayAssign.value);
+            break;
+            
         // Add cases for other node types as needed
     }
 
@@ -247,6 +439,18 @@ AstNode* substitute_type_params(AstNode* node, const char** paramNames, Type** t
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                node->concatExpr.parts[i] =
+                    substitute_type_params(node->concatExpr.parts[i], paramNames, typeArgs, count);
+            }
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            node->arrayAssign.index = substitute_type_params(node->arrayAssign.index, paramNames, typeArgs, count);
+            node->arrayAssign.value = substitute_type_params(node->arrayAssign.value, paramNames, typeArgs, count);
+            break;
+            
         // Add cases for other node types
     }
 
@@ -286,6 +490,14 @@ void specialize_generic_code(AstNode* node, Type** typeArgs, int typeArgCount) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            // Already a string concatenation
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // Only its operands can be specialized, below
+            break;
+            
         // Add cases for other node types
     }
 
@@ -298,6 +510,17 @@ void specialize_generic_code(AstNode* node, Type** typeArgs, int typeArgCount) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                specialize_generic_code(node->concatExpr.parts[i], typeArgs, typeArgCount);
+            }
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            specialize_generic_code(node->arrayAssign.index, typeArgs, typeArgCount);
+            specialize_generic_code(node->arrayAssign.value, typeArgs, typeArgCount);
+            break;
+            
         // Add cases for other node types
     }
 }
@@ -331,6 +554,14 @@ void optimize_template(AstNode* node) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            // Nothing type-specific in joining strings
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            // A store is the same for every element type
+            break;
+            
         // Add cases for other node types
     }
 
@@ -342,6 +573,153 @@ void optimize_template(AstNode* node) {
             }
             break;
             
+        case AST_CONCAT_EXPR:
+            for (int i = 0; i < node->concatExpr.partCount; i++) {
+                optimize_template(node->concatExpr.parts[i]);
+            }
+            break;
+            
+        case AST_ARRAY_ASSIGN:
+            optimize_template(node->arrayAssign.index);
+            optimize_template(node->arrayAssign.value);
+            break;
+            
         // Add cases for other node types
     }
 }
+
+/** State shared by the reachability walk */
+typedef struct {
+    int reachableCount;  ///< Number of specializations marked so far
+} ReachabilityState;
+
+static void mark_reachable_node(AstNode* node, void* userData);
+
+/**
+ * @brief Marks a specialization reachable and walks its body
+ * 
+ * @param name Mangled name or canonical key of the specialization
+ * @param state Reachability walk state
+ */
+static void mark_specialization(const char* name, ReachabilityState* state) {
+    TemplateSpecialization* spec = (TemplateSpecialization*)hashmap_get(specializationsByName, name);
+    if (!spec) spec = (TemplateSpecialization*)hashmap_get(specializations, name);
+    if (!spec || spec->reachable) return;
+
+    spec->reachable = true;
+    state->reachableCount++;
+    if (spec->body) mark_reachable_node(spec->body, state);
+}
+
+/**
+ * @brief Walks an AST and marks every specialization it references
+ * 
+ * @param node Node to inspect
+ * @param userData Reachability walk state
+ */
+static void mark_reachable_node(AstNode* node, void* userData) {
+    ReachabilityState* state = (ReachabilityState*)userData;
+
+    switch (node->type) {
+        case AST_FUNC_CALL: mark_specialization(node->funcCall.name, state); break;
+        case AST_NEW_EXPR: mark_specialization(node->newExpr.className, state); break;
+        case AST_VAR_DECL: mark_specialization(node->varDecl.type, state); break;
+        case AST_IDENTIFIER: mark_specialization(node->identifier.name, state); break;
+        default: break;
+    }
+    astVisitChildren(node, mark_reachable_node, userData);
+}
+
+/**
+ * @brief Marks the specializations reachable from the program roots
+ * 
+ * The top-level program (the body of main) and every exported name are
+ * treated as roots. A specialization is reachable when a root, or another
+ * reachable specialization, calls it by its mangled name.
+ * 
+ * @param program The program AST (may be NULL)
+ * @param exportedNames Names exported by the compilation unit
+ * @param exportCount Number of exported names
+ * @return int Number of reachable specializations
+ */
+int templates_mark_reachable(AstNode* program, const char** exportedNames, int exportCount) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)templates_mark_reachable);
+
+    ReachabilityState state = {0};
+    for (int i = 0; i < specializationCount; i++) {
+        specializationOrder[i]->reachable = false;
+    }
+
+    if (program) mark_reachable_node(program, &state);
+    for (int i = 0; i < exportCount; i++) {
+        if (exportedNames[i]) mark_specialization(exportedNames[i], &state);
+    }
+
+    logger_log(LOG_DEBUG, "%d of %d template specializations reachable",
+              state.reachableCount, specializationCount);
+    return state.reachableCount;
+}
+
+/**
+ * @brief Collects the specializations that should be emitted
+ * 
+ * Only specializations marked by templates_mark_reachable() are returned,
+ * in the order they were instantiated; the rest are counted as pruned in
+ * the statistics.
+ * 
+ * @param count Output for the number of returned nodes
+ * @return AstNode** Newly allocated array of specialization bodies (caller frees the array only)
+ */
+AstNode** templates_collect_reachable(int* count) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)templates_collect_reachable);
+
+    *count = 0;
+    if (specializationCount == 0) return NULL;
+
+    AstNode** nodes = malloc(specializationCount * sizeof(AstNode*));
+    if (!nodes) {
+        error_report("Template", __LINE__, 0, "Failed to allocate specialization list", ERROR_MEMORY);
+        return NULL;
+    }
+    for (int i = 0; i < specializationCount; i++) {
+        TemplateSpecialization* spec = specializationOrder[i];
+        if (spec->reachable && spec->body) {
+            nodes[(*count)++] = spec->body;
+            stats.specializations_emitted++;
+        } else {
+            stats.specializations_pruned++;
+            stats.c_bytes_saved += spec->estimatedCSize;
+            logger_log(LOG_DEBUG, "Pruning unreachable template specialization %s", spec->key);
+        }
+    }
+    return nodes;
+}
+
+/**
+ * @brief Gets the template instantiation statistics
+ * 
+ * @return TemplateStats Current statistics
+ */
+TemplateStats templates_get_stats(void) {
+    return stats;
+}
+
+/**
+ * @brief Releases all template definitions and cached specializations
+ */
+void templates_cleanup(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)templates_cleanup);
+
+    // Specializations are owned by the key map; the name map and the order list only alias them
+    hashmap_free(specializationsByName, NULL);
+    hashmap_free(specializations, free_specialization);
+    hashmap_free(templates, free_template_definition);
+    free(specializationOrder);
+    specializationOrder = NULL;
+    specializationCount = 0;
+    specializationCapacity = 0;
+    specializationsByName = NULL;
+    specializations = NULL;
+    templates = NULL;
+    memset(&stats, 0, sizeof(stats));
+}
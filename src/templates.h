@@ -60,17 +60,53 @@ typedef struct {
     int typeArgCount;
 } TemplateInstance;
 
+/**
+ * @brief Structure representing a cached template specialization
+ * 
+ * Each distinct (template name, canonical type arguments) pair is
+ * instantiated once and stored here; later requests reuse the same AST.
+ */
+typedef struct {
+    /** Canonical cache key, e.g. "Pair<int,string>" */
+    char key[512];
+    /** C-safe name of the specialization, e.g. "Pair__int__string" */
+    char mangledName[512];
+    /** Instantiated AST (owned by the cache) */
+    AstNode* body;
+    /** Number of times this specialization was requested */
+    int useCount;
+    /** Whether the specialization is reachable from main or an export */
+    bool reachable;
+    /** Estimated size in bytes of the C code generated for the body */
+    size_t estimatedCSize;
+} TemplateSpecialization;
+
+/**
+ * @brief Statistics about template instantiation
+ */
+typedef struct {
+    int instantiations_requested;  ///< Calls to instantiate_template()
+    int specializations_created;   ///< Distinct specializations generated
+    int duplicates_avoided;        ///< Requests served from the cache
+    size_t c_bytes_saved;          ///< Estimated bytes of C not regenerated
+    int specializations_emitted;   ///< Specializations reachable and emitted
+    int specializations_pruned;    ///< Specializations dropped as unreachable
+} TemplateStats;
+
 /**
  * @brief Registers a new template definition
  * 
  * Adds a new template to the registry with its parameters and body.
  * The template can later be instantiated with specific type arguments.
+ * As with macros, the first definition of a name is kept: a later one
+ * is ignored with a warning, so cached specializations never go stale.
+ * The parameters are only stored when the definition is kept.
  * 
  * @param name Name of the template
  * @param params Array of template parameters
  * @param paramCount Number of parameters
  * @param body AST node representing the template body
- * @return bool true if registration successful, false if limit reached
+ * @return bool true if registration successful, false on allocation failure
  */
 bool register_template(const char* name, TemplateParam** params, int paramCount, AstNode* body);
 
@@ -78,7 +114,12 @@ bool register_template(const char* name, TemplateParam** params, int paramCount,
  * @brief Instantiates a template with specific type arguments
  * 
  * Creates a new instance of a template by substituting type parameters
- * with concrete types. The process includes:
+ * with concrete types. Results are cached by template name and canonical
+ * type arguments, so each specialization is generated only once; every
+ * call returns a fresh copy of the cached AST, which the caller owns and
+ * may splice into its tree or free without touching the cache.
+ * The process includes:
+ * - Looking up the instantiation cache
  * - Finding the template definition
  * - Validating type arguments
  * - Substituting type parameters
@@ -88,7 +129,7 @@ bool register_template(const char* name, TemplateParam** params, int paramCount,
  * @param name Name of the template to instantiate
  * @param typeArgs Array of type arguments
  * @param typeArgCount Number of type arguments
- * @return AstNode* Instantiated template AST, or NULL on error
+ * @return AstNode* Copy of the cached specialization owned by the caller, or NULL on error
  */
 AstNode* instantiate_template(const char* name, Type** typeArgs, int typeArgCount);
 
@@ -163,4 +204,56 @@ AstNode* inline_template_calls(AstNode* node);
  */
 void specialize_generic_code(AstNode* node, Type** typeArgs, int typeArgCount);
 
+/**
+ * @brief Builds the canonical cache key for a template instantiation
+ * 
+ * @param name Name of the template
+ * @param typeArgs Array of type arguments
+ * @param typeArgCount Number of type arguments
+ * @param buffer Output buffer for the key
+ * @param size Size of the output buffer
+ */
+void template_canonical_key(const char* name, Type** typeArgs, int typeArgCount, char* buffer, size_t size);
+
+/**
+ * @brief Marks the specializations reachable from the program roots
+ * 
+ * The top-level program (the body of main) and every exported name are
+ * treated as roots. A specialization is reachable when a root, or another
+ * reachable specialization, calls it by its mangled name. Lyn has no
+ * template syntax yet, so the compiler does not instantiate templates and
+ * emits no specializations; a front end that does calls this before
+ * templates_collect_reachable().
+ * 
+ * @param program The program AST (may be NULL)
+ * @param exportedNames Names exported by the compilation unit
+ * @param exportCount Number of exported names
+ * @return int Number of reachable specializations
+ */
+int templates_mark_reachable(AstNode* program, const char** exportedNames, int exportCount);
+
+/**
+ * @brief Collects the specializations that should be emitted
+ * 
+ * Only specializations marked by templates_mark_reachable() are returned,
+ * in the order they were instantiated; the rest are counted as pruned in
+ * the statistics.
+ * 
+ * @param count Output for the number of returned nodes
+ * @return AstNode** Newly allocated array of specialization bodies (caller frees the array only)
+ */
+AstNode** templates_collect_reachable(int* count);
+
+/**
+ * @brief Gets the template instantiation statistics
+ * 
+ * @return TemplateStats Current statistics
+ */
+TemplateStats templates_get_stats(void);
+
+/**
+ * @brief Releases all template definitions and cached specializations
+ */
+void templates_cleanup(void);
+
 #endif
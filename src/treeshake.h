@@ -0,0 +1,80 @@
+/**
+ * @file treeshake.h
+ * @brief Whole-program reachability analysis for the Lyn compiler
+ *
+ * Before code generation the program is walked from its roots (the body of
+ * main, the auto-called test_* functions and functions marked @export) to
+ * find every function and imported module member that can actually run:
+ * - Unreachable function definitions are removed from the AST
+ * - Module members that are never referenced are reported so that the
+ *   code generator can skip their stubs, wrappers and struct fields
+ */
+
+#ifndef TREESHAKE_H
+#define TREESHAKE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "ast.h"
+
+/**
+ * @brief Statistics about the last tree-shaking run
+ */
+typedef struct {
+    int functions_kept;           ///< Function definitions reachable from a root
+    int functions_removed;        ///< Function definitions dropped as unreachable
+    int module_members_used;      ///< Distinct module members referenced by reachable code
+    size_t c_bytes_saved;         ///< Estimated bytes of C not generated for removed functions
+    bool conservative;            ///< The walk met a construct it cannot see through and kept everything
+} TreeShakeStats;
+
+/**
+ * @brief Removes the functions that cannot be reached from the program roots
+ *
+ * Roots are the top-level statements of main, functions whose name starts
+ * with "test_" (main calls them automatically) and functions annotated with
+ * @export. A function is reachable when reachable code calls it or refers
+ * to it by name. Nested definitions are handled the same way as top-level
+ * ones. The module members used by reachable code are recorded for
+ * treeshake_module_member_used().
+ *
+ * @param program The program AST
+ * @return int Number of function definitions removed
+ */
+int treeshake_program(AstNode* program);
+
+/**
+ * @brief Checks whether reachable code uses a member of an imported module
+ *
+ * A member is used when it is called or read through the module name or one
+ * of its aliases (math_lib.add, m.add), or imported selectively under a name
+ * that reachable code calls. When no analysis ran, or the last one was
+ * conservative, every member counts as used.
+ *
+ * @param moduleName Module name as written in the import statement
+ * @param member Member name
+ * @return bool true if the member must be emitted
+ */
+bool treeshake_module_member_used(const char* moduleName, const char* member);
+
+/**
+ * @brief Checks whether reachable code calls a selectively imported name
+ *
+ * @param name Local name of the symbol (its alias, if any)
+ * @return bool true if the wrapper for the name must be emitted
+ */
+bool treeshake_symbol_used(const char* name);
+
+/**
+ * @brief Gets the statistics of the last tree-shaking run
+ *
+ * @return TreeShakeStats Current statistics
+ */
+TreeShakeStats treeshake_get_stats(void);
+
+/**
+ * @brief Releases the tables built by the last run
+ */
+void treeshake_cleanup(void);
+
+#endif /* TREESHAKE_H */
@@ -842,6 +842,7 @@ Type* infer_type(struct AstNode* node) {
             break;
             
         case AST_STRING_LITERAL:
+        case AST_CONCAT_EXPR:
             result = create_primitive_type(TYPE_STRING);
             break;
             
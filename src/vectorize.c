@@ -0,0 +1,860 @@
+/**
+ * @file vectorize.c
+ * @brief Implementation of vectorization analysis and reporting
+ *
+ * The verdict on a range loop is reached in three walks over its body:
+ * - The first checks that every statement and expression is one the C
+ *   compiler can vectorize (assignments, element stores, ifs, arithmetic,
+ *   array reads) and collects the scalars and arrays the body writes
+ * - The second checks that every array stored to is only ever indexed by
+ *   the iterator, so each iteration touches its own element
+ * - The third goes through the top-level statements in order and finds
+ *   scalars read before the iteration assigns them, which carry a value
+ *   from the previous iteration; only an integer sum is allowed to
+ *
+ * The report side reads the generated C for the loop markers and the C
+ * compiler's -fopt-info output for the lines it vectorized.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include "vectorize.h"
+#include "hashmap.h"
+#include "profile.h"
+#include "error.h"
+#include "logger.h"
+
+/** Whether --vectorize-report was given */
+static bool reportEnabled = false;
+/** Variables only ever assigned array literals */
+static HashMap* freshArrays = NULL;
+/** Variables assigned anything else, or bound as parameters and iterators */
+static HashMap* otherNames = NULL;
+/** Set when the program holds a construct the fresh-array scan cannot see into */
+static bool freshUnknown = false;
+/** Verdicts in code generation order (each allocated separately so pointers stay valid) */
+static VectorizeLoop** loops = NULL;
+static int loopCount = 0;
+static int loopCapacity = 0;
+/** Statistics */
+static VectorizeStats stats = {0};
+
+void vectorize_set_report(bool enabled) {
+    reportEnabled = enabled;
+}
+
+bool vectorize_report_enabled(void) {
+    return reportEnabled;
+}
+
+void vectorize_cleanup(void) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)vectorize_cleanup);
+
+    hashmap_free(freshArrays, NULL);
+    freshArrays = NULL;
+    hashmap_free(otherNames, NULL);
+    otherNames = NULL;
+    freshUnknown = false;
+    for (int i = 0; i < loopCount; i++) {
+        free(loops[i]);
+    }
+    free(loops);
+    loops = NULL;
+    loopCount = 0;
+    loopCapacity = 0;
+}
+
+VectorizeStats vectorize_get_stats(void) {
+    return stats;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Fresh arrays                                                              */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Records how a name is bound by one assignment or binding
+ *
+ * @param name Variable name
+ * @param fresh true if the value is a new array literal
+ */
+static void note_binding(const char* name, bool fresh) {
+    if (!name || name[0] == '\0' || strchr(name, '.')) return;
+    if (fresh) {
+        hashmap_put(freshArrays, name, NULL, NULL);
+    } else {
+        hashmap_put(otherNames, name, NULL, NULL);
+    }
+}
+
+/**
+ * @brief Notes the parameters of a function or lambda as non-fresh bindings
+ */
+static void note_parameters(AstNode** parameters, int count) {
+    for (int i = 0; parameters && i < count; i++) {
+        if (parameters[i] && parameters[i]->type == AST_IDENTIFIER) {
+            note_binding(parameters[i]->identifier.name, false);
+        }
+    }
+}
+
+/**
+ * @brief Walks a subtree recording every binding of every name
+ *
+ * @param node Subtree to walk
+ */
+static void scan_bindings(AstNode* node) {
+    if (!node) return;
+
+#define SCAN(child) scan_bindings(child)
+#define SCAN_LIST(list, count) do { for (int i_ = 0; (list) && i_ < (count); i_++) SCAN((list)[i_]); } while (0)
+    switch (node->type) {
+        case AST_PROGRAM: SCAN_LIST(node->program.statements, node->program.statementCount); break;
+        case AST_FUNC_DEF:
+            note_parameters(node->funcDef.parameters, node->funcDef.paramCount);
+            SCAN_LIST(node->funcDef.body, node->funcDef.bodyCount);
+            break;
+        case AST_CLASS_DEF: SCAN_LIST(node->classDef.members, node->classDef.memberCount); break;
+        case AST_VAR_DECL:
+            note_binding(node->varDecl.name, false);
+            SCAN(node->varDecl.initializer);
+            break;
+        case AST_VAR_ASSIGN:
+            note_binding(node->varAssign.name, node->varAssign.initializer &&
+                         node->varAssign.initializer->type == AST_ARRAY_LITERAL);
+            SCAN(node->varAssign.initializer);
+            break;
+        case AST_ARRAY_ASSIGN:
+            SCAN(node->arrayAssign.index);
+            SCAN(node->arrayAssign.value);
+            break;
+        case AST_BLOCK: SCAN_LIST(node->block.statements, node->block.statementCount); break;
+        case AST_IF_STMT:
+            SCAN(node->ifStmt.condition);
+            SCAN_LIST(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            SCAN_LIST(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            note_binding(node->forStmt.iterator, false);
+            SCAN(node->forStmt.rangeStart);
+            SCAN(node->forStmt.rangeEnd);
+            SCAN(node->forStmt.rangeStep);
+            SCAN(node->forStmt.collection);
+            SCAN(node->forStmt.init);
+            SCAN(node->forStmt.condition);
+            SCAN(node->forStmt.update);
+            SCAN_LIST(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_WHILE_STMT:
+            SCAN(node->whileStmt.condition);
+            SCAN_LIST(node->whileStmt.body, node->whileStmt.bodyCount);
+            break;
+        case AST_DO_WHILE_STMT:
+            SCAN_LIST(node->doWhileStmt.body, node->doWhileStmt.bodyCount);
+            SCAN(node->doWhileStmt.condition);
+            break;
+        case AST_SWITCH_STMT:
+            SCAN(node->switchStmt.expr);
+            SCAN_LIST(node->switchStmt.cases, node->switchStmt.caseCount);
+            SCAN_LIST(node->switchStmt.defaultCase, node->switchStmt.defaultCaseCount);
+            break;
+        case AST_CASE_STMT:
+            SCAN(node->caseStmt.expr);
+            SCAN_LIST(node->caseStmt.body, node->caseStmt.bodyCount);
+            break;
+        case AST_PATTERN_MATCH:
+            SCAN(node->patternMatch.expr);
+            SCAN_LIST(node->patternMatch.cases, node->patternMatch.caseCount);
+            SCAN(node->patternMatch.otherwise);
+            break;
+        case AST_PATTERN_CASE:
+            SCAN(node->patternCase.pattern);
+            SCAN_LIST(node->patternCase.body, node->patternCase.bodyCount);
+            break;
+        case AST_TRY_CATCH_STMT:
+            note_binding(node->tryCatchStmt.errorVarName, false);
+            SCAN_LIST(node->tryCatchStmt.tryBody, node->tryCatchStmt.tryCount);
+            SCAN_LIST(node->tryCatchStmt.catchBody, node->tryCatchStmt.catchCount);
+            SCAN_LIST(node->tryCatchStmt.finallyBody, node->tryCatchStmt.finallyCount);
+            break;
+        case AST_THROW_STMT: SCAN(node->throwStmt.expr); break;
+        case AST_RETURN_STMT: SCAN(node->returnStmt.expr); break;
+        case AST_PRINT_STMT: SCAN(node->printStmt.expr); break;
+        case AST_BINARY_OP:
+            SCAN(node->binaryOp.left);
+            SCAN(node->binaryOp.right);
+            break;
+        case AST_UNARY_OP: SCAN(node->unaryOp.expr); break;
+        case AST_MEMBER_ACCESS: SCAN(node->memberAccess.object); break;
+        case AST_ARRAY_ACCESS:
+            SCAN(node->arrayAccess.array);
+            SCAN(node->arrayAccess.index);
+            break;
+        case AST_ARRAY_LITERAL: SCAN_LIST(node->arrayLiteral.elements, node->arrayLiteral.elementCount); break;
+        case AST_FUNC_CALL: SCAN_LIST(node->funcCall.arguments, node->funcCall.argCount); break;
+        case AST_NEW_EXPR: SCAN_LIST(node->newExpr.arguments, node->newExpr.argCount); break;
+        case AST_LAMBDA:
+            note_parameters(node->lambda.parameters, node->lambda.paramCount);
+            SCAN(node->lambda.body);
+            break;
+        case AST_CONCAT_EXPR: SCAN_LIST(node->concatExpr.parts, node->concatExpr.partCount); break;
+        case AST_IMPORT:
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_NULL_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_THIS_EXPR:
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+            break;
+        default:
+            // Aspects, modules, patterns...: bindings could hide anywhere
+            freshUnknown = true;
+            break;
+    }
+#undef SCAN_LIST
+#undef SCAN
+}
+
+void vectorize_begin_program(AstNode* program) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)vectorize_begin_program);
+
+    vectorize_cleanup();
+    stats = (VectorizeStats){0};
+    freshArrays = hashmap_create(32);
+    otherNames = hashmap_create(64);
+    if (!freshArrays || !otherNames) {
+        error_report("Vectorize", __LINE__, 0, "Failed to allocate the array tables", ERROR_MEMORY);
+        freshUnknown = true;
+        return;
+    }
+    scan_bindings(program);
+}
+
+/**
+ * @brief Checks that an array variable cannot share storage with another
+ */
+static bool is_fresh_array(const char* name) {
+    return !freshUnknown && hashmap_contains(freshArrays, name) && !hashmap_contains(otherNames, name);
+}
+
+/* ------------------------------------------------------------------------ */
+/* Loop analysis                                                             */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief State of the analysis of one loop body
+ */
+typedef struct {
+    const char* iterator;          ///< Loop iterator
+    VectorizeTypeFn variableType;  ///< Types of the variables declared before the loop
+    HashMap* scalarWrites;         ///< Scalars assigned in the body -> number of assignments
+    HashMap* arrayWrites;          ///< Arrays stored to in the body
+    HashMap* arrays;               ///< Every array the body accesses
+    VectorizeLoop* verdict;        ///< Verdict being filled
+    bool rejected;                 ///< A reason has been given
+} LoopScan;
+
+/**
+ * @brief Rejects the loop, keeping the first reason given
+ */
+static void reject(LoopScan* scan, const char* fmt, const char* name) {
+    if (scan->rejected) return;
+    scan->rejected = true;
+    snprintf(scan->verdict->reason, sizeof(scan->verdict->reason), fmt, name ? name : "");
+}
+
+/**
+ * @brief Counts one assignment of a scalar
+ */
+static void note_scalar_write(LoopScan* scan, const char* name) {
+    intptr_t count = (intptr_t)hashmap_get(scan->scalarWrites, name);
+    hashmap_put(scan->scalarWrites, name, (void*)(count + 1), NULL);
+}
+
+/**
+ * @brief Checks that an expression only reads scalars and arrays
+ */
+static void scan_expression(AstNode* expr, LoopScan* scan) {
+    if (!expr || scan->rejected) return;
+
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_BOOLEAN_LITERAL:
+        case AST_IDENTIFIER:
+            break;
+        case AST_UNARY_OP:
+            scan_expression(expr->unaryOp.expr, scan);
+            break;
+        case AST_BINARY_OP:
+            if (expr->binaryOp.op == '+' &&
+                ((expr->binaryOp.left && expr->binaryOp.left->type == AST_STRING_LITERAL) ||
+                 (expr->binaryOp.right && expr->binaryOp.right->type == AST_STRING_LITERAL))) {
+                reject(scan, "body concatenates strings", NULL);
+                break;
+            }
+            scan_expression(expr->binaryOp.left, scan);
+            scan_expression(expr->binaryOp.right, scan);
+            break;
+        case AST_ARRAY_ACCESS:
+            if (!expr->arrayAccess.array || expr->arrayAccess.array->type != AST_IDENTIFIER) {
+                reject(scan, "body indexes something other than an array variable", NULL);
+                break;
+            }
+            hashmap_put(scan->arrays, expr->arrayAccess.array->identifier.name, NULL, NULL);
+            scan_expression(expr->arrayAccess.index, scan);
+            break;
+        case AST_MEMBER_ACCESS:
+            // a.length is read once per loop; other members are object fields
+            if (strcmp(expr->memberAccess.member, "length") != 0 ||
+                !expr->memberAccess.object || expr->memberAccess.object->type != AST_IDENTIFIER) {
+                reject(scan, "body reads object fields", NULL);
+            }
+            break;
+        case AST_FUNC_CALL:
+            reject(scan, "body calls '%s'", expr->funcCall.name);
+            break;
+        default:
+            reject(scan, "body uses a %s expression", astNodeTypeToString(expr->type));
+            break;
+    }
+}
+
+static void scan_statements(AstNode** list, int count, LoopScan* scan);
+
+/**
+ * @brief Checks that a body statement is straight-line arithmetic and collects its writes
+ */
+static void scan_statement(AstNode* stmt, LoopScan* scan) {
+    if (!stmt || scan->rejected) return;
+
+    switch (stmt->type) {
+        case AST_IDENTIFIER:
+            // The 'var' keyword before an assignment
+            break;
+        case AST_VAR_ASSIGN:
+            if (strchr(stmt->varAssign.name, '.')) {
+                reject(scan, "body stores object fields", NULL);
+                break;
+            }
+            note_scalar_write(scan, stmt->varAssign.name);
+            scan_expression(stmt->varAssign.initializer, scan);
+            break;
+        case AST_VAR_DECL:
+            note_scalar_write(scan, stmt->varDecl.name);
+            scan_expression(stmt->varDecl.initializer, scan);
+            break;
+        case AST_ARRAY_ASSIGN:
+            hashmap_put(scan->arrays, stmt->arrayAssign.name, NULL, NULL);
+            hashmap_put(scan->arrayWrites, stmt->arrayAssign.name, NULL, NULL);
+            if (!stmt->arrayAssign.index || stmt->arrayAssign.index->type != AST_IDENTIFIER ||
+                strcmp(stmt->arrayAssign.index->identifier.name, scan->iterator) != 0) {
+                reject(scan, "'%s' is stored at an index other than the iterator", stmt->arrayAssign.name);
+                break;
+            }
+            scan_expression(stmt->arrayAssign.value, scan);
+            break;
+        case AST_IF_STMT:
+            scan_expression(stmt->ifStmt.condition, scan);
+            scan_statements(stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount, scan);
+            scan_statements(stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount, scan);
+            break;
+        case AST_BLOCK:
+            scan_statements(stmt->block.statements, stmt->block.statementCount, scan);
+            break;
+        case AST_PRINT_STMT:
+            reject(scan, "body prints", NULL);
+            break;
+        case AST_FUNC_CALL:
+            reject(scan, "body calls '%s'", stmt->funcCall.name);
+            break;
+        case AST_FOR_STMT:
+        case AST_WHILE_STMT:
+        case AST_DO_WHILE_STMT:
+            reject(scan, "body contains a nested loop", NULL);
+            break;
+        case AST_BREAK_STMT:
+        case AST_CONTINUE_STMT:
+        case AST_RETURN_STMT:
+        case AST_THROW_STMT:
+            reject(scan, "body can leave the loop early", NULL);
+            break;
+        default:
+            reject(scan, "body contains a %s statement", astNodeTypeToString(stmt->type));
+            break;
+    }
+}
+
+static void scan_statements(AstNode** list, int count, LoopScan* scan) {
+    for (int i = 0; list && i < count && !scan->rejected; i++) {
+        scan_statement(list[i], scan);
+    }
+}
+
+/**
+ * @brief Checks that arrays stored to are only read at the iterator
+ */
+static void check_array_reads(AstNode* node, LoopScan* scan) {
+    if (!node || scan->rejected) return;
+
+    switch (node->type) {
+        case AST_ARRAY_ACCESS: {
+            const char* name = node->arrayAccess.array->identifier.name;
+            AstNode* index = node->arrayAccess.index;
+            if (hashmap_contains(scan->arrayWrites, name) &&
+                (!index || index->type != AST_IDENTIFIER || strcmp(index->identifier.name, scan->iterator) != 0)) {
+                reject(scan, "'%s' is read at another element than the one stored", name);
+                return;
+            }
+            check_array_reads(index, scan);
+            break;
+        }
+        case AST_UNARY_OP: check_array_reads(node->unaryOp.expr, scan); break;
+        case AST_BINARY_OP:
+            check_array_reads(node->binaryOp.left, scan);
+            check_array_reads(node->binaryOp.right, scan);
+            break;
+        case AST_VAR_ASSIGN: check_array_reads(node->varAssign.initializer, scan); break;
+        case AST_VAR_DECL: check_array_reads(node->varDecl.initializer, scan); break;
+        case AST_ARRAY_ASSIGN: check_array_reads(node->arrayAssign.value, scan); break;
+        case AST_IF_STMT:
+            check_array_reads(node->ifStmt.condition, scan);
+            for (int i = 0; i < node->ifStmt.thenCount; i++) check_array_reads(node->ifStmt.thenBranch[i], scan);
+            for (int i = 0; i < node->ifStmt.elseCount; i++) check_array_reads(node->ifStmt.elseBranch[i], scan);
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) check_array_reads(node->block.statements[i], scan);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Visits every name an expression or statement reads
+ */
+static void visit_reads(AstNode* node, HashMapVisitFn visit, void* userData) {
+    if (!node) return;
+
+    switch (node->type) {
+        case AST_IDENTIFIER: visit(node->identifier.name, NULL, userData); break;
+        case AST_UNARY_OP: visit_reads(node->unaryOp.expr, visit, userData); break;
+        case AST_BINARY_OP:
+            visit_reads(node->binaryOp.left, visit, userData);
+            visit_reads(node->binaryOp.right, visit, userData);
+            break;
+        case AST_ARRAY_ACCESS:
+            visit_reads(node->arrayAccess.array, visit, userData);
+            visit_reads(node->arrayAccess.index, visit, userData);
+            break;
+        case AST_MEMBER_ACCESS: visit_reads(node->memberAccess.object, visit, userData); break;
+        case AST_VAR_ASSIGN: visit_reads(node->varAssign.initializer, visit, userData); break;
+        case AST_VAR_DECL: visit_reads(node->varDecl.initializer, visit, userData); break;
+        case AST_ARRAY_ASSIGN:
+            visit(node->arrayAssign.name, NULL, userData);
+            visit_reads(node->arrayAssign.index, visit, userData);
+            visit_reads(node->arrayAssign.value, visit, userData);
+            break;
+        case AST_IF_STMT:
+            visit_reads(node->ifStmt.condition, visit, userData);
+            for (int i = 0; i < node->ifStmt.thenCount; i++) visit_reads(node->ifStmt.thenBranch[i], visit, userData);
+            for (int i = 0; i < node->ifStmt.elseCount; i++) visit_reads(node->ifStmt.elseBranch[i], visit, userData);
+            break;
+        case AST_BLOCK:
+            for (int i = 0; i < node->block.statementCount; i++) visit_reads(node->block.statements[i], visit, userData);
+            break;
+        default:
+            break;
+    }
+}
+
+/**
+ * @brief Counter of the reads of one name
+ */
+typedef struct {
+    const char* name;
+    int count;
+} ReadCount;
+
+static void count_read(const char* key, void* value, void* userData) {
+    (void)value;
+    ReadCount* reads = userData;
+    if (strcmp(key, reads->name) == 0) reads->count++;
+}
+
+/**
+ * @brief Checks whether a statement is `s = s + e` (or `e + s`, `s - e`) without other reads of s
+ */
+static bool is_sum_update(AstNode* stmt) {
+    if (!stmt || stmt->type != AST_VAR_ASSIGN) return false;
+    AstNode* init = stmt->varAssign.initializer;
+    if (!init || init->type != AST_BINARY_OP || (init->binaryOp.op != '+' && init->binaryOp.op != '-')) return false;
+
+    const char* name = stmt->varAssign.name;
+    AstNode* left = init->binaryOp.left;
+    AstNode* right = init->binaryOp.right;
+    AstNode* other = NULL;
+    if (left && left->type == AST_IDENTIFIER && strcmp(left->identifier.name, name) == 0) {
+        other = right;
+    } else if (init->binaryOp.op == '+' && right && right->type == AST_IDENTIFIER &&
+               strcmp(right->identifier.name, name) == 0) {
+        other = left;
+    }
+    if (!other) return false;
+
+    ReadCount reads = { name, 0 };
+    visit_reads(other, count_read, &reads);
+    return reads.count == 0;
+}
+
+/**
+ * @brief State of the in-order scan for values carried between iterations
+ */
+typedef struct {
+    LoopScan* scan;
+    HashMap* assigned;             ///< Scalars assigned earlier in the iteration
+    const char* reduction;         ///< Sum variable of the statement being scanned
+} CarryScan;
+
+static void check_carried_read(const char* key, void* value, void* userData) {
+    (void)value;
+    CarryScan* carry = userData;
+    LoopScan* scan = carry->scan;
+    if (scan->rejected || !hashmap_contains(scan->scalarWrites, key) || hashmap_contains(carry->assigned, key)) return;
+    if (carry->reduction && strcmp(key, carry->reduction) == 0) return;
+    reject(scan, "'%s' carries a value from one iteration to the next", key);
+}
+
+/**
+ * @brief Finds scalars read before the iteration assigns them
+ *
+ * An integer sum updated once at the top level of the body is a reduction
+ * the C compiler vectorizes; a floating-point one is not, since adding in a
+ * different order changes the result.
+ */
+static void check_carried_scalars(AstNode** body, int count, LoopScan* scan) {
+    CarryScan carry = { scan, hashmap_create(16), NULL };
+    if (!carry.assigned) {
+        reject(scan, "out of memory", NULL);
+        return;
+    }
+
+    for (int i = 0; i < count && !scan->rejected; i++) {
+        AstNode* stmt = body[i];
+        // A bare name (what 'var' leaves before an assignment) reads nothing
+        if (!stmt || stmt->type == AST_IDENTIFIER) continue;
+        carry.reduction = NULL;
+        if (is_sum_update(stmt) && (intptr_t)hashmap_get(scan->scalarWrites, stmt->varAssign.name) == 1) {
+            const char* name = stmt->varAssign.name;
+            ReadCount reads = { name, 0 };
+            for (int j = 0; j < count; j++) visit_reads(body[j], count_read, &reads);
+            const char* type = scan->variableType ? scan->variableType(name) : NULL;
+            if (reads.count == 1 && type) {
+                if (strcmp(type, "int64_t") != 0) {
+                    reject(scan, "'%s' is a floating-point sum, which may only be added in order", name);
+                    break;
+                }
+                carry.reduction = name;
+            }
+        }
+        visit_reads(stmt, check_carried_read, &carry);
+        if (stmt->type == AST_VAR_ASSIGN) {
+            hashmap_put(carry.assigned, stmt->varAssign.name, NULL, NULL);
+        } else if (stmt->type == AST_VAR_DECL) {
+            hashmap_put(carry.assigned, stmt->varDecl.name, NULL, NULL);
+        }
+    }
+    hashmap_free(carry.assigned, NULL);
+}
+
+/**
+ * @brief Checks that the range end reads nothing the body changes
+ */
+static void check_end_read(const char* key, void* value, void* userData) {
+    (void)value;
+    LoopScan* scan = userData;
+    if (hashmap_contains(scan->scalarWrites, key)) scan->verdict->hoist_end = false;
+}
+
+/**
+ * @brief Checks whether a C type is one the code generator gives Lyn arrays
+ */
+static bool is_array_type(const char* type) {
+    return type && (strcmp(type, "int64_t*") == 0 || strcmp(type, "double*") == 0 ||
+                    strcmp(type, "const char**") == 0);
+}
+
+/**
+ * @brief hashmap_foreach callback recording one accessed array in a candidate
+ */
+static void check_array(const char* key, void* value, void* userData) {
+    (void)value;
+    LoopScan* scan = userData;
+    VectorizeLoop* verdict = scan->verdict;
+    if (scan->rejected) return;
+
+    if (hashmap_contains(scan->scalarWrites, key)) {
+        reject(scan, "'%s' is reassigned inside the loop", key);
+        return;
+    }
+    const char* type = scan->variableType ? scan->variableType(key) : NULL;
+    if (!is_array_type(type)) {
+        reject(scan, "'%s' is not a typed array", key);
+        return;
+    }
+    if (!is_fresh_array(key)) {
+        reject(scan, "'%s' may share its storage with another array", key);
+        return;
+    }
+    if (verdict->array_count == VECTORIZE_MAX_ARRAYS ||
+        strlen(key) >= sizeof(verdict->arrays[0])) {
+        reject(scan, "loop accesses too many arrays", NULL);
+        return;
+    }
+    snprintf(verdict->arrays[verdict->array_count], sizeof(verdict->arrays[0]), "%s", key);
+    snprintf(verdict->array_types[verdict->array_count], sizeof(verdict->array_types[0]), "%s", type);
+    verdict->array_count++;
+}
+
+/**
+ * @brief Analyzes a range loop
+ */
+static void analyze_range_loop(AstNode* loop, VectorizeTypeFn variableType, VectorizeLoop* verdict) {
+    LoopScan scan = {0};
+    scan.iterator = loop->forStmt.iterator;
+    scan.variableType = variableType;
+    scan.verdict = verdict;
+    scan.scalarWrites = hashmap_create(16);
+    scan.arrayWrites = hashmap_create(8);
+    scan.arrays = hashmap_create(8);
+    if (!scan.scalarWrites || !scan.arrayWrites || !scan.arrays) {
+        reject(&scan, "out of memory", NULL);
+    }
+
+    AstNode* step = loop->forStmt.rangeStep;
+    if (step && (step->type != AST_NUMBER_LITERAL || step->numberLiteral.value < 1 ||
+                 step->numberLiteral.value != (double)(int)step->numberLiteral.value)) {
+        reject(&scan, "step is not a positive integer constant", NULL);
+    }
+    if (profile_get_mode() == PROFILE_GENERATE) {
+        reject(&scan, "loop is instrumented by --profile-generate", NULL);
+    }
+
+    scan_statements(loop->forStmt.body, loop->forStmt.bodyCount, &scan);
+    scan_expression(loop->forStmt.rangeStart, &scan);
+    scan_expression(loop->forStmt.rangeEnd, &scan);
+    if (!scan.rejected && hashmap_contains(scan.scalarWrites, scan.iterator)) {
+        reject(&scan, "iterator '%s' is assigned in the body", scan.iterator);
+    }
+    for (int i = 0; i < loop->forStmt.bodyCount && !scan.rejected; i++) {
+        check_array_reads(loop->forStmt.body[i], &scan);
+    }
+    if (!scan.rejected) {
+        check_array_reads(loop->forStmt.rangeEnd, &scan);
+    }
+    if (!scan.rejected) {
+        check_carried_scalars(loop->forStmt.body, loop->forStmt.bodyCount, &scan);
+    }
+    if (!scan.rejected && hashmap_count(scan.arrays) == 0) {
+        reject(&scan, "no array accesses to hint", NULL);
+    }
+    if (!scan.rejected) {
+        hashmap_foreach(scan.arrays, check_array, &scan);
+    }
+    if (!scan.rejected) {
+        verdict->hoist_end = true;
+        visit_reads(loop->forStmt.rangeEnd, check_end_read, &scan);
+        verdict->candidate = true;
+    } else {
+        verdict->array_count = 0;
+    }
+
+    hashmap_free(scan.scalarWrites, NULL);
+    hashmap_free(scan.arrayWrites, NULL);
+    hashmap_free(scan.arrays, NULL);
+}
+
+const VectorizeLoop* vectorize_analyze_loop(AstNode* loop, VectorizeTypeFn variableType) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)vectorize_analyze_loop);
+
+    if (!loop) return NULL;
+    if (loopCount == loopCapacity) {
+        int capacity = loopCapacity ? loopCapacity * 2 : 16;
+        VectorizeLoop** grown = realloc(loops, capacity * sizeof(VectorizeLoop*));
+        if (!grown) {
+            error_report("Vectorize", __LINE__, 0, "Failed to grow the loop table", ERROR_MEMORY);
+            return NULL;
+        }
+        loops = grown;
+        loopCapacity = capacity;
+    }
+    VectorizeLoop* verdict = calloc(1, sizeof(VectorizeLoop));
+    if (!verdict) {
+        error_report("Vectorize", __LINE__, 0, "Failed to allocate a loop verdict", ERROR_MEMORY);
+        return NULL;
+    }
+    verdict->id = loopCount;
+    verdict->line = loop->line;
+    verdict->col = loop->col;
+
+    switch (loop->type) {
+        case AST_FOR_STMT:
+            snprintf(verdict->kind, sizeof(verdict->kind), "for");
+            if (loop->forStmt.forType != FOR_TRADITIONAL) {
+                snprintf(verdict->iterator, sizeof(verdict->iterator), "%s", loop->forStmt.iterator);
+            }
+            if (loop->forStmt.forType == FOR_RANGE) {
+                analyze_range_loop(loop, variableType, verdict);
+            } else if (loop->forStmt.forType == FOR_COLLECTION) {
+                snprintf(verdict->reason, sizeof(verdict->reason), "only range loops are analyzed");
+            } else {
+                snprintf(verdict->reason, sizeof(verdict->reason), "C-style loop: the trip count is not known on entry");
+            }
+            break;
+        case AST_WHILE_STMT:
+            snprintf(verdict->kind, sizeof(verdict->kind), "while");
+            snprintf(verdict->reason, sizeof(verdict->reason), "while loop: the trip count is not known on entry");
+            break;
+        case AST_DO_WHILE_STMT:
+            snprintf(verdict->kind, sizeof(verdict->kind), "do-while");
+            snprintf(verdict->reason, sizeof(verdict->reason), "do-while loop: the trip count is not known on entry");
+            break;
+        default:
+            free(verdict);
+            return NULL;
+    }
+
+    loops[loopCount++] = verdict;
+    stats.loops_analyzed++;
+    if (verdict->candidate) {
+        stats.loops_hinted++;
+        logger_log(LOG_DEBUG, "Vectorize: loop %d at %d:%d is independent (%d arrays)",
+                   verdict->id, verdict->line, verdict->col, verdict->array_count);
+    } else {
+        logger_log(LOG_DEBUG, "Vectorize: loop %d at %d:%d not hinted: %s",
+                   verdict->id, verdict->line, verdict->col, verdict->reason);
+    }
+    return verdict;
+}
+
+/* ------------------------------------------------------------------------ */
+/* Report                                                                    */
+/* ------------------------------------------------------------------------ */
+
+/**
+ * @brief Finds the line of the generated C where each loop marker is
+ *
+ * @param cPath Generated C file
+ * @param markerLines Output: line of marker N (0 if not found), loopCount entries
+ */
+static void find_loop_markers(const char* cPath, int* markerLines) {
+    FILE* file = fopen(cPath, "r");
+    if (!file) return;
+
+    char line[4096];
+    int number = 0;
+    while (fgets(line, sizeof(line), file)) {
+        number++;
+        const char* marker = strstr(line, "// lyn-loop ");
+        if (!marker) continue;
+        int id = atoi(marker + strlen("// lyn-loop "));
+        if (id >= 0 && id < loopCount) markerLines[id] = number;
+    }
+    fclose(file);
+}
+
+/**
+ * @brief Finds the loop whose generated C contains a line
+ *
+ * A loop spans from its marker to the next marker, so a vectorized inner
+ * loop is not credited to the loop around it.
+ *
+ * @return int Loop id, or -1 if the line is outside every loop
+ */
+static int loop_at_line(const int* markerLines, int cLine) {
+    int best = -1;
+    for (int i = 0; i < loopCount; i++) {
+        if (markerLines[i] > 0 && markerLines[i] <= cLine &&
+            (best < 0 || markerLines[i] > markerLines[best])) {
+            best = i;
+        }
+    }
+    return best;
+}
+
+void vectorize_print_report(FILE* out, const char* sourcePath, const char* cPath, const char* optInfoPath) {
+    error_push_debug(__func__, __FILE__, __LINE__, (void*)vectorize_print_report);
+
+    if (!out) return;
+    fprintf(out, "Vectorization report for %s:\n", sourcePath ? sourcePath : "program");
+    if (loopCount == 0) {
+        fprintf(out, "  no loops\n");
+        return;
+    }
+
+    int* markerLines = calloc(loopCount, sizeof(int));
+    bool* vectorized = calloc(loopCount, sizeof(bool));
+    if (!markerLines || !vectorized) {
+        error_report("Vectorize", __LINE__, 0, "Failed to allocate the report tables", ERROR_MEMORY);
+        free(markerLines);
+        free(vectorized);
+        return;
+    }
+
+    if (optInfoPath) {
+        find_loop_markers(cPath, markerLines);
+        FILE* info = fopen(optInfoPath, "r");
+        if (info) {
+            // Lines look like "prog.c:42:9: optimized: loop vectorized using 16 byte vectors"
+            char line[1024];
+            while (fgets(line, sizeof(line), info)) {
+                if (!strstr(line, "optimized: loop vectorized")) continue;
+                const char* position = strstr(line, ".c:");
+                if (!position) continue;
+                int id = loop_at_line(markerLines, atoi(position + 3));
+                if (id >= 0) vectorized[id] = true;
+            }
+            fclose(info);
+        } else {
+            logger_log(LOG_WARNING, "No vectorization remarks in %s", optInfoPath);
+        }
+    } else {
+        fprintf(out, "  (the C compiler only vectorizes at -o 2; showing the Lyn analysis)\n");
+    }
+
+    stats.loops_vectorized = 0;
+    for (int i = 0; i < loopCount; i++) {
+        const VectorizeLoop* loop = loops[i];
+        char where[sizeof(loop->kind) + sizeof(loop->iterator)];
+        if (loop->iterator[0]) {
+            snprintf(where, sizeof(where), "%s %s", loop->kind, loop->iterator);
+        } else {
+            snprintf(where, sizeof(where), "%s", loop->kind);
+        }
+        if (loop->line > 0) {
+            fprintf(out, "  %s loop at %d:%d: ", where, loop->line, loop->col);
+        } else {
+            fprintf(out, "  %s loop #%d: ", where, loop->id + 1);
+        }
+
+        if (vectorized[i]) stats.loops_vectorized++;
+        if (!optInfoPath) {
+            if (loop->candidate) fprintf(out, "independent, hints emitted\n");
+            else fprintf(out, "not vectorizable: %s\n", loop->reason);
+        } else if (vectorized[i] && loop->candidate) {
+            fprintf(out, "vectorized\n");
+        } else if (vectorized[i]) {
+            fprintf(out, "vectorized by the C compiler on its own (%s)\n", loop->reason);
+        } else if (loop->candidate) {
+            fprintf(out, "not vectorized: hints emitted, but the C compiler did not vectorize it\n");
+        } else {
+            fprintf(out, "not vectorized: %s\n", loop->reason);
+        }
+    }
+
+    free(markerLines);
+    free(vectorized);
+}
@@ -0,0 +1,132 @@
+/**
+ * @file vectorize.h
+ * @brief Vectorization analysis and reporting for the Lyn compiler
+ *
+ * The C compiler only vectorizes a loop when it can prove that iterations
+ * are independent, which it rarely can for code that reaches arrays through
+ * plain pointers. This module does the proof on the Lyn side, where more is
+ * known: every array literal is a fresh allocation, so two array variables
+ * that are only ever assigned literals cannot alias.
+ *
+ * For each range loop the code generator asks for a verdict. A loop is a
+ * candidate when its body is straight-line arithmetic on arrays and scalars,
+ * every array it stores to is indexed by the iterator alone and read nowhere
+ * else, and no scalar carries a value between iterations except an integer
+ * sum. Candidates are emitted with the range end hoisted into a constant,
+ * restrict-qualified pointers that are assumed 32-byte aligned, and
+ * `#pragma GCC ivdep`.
+ *
+ * With --vectorize-report every loop is also marked in the generated C, and
+ * after the C compiler has run its -fopt-info output is mapped back to the
+ * Lyn loops to report which were vectorized and why the others were not.
+ */
+
+#ifndef VECTORIZE_H
+#define VECTORIZE_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "ast.h"
+
+/** Alignment (bytes) of the element storage of Lyn arrays */
+#define VECTORIZE_ALIGNMENT 32
+
+/** Most distinct arrays a candidate loop may access */
+#define VECTORIZE_MAX_ARRAYS 8
+
+/**
+ * @brief Gives the C type of a variable declared before the loop
+ *
+ * @param name Variable name
+ * @return const char* C type, or NULL if the variable is not declared yet
+ */
+typedef const char* (*VectorizeTypeFn)(const char* name);
+
+/**
+ * @brief Verdict on one Lyn loop
+ */
+typedef struct {
+    int id;                    ///< Loop number, in code generation order
+    int line;                  ///< Source line of the loop (0 if unknown)
+    int col;                   ///< Source column of the loop
+    char kind[16];             ///< "for", "while" or "do-while"
+    char iterator[256];        ///< Iterator of range and collection loops ("" otherwise)
+    bool candidate;            ///< Independence proven: emitted with restrict, alignment and ivdep
+    bool hoist_end;            ///< The range end is loop-invariant and evaluated once
+    char reason[384];          ///< Why the loop is not a candidate (may quote a name)
+    int array_count;           ///< Arrays the loop accesses (candidates only)
+    char arrays[VECTORIZE_MAX_ARRAYS][64];      ///< Their names
+    char array_types[VECTORIZE_MAX_ARRAYS][64]; ///< Their C pointer types
+} VectorizeLoop;
+
+/**
+ * @brief Statistics about vectorization
+ */
+typedef struct {
+    int loops_analyzed;        ///< Loops given a verdict
+    int loops_hinted;          ///< Candidates emitted with vectorization hints
+    int loops_vectorized;      ///< Loops the C compiler reported vectorized (with a report)
+} VectorizeStats;
+
+/**
+ * @brief Enables the vectorization report
+ *
+ * @param enabled true to mark loops in the generated C and report on them
+ */
+void vectorize_set_report(bool enabled);
+
+/**
+ * @brief Checks whether the vectorization report is enabled
+ *
+ * @return bool true if loops should be marked in the generated C
+ */
+bool vectorize_report_enabled(void);
+
+/**
+ * @brief Prepares the analysis of a program
+ *
+ * Forgets the loops of any earlier program and finds the fresh arrays:
+ * variables that are only ever assigned array literals and never appear as
+ * parameters, iterators or declarations.
+ *
+ * @param program AST_PROGRAM node
+ */
+void vectorize_begin_program(AstNode* program);
+
+/**
+ * @brief Gives the verdict on a loop and records it for the report
+ *
+ * @param loop For, while or do-while statement
+ * @param variableType Types of the variables declared before the loop
+ * @return const VectorizeLoop* Verdict (valid until the next program), or NULL on allocation failure
+ */
+const VectorizeLoop* vectorize_analyze_loop(AstNode* loop, VectorizeTypeFn variableType);
+
+/**
+ * @brief Prints the vectorization report
+ *
+ * Loops are located in the generated C by their `// lyn-loop N` markers;
+ * the C compiler's `-fopt-info-vec-optimized` output says which of those
+ * lines it vectorized.
+ *
+ * @param out Stream for the report
+ * @param sourcePath Lyn source file (for the heading)
+ * @param cPath Generated C file
+ * @param optInfoPath File the C compiler wrote its vectorization remarks to, or NULL
+ *                    if it was not asked to vectorize
+ */
+void vectorize_print_report(FILE* out, const char* sourcePath, const char* cPath, const char* optInfoPath);
+
+/**
+ * @brief Gets the vectorization statistics
+ *
+ * @return VectorizeStats Current statistics
+ */
+VectorizeStats vectorize_get_stats(void);
+
+/**
+ * @brief Releases the loop verdicts and the fresh array table
+ */
+void vectorize_cleanup(void);
+
+#endif /* VECTORIZE_H */
@@ -0,0 +1,44 @@
+#!/bin/bash
+
+# Compila y ejecuta las pruebas unitarias de tests/ contra los módulos del
+# compilador (todos los de src/ salvo main.c). Uso: tests/run_tests.sh [prueba...]
+
+# Colores para los mensajes
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m'
+
+ROOT="$(cd "$(dirname "$0")/.." && pwd)"
+BUILD="${TMPDIR:-/tmp}/lyn_tests"
+mkdir -p "$BUILD"
+
+SOURCES=$(ls "$ROOT"/src/*.c | grep -v '/main\.c$')
+if [ $# -gt 0 ]; then
+    TESTS="$@"
+else
+    TESTS=$(ls "$ROOT"/tests/test_*.c)
+fi
+
+FAILED=0
+for TEST in $TESTS; do
+    NAME=$(basename "$TEST" .c)
+    echo -e "${YELLOW}Compilando $NAME...${NC}"
+    gcc $CFLAGS -w -o "$BUILD/$NAME" "$TEST" $SOURCES -rdynamic -I"$ROOT/src"
+    if [ $? -ne 0 ]; then
+        echo -e "${RED}Error compilando $NAME${NC}"
+        FAILED=$((FAILED + 1))
+        continue
+    fi
+    (cd "$ROOT" && "$BUILD/$NAME")
+    if [ $? -ne 0 ]; then
+        echo -e "${RED}$NAME falló${NC}"
+        FAILED=$((FAILED + 1))
+    fi
+done
+
+if [ $FAILED -ne 0 ]; then
+    echo -e "${RED}$FAILED prueba(s) fallaron${NC}"
+    exit 1
+fi
+echo -e "${GREEN}¡Todas las pruebas pasaron!${NC}"
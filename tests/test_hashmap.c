@@ -0,0 +1,199 @@
+/**
+ * @file test_hashmap.c
+ * @brief Unit tests for the string-keyed hash map (src/hashmap.c)
+ *
+ * Covers insertion, replacement, removal, growth far past the initial
+ * capacity, keys whose full 32-bit hashes collide, traversal and release
+ * of the stored values. Run with tests/run_tests.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hashmap.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/** Values released through free_counted() */
+static int freedValues = 0;
+
+static void free_counted(void* value) {
+    freedValues++;
+    free(value);
+}
+
+static void count_entry(const char* key, void* value, void* userData) {
+    (void)key;
+    (void)value;
+    (*(int*)userData)++;
+}
+
+static void test_put_get_replace(void) {
+    HashMap* map = hashmap_create(0);
+    CHECK(map != NULL);
+    int a = 1, b = 2;
+    void* old = &a;
+
+    CHECK(hashmap_put(map, "alpha", &a, &old));
+    CHECK(old == NULL);
+    CHECK(hashmap_get(map, "alpha") == &a);
+    CHECK(hashmap_contains(map, "alpha"));
+    CHECK(!hashmap_contains(map, "beta"));
+    CHECK(hashmap_get(map, "beta") == NULL);
+
+    // Replacing a key keeps one entry and hands back the previous value
+    CHECK(hashmap_put(map, "alpha", &b, &old));
+    CHECK(old == &a);
+    CHECK(hashmap_get(map, "alpha") == &b);
+    CHECK(hashmap_count(map) == 1);
+
+    // The empty string is an ordinary key
+    CHECK(hashmap_put(map, "", &a, NULL));
+    CHECK(hashmap_get(map, "") == &a);
+    CHECK(hashmap_count(map) == 2);
+
+    // Keys are copied: changing the caller's buffer does not change the map
+    char key[16] = "gamma";
+    CHECK(hashmap_put(map, key, &b, NULL));
+    key[0] = 'G';
+    CHECK(hashmap_get(map, "gamma") == &b);
+    CHECK(hashmap_get(map, key) == NULL);
+
+    hashmap_free(map, NULL);
+}
+
+static void test_null_arguments(void) {
+    CHECK(hashmap_get(NULL, "x") == NULL);
+    CHECK(!hashmap_contains(NULL, "x"));
+    CHECK(hashmap_remove(NULL, "x") == NULL);
+    CHECK(hashmap_count(NULL) == 0);
+    CHECK(!hashmap_put(NULL, "x", NULL, NULL));
+
+    HashMap* map = hashmap_create(4);
+    CHECK(!hashmap_put(map, NULL, NULL, NULL));
+    CHECK(hashmap_get(map, NULL) == NULL);
+    hashmap_free(map, NULL);
+    hashmap_free(NULL, NULL);
+}
+
+static void test_growth(void) {
+    // Starts with the default buckets and has to double many times
+    HashMap* map = hashmap_create(1);
+    enum { KEYS = 20000 };
+    char key[32];
+    for (int i = 0; i < KEYS; i++) {
+        int* value = malloc(sizeof(int));
+        *value = i;
+        snprintf(key, sizeof(key), "key%d", i);
+        CHECK(hashmap_put(map, key, value, NULL));
+    }
+    CHECK(hashmap_count(map) == KEYS);
+
+    int wrong = 0;
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        int* value = hashmap_get(map, key);
+        if (!value || *value != i) wrong++;
+    }
+    CHECK(wrong == 0);
+
+    // Remove every other key; the rest must still be found
+    for (int i = 0; i < KEYS; i += 2) {
+        snprintf(key, sizeof(key), "key%d", i);
+        free(hashmap_remove(map, key));
+    }
+    CHECK(hashmap_count(map) == KEYS / 2);
+    wrong = 0;
+    for (int i = 0; i < KEYS; i++) {
+        snprintf(key, sizeof(key), "key%d", i);
+        if (hashmap_contains(map, key) != (i % 2 == 1)) wrong++;
+    }
+    CHECK(wrong == 0);
+    CHECK(hashmap_remove(map, "key0") == NULL);
+
+    int visited = 0;
+    hashmap_foreach(map, count_entry, &visited);
+    CHECK(visited == KEYS / 2);
+
+    freedValues = 0;
+    hashmap_free(map, free_counted);
+    CHECK(freedValues == KEYS / 2);
+}
+
+static void test_collisions(void) {
+    // These two keys have the same 32-bit FNV-1a hash, so they share a
+    // bucket at every size and only the key comparison tells them apart
+    const char* first = "key583084";
+    const char* second = "key1092000";
+    CHECK(hashmap_hash_string(first) == hashmap_hash_string(second));
+
+    HashMap* map = hashmap_create(0);
+    int a = 1, b = 2;
+    CHECK(hashmap_put(map, first, &a, NULL));
+    CHECK(hashmap_put(map, second, &b, NULL));
+    CHECK(hashmap_count(map) == 2);
+    CHECK(hashmap_get(map, first) == &a);
+    CHECK(hashmap_get(map, second) == &b);
+
+    // Growing redistributes the chain without losing either key
+    char key[32];
+    for (int i = 0; i < 1000; i++) {
+        snprintf(key, sizeof(key), "filler%d", i);
+        hashmap_put(map, key, &a, NULL);
+    }
+    CHECK(hashmap_get(map, first) == &a);
+    CHECK(hashmap_get(map, second) == &b);
+
+    // Removing one leaves the other in place, whichever is first in the chain
+    CHECK(hashmap_remove(map, second) == &b);
+    CHECK(hashmap_get(map, first) == &a);
+    CHECK(hashmap_get(map, second) == NULL);
+    CHECK(hashmap_put(map, second, &b, NULL));
+    CHECK(hashmap_remove(map, first) == &a);
+    CHECK(hashmap_get(map, second) == &b);
+
+    hashmap_free(map, NULL);
+}
+
+static void test_clear(void) {
+    HashMap* map = hashmap_create(8);
+    for (int i = 0; i < 100; i++) {
+        char key[16];
+        snprintf(key, sizeof(key), "k%d", i);
+        hashmap_put(map, key, malloc(1), NULL);
+    }
+    freedValues = 0;
+    hashmap_clear(map, free_counted);
+    CHECK(freedValues == 100);
+    CHECK(hashmap_count(map) == 0);
+    CHECK(hashmap_get(map, "k1") == NULL);
+
+    // A cleared map is still usable
+    int a = 1;
+    CHECK(hashmap_put(map, "k1", &a, NULL));
+    CHECK(hashmap_get(map, "k1") == &a);
+    hashmap_free(map, NULL);
+}
+
+int main(void) {
+    test_put_get_replace();
+    test_null_arguments();
+    test_growth();
+    test_collisions();
+    test_clear();
+
+    if (failures) {
+        fprintf(stderr, "test_hashmap: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_hashmap: all checks passed\n");
+    return 0;
+}
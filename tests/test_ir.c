@@ -0,0 +1,155 @@
+/**
+ * @file test_ir.c
+ * @brief Unit tests for the IR lowering of program bodies (src/ir.c)
+ *
+ * A body that defines and calls functions must be lowered to the IR, with
+ * the functions left to the AST emitter, and compiled through the IR when
+ * the compiler's IR path is enabled. A function that shares a variable with
+ * the body makes the lowering fall back. Run with tests/run_tests.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+#include "lexer.h"
+#include "parser.h"
+#include "compiler.h"
+#include "ir.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/** Defines two functions and calls them from a loop and a printed concatenation */
+static const char* callingProgram =
+    "main\n"
+    "    func twice(tw: int) -> int\n"
+    "        return tw * 2;\n"
+    "    end\n"
+    "    func report(rv: int)\n"
+    "        print(rv)\n"
+    "    end\n"
+    "    var total = 0;\n"
+    "    for k in range(0, 4)\n"
+    "        total = total + twice(k);\n"
+    "    end\n"
+    "    report(total)\n"
+    "    print(\"total: \" + total)\n"
+    "end\n";
+
+/** The function writes a variable of the body */
+static const char* sharingProgram =
+    "main\n"
+    "    var hits = 0;\n"
+    "    func hit()\n"
+    "        hits = hits + 1;\n"
+    "    end\n"
+    "    hit()\n"
+    "    print(hits)\n"
+    "end\n";
+
+static AstNode* parse(const char* source) {
+    lexerInit(source);
+    return parseProgram();
+}
+
+/**
+ * @brief Counts the calls to a function in the lowered IR
+ */
+static int count_calls(IrFunction* fn, const char* name) {
+    int count = 0;
+    for (int b = 0; b < fn->blockCount; b++) {
+        for (int i = 0; i < fn->blocks[b]->instrCount; i++) {
+            IrInstr* instr = fn->blocks[b]->instrs[i];
+            if (instr->op == IR_CALL && strcmp(instr->name, name) == 0) count++;
+        }
+    }
+    return count;
+}
+
+static void test_lowering_with_functions(void) {
+    ir_init(2);
+    AstNode* program = parse(callingProgram);
+    CHECK(program != NULL);
+    if (!program) return;
+
+    IrFunction* fn = ir_lower_program(program, NULL);
+    CHECK(fn != NULL);
+    if (fn) {
+        CHECK(count_calls(fn, "twice") == 1);
+        CHECK(count_calls(fn, "report") == 1);
+        ir_optimize(fn);
+        CHECK(count_calls(fn, "twice") == 1);
+        ir_free(fn);
+    }
+    IrStats stats = ir_get_stats();
+    CHECK(stats.functions_lowered == 1);
+    CHECK(stats.lowering_fallbacks == 0);
+    freeAst(program);
+}
+
+static void test_shared_variable_falls_back(void) {
+    ir_init(2);
+    AstNode* program = parse(sharingProgram);
+    CHECK(program != NULL);
+    if (!program) return;
+
+    CHECK(ir_lower_program(program, NULL) == NULL);
+    CHECK(ir_get_stats().lowering_fallbacks == 1);
+    freeAst(program);
+}
+
+static void test_compiler_takes_ir_path(void) {
+    ir_init(2);
+    compiler_set_use_ir(true);
+    AstNode* program = parse(callingProgram);
+    CHECK(program != NULL);
+    if (!program) return;
+
+    char path[512];
+    const char* dir = getenv("TMPDIR");
+    snprintf(path, sizeof(path), "%s/test_ir_output.c", dir ? dir : "/tmp");
+    CHECK(compileToC(program, path));
+    CHECK(ir_get_stats().functions_lowered == 1);
+
+    FILE* file = fopen(path, "r");
+    CHECK(file != NULL);
+    if (file) {
+        static char code[1 << 16];
+        size_t length = fread(code, 1, sizeof(code) - 1, file);
+        code[length] = '\0';
+        fclose(file);
+        // The functions come first, then the body as labelled SSA blocks that call them
+        const char* definition = strstr(code, "int64_t twice(");
+        const char* body = strstr(code, "// Lyn IR:");
+        CHECK(definition != NULL);
+        CHECK(body != NULL);
+        CHECK(definition && body && definition < body);
+        CHECK(body && strstr(body, "= twice(") != NULL);
+        CHECK(body && strstr(body, "report(") != NULL);
+    }
+    remove(path);
+    compiler_set_use_ir(false);
+    freeAst(program);
+}
+
+int main(void) {
+    lexerInitialize();
+    test_lowering_with_functions();
+    test_shared_variable_falls_back();
+    test_compiler_takes_ir_path();
+
+    if (failures) {
+        fprintf(stderr, "test_ir: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_ir: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file test_macro_expansion.c
+ * @brief Unit tests for macro expansion (src/macro_evaluator.c)
+ *
+ * No Lyn syntax defines macros yet, so the programs below are built by hand:
+ * a function named macro_* is registered as a macro by macro_expand_all()
+ * and each call to it is replaced by its body. Every call must get its own
+ * copy with the arguments substituted, and macros that call macros must be
+ * expanded in one walk. Run with tests/run_tests.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+#include "macro_evaluator.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+static AstNode* identifier(const char* name) {
+    AstNode* node = createAstNode(AST_IDENTIFIER);
+    strncpy(node->identifier.name, name, sizeof(node->identifier.name) - 1);
+    return node;
+}
+
+static AstNode* number(double value) {
+    AstNode* node = createAstNode(AST_NUMBER_LITERAL);
+    node->numberLiteral.value = value;
+    return node;
+}
+
+static AstNode* binary(char op, AstNode* left, AstNode* right) {
+    AstNode* node = createAstNode(AST_BINARY_OP);
+    node->binaryOp.op = op;
+    node->binaryOp.left = left;
+    node->binaryOp.right = right;
+    return node;
+}
+
+/**
+ * @brief Builds a statement that calls a macro with one argument
+ */
+static AstNode* call(const char* name, AstNode* argument) {
+    AstNode* node = createAstNode(AST_FUNC_CALL);
+    strncpy(node->funcCall.name, name, sizeof(node->funcCall.name) - 1);
+    node->funcCall.arguments = malloc(sizeof(AstNode*));
+    node->funcCall.arguments[0] = argument;
+    node->funcCall.argCount = 1;
+    return node;
+}
+
+/**
+ * @brief Builds macro_show(x), whose body is print(x * 2)
+ */
+static AstNode* show_macro(void) {
+    AstNode* print = createAstNode(AST_PRINT_STMT);
+    print->printStmt.expr = binary('*', identifier("x"), number(2));
+    AstNode* def = createAstNode(AST_FUNC_DEF);
+    strcpy(def->funcDef.name, "macro_show");
+    def->funcDef.parameters = malloc(sizeof(AstNode*));
+    def->funcDef.parameters[0] = identifier("x");
+    def->funcDef.paramCount = 1;
+    def->funcDef.body = malloc(sizeof(AstNode*));
+    def->funcDef.body[0] = print;
+    def->funcDef.bodyCount = 1;
+    return def;
+}
+
+/**
+ * @brief Builds a program from the given statements
+ */
+static AstNode* program_of(AstNode** statements, int count) {
+    AstNode* program = createAstNode(AST_PROGRAM);
+    program->program.statements = malloc(count * sizeof(AstNode*));
+    memcpy(program->program.statements, statements, count * sizeof(AstNode*));
+    program->program.statementCount = count;
+    return program;
+}
+
+static void test_calls_are_substituted(void) {
+    macro_init();
+
+    AstNode* statements[] = {
+        show_macro(),
+        call("macro_show", binary('+', identifier("level"), number(1))),
+        call("macro_show", number(7)),
+        call("macro_show", binary('+', identifier("level"), number(1))),
+    };
+    AstNode* program = program_of(statements, sizeof(statements) / sizeof(statements[0]));
+    program = macro_expand_all(program, 0);
+
+    // The definition is removed and every call becomes one print statement
+    CHECK(program->program.statementCount == 3);
+    for (int i = 0; i < program->program.statementCount; i++) {
+        CHECK(program->program.statements[i]->type == AST_PRINT_STMT);
+    }
+    CHECK(macro_get_stats().expansions == 3);
+
+    // The argument was substituted, and equal calls still get their own copies
+    AstNode* first = program->program.statements[0]->printStmt.expr;
+    AstNode* again = program->program.statements[2]->printStmt.expr;
+    CHECK(first != again && first->binaryOp.left != again->binaryOp.left);
+    CHECK(first->type == AST_BINARY_OP && first->binaryOp.op == '*');
+    CHECK(first->binaryOp.left->type == AST_BINARY_OP);
+    CHECK(strcmp(first->binaryOp.left->binaryOp.left->identifier.name, "level") == 0);
+    CHECK(program->program.statements[1]->printStmt.expr->binaryOp.left->numberLiteral.value == 7);
+
+    freeAstNode(program);
+    macro_cleanup();
+}
+
+static void test_nested_macros_reach_a_fixed_point(void) {
+    macro_init();
+
+    // macro_pair(y) expands to macro_show(y) twice
+    AstNode* pair = createAstNode(AST_FUNC_DEF);
+    strcpy(pair->funcDef.name, "macro_pair");
+    pair->funcDef.parameters = malloc(sizeof(AstNode*));
+    pair->funcDef.parameters[0] = identifier("y");
+    pair->funcDef.paramCount = 1;
+    pair->funcDef.body = malloc(2 * sizeof(AstNode*));
+    pair->funcDef.body[0] = call("macro_show", identifier("y"));
+    pair->funcDef.body[1] = call("macro_show", identifier("y"));
+    pair->funcDef.bodyCount = 2;
+
+    AstNode* statements[] = { show_macro(), pair, call("macro_pair", number(5)) };
+    AstNode* program = program_of(statements, 3);
+    program = macro_expand_all(program, 0);
+
+    CHECK(program->program.statementCount == 2);
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode* print = program->program.statements[i];
+        CHECK(print->type == AST_PRINT_STMT);
+        CHECK(print->type == AST_PRINT_STMT &&
+              print->printStmt.expr->binaryOp.left->numberLiteral.value == 5);
+    }
+    MacroStats stats = macro_get_stats();
+    CHECK(stats.expansions == 3);
+    CHECK(stats.limit_reached == 0);
+
+    freeAstNode(program);
+    macro_cleanup();
+}
+
+int main(void) {
+    test_calls_are_substituted();
+    test_nested_macros_reach_a_fixed_point();
+
+    if (failures) {
+        fprintf(stderr, "test_macro_expansion: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_macro_expansion: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,274 @@
+/**
+ * @file test_pointcut.c
+ * @brief Unit tests and a timing for the pointcut matcher (src/aspect_weaver.c)
+ *
+ * The weaver compiles every pointcut into one DFA over function names. The
+ * tests weave hand-built programs and check, for every function, that the
+ * pointcuts it was advised by are exactly those fnmatch() accepts: prefixes,
+ * suffixes, '*' in the middle, "**" and exact names. Another test drives
+ * the matcher past MAX_MATCHER_STATES. The timing compares the weaver with
+ * the backtracking matcher it replaced, on hundreds of pointcuts and
+ * thousands of functions; it is printed, not checked. Run with
+ * tests/run_tests.sh.
+ */
+
+#include <fnmatch.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ast.h"
+#include "aspect_weaver.h"
+#include "logger.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief The matcher the DFA replaced, without its logging
+ *
+ * Kept here only to time it; it backtracks on every '*'.
+ */
+static bool backtracking_match(const char* pattern, const char* target) {
+    size_t pattern_len = strlen(pattern);
+    size_t target_len = strlen(target);
+    if (pattern_len > 0 && pattern[pattern_len - 1] == '*') {
+        size_t prefix_len = pattern_len - 1;
+        if (target_len >= prefix_len && strncmp(target, pattern, prefix_len) == 0) return true;
+    }
+    if (strcmp(pattern, target) == 0) return true;
+
+    const char* p = pattern;
+    const char* t = target;
+    while (*p && *t) {
+        if (*p == '*') {
+            p++;
+            if (!*p) return true;
+            while (*t) {
+                if (backtracking_match(p, t)) return true;
+                t++;
+            }
+            return false;
+        } else if (*p != *t) {
+            return false;
+        }
+        p++;
+        t++;
+    }
+    return *p == *t;
+}
+
+/**
+ * @brief Builds an aspect with one pointcut per pattern
+ *
+ * Pointcut i is named "pc<i>". With advise set, each pointcut gets a before
+ * advice of one print statement, so a function's body grows by one
+ * statement per pointcut that matches it.
+ */
+static AstNode* make_aspect(const char** patterns, int count, bool advise) {
+    AstNode* aspect = createAstNode(AST_ASPECT_DEF);
+    strcpy(aspect->aspectDef.name, "Probe");
+    aspect->aspectDef.pointcuts = malloc(count * sizeof(AstNode*));
+    aspect->aspectDef.pointcutCount = count;
+    aspect->aspectDef.advice = advise ? malloc(count * sizeof(AstNode*)) : NULL;
+    aspect->aspectDef.adviceCount = advise ? count : 0;
+    for (int i = 0; i < count; i++) {
+        AstNode* pointcut = createAstNode(AST_POINTCUT);
+        snprintf(pointcut->pointcut.name, sizeof(pointcut->pointcut.name), "pc%d", i);
+        snprintf(pointcut->pointcut.pattern, sizeof(pointcut->pointcut.pattern), "%s", patterns[i]);
+        aspect->aspectDef.pointcuts[i] = pointcut;
+        if (!advise) continue;
+
+        AstNode* print = createAstNode(AST_PRINT_STMT);
+        print->printStmt.expr = createAstNode(AST_NUMBER_LITERAL);
+        print->printStmt.expr->numberLiteral.value = i;
+        AstNode* advice = createAstNode(AST_ADVICE);
+        advice->advice.type = ADVICE_BEFORE;
+        strcpy(advice->advice.pointcutName, pointcut->pointcut.name);
+        advice->advice.body = malloc(sizeof(AstNode*));
+        advice->advice.body[0] = print;
+        advice->advice.bodyCount = 1;
+        aspect->aspectDef.advice[i] = advice;
+    }
+    return aspect;
+}
+
+/**
+ * @brief Builds a program holding the aspect and one empty function per name
+ */
+static AstNode* make_program(AstNode* aspect, char** names, int count) {
+    AstNode* program = createAstNode(AST_PROGRAM);
+    program->program.statements = malloc((count + 1) * sizeof(AstNode*));
+    program->program.statements[0] = aspect;
+    for (int i = 0; i < count; i++) {
+        AstNode* def = createAstNode(AST_FUNC_DEF);
+        snprintf(def->funcDef.name, sizeof(def->funcDef.name), "%s", names[i]);
+        program->program.statements[i + 1] = def;
+    }
+    program->program.statementCount = count + 1;
+    return program;
+}
+
+/**
+ * @brief Checks that each function was advised by exactly the pointcuts
+ *        fnmatch() accepts, in declaration order
+ */
+static void check_advised(AstNode* program, const char** patterns, int patternCount) {
+    for (int f = 1; f < program->program.statementCount; f++) {
+        AstNode* def = program->program.statements[f];
+        int expected = 0;
+        for (int p = 0; p < patternCount; p++) {
+            if (fnmatch(patterns[p], def->funcDef.name, 0) == 0) expected++;
+        }
+        if (def->funcDef.bodyCount != expected) {
+            fprintf(stderr, "%s: %d pointcuts matched, expected %d\n",
+                    def->funcDef.name, def->funcDef.bodyCount, expected);
+            failures++;
+            continue;
+        }
+        // Before advice is inserted at the top, so the last match comes first
+        int seen = expected;
+        for (int p = 0; p < patternCount; p++) {
+            if (fnmatch(patterns[p], def->funcDef.name, 0) != 0) continue;
+            AstNode* advice = def->funcDef.body[--seen];
+            AstNode* print = advice->type == AST_BLOCK ? advice->block.statements[0] : advice;
+            CHECK(print->type == AST_PRINT_STMT && print->printStmt.expr->numberLiteral.value == p);
+        }
+    }
+}
+
+static void test_pattern_shapes(void) {
+    const char* patterns[] = {
+        "get*",           // prefix
+        "*_test",         // suffix
+        "load*config",    // '*' in the middle
+        "a*b*c",          // several '*'
+        "**",             // same as '*'
+        "get**name",      // "**" in the middle
+        "render",         // exact name
+        "*x*",            // contains
+        "",               // matches nothing
+    };
+    char* names[] = {
+        "get", "getter", "get_name", "getname", "forget", "parse_test", "_test",
+        "test", "load_config", "loadconfig", "load_configs", "reload_config",
+        "abc", "aabbcc", "acb", "a_b_c_", "render", "renderer", "box", "x", "name_x_test",
+    };
+    int patternCount = sizeof(patterns) / sizeof(patterns[0]);
+    int nameCount = sizeof(names) / sizeof(names[0]);
+
+    weaver_init();
+    AstNode* program = make_program(make_aspect(patterns, patternCount, true), names, nameCount);
+    CHECK(weaver_process(program));
+    check_advised(program, patterns, patternCount);
+    CHECK(weaver_get_stats().matcher_resets == 0);
+
+    weaver_cleanup();
+    freeAstNode(program);
+}
+
+static void test_state_limit(void) {
+    // "*a*" ... "*m*": the DFA needs one state per subset of letters seen,
+    // 8192 in all, which is more than MAX_MATCHER_STATES allows at once
+    enum { LETTERS = 13 };
+    const char* patterns[LETTERS];
+    char patternText[LETTERS][4];
+    for (int i = 0; i < LETTERS; i++) {
+        snprintf(patternText[i], sizeof(patternText[i]), "*%c*", 'a' + i);
+        patterns[i] = patternText[i];
+    }
+    int nameCount = (1 << LETTERS) - 1;
+    char** names = malloc(nameCount * sizeof(char*));
+    for (int subset = 1; subset <= nameCount; subset++) {
+        names[subset - 1] = calloc(LETTERS + 1, 1);
+        for (int i = 0, len = 0; i < LETTERS; i++) {
+            if (subset & (1 << i)) names[subset - 1][len++] = 'a' + i;
+        }
+    }
+
+    weaver_init();
+    AstNode* program = make_program(make_aspect(patterns, LETTERS, true), names, nameCount);
+    CHECK(weaver_process(program));
+    CHECK(weaver_get_stats().matcher_resets > 0);
+    // Rebuilding the matcher between names does not change any result
+    check_advised(program, patterns, LETTERS);
+
+    weaver_cleanup();
+    freeAstNode(program);
+    for (int i = 0; i < nameCount; i++) free(names[i]);
+    free(names);
+}
+
+static double elapsed_ms(struct timespec start) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (now.tv_sec - start.tv_sec) * 1e3 + (now.tv_nsec - start.tv_nsec) / 1e6;
+}
+
+static void time_against_backtracking(void) {
+    enum { POINTCUTS = 400, FUNCTIONS = 3000 };
+    const char* patterns[POINTCUTS];
+    char patternText[POINTCUTS][48];
+    for (int i = 0; i < POINTCUTS; i++) {
+        switch (i % 4) {
+            case 0: snprintf(patternText[i], sizeof(patternText[i]), "module%d_*", i); break;
+            case 1: snprintf(patternText[i], sizeof(patternText[i]), "*_handler%d", i); break;
+            case 2: snprintf(patternText[i], sizeof(patternText[i]), "*load*item%d*", i); break;
+            default: snprintf(patternText[i], sizeof(patternText[i]), "module*_*_handler%d", i); break;
+        }
+        patterns[i] = patternText[i];
+    }
+    char** names = malloc(FUNCTIONS * sizeof(char*));
+    for (int i = 0; i < FUNCTIONS; i++) {
+        names[i] = malloc(64);
+        snprintf(names[i], 64, "module%d_loader_load_item%d_handler%d", i % 97, i, i % 401);
+    }
+
+    struct timespec start;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    long oldMatches = 0;
+    for (int f = 0; f < FUNCTIONS; f++) {
+        for (int p = 0; p < POINTCUTS; p++) {
+            oldMatches += backtracking_match(patterns[p], names[f]);
+        }
+    }
+    double oldMs = elapsed_ms(start);
+
+    // Pointcuts without advice, so the weaver only matches
+    weaver_init();
+    AstNode* program = make_program(make_aspect(patterns, POINTCUTS, false), names, FUNCTIONS);
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    CHECK(weaver_process(program));
+    double dfaMs = elapsed_ms(start);
+    CHECK(weaver_get_stats().joinpoints_found == oldMatches);
+
+    printf("pointcut matching, %d pointcuts x %d functions (%ld joinpoints): "
+           "backtracking %.1f ms, DFA weave %.1f ms\n",
+           POINTCUTS, FUNCTIONS, oldMatches, oldMs, dfaMs);
+
+    weaver_cleanup();
+    freeAstNode(program);
+    for (int i = 0; i < FUNCTIONS; i++) free(names[i]);
+    free(names);
+}
+
+int main(void) {
+    logger_set_level(LOG_ERROR);
+    test_pattern_shapes();
+    test_state_limit();
+    time_against_backtracking();
+
+    if (failures) {
+        fprintf(stderr, "test_pointcut: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_pointcut: all checks passed\n");
+    return 0;
+}
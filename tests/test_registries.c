@@ -0,0 +1,100 @@
+/**
+ * @file test_registries.c
+ * @brief Unit tests for the name-keyed registries built on src/hashmap.c
+ *
+ * Covers the macro registry (the first definition of a name is the one
+ * expanded) and the reflection type cache (distinct types that print the
+ * same name each get their own cached TypeInfo). Run with tests/run_tests.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+#include "macro_evaluator.h"
+#include "reflection.h"
+#include "types.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Builds a macro without parameters whose body is one number
+ */
+static AstNode* number_macro(const char* name, double value) {
+    AstNode* literal = createAstNode(AST_NUMBER_LITERAL);
+    literal->numberLiteral.value = value;
+    AstNode* def = createAstNode(AST_FUNC_DEF);
+    strncpy(def->funcDef.name, name, sizeof(def->funcDef.name) - 1);
+    def->funcDef.body = malloc(sizeof(AstNode*));
+    def->funcDef.body[0] = literal;
+    def->funcDef.bodyCount = 1;
+    return def;
+}
+
+static double expanded_number(const char* name) {
+    AstNode* block = expand_macro(name, NULL, 0);
+    if (!block || block->type != AST_PROGRAM || block->program.statementCount != 1 ||
+        block->program.statements[0]->type != AST_NUMBER_LITERAL) {
+        return -1;
+    }
+    double value = block->program.statements[0]->numberLiteral.value;
+    freeAstNode(block);
+    return value;
+}
+
+static void test_macro_first_definition_wins(void) {
+    macro_init();
+    AstNode* first = number_macro("pick_first", 1);
+    AstNode* second = number_macro("pick_first", 2);
+    AstNode* other = number_macro("pick_other", 3);
+
+    CHECK(register_macro(first));
+    CHECK(register_macro(second));
+    CHECK(register_macro(other));
+    CHECK(expanded_number("pick_first") == 1);
+    CHECK(expanded_number("pick_other") == 3);
+    CHECK(expand_macro("pick_missing", NULL, 0) == NULL);
+
+    macro_cleanup();
+}
+
+static void test_type_cache_shared_names(void) {
+    // A class named "int" prints like the primitive but is a different type
+    Type* primitive = createBasicType(TYPE_INT);
+    Type* klass = createClassType("int", NULL);
+    Type* samePrimitive = createBasicType(TYPE_INT);
+
+    TypeInfo* primitiveInfo = get_type_info(primitive);
+    TypeInfo* classInfo = get_type_info(klass);
+    CHECK(primitiveInfo != NULL);
+    CHECK(classInfo != NULL);
+    CHECK(primitiveInfo != classInfo);
+
+    // Both stay cached: asking again returns the same entries
+    CHECK(get_type_info(samePrimitive) == primitiveInfo);
+    CHECK(get_type_info(klass) == classInfo);
+
+    // Lookups by name find the type cached first
+    CHECK(get_type_info_by_name("int") == primitiveInfo);
+    CHECK(get_type_info_by_name("no_such_type") == NULL);
+}
+
+int main(void) {
+    test_macro_first_definition_wins();
+    test_type_cache_shared_names();
+
+    if (failures) {
+        fprintf(stderr, "test_registries: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_registries: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,173 @@
+/**
+ * @file test_templates.c
+ * @brief Unit tests for the template instantiation cache (src/templates.c)
+ *
+ * Covers reuse of a specialization for the same canonical type arguments,
+ * copies handed to callers, keeping the first definition of a name,
+ * reachability from the program and from exported names, and emission in
+ * instantiation order. Run with tests/run_tests.sh.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "ast.h"
+#include "templates.h"
+#include "types.h"
+
+static int failures = 0;
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            failures++; \
+        } \
+    } while (0)
+
+/**
+ * @brief Registers a one-parameter template whose body is an empty function
+ */
+static void register_function_template(const char* name) {
+    TemplateParam** params = malloc(sizeof(TemplateParam*));
+    params[0] = calloc(1, sizeof(TemplateParam));
+    strcpy(params[0]->name, "T");
+    AstNode* body = createAstNode(AST_FUNC_DEF);
+    strncpy(body->funcDef.name, name, sizeof(body->funcDef.name) - 1);
+    CHECK(register_template(name, params, 1, body));
+    freeAstNode(body);
+}
+
+/**
+ * @brief Builds a program whose only statement calls the given function
+ */
+static AstNode* program_calling(const char* name) {
+    AstNode* call = createAstNode(AST_FUNC_CALL);
+    strncpy(call->funcCall.name, name, sizeof(call->funcCall.name) - 1);
+    AstNode* program = createAstNode(AST_PROGRAM);
+    program->program.statements = malloc(sizeof(AstNode*));
+    program->program.statements[0] = call;
+    program->program.statementCount = 1;
+    return program;
+}
+
+static void test_cache_reuse(void) {
+    register_function_template("Box");
+    Type* intType = createBasicType(TYPE_INT);
+    Type* otherInt = createBasicType(TYPE_INT);
+    Type* floatType = createBasicType(TYPE_FLOAT);
+
+    AstNode* first = instantiate_template("Box", &intType, 1);
+    CHECK(first != NULL);
+    CHECK(first && strcmp(first->funcDef.name, "Box__int") == 0);
+
+    // Equal type arguments are the same specialization, even as new Type objects;
+    // each call hands out its own copy, so changing one leaves the cache intact
+    AstNode* again = instantiate_template("Box", &otherInt, 1);
+    CHECK(again != NULL && again != first);
+    CHECK(again && strcmp(again->funcDef.name, "Box__int") == 0);
+    if (first) strcpy(first->funcDef.name, "changed");
+    AstNode* third = instantiate_template("Box", &intType, 1);
+    CHECK(third && strcmp(third->funcDef.name, "Box__int") == 0);
+    AstNode* floats = instantiate_template("Box", &floatType, 1);
+    CHECK(floats && strcmp(floats->funcDef.name, "Box__float") == 0);
+
+    TemplateStats stats = templates_get_stats();
+    CHECK(stats.instantiations_requested == 4);
+    CHECK(stats.specializations_created == 2);
+    CHECK(stats.duplicates_avoided == 2);
+    CHECK(stats.c_bytes_saved > 0);
+
+    char key[64];
+    template_canonical_key("Box", &floatType, 1, key, sizeof(key));
+    CHECK(strcmp(key, "Box<float>") == 0);
+
+    freeAstNode(first);
+    freeAstNode(again);
+    freeAstNode(third);
+    freeAstNode(floats);
+    templates_cleanup();
+}
+
+static void test_redefinition_keeps_first(void) {
+    register_function_template("Pair");
+    Type* intType = createBasicType(TYPE_INT);
+    AstNode* before = instantiate_template("Pair", &intType, 1);
+
+    // A second definition of the name is ignored, so the cached body stays valid
+    TemplateParam** params = malloc(2 * sizeof(TemplateParam*));
+    for (int i = 0; i < 2; i++) {
+        params[i] = calloc(1, sizeof(TemplateParam));
+        strcpy(params[i]->name, i == 0 ? "K" : "V");
+    }
+    AstNode* body = createAstNode(AST_VAR_DECL);
+    CHECK(register_template("Pair", params, 2, body));
+    freeAstNode(body);
+
+    AstNode* after = instantiate_template("Pair", &intType, 1);
+    CHECK(after && after->type == AST_FUNC_DEF);
+    CHECK(after && strcmp(after->funcDef.name, "Pair__int") == 0);
+    CHECK(templates_get_stats().specializations_created == 1);
+
+    for (int i = 0; i < 2; i++) free(params[i]);
+    free(params);
+    freeAstNode(before);
+    freeAstNode(after);
+    templates_cleanup();
+}
+
+static void test_reachability_and_order(void) {
+    register_function_template("Cell");
+    TypeKind kinds[] = { TYPE_STRING, TYPE_FLOAT, TYPE_INT, TYPE_BOOL };
+    for (int i = 0; i < 4; i++) {
+        Type* arg = createBasicType(kinds[i]);
+        AstNode* copy = instantiate_template("Cell", &arg, 1);
+        CHECK(copy != NULL);
+        freeAstNode(copy);
+    }
+
+    // main calls two of them, an export names a third, the fourth is dead
+    AstNode* program = program_calling("Cell__int");
+    AstNode* extra = program_calling("Cell__string");
+    program->program.statements = realloc(program->program.statements, 2 * sizeof(AstNode*));
+    program->program.statements[1] = extra->program.statements[0];
+    program->program.statementCount = 2;
+    extra->program.statementCount = 0;
+    freeAstNode(extra);
+
+    const char* exported[] = { "Cell__bool", "not_a_specialization" };
+    CHECK(templates_mark_reachable(program, exported, 2) == 3);
+
+    int count = 0;
+    AstNode** nodes = templates_collect_reachable(&count);
+    CHECK(count == 3);
+    // Emitted in instantiation order, not in hash order
+    const char* expected[] = { "Cell__string", "Cell__int", "Cell__bool" };
+    for (int i = 0; i < count && i < 3; i++) {
+        CHECK(strcmp(nodes[i]->funcDef.name, expected[i]) == 0);
+    }
+    free(nodes);
+
+    TemplateStats stats = templates_get_stats();
+    CHECK(stats.specializations_emitted == 3);
+    CHECK(stats.specializations_pruned == 1);
+
+    // Without the export the same specialization is pruned
+    CHECK(templates_mark_reachable(program, NULL, 0) == 2);
+
+    freeAstNode(program);
+    templates_cleanup();
+}
+
+int main(void) {
+    test_cache_reuse();
+    test_redefinition_keeps_first();
+    test_reachability_and_order();
+
+    if (failures) {
+        fprintf(stderr, "test_templates: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("test_templates: all checks passed\n");
+    return 0;
+}